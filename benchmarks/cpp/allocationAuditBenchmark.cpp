@@ -0,0 +1,115 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/allocationAudit.h"
+#include "tensorrt_llm/runtime/tllmBuffers.h"
+
+#include <chrono>
+#include <cxxopts.hpp>
+#include <iostream>
+#include <string>
+
+using namespace tensorrt_llm::runtime;
+
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+// Allocates and frees a host buffer of `size` bytes `iterations` times and returns ns per allocation and free.
+double benchmarkAllocations(std::size_t size, std::size_t iterations)
+{
+    HostAllocator allocator;
+    auto const start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        auto* ptr = allocator.allocate(size);
+        allocator.deallocate(ptr, size);
+    }
+    auto const end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(iterations);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options("TensorRT-LLM C++ Runtime Benchmark",
+        "Host-only benchmark of the cost of AllocationAudit per allocation and free.");
+    options.add_options()("h,help", "Print usage");
+    options.add_options()("size", "Buffer size in bytes.", cxxopts::value<std::size_t>()->default_value("4096"));
+    options.add_options()(
+        "iterations", "Number of allocations per run.", cxxopts::value<std::size_t>()->default_value("100000"));
+    options.add_options()("num_frames", "Stack frames to record in the last run.",
+        cxxopts::value<std::size_t>()->default_value(std::to_string(AllocationAudit::kDefaultFrames)));
+    options.add_options()("log_level", "Choose log level between verbose/info/warning/error.",
+        cxxopts::value<std::string>()->default_value("error"));
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help"))
+    {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    auto logLevel = result["log_level"].as<std::string>();
+    auto& logger = *tc::Logger::getLogger();
+    if (logLevel == "verbose")
+    {
+        logger.setLevel(tc::Logger::TRACE);
+    }
+    else if (logLevel == "info")
+    {
+        logger.setLevel(tc::Logger::INFO);
+    }
+    else if (logLevel == "warning")
+    {
+        logger.setLevel(tc::Logger::WARNING);
+    }
+    else if (logLevel == "error")
+    {
+        logger.setLevel(tc::Logger::ERROR);
+    }
+    else
+    {
+        TLLM_LOG_ERROR("Unexpected log level: " + logLevel);
+        return 1;
+    }
+
+    auto const size = result["size"].as<std::size_t>();
+    auto const iterations = result["iterations"].as<std::size_t>();
+    auto const numFrames = result["num_frames"].as<std::size_t>();
+    if (size == 0 || iterations == 0)
+    {
+        TLLM_LOG_ERROR("Expected size > 0 and iterations > 0.");
+        return 1;
+    }
+
+    auto& audit = AllocationAudit::getInstance();
+    audit.disable();
+    auto const offNs = benchmarkAllocations(size, iterations);
+    audit.enable(0);
+    auto const tagOnlyNs = benchmarkAllocations(size, iterations);
+    audit.enable(numFrames);
+    auto const stackNs = benchmarkAllocations(size, iterations);
+    audit.disable();
+
+    std::cout << "[BENCHMARK] size " << size << " iterations " << iterations << " off(ns) " << offNs
+              << " tag_only(ns) " << tagOnlyNs << " stack_" << numFrames << "_frames(ns) " << stackNs << std::endl;
+
+    return 0;
+}
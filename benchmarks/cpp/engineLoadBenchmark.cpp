@@ -0,0 +1,197 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/plugins/api/tllmPlugin.h"
+#include "tensorrt_llm/runtime/engineBlob.h"
+#include "tensorrt_llm/runtime/tllmLogger.h"
+
+#include <NvInfer.h>
+#include <chrono>
+#include <cstdint>
+#include <cxxopts.hpp>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+// Peak resident set size of the process in MiB
+double getPeakRssMb()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss) / 1024.0; // ru_maxrss is in KiB on Linux
+}
+
+// Resident memory in MiB of `field` of /proc/self/status, RssAnon for anonymous memory or RssFile for mapped files
+double getStatusMb(std::string const& field)
+{
+    std::ifstream status("/proc/self/status");
+    std::string name;
+    double kb{0};
+    while (status >> name)
+    {
+        if (name == field + ":")
+        {
+            status >> kb;
+            break;
+        }
+        status.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    return kb / 1024.0;
+}
+
+// Reads every page of the blob, which is what deserializing does to a mapped file
+std::uint64_t touch(EngineBlob const& blob)
+{
+    auto const* const data = static_cast<std::uint8_t const*>(blob.data());
+    std::uint64_t sum{0};
+    for (std::size_t i = 0; i < blob.size(); i += 4096)
+    {
+        sum += data[i];
+    }
+    return sum;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options("TensorRT-LLM C++ Runtime Benchmark",
+        "Measures the time and peak host memory of loading an engine file. Peak RSS only grows, so run once per "
+        "load mode.");
+    options.add_options()("h,help", "Print usage");
+    options.add_options()("engine", "Path to the engine file.", cxxopts::value<std::string>());
+    options.add_options()(
+        "mode", "Load mode: read, mmap or direct.", cxxopts::value<std::string>()->default_value("read"));
+    options.add_options()("sessions", "Number of sessions that load the engine at the same time.",
+        cxxopts::value<int>()->default_value("1"));
+    options.add_options()("shared", "Share the blob between sessions through EngineBlobRegistry.",
+        cxxopts::value<bool>()->default_value("true"));
+    options.add_options()("deserialize", "Deserialize the engine with TensorRT rather than only reading its pages.",
+        cxxopts::value<bool>()->default_value("false"));
+    options.add_options()("log_level", "Choose log level between verbose/info/warning/error.",
+        cxxopts::value<std::string>()->default_value("error"));
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help") || !result.count("engine"))
+    {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    auto logLevel = result["log_level"].as<std::string>();
+    auto& logger = *tc::Logger::getLogger();
+    if (logLevel == "verbose")
+    {
+        logger.setLevel(tc::Logger::TRACE);
+    }
+    else if (logLevel == "info")
+    {
+        logger.setLevel(tc::Logger::INFO);
+    }
+    else if (logLevel == "warning")
+    {
+        logger.setLevel(tc::Logger::WARNING);
+    }
+    else if (logLevel == "error")
+    {
+        logger.setLevel(tc::Logger::ERROR);
+    }
+    else
+    {
+        TLLM_LOG_ERROR("Unexpected log level: " + logLevel);
+        return 1;
+    }
+
+    auto const enginePath = result["engine"].as<std::string>();
+    auto const modeName = result["mode"].as<std::string>();
+    auto const numSessions = result["sessions"].as<int>();
+    auto const shared = result["shared"].as<bool>();
+    auto const deserialize = result["deserialize"].as<bool>();
+
+    auto const mode = EngineBlob::parseLoadMode(modeName);
+    if (!mode)
+    {
+        TLLM_LOG_ERROR("Unexpected load mode: " + modeName);
+        return 1;
+    }
+    if (numSessions < 1)
+    {
+        TLLM_LOG_ERROR("Expected sessions > 0.");
+        return 1;
+    }
+
+    TllmLogger trtLogger{};
+    trtLogger.setLevel(nvinfer1::ILogger::Severity::kERROR);
+    std::unique_ptr<nvinfer1::IRuntime> runtime;
+    if (deserialize)
+    {
+        initTrtLlmPlugins(&trtLogger);
+        runtime.reset(nvinfer1::createInferRuntime(trtLogger));
+    }
+
+    auto const peakRssBefore = getPeakRssMb();
+    auto const start = std::chrono::steady_clock::now();
+
+    // Every session holds its blob until all are loaded, as sessions created at the same time would
+    std::vector<EngineBlobRegistry::BlobPtr> blobs;
+    std::vector<std::unique_ptr<nvinfer1::ICudaEngine>> engines;
+    std::uint64_t checksum{0};
+    for (int session = 0; session < numSessions; ++session)
+    {
+        auto const& blob = blobs.emplace_back(shared ? EngineBlobRegistry::getInstance().acquire(enginePath, *mode)
+                                                     : EngineBlobRegistry::BlobPtr{EngineBlob::load(enginePath, *mode)});
+        if (deserialize)
+        {
+            engines.emplace_back(runtime->deserializeCudaEngine(blob->data(), blob->size()));
+            if (!engines.back())
+            {
+                TLLM_LOG_ERROR("Failed to deserialize " + enginePath);
+                return 1;
+            }
+        }
+        else
+        {
+            checksum += touch(*blob);
+        }
+    }
+
+    auto const end = std::chrono::steady_clock::now();
+    auto const peakRssAfter = getPeakRssMb();
+    // Mapped pages count towards RSS like anonymous memory, but are clean page cache the kernel can reclaim
+    auto const anonRss = getStatusMb("RssAnon");
+    auto const fileRss = getStatusMb("RssFile");
+    auto const latencyMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::cout << "[BENCHMARK] engine_size(MiB) " << static_cast<double>(blobs.front()->size()) / (1 << 20) << " mode "
+              << modeName << " sessions " << numSessions << " shared " << shared << " latency(ms) " << latencyMs
+              << " peak_rss_before(MiB) " << peakRssBefore << " peak_rss_after(MiB) " << peakRssAfter
+              << " rss_anon(MiB) " << anonRss << " rss_file(MiB) " << fileRss << " checksum " << checksum
+              << std::endl;
+
+    return 0;
+}
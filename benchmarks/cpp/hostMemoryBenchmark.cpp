@@ -0,0 +1,234 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/tllmBuffers.h"
+
+#include <chrono>
+#include <cstring>
+#include <cxxopts.hpp>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace tensorrt_llm::runtime;
+
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+// Counts the data TLB misses of this thread while alive. Reads nothing if perf events are not available, which is
+// common in containers.
+class TlbMissCounter
+{
+public:
+    TlbMissCounter()
+    {
+#if defined(__linux__)
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        mFd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~TlbMissCounter()
+    {
+#if defined(__linux__)
+        if (mFd >= 0)
+        {
+            ::close(mFd);
+        }
+#endif
+    }
+
+    TlbMissCounter(TlbMissCounter const&) = delete;
+    TlbMissCounter& operator=(TlbMissCounter const&) = delete;
+
+    void start()
+    {
+#if defined(__linux__)
+        if (mFd >= 0)
+        {
+            ::ioctl(mFd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(mFd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    [[nodiscard]] std::optional<std::uint64_t> stop()
+    {
+#if defined(__linux__)
+        std::uint64_t count{};
+        if (mFd >= 0 && ::ioctl(mFd, PERF_EVENT_IOC_DISABLE, 0) == 0
+            && ::read(mFd, &count, sizeof(count)) == sizeof(count))
+        {
+            return count;
+        }
+#endif
+        return std::nullopt;
+    }
+
+private:
+    int mFd{-1};
+};
+
+struct Result
+{
+    double gbPerSec;
+    std::optional<std::uint64_t> tlbMisses;
+};
+
+// Copies `size` bytes between two buffers from `allocator` `iterations` times after one untimed copy, so that page
+// faults are not part of the result.
+template <typename TAllocator>
+Result benchmarkMemcpy(TAllocator& allocator, std::size_t size, std::size_t iterations)
+{
+    auto* src = static_cast<std::uint8_t*>(allocator.allocate(size));
+    auto* dst = static_cast<std::uint8_t*>(allocator.allocate(size));
+    std::memset(src, 1, size);
+    std::memcpy(dst, src, size);
+
+    TlbMissCounter tlbMisses;
+    tlbMisses.start();
+    auto const start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        std::memcpy(dst, src, size);
+        // Keep the copies from being merged
+        src[i % size] = dst[(i * 7) % size];
+    }
+    auto const end = std::chrono::steady_clock::now();
+    auto const misses = tlbMisses.stop();
+
+    allocator.deallocate(dst, size);
+    allocator.deallocate(src, size);
+    auto const seconds = std::chrono::duration<double>(end - start).count();
+    return {static_cast<double>(size * iterations) / seconds / 1e9, misses};
+}
+
+std::string toString(std::optional<std::uint64_t> const& count)
+{
+    return count ? std::to_string(*count) : std::string{"n/a"};
+}
+
+std::vector<std::size_t> parseList(std::string const& arg)
+{
+    std::istringstream ss(arg);
+    std::vector<std::size_t> values;
+    for (std::string token; std::getline(ss, token, ';');)
+    {
+        values.push_back(std::stoul(token));
+    }
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options("TensorRT-LLM C++ Runtime Benchmark",
+        "Host-only benchmark of memcpy bandwidth and TLB misses with regular pages, huge pages and NUMA binding.");
+    options.add_options()("h,help", "Print usage");
+    options.add_options()("size_mb",
+        "Buffer size(s) in MB. Multiple values can be separated by \";\", example: \"16;256;1024\".",
+        cxxopts::value<std::string>()->default_value("16;256;1024"));
+    options.add_options()(
+        "iterations", "Number of copies to time per size.", cxxopts::value<std::size_t>()->default_value("10"));
+    options.add_options()("numa_node",
+        "NUMA node to bind the buffers to, -1 for none. Compare runs pinned to the same and another socket, e.g. with "
+        "numactl --cpunodebind.",
+        cxxopts::value<int>()->default_value("-1"));
+    options.add_options()("log_level", "Choose log level between verbose/info/warning/error.",
+        cxxopts::value<std::string>()->default_value("warning"));
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help"))
+    {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    auto logLevel = result["log_level"].as<std::string>();
+    auto& logger = *tc::Logger::getLogger();
+    if (logLevel == "verbose")
+    {
+        logger.setLevel(tc::Logger::TRACE);
+    }
+    else if (logLevel == "info")
+    {
+        logger.setLevel(tc::Logger::INFO);
+    }
+    else if (logLevel == "warning")
+    {
+        logger.setLevel(tc::Logger::WARNING);
+    }
+    else if (logLevel == "error")
+    {
+        logger.setLevel(tc::Logger::ERROR);
+    }
+    else
+    {
+        TLLM_LOG_ERROR("Unexpected log level: " + logLevel);
+        return 1;
+    }
+
+    auto const iterations = result["iterations"].as<std::size_t>();
+    auto const numaNode = result["numa_node"].as<int>();
+    if (iterations == 0 || numaNode < HostMemoryPolicy::kAnyNode)
+    {
+        TLLM_LOG_ERROR("Expected iterations > 0 and numa_node >= -1.");
+        return 1;
+    }
+
+    for (auto const sizeMb : parseList(result["size_mb"].as<std::string>()))
+    {
+        if (sizeMb == 0)
+        {
+            continue;
+        }
+        auto const size = sizeMb << 20;
+        HostAllocator hostAllocator;
+        auto const host = benchmarkMemcpy(hostAllocator, size, iterations);
+
+        HostMemoryPolicy policy;
+        policy.hugePages = true;
+        policy.numaNode = numaNode;
+        PlacedCpuAllocator placedAllocator{policy};
+        auto const placed = benchmarkMemcpy(placedAllocator, size, iterations);
+
+        std::cout << "[BENCHMARK] size(MB) " << sizeMb << " numa_node " << numaNode << " malloc(GB/s) "
+                  << host.gbPerSec << " malloc_dtlb_misses " << toString(host.tlbMisses) << " huge_pages(GB/s) "
+                  << placed.gbPerSec << " huge_pages_dtlb_misses " << toString(placed.tlbMisses) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/tllmBuffers.h"
+
+#include <chrono>
+#include <cmath>
+#include <cxxopts.hpp>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+// Sizes drawn log-uniformly from [minSize, maxSize], which is roughly what the runtime asks for: many small
+// per-request buffers and fewer large ones.
+std::vector<std::size_t> makeSizes(std::size_t count, std::size_t minSize, std::size_t maxSize, std::mt19937& rng)
+{
+    std::uniform_real_distribution<double> dist(std::log2(static_cast<double>(minSize)),
+        std::log2(static_cast<double>(maxSize)));
+    std::vector<std::size_t> sizes(count);
+    for (auto& size : sizes)
+    {
+        size = static_cast<std::size_t>(std::exp2(dist(rng)));
+    }
+    return sizes;
+}
+
+// Fills `numLive` allocations, then frees a random live one and allocates a new one `numOps` times. Only the churn
+// is timed. Returns ns per alloc/free pair.
+template <typename TAllocator>
+double benchmarkChurn(TAllocator& allocator, std::size_t numLive, std::size_t numOps, std::size_t minSize,
+    std::size_t maxSize, unsigned seed)
+{
+    std::mt19937 rng{seed};
+    auto const sizes = makeSizes(numLive + numOps, minSize, maxSize, rng);
+    std::vector<std::size_t> victims(numOps);
+    for (auto& victim : victims)
+    {
+        victim = rng() % numLive;
+    }
+
+    std::vector<std::pair<void*, std::size_t>> live(numLive);
+    for (std::size_t i = 0; i < numLive; ++i)
+    {
+        live[i] = {allocator.allocate(sizes[i]), sizes[i]};
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < numOps; ++i)
+    {
+        auto& [ptr, size] = live[victims[i]];
+        allocator.deallocate(ptr, size);
+        size = sizes[numLive + i];
+        ptr = allocator.allocate(size);
+    }
+    auto const end = std::chrono::steady_clock::now();
+
+    for (auto const& [ptr, size] : live)
+    {
+        allocator.deallocate(ptr, size);
+    }
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(numOps);
+}
+
+// Runs benchmarkChurn on `numThreads` threads sharing `allocator`. Returns the mean ns per alloc/free pair.
+template <typename TAllocator>
+double benchmarkThreads(TAllocator& allocator, std::size_t numThreads, std::size_t numLive, std::size_t numOps,
+    std::size_t minSize, std::size_t maxSize, unsigned seed)
+{
+    // The logger is per thread
+    auto const logLevel = tc::Logger::getLogger()->getLevel();
+    std::vector<double> nsPerOp(numThreads);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < numThreads; ++t)
+    {
+        threads.emplace_back(
+            [&, t]()
+            {
+                tc::Logger::getLogger()->setLevel(logLevel);
+                nsPerOp[t] = benchmarkChurn(allocator, numLive, numOps, minSize, maxSize, seed + t);
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    return std::accumulate(nsPerOp.begin(), nsPerOp.end(), 0.0) / static_cast<double>(numThreads);
+}
+
+std::vector<std::size_t> parseList(std::string const& arg)
+{
+    std::istringstream ss(arg);
+    std::vector<std::size_t> values;
+    for (std::string token; std::getline(ss, token, ';');)
+    {
+        values.push_back(std::stoul(token));
+    }
+    return values;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options(
+        "TensorRT-LLM C++ Runtime Benchmark", "Host-only benchmark of MemoryPool against its backing allocator.");
+    options.add_options()("h,help", "Print usage");
+    options.add_options()("num_live",
+        "Number(s) of live allocations kept while churning. Multiple values can be separated by \";\", example: "
+        "\"64;1024;8192\".",
+        cxxopts::value<std::string>()->default_value("64;1024;8192"));
+    options.add_options()(
+        "num_ops", "Number of free/alloc pairs to time.", cxxopts::value<std::size_t>()->default_value("200000"));
+    options.add_options()(
+        "min_size", "Smallest allocation in bytes.", cxxopts::value<std::size_t>()->default_value("256"));
+    options.add_options()(
+        "max_size", "Largest allocation in bytes.", cxxopts::value<std::size_t>()->default_value("65536"));
+    options.add_options()("threads",
+        "Number(s) of threads sharing one pool, each keeping num_live / 8 allocations. Multiple values can be "
+        "separated by \";\", example: \"1;4;8\".",
+        cxxopts::value<std::string>()->default_value("1;2;4;8"));
+    options.add_options()("seed", "Random seed.", cxxopts::value<unsigned>()->default_value("0"));
+    options.add_options()("log_level", "Choose log level between verbose/info/warning/error.",
+        cxxopts::value<std::string>()->default_value("error"));
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help"))
+    {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    auto logLevel = result["log_level"].as<std::string>();
+    auto& logger = *tc::Logger::getLogger();
+    if (logLevel == "verbose")
+    {
+        logger.setLevel(tc::Logger::TRACE);
+    }
+    else if (logLevel == "info")
+    {
+        logger.setLevel(tc::Logger::INFO);
+    }
+    else if (logLevel == "warning")
+    {
+        logger.setLevel(tc::Logger::WARNING);
+    }
+    else if (logLevel == "error")
+    {
+        logger.setLevel(tc::Logger::ERROR);
+    }
+    else
+    {
+        TLLM_LOG_ERROR("Unexpected log level: " + logLevel);
+        return 1;
+    }
+
+    auto const numOps = result["num_ops"].as<std::size_t>();
+    auto const minSize = result["min_size"].as<std::size_t>();
+    auto const maxSize = result["max_size"].as<std::size_t>();
+    auto const seed = result["seed"].as<unsigned>();
+    if (minSize == 0 || minSize > maxSize)
+    {
+        TLLM_LOG_ERROR("Expected 0 < min_size <= max_size.");
+        return 1;
+    }
+
+    for (auto const numLive : parseList(result["num_live"].as<std::string>()))
+    {
+        if (numLive == 0)
+        {
+            continue;
+        }
+        HostAllocator hostAllocator;
+        auto const hostNs = benchmarkChurn(hostAllocator, numLive, numOps, minSize, maxSize, seed);
+
+        // One chunk large enough for the worst case, so the pool never grows while being timed
+        MemoryPool<HostAllocator> pool{numLive * (maxSize + MemoryPool<HostAllocator>::kAlignment) * 2};
+        auto const poolNs = benchmarkChurn(pool, numLive, numOps, minSize, maxSize, seed);
+
+        std::cout << "[BENCHMARK] num_live " << numLive << " sizes " << minSize << "-" << maxSize << " host(ns/op) "
+                  << hostNs << " pool(ns/op) " << poolNs << std::endl;
+    }
+
+    // The same pool behind one lock, as every thread used it before, against PoolAllocator's thread caches
+    auto const maxLive = parseList(result["num_live"].as<std::string>()).back();
+    auto const threadLive = std::max<std::size_t>(maxLive / 8, 1);
+    for (auto const numThreads : parseList(result["threads"].as<std::string>()))
+    {
+        if (numThreads == 0)
+        {
+            continue;
+        }
+        using CachedAllocator = PoolAllocator<HostAllocator>;
+        MemoryPool<HostAllocator> pool{numThreads * threadLive * (maxSize + MemoryPool<HostAllocator>::kAlignment) * 2};
+        auto const lockedNs = benchmarkThreads(pool, numThreads, threadLive, numOps, minSize, maxSize, seed);
+
+        CachedAllocator cachedAllocator;
+        auto const initStats = CachedAllocator::getThreadCacheStats();
+        auto const cachedNs
+            = benchmarkThreads(cachedAllocator, numThreads, threadLive, numOps, minSize, maxSize, seed);
+        auto const stats = CachedAllocator::getThreadCacheStats();
+        auto const hits = static_cast<double>(stats.hits - initStats.hits);
+        auto const hitRate = 100.0 * hits / (hits + static_cast<double>(stats.misses - initStats.misses));
+
+        std::cout << "[BENCHMARK] threads " << numThreads << " num_live " << threadLive << " shared_pool(ns/op) "
+                  << lockedNs << " thread_cache(ns/op) " << cachedNs << " cache_hit_rate(%) " << hitRate << std::endl;
+    }
+
+    return 0;
+}
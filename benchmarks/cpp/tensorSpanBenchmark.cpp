@@ -0,0 +1,144 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/tensorSpan.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cxxopts.hpp>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <utility>
+
+using namespace tensorrt_llm::runtime;
+
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+// Stands in for a kernel launch or copy that takes a tensor by reference. Called through a volatile pointer so that
+// it is not inlined, like those functions which live in other translation units.
+std::int64_t consumeImpl(ITensor const& tensor)
+{
+    return *bufferCast<std::int32_t>(tensor) + static_cast<std::int64_t>(tensor.getSize());
+}
+
+std::int64_t (*volatile consume)(ITensor const&) = consumeImpl;
+
+// Per step, takes one slice per request of a [batch, beam, length] tensor, squeezes it and reads it, the way the
+// decoder picks per-request rows. Returns ns per slice and a checksum.
+template <typename TSliceFn>
+std::pair<double, std::int64_t> benchmarkSlices(std::size_t numSteps, std::size_t batchSize, TSliceFn&& sliceFn)
+{
+    std::int64_t checksum = 0;
+    auto const start = std::chrono::steady_clock::now();
+    for (std::size_t step = 0; step < numSteps; ++step)
+    {
+        for (std::size_t bi = 0; bi < batchSize; ++bi)
+        {
+            checksum += sliceFn(bi);
+        }
+    }
+    auto const end = std::chrono::steady_clock::now();
+    auto const ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return {ns / static_cast<double>(numSteps * batchSize), checksum};
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    cxxopts::Options options("TensorRT-LLM C++ Runtime Benchmark",
+        "Host-only benchmark of ITensor::slice against TensorSpan in a per-step slicing loop.");
+    options.add_options()("h,help", "Print usage");
+    options.add_options()(
+        "batch_size", "Number of requests sliced per step.", cxxopts::value<std::size_t>()->default_value("64"));
+    options.add_options()("num_steps", "Number of steps.", cxxopts::value<std::size_t>()->default_value("100000"));
+    options.add_options()("log_level", "Choose log level between verbose/info/warning/error.",
+        cxxopts::value<std::string>()->default_value("error"));
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help"))
+    {
+        std::cout << options.help() << std::endl;
+        exit(0);
+    }
+
+    auto logLevel = result["log_level"].as<std::string>();
+    auto& logger = *tc::Logger::getLogger();
+    if (logLevel == "verbose")
+    {
+        logger.setLevel(tc::Logger::TRACE);
+    }
+    else if (logLevel == "info")
+    {
+        logger.setLevel(tc::Logger::INFO);
+    }
+    else if (logLevel == "warning")
+    {
+        logger.setLevel(tc::Logger::WARNING);
+    }
+    else if (logLevel == "error")
+    {
+        logger.setLevel(tc::Logger::ERROR);
+    }
+    else
+    {
+        TLLM_LOG_ERROR("Unexpected log level: " + logLevel);
+        return 1;
+    }
+
+    auto const batchSize = result["batch_size"].as<std::size_t>();
+    auto const numSteps = result["num_steps"].as<std::size_t>();
+    if (batchSize == 0 || numSteps == 0)
+    {
+        TLLM_LOG_ERROR("Expected batch_size > 0 and num_steps > 0.");
+        return 1;
+    }
+
+    auto constexpr beamWidth = 1;
+    auto constexpr length = 16;
+    ITensor::SharedPtr tensor{BufferManager::cpu(
+        ITensor::makeShape({static_cast<SizeType>(batchSize), beamWidth, length}), nvinfer1::DataType::kINT32)};
+    auto* data = bufferCast<std::int32_t>(*tensor);
+    std::iota(data, data + tensor->getSize(), 0);
+
+    auto const [sliceNs, sliceChecksum] = benchmarkSlices(numSteps, batchSize,
+        [&tensor](std::size_t bi)
+        {
+            ITensor::SharedPtr slice = ITensor::slice(tensor, bi, 1);
+            slice->squeeze(0);
+            return consume(*slice);
+        });
+
+    auto const [spanNs, spanChecksum] = benchmarkSlices(numSteps, batchSize,
+        [span = TensorSpan{*tensor}](std::size_t bi) { return consume(SpanTensor{span.at(bi)}); });
+
+    if (sliceChecksum != spanChecksum)
+    {
+        TLLM_LOG_ERROR("Checksums differ: %ld != %ld", sliceChecksum, spanChecksum);
+        return 1;
+    }
+
+    std::cout << "[BENCHMARK] batch_size " << batchSize << " num_steps " << numSteps << " itensor_slice(ns/slice) "
+              << sliceNs << " tensor_span(ns/slice) " << spanNs << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/iBuffer.h"
+#include "tensorrt_llm/runtime/memoryCounters.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Records the allocation site, size and time of every live runtime buffer, to find what holds memory that
+//!        creeps up over time.
+//!
+//! \details Off by default. It is enabled with enable() or by setting TLLM_ALLOCATION_AUDIT to the number of stack
+//!          frames to record. With 0 frames, a site is only the memory type and tag of the allocator, which adds a
+//!          hash map insert and erase to every buffer, around 150 ns. The stack is captured with backtrace(), which
+//!          adds around 2.5 us for 8 frames, affordable since most runtime buffers are allocated up front rather than
+//!          per step. Built with the FRAME_POINTERS CMake option on x86-64 or AArch64 Linux, the frame pointers are
+//!          followed instead, around 20 ns for 8 frames, with backtrace() for chains that end early in callers built
+//!          without them. Stack capture is not available on Windows.
+//!
+//!          Allocators that take memory from the system record it, except for the chunks of memory pools, whose
+//!          blocks are recorded by PoolAllocator instead. Buffers allocated before the audit was enabled are not
+//!          recorded, and disabling it forgets all records.
+class AllocationAudit
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static std::size_t constexpr kMaxFrames{32};
+    static std::size_t constexpr kDefaultFrames{8};
+
+    //! \brief Where a buffer was allocated: the return addresses of the calls leading to the allocator, innermost
+    //!        first, with the memory type and tag of the allocator.
+    struct Site
+    {
+        std::array<void*, kMaxFrames> frames{};
+        std::size_t numFrames{0};
+        MemoryType memoryType{MemoryType::kCPU};
+        MemoryTag tag{MemoryTag::kUNTAGGED};
+
+        [[nodiscard]] bool operator==(Site const& other) const;
+
+        [[nodiscard]] std::size_t hash() const;
+
+        //! \brief One line with the memory type and tag and one line per symbolized frame.
+        [[nodiscard]] std::string toString() const;
+    };
+
+    //! \brief The live buffers of one site.
+    struct SiteUsage
+    {
+        Site site;
+        std::size_t count{0};
+        std::size_t bytes{0};
+        //! \brief When the oldest of the buffers was allocated.
+        Clock::time_point oldest;
+    };
+
+    //! \brief The live buffers at one point in time, grouped by site with the most bytes first.
+    struct Snapshot
+    {
+        Clock::time_point time;
+        std::vector<SiteUsage> sites;
+
+        [[nodiscard]] std::size_t getBytes() const;
+
+        [[nodiscard]] std::size_t getCount() const;
+
+        //! \brief The `maxSites` sites holding the most bytes.
+        [[nodiscard]] std::string toString(std::size_t maxSites = 10) const;
+    };
+
+    struct SiteDiff
+    {
+        Site site;
+        std::ptrdiff_t count{0};
+        std::ptrdiff_t bytes{0};
+    };
+
+    //! \brief The sites whose live buffers changed between two snapshots, the largest change in bytes first.
+    struct SnapshotDiff
+    {
+        Clock::duration elapsed{};
+        std::vector<SiteDiff> sites;
+
+        [[nodiscard]] std::ptrdiff_t getBytes() const;
+
+        [[nodiscard]] std::string toString(std::size_t maxSites = 10) const;
+    };
+
+    //! \brief Disables auditing while alive on this thread. Used around the chunk allocations of memory pools.
+    class SuppressScope
+    {
+    public:
+        SuppressScope() noexcept
+        {
+            ++suppressed();
+        }
+
+        ~SuppressScope()
+        {
+            --suppressed();
+        }
+
+        SuppressScope(SuppressScope const&) = delete;
+        SuppressScope& operator=(SuppressScope const&) = delete;
+    };
+
+    static AllocationAudit& getInstance();
+
+    [[nodiscard]] static bool isEnabled() noexcept
+    {
+        return sEnabled.load(std::memory_order_relaxed);
+    }
+
+    //! \brief Starts recording allocations with `numFrames` stack frames, at most kMaxFrames.
+    void enable(std::size_t numFrames = kDefaultFrames);
+
+    //! \brief Stops recording and forgets all live buffers.
+    void disable();
+
+    void recordAllocation(void* ptr, std::size_t size, MemoryType memoryType, MemoryTag tag);
+
+    //! \brief Forgets `ptr`. Must be called before the memory is freed, since it may be handed out again right away.
+    void recordDeallocation(void* ptr);
+
+    [[nodiscard]] Snapshot snapshot() const;
+
+    [[nodiscard]] static SnapshotDiff diff(Snapshot const& before, Snapshot const& after);
+
+private:
+    static std::size_t constexpr kNumShards{16}; // Must match the shift in getShard
+
+    struct Record
+    {
+        Site site;
+        std::size_t size;
+        Clock::time_point time;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<void*, Record> records;
+    };
+
+    AllocationAudit() = default;
+
+    static int& suppressed() noexcept
+    {
+        static thread_local int count{0};
+        return count;
+    }
+
+    Shard& getShard(void* ptr);
+
+    static inline std::atomic<bool> sEnabled{false};
+
+    std::atomic<std::size_t> mNumFrames{kDefaultFrames};
+    std::array<Shard, kNumShards> mShards;
+};
+
+} // namespace tensorrt_llm::runtime
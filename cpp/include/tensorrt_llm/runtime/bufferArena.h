@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/iBuffer.h"
+#include "tensorrt_llm/runtime/memoryCounters.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Bump-pointer arena for the buffers of one request.
+//!
+//! \details Buffers are carved from blocks of one memory type by moving an offset, and freeing a buffer does nothing.
+//!          All blocks are released together when the arena is destroyed, which happens when the last buffer
+//!          allocated from it goes away, as each buffer holds a reference to its arena. Sizing the first block for
+//!          the whole request makes its setup a single allocation. Blocks are attributed to the MemoryTagScope the
+//!          arena was created in. Not thread-safe: allocate from one thread at a time.
+class BufferArena
+{
+public:
+    using SharedPtr = std::shared_ptr<BufferArena>;
+    using CudaStreamPtr = std::shared_ptr<CudaStream>;
+
+    static std::size_t constexpr kAlignment{256};
+    static std::size_t constexpr kDefaultBlockSize{std::size_t{1} << 16}; // 64 KB
+
+    //! \param[in] memoryType The memory type of all blocks.
+    //! \param[in] blockSize The size of a block. Larger requests get a block of their own size.
+    //! \param[in] stream The stream used to allocate and free GPU blocks. Not needed for other memory types.
+    explicit BufferArena(
+        MemoryType memoryType, std::size_t blockSize = kDefaultBlockSize, CudaStreamPtr stream = nullptr);
+
+    //! \brief Returns `size` bytes aligned to kAlignment, adding a block when the current one is full.
+    [[nodiscard]] void* allocate(std::size_t size);
+
+    [[nodiscard]] MemoryType getMemoryType() const
+    {
+        return mMemoryType;
+    }
+
+    //! \brief The bytes handed out so far, including alignment.
+    [[nodiscard]] std::size_t getUsedSize() const
+    {
+        return mUsedSize;
+    }
+
+    //! \brief The total size of all blocks.
+    [[nodiscard]] std::size_t getReservedSize() const
+    {
+        return mReservedSize;
+    }
+
+    [[nodiscard]] std::size_t getNumBlocks() const
+    {
+        return mBlocks.size();
+    }
+
+private:
+    [[nodiscard]] IBuffer::UniquePtr allocateBlock(std::size_t size) const;
+
+    MemoryType mMemoryType;
+    std::size_t mBlockSize;
+    CudaStreamPtr mStream;
+    MemoryTag mMemoryTag{MemoryCounters::getCurrentTag()};
+    std::vector<IBuffer::UniquePtr> mBlocks;
+    // Into the last block
+    std::size_t mOffset{0};
+    std::size_t mUsedSize{0};
+    std::size_t mReservedSize{0};
+};
+
+} // namespace tensorrt_llm::runtime
@@ -17,11 +17,16 @@
 #pragma once
 
 #include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/bufferArena.h"
+#include "tensorrt_llm/runtime/copyBatch.h"
 #include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/hostMemoryPolicy.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
 #include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/memoryCounters.h"
 #include <NvInferRuntime.h>
 
+#include <chrono>
 #include <cstring>
 #include <memory>
 #include <string>
@@ -70,16 +75,17 @@ public:
     //! \brief Allocates an `ITensor` of the given dimensions on the GPU, using cudaMalloc.
     [[nodiscard]] static ITensorPtr gpuSync(nvinfer1::Dims dims, nvinfer1::DataType type = kBYTE_TYPE);
 
-    //! \brief Allocates an `IBuffer` of the given size on the CPU.
+    //! \brief Allocates an `IBuffer` of the given size on the CPU, placed according to the host memory policy.
     [[nodiscard]] static IBufferPtr cpu(std::size_t size, nvinfer1::DataType type = kBYTE_TYPE);
 
-    //! \brief Allocates an `ITensor` of the given dimensions on the CPU.
+    //! \brief Allocates an `ITensor` of the given dimensions on the CPU, placed according to the host memory policy.
     [[nodiscard]] static ITensorPtr cpu(nvinfer1::Dims dims, nvinfer1::DataType type = kBYTE_TYPE);
 
-    //! \brief Allocates a pinned `IBuffer` of the given size on the CPU.
+    //! \brief Allocates a pinned `IBuffer` of the given size on the CPU, placed according to the host memory policy.
     [[nodiscard]] static IBufferPtr pinned(std::size_t size, nvinfer1::DataType type = kBYTE_TYPE);
 
-    //! \brief Allocates a pinned `ITensor` of the given dimensions on the CPU.
+    //! \brief Allocates a pinned `ITensor` of the given dimensions on the CPU, placed according to the host memory
+    //! policy.
     [[nodiscard]] static ITensorPtr pinned(nvinfer1::Dims dims, nvinfer1::DataType type = kBYTE_TYPE);
 
     //! \brief Allocates a pinned `IBuffer` of the given size on the CPU in the default memory pool.
@@ -102,6 +108,21 @@ public:
     [[nodiscard]] ITensorPtr allocate(
         MemoryType memoryType, nvinfer1::Dims dims, nvinfer1::DataType type = kBYTE_TYPE) const;
 
+    //! \brief Create an arena for the buffers of one request. GPU blocks are allocated on this manager's stream.
+    [[nodiscard]] BufferArena::SharedPtr createArena(
+        MemoryType memoryType, std::size_t blockSize = BufferArena::kDefaultBlockSize) const;
+
+    //! \brief Create a batch of host-to-device copies that is issued on this manager's stream.
+    [[nodiscard]] CopyBatch::UniquePtr createCopyBatch() const;
+
+    //! \brief Allocates an `IBuffer` of the given size from `arena`.
+    [[nodiscard]] static IBufferPtr allocate(
+        BufferArena::SharedPtr const& arena, std::size_t size, nvinfer1::DataType type = kBYTE_TYPE);
+
+    //! \brief Allocates an `ITensor` of the given dimensions from `arena`.
+    [[nodiscard]] static ITensorPtr allocate(
+        BufferArena::SharedPtr const& arena, nvinfer1::Dims dims, nvinfer1::DataType type = kBYTE_TYPE);
+
     //! \brief Create an empty `IBuffer` of the given memory type. It may be resized later.
     [[nodiscard]] IBufferPtr emptyBuffer(MemoryType memoryType, nvinfer1::DataType type = kBYTE_TYPE) const
     {
@@ -114,6 +135,13 @@ public:
         return allocate(memoryType, ITensor::makeShape({}), type);
     }
 
+    //! \brief Create an empty `ITensor` in `arena`. It may be reshaped later.
+    [[nodiscard]] static ITensorPtr emptyTensor(
+        BufferArena::SharedPtr const& arena, nvinfer1::DataType type = kBYTE_TYPE)
+    {
+        return allocate(arena, ITensor::makeShape({}), type);
+    }
+
     //! \brief Set the contents of the given `buffer` to value.
     void setMem(IBuffer& buffer, int32_t value) const;
 
@@ -175,6 +203,19 @@ public:
         return copyFrom(src.data(), dims, memoryType);
     }
 
+    //! \brief Copy `src` into a new `ITensor` allocated from `arena`.
+    template <typename T>
+    [[nodiscard]] ITensorPtr copyFrom(
+        std::vector<T> const& src, nvinfer1::Dims dims, BufferArena::SharedPtr const& arena) const
+    {
+        TLLM_CHECK_WITH_INFO(src.size() == ITensor::volumeNonNegative(dims),
+            common::fmtstr("[TensorRT-LLM][ERROR] Incompatible size %lu and dims %s", src.size(),
+                ITensor::toString(dims).c_str()));
+        auto buffer = allocate(arena, dims, TRTDataType<std::remove_cv_t<T>>::value);
+        copy(src.data(), *buffer);
+        return buffer;
+    }
+
     //! \brief Get the underlying cuda stream.
     [[nodiscard]] CudaStream const& getStream() const;
 
@@ -191,6 +232,31 @@ public:
     //! stream.
     void memoryPoolTrimTo(std::size_t size);
 
+    //! \brief Return the chunks of the pinned memory pool that hold no buffers until at most `size` bytes are
+    //! reserved. Only the calling thread's cache is flushed first, other threads flush theirs on their next
+    //! allocation or free, and their chunks are released by a later trim. Returns the number of bytes released.
+    std::size_t static pinnedPoolTrimTo(std::size_t size);
+
+    //! \brief Release chunks of the pinned memory pool once they have held no buffers for `timeout`. A timeout of 0
+    //! keeps them until trimmed.
+    void static pinnedPoolSetIdleTimeout(std::chrono::milliseconds timeout);
+
+    //! \brief Release the chunks of the pinned memory pool that have been idle for longer than the idle timeout. The
+    //! timeout is otherwise only checked when the pool allocates or frees, call this periodically to release chunks
+    //! while the pool sees no traffic. Threads flush their cached buffers on their next allocation or free, so that
+    //! they do not keep chunks from going idle. Returns the number of bytes released.
+    std::size_t static pinnedPoolTrimIdle();
+
+    //! \brief Occupancy and fragmentation of the pinned memory pool.
+    [[nodiscard]] MemoryPoolReport static pinnedPoolReport();
+
+    //! \brief Set the page size and NUMA node of the buffers later returned by cpu() and pinned(). Existing buffers and
+    //! the pinned memory pool keep their placement.
+    void static setHostMemoryPolicy(HostMemoryPolicy const& policy);
+
+    //! \brief The policy last set, read without a lock.
+    [[nodiscard]] HostMemoryPolicy static getHostMemoryPolicy();
+
 private:
     friend class ::BufferManagerTest;
 
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/runtime/cudaEvent.h"
+#include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/iBuffer.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Copies many small host buffers to the device with one transfer.
+//!
+//! \details execute() gathers the sources into one pinned staging buffer. If all destinations are adjacent, it is
+//!          copied to them directly. Otherwise a table of the destinations is put in front of it, the whole buffer is
+//!          copied to device scratch memory and a kernel scatters it. Destinations may be views of larger buffers.
+//!          Sources passed by pointer must stay valid until execute() returns. The staging buffer and the scratch
+//!          memory only grow and are reused by the next execute(). The staging buffer is kept until the transfer is
+//!          done, so destroying a batch waits for its last transfer.
+class CopyBatch
+{
+public:
+    using UniquePtr = std::unique_ptr<CopyBatch>;
+    using CudaStreamPtr = std::shared_ptr<CudaStream>;
+
+    explicit CopyBatch(CudaStreamPtr stream);
+
+    ~CopyBatch();
+
+    CopyBatch(CopyBatch const&) = delete;
+    CopyBatch& operator=(CopyBatch const&) = delete;
+
+    //! \brief Adds a copy of `size` bytes from host `src` to device `dst`.
+    void add(void const* src, void* dst, std::size_t size);
+
+    //! \brief Adds a copy of `dst.getSizeInBytes()` bytes from host `src` to the device buffer `dst`.
+    void add(void const* src, IBuffer& dst);
+
+    //! \brief Adds a copy from the host buffer `src` to the device buffer `dst` of the same size.
+    void add(IBuffer const& src, IBuffer& dst);
+
+    //! \brief Adds a copy of `src` to the device buffer `dst`, keeping `src` until execute().
+    template <typename T>
+    void add(std::vector<T> src, IBuffer& dst)
+    {
+        auto owned = std::make_shared<std::vector<T>>(std::move(src));
+        add(owned->data(), owned->size() * sizeof(T), dst);
+        mOwnedSources.push_back(std::move(owned));
+    }
+
+    //! \brief Enqueues the copies added since the last call on the stream.
+    void execute();
+
+    //! \brief The number of copies added since the last execute().
+    [[nodiscard]] std::size_t getNumPending() const
+    {
+        return mRegions.size();
+    }
+
+    //! \brief The number of destination regions the last execute() had after merging adjacent ones.
+    [[nodiscard]] std::size_t getNumTransfers() const
+    {
+        return mNumTransfers;
+    }
+
+private:
+    struct PendingRegion
+    {
+        void const* src;
+        void* dst;
+        std::size_t size;
+    };
+
+    void add(void const* src, std::size_t size, IBuffer& dst);
+
+    CudaStreamPtr mStream;
+    std::vector<PendingRegion> mRegions;
+    std::vector<std::shared_ptr<void const>> mOwnedSources;
+    IBuffer::UniquePtr mStaging;
+    // Recorded after the transfer that reads mStaging
+    CudaEvent mStagingDone;
+    bool mStagingInUse{false};
+    // Device copy of mStaging for the scatter kernel, grown on demand
+    IBuffer::UniquePtr mScratch;
+    std::size_t mNumTransfers{0};
+};
+
+} // namespace tensorrt_llm::runtime
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief A serialized TensorRT engine in host memory, loaded from its file.
+//!
+//! \details TensorRT copies what it needs while deserializing, so a blob only has to live until the engine is
+//!          deserialized. Mapping the file avoids the copy that reading it into a buffer makes: the pages are read
+//!          from the page cache while TensorRT deserializes and are clean file pages rather than anonymous memory,
+//!          so they do not add to the peak of anonymous memory and can be reclaimed. A mapped file must not be
+//!          truncated or rewritten in place while the blob lives, which raises SIGBUS on access, so mapping is opt-in
+//!          and engines should be rebuilt by writing a new file and renaming it over the old one.
+class EngineBlob
+{
+public:
+    enum class LoadMode : std::int32_t
+    {
+        //! Reads the file into a buffer, as utils::loadEngine does.
+        kREAD = 0,
+        //! Maps the file read-only, with sequential and will-need hints.
+        kMMAP = 1,
+        //! Reads the file into an aligned buffer with O_DIRECT, bypassing the page cache. Falls back to kREAD where
+        //! the file system does not support it.
+        kDIRECT = 2,
+    };
+
+    //! \brief Identifies a version of a file, so that a blob of a file that was rebuilt is not reused.
+    struct FileId
+    {
+        std::uint64_t device{0};
+        std::uint64_t inode{0};
+        std::uint64_t size{0};
+        std::int64_t modifiedNs{0};
+
+        [[nodiscard]] bool operator==(FileId const& other) const
+        {
+            return device == other.device && inode == other.inode && size == other.size
+                && modifiedNs == other.modifiedNs;
+        }
+    };
+
+    //! \brief Loads `path` with `mode`. Mapping and O_DIRECT are not available on Windows, where the file is read.
+    [[nodiscard]] static std::unique_ptr<EngineBlob> load(std::string const& path, LoadMode mode);
+
+    //! \brief The mode named read, mmap or direct, or nothing for any other name.
+    [[nodiscard]] static std::optional<LoadMode> parseLoadMode(std::string_view name);
+
+    //! \brief The mode set by TLLM_ENGINE_LOAD_MODE, one of read, mmap or direct, and kREAD if it is not set.
+    [[nodiscard]] static LoadMode getDefaultLoadMode();
+
+    [[nodiscard]] static FileId getFileId(std::string const& path);
+
+    ~EngineBlob();
+
+    EngineBlob(EngineBlob const&) = delete;
+    EngineBlob& operator=(EngineBlob const&) = delete;
+
+    [[nodiscard]] void const* data() const
+    {
+        return mData;
+    }
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return mSize;
+    }
+
+    //! \brief The mode the blob was actually loaded with.
+    [[nodiscard]] LoadMode getLoadMode() const
+    {
+        return mLoadMode;
+    }
+
+    [[nodiscard]] FileId const& getFileId() const
+    {
+        return mFileId;
+    }
+
+private:
+    EngineBlob(LoadMode loadMode, FileId const& fileId);
+
+    void read(std::string const& path);
+    void map(std::string const& path);
+    //! \brief Returns false if the file cannot be opened with O_DIRECT.
+    bool readDirect(std::string const& path);
+
+    LoadMode mLoadMode;
+    FileId mFileId;
+    void const* mData{nullptr};
+    std::size_t mSize{0};
+    std::vector<std::uint8_t> mBuffer; // kREAD
+    void* mDirectBuffer{nullptr};      // kDIRECT
+    void* mMapping{nullptr};           // kMMAP
+};
+
+//! \brief Shares the blob of an engine file among the sessions of a process that load it at the same time, for
+//!        example one session per rank.
+//!
+//! \details The registry holds no blob itself. A blob is shared for as long as one of its users holds it and is
+//!          unmapped or freed with the last of them. GptSession only holds it while it deserializes the engine, so
+//!          sessions created one after another each load the file; hold the blob and pass it to each of them to
+//!          load it once. A blob is only shared with a request for the same version of
+//!          the same file, whatever the path and load mode of the request.
+class EngineBlobRegistry
+{
+public:
+    using BlobPtr = std::shared_ptr<EngineBlob const>;
+
+    static EngineBlobRegistry& getInstance();
+
+    //! \brief The live blob of the file at `path`, or a new one loaded with `mode`.
+    [[nodiscard]] BlobPtr acquire(
+        std::string const& path, EngineBlob::LoadMode mode = EngineBlob::getDefaultLoadMode());
+
+    //! \brief The number of blobs that are still held.
+    [[nodiscard]] std::size_t getNbBlobs() const;
+
+private:
+    EngineBlobRegistry() = default;
+
+    using Key = std::tuple<std::uint64_t, std::uint64_t>; // device and inode
+
+    mutable std::mutex mMutex;
+    std::map<Key, std::weak_ptr<EngineBlob const>> mBlobs;
+};
+
+} // namespace tensorrt_llm::runtime
@@ -21,6 +21,7 @@
 #include "tensorrt_llm/runtime/common.h"
 #include "tensorrt_llm/runtime/cudaEvent.h"
 #include "tensorrt_llm/runtime/decodingMode.h"
+#include "tensorrt_llm/runtime/engineBlob.h"
 #include "tensorrt_llm/runtime/generationInput.h"
 #include "tensorrt_llm/runtime/generationOutput.h"
 #include "tensorrt_llm/runtime/gptModelConfig.h"
@@ -160,9 +161,19 @@ public:
     {
     }
 
+    GptSession(Config const& sessionConfig, GptModelConfig const& modelConfig, WorldConfig const& worldConfig,
+        EngineBlob const& engineBlob, LoggerPtr logger = nullptr)
+        : GptSession(sessionConfig, modelConfig, worldConfig, engineBlob.data(), engineBlob.size(), std::move(logger))
+    {
+    }
+
+    //! @brief Loads `engineFile` through EngineBlobRegistry, so that sessions created at the same time share it. The
+    //! blob is released once the engine is deserialized, so the file is only shared while sessions are being
+    //! created.
     GptSession(Config const& sessionConfig, GptModelConfig const& modelConfig, WorldConfig const& worldConfig,
         std::string const& engineFile, LoggerPtr logger = nullptr)
-        : GptSession(sessionConfig, modelConfig, worldConfig, utils::loadEngine(engineFile), std::move(logger))
+        : GptSession(sessionConfig, modelConfig, worldConfig, *EngineBlobRegistry::getInstance().acquire(engineFile),
+            std::move(logger))
     {
     }
 
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Page size and NUMA placement of host and pinned buffers.
+//!
+//! \details Both are best effort: if the system has no huge pages reserved, transparent huge pages are requested
+//!          instead, and if the memory cannot be bound to the node it stays wherever the kernel puts it. Either case
+//!          logs a warning once. The policy is held in a lock-free atomic and has to stay small and trivially
+//!          copyable.
+struct HostMemoryPolicy
+{
+    static std::size_t constexpr kHugePageSize{std::size_t{1} << 21}; // 2 MB
+    //! \brief Smaller buffers stay with malloc, mapping each of them would cost a system call pair and a whole page.
+    //! This is the size glibc starts to map buffers at by default, malloc places smaller ones on first touch.
+    static std::size_t constexpr kNumaMinSize{std::size_t{1} << 17}; // 128 KB
+    static int constexpr kAnyNode{-1};
+
+    //! \brief Back buffers of at least kHugePageSize with 2 MB pages. Their size is rounded up to a whole page.
+    bool hugePages{false};
+    //! \brief The NUMA node to bind buffers of at least kNumaMinSize to, or kAnyNode.
+    int numaNode{kAnyNode};
+
+    //! \brief Whether the policy differs from the default of plain malloc and cudaHostAlloc.
+    [[nodiscard]] bool isDefault() const
+    {
+        return !hugePages && numaNode == kAnyNode;
+    }
+
+    //! \brief Whether an allocation of `size` bytes is mapped by this policy instead of taken from malloc.
+    [[nodiscard]] bool isMapped(std::size_t size) const
+    {
+        return (hugePages && size >= kHugePageSize) || (numaNode != kAnyNode && size >= kNumaMinSize);
+    }
+};
+
+} // namespace tensorrt_llm::runtime
@@ -19,19 +19,51 @@
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace tensorrt_llm::runtime
 {
 
+//! \brief The subsystem an allocation is attributed to.
+enum class MemoryTag : std::int32_t
+{
+    kUNTAGGED = 0,
+    kRUNTIME = 1,   // Session and engine I/O buffers
+    kDECODER = 2,   // Decoder state and outputs
+    kKV_CACHE = 3,  // KV cache pools
+    kLORA = 4,      // LoRA cache pages
+    kWORKSPACE = 5, // Engine activations and communication workspaces
+    kREQUEST = 6    // Per-request inputs and outputs
+};
+
 class MemoryCounters
 {
 public:
     using SizeType = std::size_t;
     using DiffType = std::ptrdiff_t;
 
+    static std::size_t constexpr kNumMemoryTypes{4};
+    static std::size_t constexpr kNumMemoryTags{7};
+
+    //! \brief Bytes in use per memory type, indexed by MemoryType.
+    using Sizes = std::array<SizeType, kNumMemoryTypes>;
+
+    //! \brief A snapshot of all counters taken by sample().
+    struct Sample
+    {
+        //! \brief Microseconds since the timeline was enabled.
+        std::int64_t timeUs;
+        Sizes total;
+        std::array<Sizes, kNumMemoryTags> tagged;
+    };
+
     MemoryCounters() = default;
 
     [[nodiscard]] SizeType getGpu() const
@@ -74,40 +106,80 @@ public:
         return mUVMDiff;
     }
 
+    //! \brief The largest value getGpu() has had since the last resetPeaks().
+    [[nodiscard]] SizeType getGpuPeak() const
+    {
+        return mPeaks[toIndex(MemoryType::kGPU)].load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] SizeType getCpuPeak() const
+    {
+        return mPeaks[toIndex(MemoryType::kCPU)].load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] SizeType getPinnedPeak() const
+    {
+        return mPeaks[toIndex(MemoryType::kPINNED)].load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] SizeType getUVMPeak() const
+    {
+        return mPeaks[toIndex(MemoryType::kUVM)].load(std::memory_order_relaxed);
+    }
+
+    //! \brief The bytes of `memoryType` currently attributed to `tag`.
+    [[nodiscard]] SizeType getTagged(MemoryTag tag, MemoryType memoryType) const
+    {
+        return mTagged[toIndex(tag)][toIndex(memoryType)].current.load(std::memory_order_relaxed);
+    }
+
+    //! \brief The largest value getTagged(tag, memoryType) has had since the last resetPeaks().
+    [[nodiscard]] SizeType getTaggedPeak(MemoryTag tag, MemoryType memoryType) const
+    {
+        return mTagged[toIndex(tag)][toIndex(memoryType)].peak.load(std::memory_order_relaxed);
+    }
+
+    //! \brief Lowers all peaks to the current values.
+    void resetPeaks();
+
     template <MemoryType T>
-    void allocate(SizeType size)
+    void allocate(SizeType size, MemoryTag tag = MemoryTag::kUNTAGGED)
     {
         auto const sizeDiff = static_cast<DiffType>(size);
+        SizeType current{};
         if constexpr (T == MemoryType::kGPU)
         {
-            mGpu += size;
+            current = mGpu += size;
             mGpuDiff = sizeDiff;
         }
         else if constexpr (T == MemoryType::kCPU)
         {
-            mCpu += size;
+            current = mCpu += size;
             mCpuDiff = sizeDiff;
         }
         else if constexpr (T == MemoryType::kPINNED)
         {
-            mPinned += size;
+            current = mPinned += size;
             mPinnedDiff = sizeDiff;
         }
         else if constexpr (T == MemoryType::kUVM)
         {
-            mUVM += size;
+            current = mUVM += size;
             mUVMDiff = sizeDiff;
         }
         else
         {
             TLLM_THROW("Unknown memory type: %s", MemoryTypeString<T>::value);
         }
+        updatePeak(mPeaks[toIndex(T)], current);
+        auto& counter = mTagged[toIndex(tag)][toIndex(T)];
+        updatePeak(counter.peak, counter.current.fetch_add(size, std::memory_order_relaxed) + size);
     }
 
-    void allocate(MemoryType memoryType, SizeType size);
+    void allocate(MemoryType memoryType, SizeType size, MemoryTag tag = MemoryTag::kUNTAGGED);
 
     template <MemoryType T>
-    void deallocate(SizeType size)
+    void deallocate(SizeType size, MemoryTag tag = MemoryTag::kUNTAGGED)
     {
         auto const sizeDiff = -static_cast<DiffType>(size);
         if constexpr (T == MemoryType::kGPU)
@@ -134,9 +206,41 @@ public:
         {
             TLLM_THROW("Unknown memory type: %s", MemoryTypeString<T>::value);
         }
+        mTagged[toIndex(tag)][toIndex(T)].current.fetch_sub(size, std::memory_order_relaxed);
     }
 
-    void deallocate(MemoryType memoryType, SizeType size);
+    void deallocate(MemoryType memoryType, SizeType size, MemoryTag tag = MemoryTag::kUNTAGGED);
+
+    //! \brief The tag allocators constructed on this thread are created with. See MemoryTagScope.
+    [[nodiscard]] static MemoryTag getCurrentTag() noexcept
+    {
+        return currentTag();
+    }
+
+    //! \brief Sets the tag of this thread and returns the previous one.
+    static MemoryTag setCurrentTag(MemoryTag tag) noexcept
+    {
+        auto const previous = currentTag();
+        currentTag() = tag;
+        return previous;
+    }
+
+    //! \brief Starts recording samples into a ring buffer of `capacity` entries, dropping earlier samples. A capacity
+    //!        of 0 stops recording.
+    void enableTimeline(std::size_t capacity);
+
+    //! \brief Records a snapshot of all counters if the timeline is enabled. Cheap enough to call once per step.
+    void sample();
+
+    //! \brief The recorded samples, oldest first.
+    [[nodiscard]] std::vector<Sample> getTimeline() const;
+
+    //! \brief One row per sample and tag with a row of totals first: `time_us,tag,gpu,cpu,pinned,uvm`. Tags without
+    //!        memory in a sample are skipped.
+    [[nodiscard]] std::string timelineToCsv() const;
+
+    //! \brief An array of `{"time_us", "total", "tags"}` objects with the same contents as timelineToCsv().
+    [[nodiscard]] std::string timelineToJson() const;
 
     static MemoryCounters& getInstance();
 
@@ -144,11 +248,106 @@ public:
 
     static std::string bytesToString(DiffType bytes, int precision = 2);
 
+    static char const* tagToString(MemoryTag tag);
+
     [[nodiscard]] std::string toString() const;
 
+    //! \brief Current and peak usage of every tag with memory allocated. Logged when an allocation fails.
+    [[nodiscard]] std::string tagsToString() const;
+
 private:
+    struct TagCounter
+    {
+        std::atomic<SizeType> current{};
+        std::atomic<SizeType> peak{};
+    };
+
+    static MemoryTag& currentTag() noexcept
+    {
+        static thread_local MemoryTag tag{MemoryTag::kUNTAGGED};
+        return tag;
+    }
+
+    static constexpr std::size_t toIndex(MemoryType memoryType)
+    {
+        return static_cast<std::size_t>(memoryType);
+    }
+
+    static constexpr std::size_t toIndex(MemoryTag tag)
+    {
+        return static_cast<std::size_t>(tag);
+    }
+
+    static void updatePeak(std::atomic<SizeType>& peak, SizeType value)
+    {
+        // Only contended while a new peak is being set
+        auto previous = peak.load(std::memory_order_relaxed);
+        while (value > previous && !peak.compare_exchange_weak(previous, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    [[nodiscard]] Sample takeSample() const;
+
     std::atomic<SizeType> mGpu{}, mCpu{}, mPinned{}, mUVM{};
     std::atomic<DiffType> mGpuDiff{}, mCpuDiff{}, mPinnedDiff{}, mUVMDiff{};
+    std::array<std::atomic<SizeType>, kNumMemoryTypes> mPeaks{};
+    std::array<std::array<TagCounter, kNumMemoryTypes>, kNumMemoryTags> mTagged{};
+
+    mutable std::mutex mTimelineMutex;
+    std::atomic<bool> mTimelineEnabled{false};
+    std::chrono::steady_clock::time_point mTimelineStart;
+    std::vector<Sample> mTimeline;
+    // Where the next sample goes once the timeline is full
+    std::size_t mTimelineNext{0};
+    std::size_t mTimelineCapacity{0};
+};
+
+//! \brief Occupancy and fragmentation of a MemoryPool at one point in time.
+struct MemoryPoolReport
+{
+    std::size_t reservedSize{0};
+    std::size_t usedSize{0};
+    std::size_t freeSize{0};
+    std::size_t largestFreeSegment{0};
+    std::size_t numChunks{0};
+    //! \brief Chunks without used segments, which trimming would release.
+    std::size_t numFreeChunks{0};
+    std::size_t numFreeSegments{0};
+    //! \brief Free bytes by segment size: entry i sums the free segments of [2^i, 2^(i+1)) B.
+    std::vector<std::size_t> freeBytesHistogram;
+
+    //! \brief 0 if the free memory is one segment, approaching 1 the more it is split into small ones.
+    [[nodiscard]] double getFragmentation() const
+    {
+        return freeSize == 0 ? 0.0 : 1.0 - static_cast<double>(largestFreeSegment) / static_cast<double>(freeSize);
+    }
+
+    [[nodiscard]] std::string toString() const;
+};
+
+//! \brief Attributes the allocators constructed on this thread within its lifetime to `tag`.
+//!
+//! \details Buffers keep the tag of their allocator, so memory is returned to the tag it was taken from even if it is
+//!          freed or resized elsewhere. Scopes nest.
+class MemoryTagScope
+{
+public:
+    explicit MemoryTagScope(MemoryTag tag)
+        : mPrevious{MemoryCounters::setCurrentTag(tag)}
+    {
+    }
+
+    ~MemoryTagScope()
+    {
+        MemoryCounters::setCurrentTag(mPrevious);
+    }
+
+    MemoryTagScope(MemoryTagScope const&) = delete;
+    MemoryTagScope& operator=(MemoryTagScope const&) = delete;
+
+private:
+    MemoryTag mPrevious;
 };
 
 } // namespace tensorrt_llm::runtime
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <typeinfo>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief A non-owning view of a tensor: pointer, data type, shape and memory type.
+//!
+//! \details Unlike ITensor::slice and ITensor::view, slicing a span allocates nothing and touches no reference count,
+//!          so it is meant for the short-lived views taken in per-step loops. The viewed tensor must outlive the span.
+//!          Like a pointer, a span does not carry the constness of the tensor it was taken from. Pass it to functions
+//!          taking an ITensor through SpanTensor, and use toTensor() where the view must keep its tensor alive.
+class TensorSpan
+{
+public:
+    using Shape = ITensor::Shape;
+
+    TensorSpan() = default;
+
+    TensorSpan(void* data, nvinfer1::DataType type, Shape const& shape, MemoryType memoryType)
+        : mData{data}
+        , mType{type}
+        , mShape{shape}
+        , mMemoryType{memoryType}
+    {
+    }
+
+    explicit TensorSpan(ITensor const& tensor)
+        : TensorSpan{const_cast<void*>(tensor.data()), tensor.getDataType(), tensor.getShape(), tensor.getMemoryType()}
+    {
+    }
+
+    [[nodiscard]] void* data() const
+    {
+        return mData;
+    }
+
+    [[nodiscard]] nvinfer1::DataType getDataType() const
+    {
+        return mType;
+    }
+
+    [[nodiscard]] Shape const& getShape() const
+    {
+        return mShape;
+    }
+
+    [[nodiscard]] MemoryType getMemoryType() const
+    {
+        return mMemoryType;
+    }
+
+    //! \brief The number of elements.
+    [[nodiscard]] std::size_t getSize() const
+    {
+        return ITensor::volumeNonNegative(mShape);
+    }
+
+    [[nodiscard]] std::size_t getSizeInBytes() const
+    {
+        return getSize() * BufferDataType(mType).getSize();
+    }
+
+    //! \brief The rows [offset, offset + size) of dimension 0.
+    [[nodiscard]] TensorSpan slice(std::size_t offset, std::size_t size) const
+    {
+        auto const dim0 = static_cast<std::size_t>((mShape.nbDims > 0 && mShape.d[0] >= 0) ? mShape.d[0] : 0);
+        TLLM_CHECK_WITH_INFO(offset <= dim0, "Offset %zu exceeds dimension 0 of size %zu", offset, dim0);
+        TLLM_CHECK_WITH_INFO(
+            offset + size <= dim0, "Slice [%zu, %zu) exceeds dimension 0 of size %zu", offset, offset + size, dim0);
+        auto shape = mShape;
+        shape.d[0] = static_cast<ITensor::DimType>(size);
+        auto const rowBytes = dim0 == 0 ? 0 : getSizeInBytes() / dim0;
+        return {static_cast<std::uint8_t*>(mData) + offset * rowBytes, mType, shape, mMemoryType};
+    }
+
+    //! \brief The rows from `offset` to the end of dimension 0.
+    [[nodiscard]] TensorSpan slice(std::size_t offset) const
+    {
+        auto const dim0 = static_cast<std::size_t>((mShape.nbDims > 0 && mShape.d[0] >= 0) ? mShape.d[0] : 0);
+        return slice(offset, offset > dim0 ? 0 : dim0 - offset);
+    }
+
+    //! \brief Row `index` of dimension 0, without that dimension.
+    [[nodiscard]] TensorSpan at(std::size_t index) const
+    {
+        return slice(index, 1).squeeze(0);
+    }
+
+    //! \brief The same data with shape `shape`, which may have fewer elements.
+    [[nodiscard]] TensorSpan view(Shape const& shape) const
+    {
+        TLLM_CHECK_WITH_INFO(ITensor::volumeNonNegative(shape) <= getSize(), "View exceeds the span");
+        return {mData, mType, shape, mMemoryType};
+    }
+
+    [[nodiscard]] TensorSpan squeeze(SizeType dim) const
+    {
+        return {mData, mType, ITensor::squeeze(mShape, dim), mMemoryType};
+    }
+
+    [[nodiscard]] TensorSpan unsqueeze(SizeType dim) const
+    {
+        return {mData, mType, ITensor::unsqueeze(mShape, dim), mMemoryType};
+    }
+
+    //! \brief A tensor over this span that keeps `owner`, which the span must lie in, alive.
+    [[nodiscard]] ITensor::UniquePtr toTensor(IBuffer::SharedPtr owner) const;
+
+private:
+    void* mData{nullptr};
+    nvinfer1::DataType mType{nvinfer1::DataType::kFLOAT};
+    Shape mShape{};
+    MemoryType mMemoryType{MemoryType::kCPU};
+};
+
+//! \brief An ITensor over a TensorSpan, to be created on the stack for a call that takes an ITensor or IBuffer.
+//!
+//! \details It can be reshaped within the span but not grown, and does not own the data.
+class SpanTensor final : virtual public ITensor
+{
+public:
+    explicit SpanTensor(TensorSpan const& span)
+        : mSpan{span}
+        , mCapacity{span.getSize()}
+    {
+    }
+
+    [[nodiscard]] void* data() override
+    {
+        return getSize() > 0 ? mSpan.data() : nullptr;
+    }
+
+    [[nodiscard]] void const* data() const override
+    {
+        return getSize() > 0 ? mSpan.data() : nullptr;
+    }
+
+    [[nodiscard]] std::size_t getSize() const override
+    {
+        return mSpan.getSize();
+    }
+
+    [[nodiscard]] std::size_t getCapacity() const override
+    {
+        return mCapacity;
+    }
+
+    [[nodiscard]] nvinfer1::DataType getDataType() const override
+    {
+        return mSpan.getDataType();
+    }
+
+    [[nodiscard]] MemoryType getMemoryType() const override
+    {
+        return mSpan.getMemoryType();
+    }
+
+    [[nodiscard]] Shape const& getShape() const override
+    {
+        return mSpan.getShape();
+    }
+
+    void reshape(Shape const& dims) override
+    {
+        TLLM_CHECK_WITH_INFO(ITensor::volumeNonNegative(dims) <= mCapacity, "SpanTensor cannot grow");
+        mSpan = TensorSpan{mSpan.data(), mSpan.getDataType(), dims, mSpan.getMemoryType()};
+    }
+
+    void resize(std::size_t newSize) override
+    {
+        ITensor::resize(newSize);
+    }
+
+    void release() override
+    {
+        reshape(ITensor::makeShape({0}));
+    }
+
+private:
+    TensorSpan mSpan;
+    std::size_t mCapacity;
+};
+
+template <typename T>
+T* bufferCast(TensorSpan const& span)
+{
+    if (TRTDataType<typename std::remove_cv<T>::type>::value != span.getDataType())
+    {
+        throw std::bad_cast();
+    }
+    return static_cast<T*>(span.data());
+}
+
+} // namespace tensorrt_llm::runtime
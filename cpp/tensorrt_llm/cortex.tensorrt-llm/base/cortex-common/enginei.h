@@ -31,7 +31,7 @@ class EngineI {
   virtual bool IsSupported(const std::string& f) {
     if (f == "HandleChatCompletion" || f == "HandleEmbedding" ||
         f == "UnloadModel" || f == "GetModelStatus" ||
-        f == "GetModels") {
+        f == "GetModels" || f == "CountTokens") {
       return true;
     }
     return false;
@@ -41,4 +41,10 @@ class EngineI {
   virtual void GetModels(
       std::shared_ptr<Json::Value> json_body,
       std::function<void(Json::Value&&, Json::Value&&)>&& callback) = 0;
+
+  // Counts the prompt tokens of a chat completion request (or of "text") and
+  // reports whether it fits the context window, without generating.
+  virtual void CountTokens(
+      std::shared_ptr<Json::Value> json_body,
+      std::function<void(Json::Value&&, Json::Value&&)>&& callback) = 0;
 };
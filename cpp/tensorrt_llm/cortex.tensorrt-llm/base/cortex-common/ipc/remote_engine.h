@@ -0,0 +1,284 @@
+#pragma once
+
+// EngineI proxy for an engine running in a separate engine-host process
+// (Linux only, see examples/engine-host).
+//
+// Calls are marshalled as JSON frames over a Unix domain socket. All callback
+// invocations (including every streamed chunk) come back through a
+// shared-memory ring created by this side and passed to the host with
+// SCM_RIGHTS. If the host dies, pending requests fail with a 503 and the next
+// call reconnects, so an engine crash does not take the server down.
+// Like the in-process engines, non-streaming calls return only after their
+// callback has run.
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "cortex-common/enginei.h"
+#include "cortex-common/ipc/shm_ring.h"
+#include "cortex-common/ipc/uds.h"
+#include "json/reader.h"
+#include "json/writer.h"
+
+namespace cortex::ipc {
+
+class RemoteEngine : public EngineI {
+ public:
+  using Callback = std::function<void(Json::Value&&, Json::Value&&)>;
+
+  explicit RemoteEngine(std::string socket_path, size_t ring_capacity = 8u << 20)
+      : socket_path_(std::move(socket_path)), ring_capacity_(ring_capacity) {}
+
+  ~RemoteEngine() {
+    std::shared_ptr<Connection> conn;
+    {
+      std::lock_guard<std::mutex> l(mtx_);
+      conn = std::move(conn_);
+    }
+    if (conn) {
+      conn->Shutdown();
+    }
+  }
+
+  void HandleChatCompletion(std::shared_ptr<Json::Value> json_body, Callback&& callback) override {
+    Call("HandleChatCompletion", json_body, std::move(callback), true);
+  }
+  void HandleEmbedding(std::shared_ptr<Json::Value> json_body, Callback&& callback) override {
+    Call("HandleEmbedding", json_body, std::move(callback), false);
+  }
+  void LoadModel(std::shared_ptr<Json::Value> json_body, Callback&& callback) override {
+    Call("LoadModel", json_body, std::move(callback), false);
+  }
+  void UnloadModel(std::shared_ptr<Json::Value> json_body, Callback&& callback) override {
+    Call("UnloadModel", json_body, std::move(callback), false);
+  }
+  void GetModelStatus(std::shared_ptr<Json::Value> json_body, Callback&& callback) override {
+    Call("GetModelStatus", json_body, std::move(callback), false);
+  }
+  void GetModels(std::shared_ptr<Json::Value> json_body, Callback&& callback) override {
+    Call("GetModels", json_body, std::move(callback), false);
+  }
+  void CountTokens(std::shared_ptr<Json::Value> json_body, Callback&& callback) override {
+    Call("CountTokens", json_body, std::move(callback), false);
+  }
+
+ private:
+  struct Pending {
+    Callback callback;
+    bool stream;
+  };
+
+  struct Connection {
+    int fd = -1;
+    std::unique_ptr<ShmRing> ring;
+    std::thread reader;
+    std::thread monitor;
+    std::mutex send_mtx;
+    std::mutex pending_mtx;
+    std::unordered_map<uint64_t, std::shared_ptr<Pending>> pending;
+    std::atomic<bool> alive{true};
+
+    ~Connection() {
+      // Closed only here: callers still holding the connection must not
+      // write to a reused descriptor.
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+
+    void Shutdown() {
+      alive = false;
+      ::shutdown(fd, SHUT_RDWR);
+      ring->Close();
+      if (monitor.joinable()) {
+        monitor.join();
+      }
+      // A callback runs on the reader and can get here through Connect() or
+      // the engine's destructor. The reader cannot join itself; it leaves
+      // once it is back at the closed ring and holds the connection until
+      // then.
+      if (reader.joinable()) {
+        if (reader.get_id() == std::this_thread::get_id()) {
+          reader.detach();
+        } else {
+          reader.join();
+        }
+      }
+    }
+  };
+
+  static Json::Value MakeStatus(int code, bool stream, bool has_error) {
+    Json::Value status;
+    status["is_done"] = true;
+    status["has_error"] = has_error;
+    status["is_stream"] = stream;
+    status["status_code"] = code;
+    return status;
+  }
+
+  static void Fail(Pending& p, const std::string& message) {
+    Json::Value res;
+    res["message"] = message;
+    p.callback(MakeStatus(503, p.stream, true), std::move(res));
+  }
+
+  std::shared_ptr<Connection> Connect() {
+    std::lock_guard<std::mutex> l(mtx_);
+    if (conn_ && conn_->alive) {
+      return conn_;
+    }
+    if (conn_) {
+      // The previous host went away, its threads have exited or are exiting.
+      conn_->Shutdown();
+      conn_.reset();
+    }
+    int fd = ConnectUnix(socket_path_);
+    if (fd < 0) {
+      return nullptr;
+    }
+    auto conn = std::make_shared<Connection>();
+    conn->fd = fd;
+    std::string ack;
+    try {
+      conn->ring = ShmRing::Create(ring_capacity_);
+    } catch (const std::exception&) {
+      return nullptr;
+    }
+    if (!SendFd(fd, conn->ring->fd()) || !RecvFrame(fd, ack) || ack != "ok") {
+      return nullptr;
+    }
+    // Threads are joined by Shutdown() before the connection is released,
+    // except a reader that shuts its own connection down.
+    conn->reader = std::thread([conn]() { ReadLoop(*conn); });
+    conn->monitor = std::thread([c = conn.get()]() { MonitorLoop(*c); });
+    conn_ = conn;
+    return conn;
+  }
+
+  void Call(const char* method, const std::shared_ptr<Json::Value>& body, Callback&& callback, bool stream) {
+    if (stream) {
+      Send(method, body, std::move(callback), true);
+      return;
+    }
+    struct Completion {
+      std::mutex mtx;
+      std::condition_variable cond;
+      bool done = false;
+    };
+    auto completion = std::make_shared<Completion>();
+    Send(method, body,
+        [completion, cb = std::move(callback)](Json::Value&& status, Json::Value&& res) mutable {
+          cb(std::move(status), std::move(res));
+          std::lock_guard<std::mutex> l(completion->mtx);
+          completion->done = true;
+          completion->cond.notify_all();
+        },
+        false);
+    std::unique_lock<std::mutex> l(completion->mtx);
+    completion->cond.wait(l, [&completion] { return completion->done; });
+  }
+
+  void Send(const char* method, const std::shared_ptr<Json::Value>& body, Callback&& callback, bool stream) {
+    auto pending = std::make_shared<Pending>(Pending{std::move(callback), stream});
+    auto conn = Connect();
+    if (!conn) {
+      Fail(*pending, "Engine process is unavailable at " + socket_path_);
+      return;
+    }
+
+    uint64_t id = next_id_.fetch_add(1);
+    Json::Value msg;
+    msg["id"] = Json::UInt64(id);
+    msg["method"] = method;
+    msg["body"] = body ? *body : Json::Value();
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    auto frame = Json::writeString(writer, msg);
+
+    bool registered = false;
+    {
+      std::lock_guard<std::mutex> l(conn->pending_mtx);
+      // The reader marks the connection dead before failing the pending map.
+      if (conn->alive) {
+        conn->pending.emplace(id, pending);
+        registered = true;
+      }
+    }
+    bool sent = false;
+    if (registered) {
+      std::lock_guard<std::mutex> l(conn->send_mtx);
+      sent = SendFrame(conn->fd, frame);
+    }
+    if (!sent) {
+      if (registered) {
+        std::lock_guard<std::mutex> l(conn->pending_mtx);
+        if (conn->pending.erase(id) == 0) {
+          return;  // Already failed by the reader.
+        }
+      }
+      Fail(*pending, "Failed to send request to the engine process");
+    }
+  }
+
+  static void ReadLoop(Connection& conn) {
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    std::string record;
+    while (conn.ring->Pop(record)) {
+      Json::Value msg;
+      std::string err;
+      if (!reader->parse(record.data(), record.data() + record.size(), &msg, &err)) {
+        continue;
+      }
+      uint64_t id = msg["id"].asUInt64();
+      Json::Value& status = msg["status"];
+      std::shared_ptr<Pending> pending;
+      {
+        std::lock_guard<std::mutex> l(conn.pending_mtx);
+        auto it = conn.pending.find(id);
+        if (it == conn.pending.end()) {
+          continue;
+        }
+        pending = it->second;
+        if (!pending->stream || status["is_done"].asBool() || status["has_error"].asBool()) {
+          conn.pending.erase(it);
+        }
+      }
+      pending->callback(std::move(status), std::move(msg["result"]));
+    }
+
+    // Host is gone: fail whatever is still waiting.
+    conn.alive = false;
+    std::unordered_map<uint64_t, std::shared_ptr<Pending>> orphans;
+    {
+      std::lock_guard<std::mutex> l(conn.pending_mtx);
+      orphans.swap(conn.pending);
+    }
+    for (auto& [id, pending] : orphans) {
+      Fail(*pending, "Engine process exited");
+    }
+  }
+
+  // The host never writes after the handshake, so a readable socket means it
+  // closed the connection (or crashed).
+  static void MonitorLoop(Connection& conn) {
+    char byte;
+    while (recv(conn.fd, &byte, 1, 0) < 0 && errno == EINTR) {
+    }
+    conn.alive = false;
+    conn.ring->Close();
+  }
+
+  std::string socket_path_;
+  size_t ring_capacity_;
+  std::mutex mtx_;
+  std::shared_ptr<Connection> conn_;
+  std::atomic<uint64_t> next_id_{1};
+};
+
+}  // namespace cortex::ipc
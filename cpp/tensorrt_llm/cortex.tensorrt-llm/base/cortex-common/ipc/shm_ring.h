@@ -0,0 +1,263 @@
+#pragma once
+
+// Shared-memory ring buffer carrying length-prefixed records between two
+// processes (Linux only).
+//
+// The ring lives in a memfd so it can be handed to the peer over a Unix
+// domain socket. Head/tail are lock-free atomics in the shared mapping. A
+// consumer that finds the ring empty spins for a while (not on single-core
+// machines) before sleeping on a futex, and producers only issue FUTEX_WAKE
+// when the consumer announced it is sleeping, so a busy stream costs no
+// syscalls per record.
+// Multiple producer threads in the same process are serialized by a local
+// mutex; there is exactly one consumer.
+
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace cortex::ipc {
+
+class ShmRing {
+ public:
+  static constexpr uint32_t kMaxRecordSize = 16u << 20;
+
+  // Creates a new ring backed by an anonymous memfd.
+  static std::unique_ptr<ShmRing> Create(size_t capacity) {
+    int fd = static_cast<int>(syscall(SYS_memfd_create, "cortex-ring", 0));
+    if (fd < 0) {
+      throw std::runtime_error("memfd_create failed");
+    }
+    if (ftruncate(fd, sizeof(Header) + capacity) != 0) {
+      close(fd);
+      throw std::runtime_error("ftruncate failed");
+    }
+    auto ring = std::unique_ptr<ShmRing>(new ShmRing(fd));
+    auto* h = ring->header_;
+    h->capacity = capacity;
+    h->head.store(0, std::memory_order_relaxed);
+    h->tail.store(0, std::memory_order_relaxed);
+    h->closed.store(0, std::memory_order_relaxed);
+    h->consumer_sleeping.store(0, std::memory_order_relaxed);
+    h->producer_sleeping.store(0, std::memory_order_relaxed);
+    h->data_seq.store(0, std::memory_order_relaxed);
+    h->space_seq.store(0, std::memory_order_release);
+    return ring;
+  }
+
+  // Maps a ring created by the peer. Takes ownership of `fd`.
+  static std::unique_ptr<ShmRing> Attach(int fd) {
+    return std::unique_ptr<ShmRing>(new ShmRing(fd));
+  }
+
+  ~ShmRing() {
+    if (base_ != nullptr) {
+      munmap(base_, mapped_size_);
+    }
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  ShmRing(const ShmRing&) = delete;
+  ShmRing& operator=(const ShmRing&) = delete;
+
+  int fd() const { return fd_; }
+
+  // Appends one record, waiting while the ring is full. Returns false if the
+  // ring was closed.
+  bool Push(const void* data, uint32_t len) {
+    uint64_t const need = sizeof(uint32_t) + static_cast<uint64_t>(len);
+    if (len > kMaxRecordSize || need > capacity_) {
+      return false;
+    }
+    std::lock_guard<std::mutex> l(producer_mtx_);
+    auto* h = header_;
+    if (h->closed.load(std::memory_order_acquire)) {
+      return false;
+    }
+    uint64_t head = h->head.load(std::memory_order_relaxed);
+    int spins = 0;
+    while (head + need - h->tail.load(std::memory_order_acquire) > capacity_) {
+      if (h->closed.load(std::memory_order_acquire)) {
+        return false;
+      }
+      if (++spins < SpinIterations()) {
+        Pause();
+        continue;
+      }
+      auto seq = h->space_seq.load(std::memory_order_acquire);
+      h->producer_sleeping.store(1, std::memory_order_seq_cst);
+      if (head + need - h->tail.load(std::memory_order_seq_cst) > capacity_) {
+        FutexWait(&h->space_seq, seq);
+      }
+      h->producer_sleeping.store(0, std::memory_order_relaxed);
+    }
+    CopyIn(head, &len, sizeof(len));
+    CopyIn(head + sizeof(len), data, len);
+    h->head.store(head + need, std::memory_order_seq_cst);
+    if (h->consumer_sleeping.load(std::memory_order_seq_cst)) {
+      h->data_seq.fetch_add(1, std::memory_order_release);
+      FutexWake(&h->data_seq);
+    }
+    return true;
+  }
+
+  bool Push(const std::string& record) {
+    return Push(record.data(), static_cast<uint32_t>(record.size()));
+  }
+
+  // Pops one record into `out`, waiting while the ring is empty. Returns
+  // false once the ring is closed and drained, or once the peer wrote an
+  // invalid record, which closes the ring.
+  bool Pop(std::string& out) {
+    if (broken_) {
+      return false;
+    }
+    auto* h = header_;
+    uint64_t tail = h->tail.load(std::memory_order_relaxed);
+    int spins = 0;
+    while (h->head.load(std::memory_order_acquire) == tail) {
+      if (h->closed.load(std::memory_order_acquire)) {
+        return false;
+      }
+      if (++spins < SpinIterations()) {
+        Pause();
+        continue;
+      }
+      auto seq = h->data_seq.load(std::memory_order_acquire);
+      h->consumer_sleeping.store(1, std::memory_order_seq_cst);
+      if (h->head.load(std::memory_order_seq_cst) == tail && !h->closed.load(std::memory_order_acquire)) {
+        FutexWait(&h->data_seq, seq);
+      }
+      h->consumer_sleeping.store(0, std::memory_order_relaxed);
+    }
+    // The peer writes both the head index and the length prefix, so neither
+    // is trusted: a bad value would read outside the mapping or allocate
+    // without bound.
+    uint64_t const available = h->head.load(std::memory_order_acquire) - tail;
+    uint32_t len = 0;
+    if (available >= sizeof(len) && available <= capacity_) {
+      CopyOut(tail, &len, sizeof(len));
+    }
+    if (available < sizeof(len) || available > capacity_ || len > kMaxRecordSize ||
+        sizeof(len) + static_cast<uint64_t>(len) > available) {
+      broken_ = true;
+      Close();
+      return false;
+    }
+    out.resize(len);
+    CopyOut(tail + sizeof(len), out.data(), len);
+    h->tail.store(tail + sizeof(len) + len, std::memory_order_seq_cst);
+    if (h->producer_sleeping.load(std::memory_order_seq_cst)) {
+      h->space_seq.fetch_add(1, std::memory_order_release);
+      FutexWake(&h->space_seq);
+    }
+    return true;
+  }
+
+  // Wakes both sides and makes further Push/Pop calls fail (Pop still drains
+  // what was already written).
+  void Close() {
+    auto* h = header_;
+    h->closed.store(1, std::memory_order_seq_cst);
+    h->data_seq.fetch_add(1, std::memory_order_release);
+    h->space_seq.fetch_add(1, std::memory_order_release);
+    FutexWake(&h->data_seq);
+    FutexWake(&h->space_seq);
+  }
+
+ private:
+  // Spinning only pays off when the peer runs on another core.
+  static int SpinIterations() {
+    static const int spins = std::thread::hardware_concurrency() > 1 ? 4096 : 0;
+    return spins;
+  }
+
+  struct Header {
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint32_t> data_seq;
+    std::atomic<uint32_t> consumer_sleeping;
+    alignas(64) std::atomic<uint32_t> space_seq;
+    std::atomic<uint32_t> producer_sleeping;
+    alignas(64) std::atomic<uint32_t> closed;
+    uint64_t capacity;
+  };
+  static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring needs lock-free atomics in shared memory");
+
+  explicit ShmRing(int fd) : fd_(fd) {
+    off_t size = lseek(fd, 0, SEEK_END);
+    if (size < static_cast<off_t>(sizeof(Header))) {
+      close(fd);
+      throw std::runtime_error("invalid ring file");
+    }
+    mapped_size_ = static_cast<size_t>(size);
+    base_ = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base_ == MAP_FAILED) {
+      base_ = nullptr;
+      close(fd);
+      throw std::runtime_error("mmap failed");
+    }
+    header_ = static_cast<Header*>(base_);
+    data_ = static_cast<char*>(base_) + sizeof(Header);
+    // Kept locally, the copy in the mapping can be rewritten by the peer.
+    capacity_ = mapped_size_ - sizeof(Header);
+    // A freshly created file still has a zero capacity.
+    if (header_->capacity != 0 && header_->capacity + sizeof(Header) != mapped_size_) {
+      munmap(base_, mapped_size_);
+      close(fd);
+      throw std::runtime_error("ring capacity does not match its file size");
+    }
+  }
+
+  void CopyIn(uint64_t pos, const void* src, size_t len) {
+    size_t off = pos % capacity_;
+    size_t first = std::min<size_t>(len, capacity_ - off);
+    std::memcpy(data_ + off, src, first);
+    std::memcpy(data_, static_cast<const char*>(src) + first, len - first);
+  }
+
+  void CopyOut(uint64_t pos, void* dst, size_t len) const {
+    size_t off = pos % capacity_;
+    size_t first = std::min<size_t>(len, capacity_ - off);
+    std::memcpy(dst, data_ + off, first);
+    std::memcpy(static_cast<char*>(dst) + first, data_, len - first);
+  }
+
+  static void Pause() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+  }
+
+  static void FutexWait(std::atomic<uint32_t>* addr, uint32_t expected) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+  }
+
+  static void FutexWake(std::atomic<uint32_t>* addr) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+  }
+
+  int fd_ = -1;
+  void* base_ = nullptr;
+  size_t mapped_size_ = 0;
+  Header* header_ = nullptr;
+  char* data_ = nullptr;
+  uint64_t capacity_ = 0;
+  bool broken_ = false;
+  std::mutex producer_mtx_;
+};
+
+}  // namespace cortex::ipc
@@ -0,0 +1,149 @@
+#pragma once
+
+// Framing helpers for the Unix domain socket control channel (Linux only).
+// A frame is a 4-byte little-endian length followed by the payload; a file
+// descriptor can ride along with a frame as SCM_RIGHTS ancillary data.
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace cortex::ipc {
+
+inline bool FillAddress(const std::string& path, sockaddr_un& addr) {
+  if (path.size() >= sizeof(addr.sun_path)) {
+    return false;
+  }
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+// Returns a listening socket bound to `path` (replacing a stale socket file),
+// or -1.
+inline int ListenUnix(const std::string& path, int backlog = 16) {
+  sockaddr_un addr;
+  if (!FillAddress(path, addr)) {
+    return -1;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  unlink(path.c_str());
+  if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, backlog) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+inline int ConnectUnix(const std::string& path) {
+  sockaddr_un addr;
+  if (!FillAddress(path, addr)) {
+    return -1;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+inline bool WriteAll(int fd, const void* data, size_t len) {
+  auto* p = static_cast<const char*>(data);
+  while (len > 0) {
+    ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    len -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+inline bool ReadAll(int fd, void* data, size_t len) {
+  auto* p = static_cast<char*>(data);
+  while (len > 0) {
+    ssize_t n = recv(fd, p, len, 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    len -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+inline bool SendFrame(int fd, const std::string& payload) {
+  uint32_t len = static_cast<uint32_t>(payload.size());
+  return WriteAll(fd, &len, sizeof(len)) && WriteAll(fd, payload.data(), payload.size());
+}
+
+inline bool RecvFrame(int fd, std::string& payload) {
+  uint32_t len = 0;
+  if (!ReadAll(fd, &len, sizeof(len))) {
+    return false;
+  }
+  payload.resize(len);
+  return ReadAll(fd, payload.data(), len);
+}
+
+// Sends a one-byte message carrying `fd_to_send`.
+inline bool SendFd(int fd, int fd_to_send) {
+  char byte = 'F';
+  iovec iov{&byte, 1};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(cmsg), &fd_to_send, sizeof(int));
+  return sendmsg(fd, &msg, MSG_NOSIGNAL) == 1;
+}
+
+// Receives a descriptor sent with SendFd, returns -1 on failure.
+inline int RecvFd(int fd) {
+  char byte = 0;
+  iovec iov{&byte, 1};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  if (recvmsg(fd, &msg, MSG_CMSG_CLOEXEC) != 1) {
+    return -1;
+  }
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  if (cmsg == nullptr || cmsg->cmsg_type != SCM_RIGHTS) {
+    return -1;
+  }
+  int received = -1;
+  std::memcpy(&received, CMSG_DATA(cmsg), sizeof(int));
+  return received;
+}
+
+}  // namespace cortex::ipc
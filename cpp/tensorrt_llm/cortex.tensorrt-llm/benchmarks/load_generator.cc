@@ -0,0 +1,385 @@
+// Open-loop HTTP load generator for the cortex server.
+//
+// Requests from a dataset are sent to /v1/chat/completions at Poisson,
+// constant or trace-driven arrival times, independently of how fast the
+// server answers. Every SSE chunk is timestamped, and per offered load the
+// generator reports time to first token (TTFT), inter-token latency (ITL),
+// end-to-end latency, throughput and goodput.
+//
+// The dataset is the output of benchmarks/cpp/prepare_dataset.py (a JSON
+// document with a "samples" array) or a JSONL file with one sample per line.
+// A sample provides either a "prompt" string or "input_ids", and an
+// "output_len"; prompts for "input_ids" are synthesized with one word per
+// input token, which the mock engine's word tokenizer maps to one token
+// each. The "delay" field is used for trace-driven arrivals.
+//
+// Usage:
+//   load_generator --dataset data.json --rates 1,2,4 [--host 127.0.0.1]
+//                  [--port 3928] [--arrival poisson|constant|trace]
+//                  [--num-requests N] [--slo-ttft-ms 1000] [--slo-itl-ms 100]
+//                  [--timeline out.csv]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "httplib.h"
+#include "json/reader.h"
+#include "json/value.h"
+#include "json/writer.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  std::string host = "127.0.0.1";
+  int port = 3928;
+  std::string dataset;
+  std::string model = "";
+  std::string arrival = "poisson";
+  std::vector<double> rates{1.0};
+  int num_requests = 0;
+  int max_tokens = 0;
+  double slo_ttft_ms = 1000.0;
+  double slo_itl_ms = 100.0;
+  uint32_t seed = 420;
+  std::string timeline;
+};
+
+struct Sample {
+  std::string prompt;
+  int output_len = 0;
+  double delay_s = 0.0;
+};
+
+struct Timeline {
+  Clock::time_point sent;
+  std::vector<Clock::time_point> chunks;
+  Clock::time_point finished;
+  bool ok = false;
+};
+
+void PrintUsage() {
+  std::cerr << "Usage: load_generator --dataset <file> [--rates r1,r2,...] [--host h] [--port p]\n"
+               "         [--arrival poisson|constant|trace] [--num-requests n] [--max-tokens n]\n"
+               "         [--model name] [--slo-ttft-ms ms] [--slo-itl-ms ms] [--seed s] [--timeline out.csv]\n";
+}
+
+bool ParseOptions(int argc, char** argv, Options& opts) {
+  for (int i = 1; i < argc; ++i) {
+    std::string key = argv[i];
+    if (key == "--help" || key == "-h" || i + 1 >= argc) {
+      return false;
+    }
+    std::string value = argv[++i];
+    if (key == "--host") {
+      opts.host = value;
+    } else if (key == "--port") {
+      opts.port = std::stoi(value);
+    } else if (key == "--dataset") {
+      opts.dataset = value;
+    } else if (key == "--model") {
+      opts.model = value;
+    } else if (key == "--arrival") {
+      opts.arrival = value;
+    } else if (key == "--rates") {
+      opts.rates.clear();
+      std::stringstream ss(value);
+      std::string rate;
+      while (std::getline(ss, rate, ',')) {
+        opts.rates.push_back(std::stod(rate));
+      }
+    } else if (key == "--num-requests") {
+      opts.num_requests = std::stoi(value);
+    } else if (key == "--max-tokens") {
+      opts.max_tokens = std::stoi(value);
+    } else if (key == "--slo-ttft-ms") {
+      opts.slo_ttft_ms = std::stod(value);
+    } else if (key == "--slo-itl-ms") {
+      opts.slo_itl_ms = std::stod(value);
+    } else if (key == "--seed") {
+      opts.seed = static_cast<uint32_t>(std::stoul(value));
+    } else if (key == "--timeline") {
+      opts.timeline = value;
+    } else {
+      std::cerr << "Unknown option " << key << std::endl;
+      return false;
+    }
+  }
+  return !opts.dataset.empty() && !opts.rates.empty();
+}
+
+Sample ToSample(const Json::Value& v) {
+  Sample s;
+  if (v.isMember("prompt")) {
+    s.prompt = v["prompt"].asString();
+  } else {
+    auto n = v["input_ids"].size();
+    s.prompt.reserve(n * 4);
+    for (Json::ArrayIndex i = 0; i < n; ++i) {
+      s.prompt += i == 0 ? "the" : " the";
+    }
+  }
+  s.output_len = v.get("output_len", 128).asInt();
+  s.delay_s = v.get("delay", 0.0).asDouble();
+  return s;
+}
+
+std::vector<Sample> LoadDataset(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("Cannot open dataset " + path);
+  }
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  std::string content = buffer.str();
+
+  std::vector<Sample> samples;
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  Json::Value root;
+  std::string err;
+  if (reader->parse(content.data(), content.data() + content.size(), &root, &err) && root.isObject()
+      && root.isMember("samples")) {
+    for (auto const& v : root["samples"]) {
+      samples.push_back(ToSample(v));
+    }
+    return samples;
+  }
+
+  std::stringstream lines(content);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+    Json::Value v;
+    if (!reader->parse(line.data(), line.data() + line.size(), &v, &err)) {
+      throw std::runtime_error("Invalid dataset line: " + err);
+    }
+    samples.push_back(ToSample(v));
+  }
+  return samples;
+}
+
+// Arrival offsets in seconds from the start of the run.
+std::vector<double> MakeArrivals(const Options& opts, const std::vector<Sample>& samples, double rate, size_t n) {
+  std::vector<double> arrivals(n);
+  std::mt19937 gen(opts.seed);
+  std::exponential_distribution<double> exp_dist(rate > 0 ? rate : 1.0);
+  double t = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    arrivals[i] = t;
+    if (opts.arrival == "trace") {
+      // Trace delays are scaled so that `rate` multiplies the recorded load.
+      t += samples[i % samples.size()].delay_s / (rate > 0 ? rate : 1.0);
+    } else if (rate <= 0) {
+      t = 0.0;  // All at once.
+    } else if (opts.arrival == "constant") {
+      t += 1.0 / rate;
+    } else {
+      t += exp_dist(gen);
+    }
+  }
+  return arrivals;
+}
+
+// Extracts complete "data: ..." events from `buffer`, returns the number of
+// content-bearing chunks and whether [DONE] was seen.
+std::pair<int, bool> ConsumeEvents(std::string& buffer, Json::CharReader& reader) {
+  int chunks = 0;
+  bool done = false;
+  size_t pos;
+  while ((pos = buffer.find("\n\n")) != std::string::npos) {
+    std::string event = buffer.substr(0, pos);
+    buffer.erase(0, pos + 2);
+    if (event.rfind("data: ", 0) != 0) {
+      continue;
+    }
+    std::string payload = event.substr(6);
+    if (payload == "[DONE]") {
+      done = true;
+      continue;
+    }
+    Json::Value v;
+    std::string err;
+    if (reader.parse(payload.data(), payload.data() + payload.size(), &v, &err)
+        && !v["choices"][0]["delta"]["content"].asString().empty()) {
+      ++chunks;
+    }
+  }
+  return {chunks, done};
+}
+
+Timeline RunRequest(const Options& opts, const Sample& sample) {
+  Timeline tl;
+  Json::Value body;
+  body["stream"] = true;
+  body["max_tokens"] = opts.max_tokens > 0 ? opts.max_tokens : sample.output_len;
+  if (!opts.model.empty()) {
+    body["model"] = opts.model;
+  }
+  Json::Value message;
+  message["role"] = "user";
+  message["content"] = sample.prompt;
+  body["messages"].append(message);
+  Json::StreamWriterBuilder writer;
+  writer["indentation"] = "";
+
+  httplib::Client cli(opts.host, opts.port);
+  cli.set_read_timeout(600, 0);
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  std::string buffer;
+  bool done = false;
+
+  httplib::Request req;
+  req.method = "POST";
+  req.path = "/v1/chat/completions";
+  req.set_header("Content-Type", "application/json");
+  req.body = Json::writeString(writer, body);
+  req.content_receiver = [&](const char* data, size_t len, uint64_t, uint64_t) {
+    auto now = Clock::now();
+    buffer.append(data, len);
+    auto [chunks, is_done] = ConsumeEvents(buffer, *reader);
+    for (int i = 0; i < chunks; ++i) {
+      tl.chunks.push_back(now);
+    }
+    done = done || is_done;
+    return true;
+  };
+
+  tl.sent = Clock::now();
+  auto res = cli.send(req);
+  tl.finished = Clock::now();
+  tl.ok = res && res->status == 200 && done;
+  return tl;
+}
+
+double Ms(Clock::duration d) {
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+double Percentile(std::vector<double> v, double p) {
+  if (v.empty()) {
+    return 0.0;
+  }
+  std::sort(v.begin(), v.end());
+  auto idx = static_cast<size_t>(p / 100.0 * (v.size() - 1) + 0.5);
+  return v[std::min(idx, v.size() - 1)];
+}
+
+void Report(const Options& opts, double rate, const std::vector<Timeline>& timelines, double wall_s) {
+  std::vector<double> ttft, itl, e2e;
+  size_t ok = 0;
+  size_t good = 0;
+  size_t tokens = 0;
+  for (auto const& tl : timelines) {
+    if (!tl.ok) {
+      continue;
+    }
+    ++ok;
+    tokens += tl.chunks.size();
+    e2e.push_back(Ms(tl.finished - tl.sent));
+    double max_itl = 0.0;
+    if (!tl.chunks.empty()) {
+      ttft.push_back(Ms(tl.chunks.front() - tl.sent));
+      for (size_t i = 1; i < tl.chunks.size(); ++i) {
+        double gap = Ms(tl.chunks[i] - tl.chunks[i - 1]);
+        itl.push_back(gap);
+        max_itl = std::max(max_itl, gap);
+      }
+      if (ttft.back() <= opts.slo_ttft_ms && max_itl <= opts.slo_itl_ms) {
+        ++good;
+      }
+    }
+  }
+
+  if (rate > 0) {
+    std::printf("\n[offered load: %.2f req/s, %s arrivals]\n", rate, opts.arrival.c_str());
+  } else {
+    std::printf("\n[offered load: all requests at once]\n");
+  }
+  std::printf("  requests: %zu ok / %zu sent, wall time %.2f s\n", ok, timelines.size(), wall_s);
+  std::printf("  throughput: %.2f req/s, %.2f tokens/s\n", ok / wall_s, tokens / wall_s);
+  std::printf("  goodput (TTFT <= %.0f ms, max ITL <= %.0f ms): %.2f req/s\n", opts.slo_ttft_ms, opts.slo_itl_ms,
+      good / wall_s);
+  std::printf("  %-8s %10s %10s %10s\n", "ms", "p50", "p90", "p99");
+  std::printf("  %-8s %10.2f %10.2f %10.2f\n", "TTFT", Percentile(ttft, 50), Percentile(ttft, 90),
+      Percentile(ttft, 99));
+  std::printf("  %-8s %10.2f %10.2f %10.2f\n", "ITL", Percentile(itl, 50), Percentile(itl, 90), Percentile(itl, 99));
+  std::printf("  %-8s %10.2f %10.2f %10.2f\n", "E2E", Percentile(e2e, 50), Percentile(e2e, 90), Percentile(e2e, 99));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opts;
+  if (!ParseOptions(argc, argv, opts)) {
+    PrintUsage();
+    return 1;
+  }
+
+  std::vector<Sample> samples;
+  try {
+    samples = LoadDataset(opts.dataset);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  if (samples.empty()) {
+    std::cerr << "Dataset is empty" << std::endl;
+    return 1;
+  }
+  size_t const n = opts.num_requests > 0 ? opts.num_requests : samples.size();
+
+  std::ofstream timeline_csv;
+  if (!opts.timeline.empty()) {
+    timeline_csv.open(opts.timeline);
+    timeline_csv << "rate,request,sent_ms,ttft_ms,e2e_ms,chunks,ok,chunk_offsets_ms\n";
+  }
+
+  for (double rate : opts.rates) {
+    auto arrivals = MakeArrivals(opts, samples, rate, n);
+    std::vector<Timeline> timelines(n);
+    std::vector<std::thread> workers;
+    workers.reserve(n);
+    auto const start = Clock::now();
+    for (size_t i = 0; i < n; ++i) {
+      auto at = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(arrivals[i]));
+      std::this_thread::sleep_until(at);
+      workers.emplace_back([&opts, &samples, &timelines, i]() {
+        timelines[i] = RunRequest(opts, samples[i % samples.size()]);
+      });
+    }
+    for (auto& w : workers) {
+      w.join();
+    }
+    double wall_s = std::chrono::duration<double>(Clock::now() - start).count();
+    Report(opts, rate, timelines, wall_s);
+
+    if (timeline_csv) {
+      for (size_t i = 0; i < n; ++i) {
+        auto const& tl = timelines[i];
+        timeline_csv << rate << ',' << i << ',' << Ms(tl.sent - start) << ','
+                     << (tl.chunks.empty() ? -1.0 : Ms(tl.chunks.front() - tl.sent)) << ','
+                     << Ms(tl.finished - tl.sent) << ',' << tl.chunks.size() << ',' << tl.ok << ',';
+        for (size_t j = 0; j < tl.chunks.size(); ++j) {
+          timeline_csv << (j ? " " : "") << Ms(tl.chunks[j] - tl.sent);
+        }
+        timeline_csv << '\n';
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,194 @@
+// Measures encode and decode throughput of the byte-level BPE tokenizer, one
+// string at a time, for templated chat prompts with and without the encode
+// cache, and through EncodeBatch/DecodeBatch from 1 to N threads.
+//
+// Usage: tokenizer_benchmark <tokenizer.json> [text file] [iterations]
+// Without a text file a mixed English/code/multilingual sample is used.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/bpe_tokenizer.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr const char* kSample =
+    "The quick brown fox jumps over the lazy dog. It's 12:45 and we've "
+    "processed 1,234,567 requests so far!\n"
+    "int main(int argc, char** argv) {\n    return argc > 1 ? 0 : -1;\n}\n"
+    "Xin chào thế giới. Grüße aus München. Привет, мир! 你好，世界。"
+    "こんにちは。안녕하세요. مرحبا بالعالم 👋🏽\n\n";
+
+std::string LoadText(int argc, char** argv) {
+  if (argc > 2) {
+    std::ifstream file(argv[2], std::ios::binary);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+  }
+  std::string text;
+  while (text.size() < (1u << 20)) {
+    text += kSample;
+  }
+  return text;
+}
+
+double Seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "Usage: %s <tokenizer.json> [text file] [iterations]\n", argv[0]);
+    return 1;
+  }
+  int const iterations = argc > 3 ? std::stoi(argv[3]) : 10;
+
+  auto load_start = Clock::now();
+  tensorrtllm::BpeTokenizer tokenizer(argv[1]);
+  std::printf("loaded %zu tokens in %.1f ms\n", tokenizer.VocabSize(), Seconds(load_start) * 1e3);
+
+  std::string const text = LoadText(argc, argv);
+  if (text.empty()) {
+    std::fprintf(stderr, "No input text\n");
+    return 1;
+  }
+  // Encode line by line, the way prompts reach the engine.
+  std::vector<std::string> lines;
+  std::istringstream stream(text);
+  for (std::string line; std::getline(stream, line);) {
+    lines.push_back(line + "\n");
+  }
+
+  size_t tokens = 0;
+  std::vector<std::vector<int>> encoded(lines.size());
+  auto encode_start = Clock::now();
+  for (int it = 0; it < iterations; ++it) {
+    tokens = 0;
+    for (size_t i = 0; i < lines.size(); ++i) {
+      encoded[i] = tokenizer.Encode(lines[i]);
+      tokens += encoded[i].size();
+    }
+  }
+  double const encode_s = Seconds(encode_start) / iterations;
+
+  size_t decoded_bytes = 0;
+  auto decode_start = Clock::now();
+  for (int it = 0; it < iterations; ++it) {
+    decoded_bytes = 0;
+    for (auto const& ids : encoded) {
+      decoded_bytes += tokenizer.Decode(ids).size();
+    }
+  }
+  double const decode_s = Seconds(decode_start) / iterations;
+
+  // Token-at-a-time, the way the streaming path renders each new token.
+  size_t piece_bytes = 0;
+  auto piece_start = Clock::now();
+  for (int it = 0; it < iterations; ++it) {
+    for (auto const& ids : encoded) {
+      for (auto id : ids) {
+        piece_bytes += tokenizer.Pieces().Piece(id).size();
+      }
+    }
+  }
+  double const piece_s = Seconds(piece_start) / iterations;
+
+  double const mb = text.size() / 1e6;
+  std::printf("text: %.2f MB, %zu lines, %zu tokens (%.2f bytes/token)\n", mb, lines.size(), tokens,
+              static_cast<double>(text.size()) / tokens);
+  std::printf("encode: %8.2f MB/s %12.0f tokens/s\n", mb / encode_s, tokens / encode_s);
+  std::printf("decode: %8.2f MB/s %12.0f tokens/s\n", decoded_bytes / 1e6 / decode_s, tokens / decode_s);
+  std::printf("piece:  %8.2f MB/s %12.0f tokens/s\n", piece_bytes / 1e6 / iterations / piece_s, tokens / piece_s);
+
+  // Chat prompts sharing a long system prompt, with and without the cache.
+  std::string system_prompt = "<|im_start|>system\n";
+  for (size_t i = 0; i < 16 && i < lines.size(); ++i) {
+    system_prompt += lines[i];
+  }
+  system_prompt += "<|im_end|>\n";
+  std::vector<std::string> prompts;
+  for (size_t i = 0; i < lines.size(); ++i) {
+    prompts.push_back(system_prompt + "<|im_start|>user\n" + lines[i] + "<|im_end|>\n<|im_start|>assistant\n");
+  }
+  size_t prompt_bytes = 0;
+  for (auto const& prompt : prompts) {
+    prompt_bytes += prompt.size();
+  }
+  tensorrtllm::BpeTokenizer cached(argv[1]);
+  cached.EnableEncodeCache({});
+  double template_s[2];
+  for (int with_cache = 0; with_cache < 2; ++with_cache) {
+    auto const& t = with_cache ? cached : tokenizer;
+    auto start = Clock::now();
+    for (int it = 0; it < iterations; ++it) {
+      for (auto const& prompt : prompts) {
+        if (t.Encode(prompt).empty()) {
+          return 1;
+        }
+      }
+    }
+    template_s[with_cache] = Seconds(start) / iterations;
+  }
+  auto const stats = cached.GetEncodeCache()->GetStats();
+  std::printf("\n%zu chat prompts, %zu-byte system prompt\n", prompts.size(), system_prompt.size());
+  std::printf("uncached: %8.2f MB/s\n", prompt_bytes / 1e6 / template_s[0]);
+  std::printf("cached:   %8.2f MB/s (%.2fx), hit rate %.1f%%, %.1f MB saved, %llu entries\n",
+              prompt_bytes / 1e6 / template_s[1], template_s[0] / template_s[1],
+              100.0 * stats.hits / std::max<uint64_t>(1, stats.hits + stats.misses), stats.bytes_saved / 1e6,
+              static_cast<unsigned long long>(stats.entries));
+
+  std::vector<int32_t> expected;
+  for (auto const& ids : encoded) {
+    expected.insert(expected.end(), ids.begin(), ids.end());
+  }
+  size_t const hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<size_t> thread_counts;
+  for (size_t t = 1; t < hardware_threads; t *= 2) {
+    thread_counts.push_back(t);
+  }
+  thread_counts.push_back(hardware_threads);
+
+  std::printf("\nbatch of %zu strings, %zu hardware threads\n", lines.size(), hardware_threads);
+  std::printf("%8s %14s %8s %14s %8s\n", "threads", "encode MB/s", "speedup", "decode MB/s", "speedup");
+  std::vector<int32_t> ids;
+  std::vector<int32_t> offsets;
+  std::vector<std::string> texts;
+  double encode_base = 0;
+  double decode_base = 0;
+  for (auto threads : thread_counts) {
+    auto batch_encode_start = Clock::now();
+    for (int it = 0; it < iterations; ++it) {
+      tokenizer.EncodeBatch(lines, ids, offsets, threads);
+    }
+    double const encode_rate = mb / (Seconds(batch_encode_start) / iterations);
+    if (ids != expected) {
+      std::fprintf(stderr, "EncodeBatch with %zu threads differs from Encode\n", threads);
+      return 1;
+    }
+
+    auto batch_decode_start = Clock::now();
+    for (int it = 0; it < iterations; ++it) {
+      tokenizer.DecodeBatch(ids, offsets, texts, threads);
+    }
+    double const decode_rate = decoded_bytes / 1e6 / (Seconds(batch_decode_start) / iterations);
+
+    if (threads == 1) {
+      encode_base = encode_rate;
+      decode_base = decode_rate;
+    }
+    std::printf("%8zu %14.2f %7.2fx %14.2f %7.2fx\n", threads, encode_rate, encode_rate / encode_base, decode_rate,
+                decode_rate / decode_base);
+  }
+  return 0;
+}
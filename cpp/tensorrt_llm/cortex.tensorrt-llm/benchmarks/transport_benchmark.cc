@@ -0,0 +1,255 @@
+// Compares the cost of streaming token chunks from an engine to the HTTP
+// front-end over the available transports (Linux only):
+//  * inproc: producer thread -> mutex/condvar queue, like Server::SyncQueue
+//  * uds:    producer process -> framed writes on a Unix domain socket
+//  * tcp:    producer process -> framed writes on a loopback TCP socket
+//  * shm:    producer process -> ShmRing (the out-of-process engine path)
+//
+// For each transport it reports the streaming throughput when the producer
+// sends back-to-back, and the one-way latency of paced chunks (the steady
+// clock is shared between processes).
+//
+// Usage: transport_benchmark [messages] [message bytes] [pace us]
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/cortex-common/ipc/shm_ring.h"
+#include "base/cortex-common/ipc/uds.h"
+
+using namespace cortex::ipc;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Config {
+  size_t messages = 200000;
+  size_t bytes = 256;
+  int pace_us = 50;
+};
+
+struct Result {
+  double msgs_per_s = 0;
+  double mb_per_s = 0;
+  double p50_us = 0;
+  double p99_us = 0;
+};
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// A transport is a pair of send/receive functions; `Run` drives one
+// throughput pass and one paced latency pass over it.
+struct Channel {
+  std::function<void(const std::string&)> send;
+  std::function<bool(std::string&)> recv;
+};
+
+std::string MakeMessage(size_t bytes, bool last) {
+  std::string msg(std::max<size_t>(bytes, sizeof(int64_t) + 1), 'x');
+  int64_t ts = NowNs();
+  std::memcpy(msg.data(), &ts, sizeof(ts));
+  msg[sizeof(ts)] = last ? 'L' : 'D';
+  return msg;
+}
+
+void Produce(const Config& cfg, Channel& ch, size_t n, bool paced) {
+  auto next = Clock::now();
+  for (size_t i = 0; i < n; ++i) {
+    if (paced) {
+      next += std::chrono::microseconds(cfg.pace_us);
+      while (Clock::now() < next) {
+      }
+    }
+    ch.send(MakeMessage(cfg.bytes, i + 1 == n));
+  }
+}
+
+// Returns per-message latencies in microseconds.
+std::vector<double> Consume(Channel& ch) {
+  std::vector<double> latencies;
+  std::string msg;
+  while (ch.recv(msg)) {
+    int64_t ts;
+    std::memcpy(&ts, msg.data(), sizeof(ts));
+    latencies.push_back((NowNs() - ts) / 1000.0);
+    if (msg[sizeof(ts)] == 'L') {
+      break;
+    }
+  }
+  return latencies;
+}
+
+double Percentile(std::vector<double> v, double p) {
+  if (v.empty()) {
+    return 0.0;
+  }
+  std::sort(v.begin(), v.end());
+  return v[std::min(v.size() - 1, static_cast<size_t>(p / 100.0 * (v.size() - 1)))];
+}
+
+Result Summarize(const Config& cfg, double seconds, const std::vector<double>& paced) {
+  Result r;
+  r.msgs_per_s = cfg.messages / seconds;
+  r.mb_per_s = cfg.messages * cfg.bytes / seconds / 1e6;
+  r.p50_us = Percentile(paced, 50);
+  r.p99_us = Percentile(paced, 99);
+  return r;
+}
+
+size_t PacedCount(const Config& cfg) {
+  return std::min<size_t>(cfg.messages, 20000);
+}
+
+Result RunInProcess(const Config& cfg) {
+  std::mutex mtx;
+  std::condition_variable cond;
+  std::queue<std::string> q;
+  Channel ch;
+  ch.send = [&](const std::string& m) {
+    std::lock_guard<std::mutex> l(mtx);
+    q.push(m);
+    cond.notify_one();
+  };
+  ch.recv = [&](std::string& m) {
+    std::unique_lock<std::mutex> l(mtx);
+    cond.wait(l, [&] { return !q.empty(); });
+    m = std::move(q.front());
+    q.pop();
+    return true;
+  };
+
+  auto start = Clock::now();
+  std::thread producer([&] { Produce(cfg, ch, cfg.messages, false); });
+  Consume(ch);
+  producer.join();
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::thread paced_producer([&] { Produce(cfg, ch, PacedCount(cfg), true); });
+  auto paced = Consume(ch);
+  paced_producer.join();
+  return Summarize(cfg, seconds, paced);
+}
+
+// Runs `produce` in a forked child and the consumer in this process.
+template <typename TProduce>
+Result RunForked(const Config& cfg, Channel& consumer, TProduce&& produce) {
+  double seconds = 0.0;
+  std::vector<double> paced;
+  for (bool is_paced : {false, true}) {
+    auto start = Clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+      produce(is_paced ? PacedCount(cfg) : cfg.messages, is_paced);
+      _exit(0);
+    }
+    auto latencies = Consume(consumer);
+    waitpid(pid, nullptr, 0);
+    if (is_paced) {
+      paced = std::move(latencies);
+    } else {
+      seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+  }
+  return Summarize(cfg, seconds, paced);
+}
+
+Channel SocketChannel(int fd) {
+  Channel ch;
+  ch.send = [fd](const std::string& m) { SendFrame(fd, m); };
+  ch.recv = [fd](std::string& m) { return RecvFrame(fd, m); };
+  return ch;
+}
+
+Result RunSocketPair(const Config& cfg, int producer_fd, int consumer_fd) {
+  Channel consumer = SocketChannel(consumer_fd);
+  auto result = RunForked(cfg, consumer, [&](size_t n, bool paced) {
+    close(consumer_fd);
+    Channel producer = SocketChannel(producer_fd);
+    Produce(cfg, producer, n, paced);
+  });
+  close(producer_fd);
+  close(consumer_fd);
+  return result;
+}
+
+Result RunUds(const Config& cfg) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    throw std::runtime_error("socketpair failed");
+  }
+  return RunSocketPair(cfg, fds[0], fds[1]);
+}
+
+Result RunTcp(const Config& cfg) {
+  int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listen_fd, 1) != 0
+      || getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+    throw std::runtime_error("loopback listen failed");
+  }
+  int client = socket(AF_INET, SOCK_STREAM, 0);
+  if (connect(client, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    throw std::runtime_error("loopback connect failed");
+  }
+  int server = accept(listen_fd, nullptr, nullptr);
+  close(listen_fd);
+  int one = 1;
+  setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return RunSocketPair(cfg, client, server);
+}
+
+Result RunShm(const Config& cfg) {
+  auto ring = ShmRing::Create(8u << 20);
+  Channel consumer;
+  consumer.recv = [&ring](std::string& m) { return ring->Pop(m); };
+  return RunForked(cfg, consumer, [&](size_t n, bool paced) {
+    Channel producer;
+    producer.send = [&ring](const std::string& m) { ring->Push(m); };
+    Produce(cfg, producer, n, paced);
+  });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Config cfg;
+  if (argc > 1) {
+    cfg.messages = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    cfg.bytes = std::stoul(argv[2]);
+  }
+  if (argc > 3) {
+    cfg.pace_us = std::stoi(argv[3]);
+  }
+
+  std::printf("%zu messages of %zu bytes, latency paced every %d us\n\n", cfg.messages, cfg.bytes, cfg.pace_us);
+  std::printf("%-8s %14s %10s %12s %12s\n", "mode", "msgs/s", "MB/s", "p50 lat us", "p99 lat us");
+  std::vector<std::pair<const char*, std::function<Result(const Config&)>>> modes{
+      {"inproc", RunInProcess}, {"uds", RunUds}, {"tcp", RunTcp}, {"shm", RunShm}};
+  for (auto const& [name, run] : modes) {
+    auto r = run(cfg);
+    std::printf("%-8s %14.0f %10.1f %12.2f %12.2f\n", name, r.msgs_per_s, r.mb_per_s, r.p50_us, r.p99_us);
+  }
+  return 0;
+}
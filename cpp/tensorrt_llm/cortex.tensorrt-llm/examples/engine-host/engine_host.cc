@@ -0,0 +1,135 @@
+// Out-of-process engine host.
+//
+// Loads an engine library through dylib and serves its EngineI calls to
+// front-ends connecting over a Unix domain socket (see
+// base/cortex-common/ipc/remote_engine.h). Every callback invocation is
+// written to the shared-memory ring of the calling connection.
+//
+// Usage: engine_host <socket path> [engine dir]
+// and start the server with "unix:<socket path>" as its engine path.
+
+#include <csignal>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "cortex-common/enginei.h"
+#include "cortex-common/ipc/shm_ring.h"
+#include "cortex-common/ipc/uds.h"
+#include "dylib.h"
+#include "json/reader.h"
+#include "json/writer.h"
+#include "trantor/utils/Logger.h"
+
+using namespace cortex::ipc;
+
+namespace {
+
+using Callback = std::function<void(Json::Value&&, Json::Value&&)>;
+
+void Dispatch(EngineI* engine, const std::string& method, std::shared_ptr<Json::Value> body, Callback&& cb) {
+  if (method == "HandleChatCompletion") {
+    engine->HandleChatCompletion(body, std::move(cb));
+  } else if (method == "HandleEmbedding") {
+    engine->HandleEmbedding(body, std::move(cb));
+  } else if (method == "LoadModel") {
+    engine->LoadModel(body, std::move(cb));
+  } else if (method == "UnloadModel") {
+    engine->UnloadModel(body, std::move(cb));
+  } else if (method == "GetModelStatus") {
+    engine->GetModelStatus(body, std::move(cb));
+  } else if (method == "GetModels") {
+    engine->GetModels(body, std::move(cb));
+  } else if (method == "CountTokens") {
+    engine->CountTokens(body, std::move(cb));
+  } else {
+    Json::Value status;
+    status["is_done"] = true;
+    status["has_error"] = true;
+    status["is_stream"] = false;
+    status["status_code"] = 400;
+    Json::Value res;
+    res["message"] = "Unknown method " + method;
+    cb(std::move(status), std::move(res));
+  }
+}
+
+void ServeConnection(EngineI* engine, int fd) {
+  int ring_fd = RecvFd(fd);
+  std::shared_ptr<ShmRing> ring;
+  try {
+    ring = ring_fd >= 0 ? std::shared_ptr<ShmRing>(ShmRing::Attach(ring_fd)) : nullptr;
+  } catch (const std::exception& e) {
+    LOG_ERROR << "Failed to map ring: " << e.what();
+  }
+  if (!ring || !SendFrame(fd, "ok")) {
+    close(fd);
+    return;
+  }
+  LOG_INFO << "Front-end connected";
+
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+  std::string frame;
+  while (RecvFrame(fd, frame)) {
+    Json::Value msg;
+    std::string err;
+    if (!reader->parse(frame.data(), frame.data() + frame.size(), &msg, &err)) {
+      LOG_WARN << "Dropping malformed frame: " << err;
+      continue;
+    }
+    uint64_t id = msg["id"].asUInt64();
+    auto body = std::make_shared<Json::Value>(std::move(msg["body"]));
+    // The ring is captured so that late callbacks never touch an unmapped
+    // region; pushes fail once the front-end is gone.
+    Dispatch(engine, msg["method"].asString(), body, [ring, id](Json::Value&& status, Json::Value&& res) {
+      Json::Value record;
+      record["id"] = Json::UInt64(id);
+      record["status"] = std::move(status);
+      record["result"] = std::move(res);
+      Json::StreamWriterBuilder writer;
+      writer["indentation"] = "";
+      ring->Push(Json::writeString(writer, record));
+    });
+  }
+  LOG_INFO << "Front-end disconnected";
+  ring->Close();
+  close(fd);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s <socket path> [engine dir]\n", argv[0]);
+    return 1;
+  }
+  std::string socket_path = argv[1];
+  std::string engine_path = argc > 2 ? argv[2] : "./engines/cortex.tensorrt-llm";
+
+  signal(SIGPIPE, SIG_IGN);
+  auto lib = std::make_unique<dylib>(engine_path, "engine");
+  auto func = lib->get_function<EngineI*()>("get_engine");
+  std::unique_ptr<EngineI> engine(func());
+
+  int listen_fd = ListenUnix(socket_path);
+  if (listen_fd < 0) {
+    fprintf(stderr, "\ncouldn't bind to unix socket: %s\n\n", socket_path.c_str());
+    return 1;
+  }
+  LOG_INFO << "Engine host listening: " << socket_path;
+
+  while (true) {
+    int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    std::thread(ServeConnection, engine.get(), fd).detach();
+  }
+  close(listen_fd);
+  unlink(socket_path.c_str());
+  return 0;
+}
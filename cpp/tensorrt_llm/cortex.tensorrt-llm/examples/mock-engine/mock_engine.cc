@@ -0,0 +1,246 @@
+// Deterministic EngineI implementation without any GPU dependency.
+//
+// The mock engine replays a fixed token stream at a configurable rate and goes
+// through the same host-side steps as the TensorRT-LLM engine (prompt
+// formatting, encoding, incremental detokenization and SSE chunk formatting),
+// so the HTTP server and streaming path can be profiled on any machine.
+//
+// Load options (all optional, passed to LoadModel next to the usual fields):
+//  * mock_tokenizer:        "word" (default) or "byte"
+//  * mock_corpus:           text the generated tokens are taken from, in a loop
+//  * mock_output_tokens:    tokens per response when the request has no
+//                           max_tokens (default 128)
+//  * mock_tokens_per_second: generation rate, 0 means as fast as possible
+//                           (default 50)
+//  * mock_ttft_ms:          extra delay before the first token (default 0)
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/cortex-common/enginei.h"
+#include "mock_tokenizer.h"
+#include "src/utils/tensorrt-llm_utils.h"
+
+namespace mock {
+
+constexpr const int k200OK = 200;
+constexpr const int k409Conflict = 409;
+
+constexpr const char* kDefaultCorpus =
+    "The quick brown fox jumps over the lazy dog. Pack my box with five dozen "
+    "liquor jugs. How vexingly quick daft zebras jump! Sphinx of black quartz, "
+    "judge my vow. 日本語のテキストも含まれます。 ";
+
+struct MockConfig {
+  std::string model_id;
+  int output_tokens = 128;
+  double tokens_per_second = 50.0;
+  int ttft_ms = 0;
+  std::string user_prompt;
+  std::string ai_prompt;
+  std::string system_prompt;
+};
+
+Json::Value MakeStatus(int code, bool is_done, bool is_stream, bool has_error = false) {
+  Json::Value status;
+  status["is_done"] = is_done;
+  status["has_error"] = has_error;
+  status["is_stream"] = is_stream;
+  status["status_code"] = code;
+  return status;
+}
+
+std::string FormatPrompt(const MockConfig& config, const Json::Value& json_body) {
+  std::string formatted_input;
+  for (auto const& message : json_body["messages"]) {
+    std::string role = message["role"].asString();
+    std::string content = message["content"].asString();
+    if (role == "user") {
+      formatted_input += config.user_prompt + content;
+    } else if (role == "assistant") {
+      formatted_input += config.ai_prompt + content;
+    } else if (role == "system") {
+      formatted_input = config.system_prompt + content + formatted_input;
+    } else {
+      formatted_input += role + content;
+    }
+  }
+  return formatted_input + config.ai_prompt;
+}
+
+class MockEngine : public EngineI {
+ public:
+  ~MockEngine() final {}
+
+  void HandleChatCompletion(
+      std::shared_ptr<Json::Value> json_body,
+      std::function<void(Json::Value&&, Json::Value&&)>&& callback) final {
+    if (!CheckModelLoaded(callback)) {
+      return;
+    }
+    auto config = config_;
+    auto tokenizer = tokenizer_;
+    auto stream = stream_;
+
+    // Format and encode the prompt the same way the real engine does.
+    auto input_len = tokenizer->Encode(FormatPrompt(*config, *json_body)).size();
+    int const max_tokens = json_body->get("max_tokens", config->output_tokens).asInt();
+
+    std::thread([config, tokenizer, stream, input_len, max_tokens, cb = std::move(callback)]() {
+      using Clock = std::chrono::steady_clock;
+      auto next = Clock::now() + std::chrono::milliseconds(config->ttft_ms);
+      auto const interval = config->tokens_per_second > 0
+          ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / config->tokens_per_second))
+          : Clock::duration::zero();
+
+      std::vector<int32_t> output_ids;
+      output_ids.reserve(max_tokens);
+      size_t prev_pos = 0;
+      for (int i = 0; i < max_tokens && !stream->empty(); ++i) {
+        std::this_thread::sleep_until(next);
+        next += interval;
+        output_ids.push_back((*stream)[(input_len + i) % stream->size()]);
+
+        // Detokenize the whole output every step, as the real engine does.
+        std::string text = tokenizer->Decode(output_ids);
+        if (text.size() <= prev_pos) {
+          continue;
+        }
+        std::string delta = text.substr(prev_pos);
+        prev_pos = text.size();
+
+        Json::Value resp_data;
+        resp_data["data"] = "data: "
+            + tensorrtllm_utils::CreateReturnJson(tensorrtllm_utils::GenerateRandomString(20), "_", delta) + "\n\n";
+        cb(MakeStatus(k200OK, false, true), std::move(resp_data));
+      }
+
+      Json::Value resp_data;
+      resp_data["data"] = "data: "
+          + tensorrtllm_utils::CreateReturnJson(tensorrtllm_utils::GenerateRandomString(20), "_", "", "stop")
+          + "\n\n" + "data: [DONE]" + "\n\n";
+      cb(MakeStatus(k200OK, true, true), std::move(resp_data));
+    }).detach();
+  }
+
+  void HandleEmbedding(
+      std::shared_ptr<Json::Value> json_body,
+      std::function<void(Json::Value&&, Json::Value&&)>&& callback) final {
+    Json::Value json_resp;
+    json_resp["message"] = "Engine does not support embedding yet";
+    callback(MakeStatus(k409Conflict, true, false, true), std::move(json_resp));
+  }
+
+  void LoadModel(
+      std::shared_ptr<Json::Value> json_body,
+      std::function<void(Json::Value&&, Json::Value&&)>&& callback) final {
+    auto config = std::make_shared<MockConfig>();
+    auto model_path = json_body->get("model_path", "mock").asString();
+    config->model_id = json_body->get("model", model_path.substr(model_path.find_last_of("/\\") + 1)).asString();
+    config->output_tokens = json_body->get("mock_output_tokens", 128).asInt();
+    config->tokens_per_second = json_body->get("mock_tokens_per_second", 50.0).asDouble();
+    config->ttft_ms = json_body->get("mock_ttft_ms", 0).asInt();
+    config->user_prompt = json_body->get("user_prompt", "<|im_end|>\n<|im_start|>user\n").asString();
+    config->ai_prompt = json_body->get("ai_prompt", "<|im_end|>\n<|im_start|>assistant\n").asString();
+    config->system_prompt = json_body->get("system_prompt", "<|im_start|>system\n").asString();
+
+    auto corpus = json_body->get("mock_corpus", kDefaultCorpus).asString();
+    std::shared_ptr<MockTokenizer> tokenizer =
+        CreateTokenizer(json_body->get("mock_tokenizer", "word").asString(), corpus);
+    stream_ = std::make_shared<const std::vector<int32_t>>(tokenizer->Encode(corpus));
+    tokenizer_ = std::move(tokenizer);
+    config_ = std::move(config);
+    start_time_ = std::chrono::system_clock::now().time_since_epoch() / std::chrono::milliseconds(1);
+    model_loaded_ = true;
+
+    Json::Value json_resp;
+    json_resp["message"] = "Model loaded successfully";
+    callback(MakeStatus(k200OK, true, false), std::move(json_resp));
+  }
+
+  void UnloadModel(
+      std::shared_ptr<Json::Value> json_body,
+      std::function<void(Json::Value&&, Json::Value&&)>&& callback) final {
+    if (!CheckModelLoaded(callback)) {
+      return;
+    }
+    model_loaded_ = false;
+    Json::Value json_resp;
+    json_resp["message"] = "Model unloaded successfully";
+    callback(MakeStatus(k200OK, true, false), std::move(json_resp));
+  }
+
+  void GetModelStatus(
+      std::shared_ptr<Json::Value> json_body,
+      std::function<void(Json::Value&&, Json::Value&&)>&& callback) final {
+    if (!CheckModelLoaded(callback)) {
+      return;
+    }
+    Json::Value json_resp;
+    json_resp["model_loaded"] = true;
+    json_resp["model"] = config_->model_id;
+    callback(MakeStatus(k200OK, true, false), std::move(json_resp));
+  }
+
+  void GetModels(
+      std::shared_ptr<Json::Value> json_body,
+      std::function<void(Json::Value&&, Json::Value&&)>&& callback) final {
+    Json::Value model_array = Json::arrayValue;
+    if (model_loaded_) {
+      Json::Value val;
+      val["id"] = config_->model_id;
+      val["engine"] = "cortex.tensorrt-llm.mock";
+      val["start_time"] = start_time_;
+      val["object"] = "model";
+      model_array.append(val);
+    }
+    Json::Value json_resp;
+    json_resp["object"] = "list";
+    json_resp["data"] = model_array;
+    callback(MakeStatus(k200OK, true, false), std::move(json_resp));
+  }
+
+  // Counts with the mock tokenizer; there is no context window to fit.
+  void CountTokens(
+      std::shared_ptr<Json::Value> json_body,
+      std::function<void(Json::Value&&, Json::Value&&)>&& callback) final {
+    if (!CheckModelLoaded(callback)) {
+      return;
+    }
+    auto const text =
+        json_body->isMember("text") ? (*json_body)["text"].asString() : FormatPrompt(*config_, *json_body);
+    Json::Value json_resp;
+    json_resp["prompt_tokens"] = static_cast<Json::UInt64>(tokenizer_->Encode(text).size());
+    json_resp["fits"] = true;
+    callback(MakeStatus(k200OK, true, false), std::move(json_resp));
+  }
+
+ private:
+  bool CheckModelLoaded(std::function<void(Json::Value&&, Json::Value&&)>& callback) {
+    if (model_loaded_) {
+      return true;
+    }
+    Json::Value json_resp;
+    json_resp["message"] = "Model has not been loaded, please load model into cortex.tensorrt-llm";
+    callback(MakeStatus(k409Conflict, false, false, true), std::move(json_resp));
+    return false;
+  }
+
+  std::shared_ptr<const MockConfig> config_;
+  std::shared_ptr<const MockTokenizer> tokenizer_;
+  std::shared_ptr<const std::vector<int32_t>> stream_;
+  std::atomic<bool> model_loaded_{false};
+  uint64_t start_time_ = 0;
+};
+
+}  // namespace mock
+
+extern "C" {
+EngineI* get_engine() {
+  return new mock::MockEngine();
+}
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mock {
+
+// Tokenizer used by the mock engine. Implementations only need to be
+// deterministic and cheap enough that they don't dominate host profiles.
+class MockTokenizer {
+ public:
+  virtual ~MockTokenizer() {}
+  virtual std::vector<int32_t> Encode(const std::string& text) const = 0;
+  virtual std::string Decode(const std::vector<int32_t>& ids) const = 0;
+};
+
+// One id per byte. Multi-byte UTF-8 characters are emitted over several
+// tokens, like byte-fallback tokens of a real model.
+class ByteTokenizer : public MockTokenizer {
+ public:
+  std::vector<int32_t> Encode(const std::string& text) const override {
+    std::vector<int32_t> ids;
+    ids.reserve(text.size());
+    for (unsigned char c : text) {
+      ids.push_back(c);
+    }
+    return ids;
+  }
+
+  std::string Decode(const std::vector<int32_t>& ids) const override {
+    std::string text;
+    text.reserve(ids.size());
+    for (auto id : ids) {
+      text.push_back(static_cast<char>(id & 0xff));
+    }
+    return text;
+  }
+};
+
+// Splits on spaces, each word carrying its leading space like SentencePiece
+// pieces. The vocabulary is the set of words of the corpus.
+class WordTokenizer : public MockTokenizer {
+ public:
+  explicit WordTokenizer(const std::string& corpus) {
+    for (auto& word : Split(corpus)) {
+      if (ids_.emplace(word, static_cast<int32_t>(vocab_.size())).second) {
+        vocab_.push_back(std::move(word));
+      }
+    }
+  }
+
+  std::vector<int32_t> Encode(const std::string& text) const override {
+    std::vector<int32_t> ids;
+    for (auto const& word : Split(text)) {
+      auto it = ids_.find(word);
+      if (it != ids_.end()) {
+        ids.push_back(it->second);
+      } else {
+        // Unknown words still cost a lookup and map to a stable id.
+        ids.push_back(static_cast<int32_t>(std::hash<std::string>{}(word) % (vocab_.empty() ? 1 : vocab_.size())));
+      }
+    }
+    return ids;
+  }
+
+  std::string Decode(const std::vector<int32_t>& ids) const override {
+    std::string text;
+    for (auto id : ids) {
+      if (id >= 0 && static_cast<size_t>(id) < vocab_.size()) {
+        text += vocab_[id];
+      }
+    }
+    return text;
+  }
+
+ private:
+  static std::vector<std::string> Split(const std::string& text) {
+    std::vector<std::string> words;
+    std::string cur;
+    for (char c : text) {
+      if (c == ' ' && !cur.empty()) {
+        words.push_back(cur);
+        cur.clear();
+      }
+      cur.push_back(c);
+    }
+    if (!cur.empty()) {
+      words.push_back(cur);
+    }
+    return words;
+  }
+
+  std::vector<std::string> vocab_;
+  std::unordered_map<std::string, int32_t> ids_;
+};
+
+inline std::unique_ptr<MockTokenizer> CreateTokenizer(const std::string& name, const std::string& corpus) {
+  if (name == "byte") {
+    return std::make_unique<ByteTokenizer>();
+  }
+  return std::make_unique<WordTokenizer>(corpus);
+}
+
+}  // namespace mock
@@ -18,7 +18,19 @@ int main(int argc, char** argv) {
     port = std::atoi(argv[2]);  // Convert string argument to int
   }
 
-  Server server;
+  // Directory of the engine library, e.g. a mock engine build
+  std::string engine_path = "./engines/cortex.tensorrt-llm";
+  if (argc > 3) {
+    engine_path = argv[3];
+  }
+
+  // Seconds in-flight generations get to finish after SIGINT/SIGTERM
+  int drain_timeout_s = 30;
+  if (argc > 4) {
+    drain_timeout_s = std::atoi(argv[4]);
+  }
+
+  Server server(engine_path);
   Json::Reader r;
   auto svr = std::make_unique<httplib::Server>();
 
@@ -28,8 +40,26 @@ int main(int argc, char** argv) {
     return 1;
   }
 
+  // Reject new work while draining. Streams already started are not routed
+  // again, so they are unaffected.
+  svr->set_pre_routing_handler([&server](const httplib::Request& req,
+                                         httplib::Response& resp) {
+    if (!server.draining) {
+      return httplib::Server::HandlerResponse::Unhandled;
+    }
+    resp.status = 503;
+    resp.set_header("Connection", "close");
+    resp.set_header("Retry-After", "1");
+    resp.set_content("{\"message\":\"Server is shutting down\"}",
+                     "application/json; charset=utf-8");
+    return httplib::Server::HandlerResponse::Handled;
+  });
+
+  // `keep_alive` holds the engine and the in-flight token until the stream
+  // is released by httplib.
   auto process_stream_res = [&server](httplib::Response& resp,
-                                      std::shared_ptr<SyncQueue> q) {
+                                      std::shared_ptr<SyncQueue> q,
+                                      std::shared_ptr<void> keep_alive) {
     const auto chunked_content_provider =
         [&server, q](size_t size, httplib::DataSink& sink) {
           while (true) {
@@ -50,9 +80,9 @@ int main(int argc, char** argv) {
 
           return true;
         };
-    resp.set_chunked_content_provider("text/event-stream",
-                                      chunked_content_provider,
-                                      [](bool) { LOG_INFO << "Done"; });
+    resp.set_chunked_content_provider(
+        "text/event-stream", chunked_content_provider,
+        [keep_alive](bool) { LOG_INFO << "Done"; });
   };
 
   const auto handle_load_model = [&](const httplib::Request& req,
@@ -61,7 +91,7 @@ int main(int argc, char** argv) {
                     req.get_header_value("Origin"));
     auto req_body = std::make_shared<Json::Value>();
     r.parse(req.body, *req_body);
-    server.engine_->LoadModel(
+    server.engine()->engine->LoadModel(
         req_body, [&server, &resp](Json::Value status, Json::Value res) {
           resp.set_content(res.toStyledString().c_str(),
                            "application/json; charset=utf-8");
@@ -78,15 +108,97 @@ int main(int argc, char** argv) {
     bool is_stream = (*req_body).get("stream", false).asBool();
     // This is an async call, need to use queue
     auto q = std::make_shared<SyncQueue>();
-    server.engine_->HandleChatCompletion(
+    auto engine = server.engine();
+    auto token = server.TrackRequest();
+    engine->engine->HandleChatCompletion(
         req_body, [&server, q](Json::Value status, Json::Value res) {
           q->push(std::make_pair(status, res));
         });
-    process_stream_res(resp, q);
+    process_stream_res(resp, q,
+                       std::make_shared<std::pair<decltype(engine), decltype(token)>>(
+                           std::move(engine), std::move(token)));
+  };
+
+  // Loads a model (optionally from another engine library given by
+  // "engine_path") next to the running one, then switches routing to it. The
+  // previous engine is released once its last stream finishes.
+  const auto handle_reload_model = [&](const httplib::Request& req,
+                                       httplib::Response& resp) {
+    resp.set_header("Access-Control-Allow-Origin",
+                    req.get_header_value("Origin"));
+    auto req_body = std::make_shared<Json::Value>();
+    r.parse(req.body, *req_body);
+    std::lock_guard<std::mutex> l(server.reload_mtx);
+
+    std::shared_ptr<Server::EngineHandle> next;
+    try {
+      next = std::make_shared<Server::EngineHandle>(
+          req_body->get("engine_path", server.engine()->path).asString());
+    } catch (const std::exception& e) {
+      LOG_ERROR << "Failed to load engine library: " << e.what();
+      Json::Value json_resp;
+      json_resp["message"] = std::string("Failed to load engine: ") + e.what();
+      resp.set_content(json_resp.toStyledString(),
+                       "application/json; charset=utf-8");
+      resp.status = 400;
+      return;
+    }
+
+    bool loaded = false;
+    next->engine->LoadModel(
+        req_body, [&resp, &loaded](Json::Value status, Json::Value res) {
+          resp.set_content(res.toStyledString().c_str(),
+                           "application/json; charset=utf-8");
+          resp.status = status["status_code"].asInt();
+          loaded = resp.status == 200;
+        });
+    if (loaded) {
+      server.SwapEngine(std::move(next));
+      LOG_INFO << "Switched to reloaded model, " << server.InFlight()
+               << " request(s) in flight";
+    }
+  };
+
+  const auto handle_model_status = [&](const httplib::Request& req,
+                                       httplib::Response& resp) {
+    resp.set_header("Access-Control-Allow-Origin",
+                    req.get_header_value("Origin"));
+    auto req_body = std::make_shared<Json::Value>();
+    r.parse(req.body, *req_body);
+    server.engine()->engine->GetModelStatus(
+        req_body, [&resp](Json::Value status, Json::Value res) {
+          resp.set_content(res.toStyledString().c_str(),
+                           "application/json; charset=utf-8");
+          resp.status = status["status_code"].asInt();
+        });
+  };
+
+  const auto handle_token_count = [&](const httplib::Request& req,
+                                      httplib::Response& resp) {
+    resp.set_header("Access-Control-Allow-Origin",
+                    req.get_header_value("Origin"));
+    auto engine = server.engine();
+    if (!engine->engine->IsSupported("CountTokens")) {
+      resp.set_content("{\"message\":\"Engine does not support token counting\"}",
+                       "application/json; charset=utf-8");
+      resp.status = 501;
+      return;
+    }
+    auto req_body = std::make_shared<Json::Value>();
+    r.parse(req.body, *req_body);
+    engine->engine->CountTokens(
+        req_body, [&resp](Json::Value status, Json::Value res) {
+          resp.set_content(res.toStyledString().c_str(),
+                           "application/json; charset=utf-8");
+          resp.status = status["status_code"].asInt();
+        });
   };
 
   // Use POST since httplib does not read request body for GET method
   svr->Post("/inferences/tensorrt-llm/loadmodel", handle_load_model);
+  svr->Post("/inferences/tensorrt-llm/modelstatus", handle_model_status);
+  svr->Post("/inferences/tensorrt-llm/reloadmodel", handle_reload_model);
+  svr->Post("/inferences/tensorrt-llm/tokencount", handle_token_count);
   svr->Post("/v1/chat/completions", handle_completions);
 
   LOG_INFO << "HTTP server listening: " << hostname << ":" << port;
@@ -125,6 +237,15 @@ int main(int argc, char** argv) {
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
   }
 
+  // Drain: refuse new requests, let in-flight generations finish, then stop.
+  server.draining = true;
+  LOG_INFO << "Draining " << server.InFlight() << " request(s), timeout "
+           << drain_timeout_s << "s";
+  if (!server.WaitForDrain(std::chrono::seconds(drain_timeout_s))) {
+    LOG_WARN << "Drain timed out with " << server.InFlight()
+             << " request(s) in flight";
+  }
+
   svr->stop();
   t.join();
   LOG_DEBUG << "Server shutdown";
@@ -2,28 +2,102 @@
 
 #include "cortex-common/enginei.h"
 #include "dylib.h"
+#if defined(__linux__)
+#include "cortex-common/ipc/remote_engine.h"
+#endif
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
 
 class Server {
  public:
-  Server() {
-    dylib_ = std::make_unique<dylib>("./engines/cortex.tensorrt-llm", "engine");
-    auto func = dylib_->get_function<EngineI*()>("get_engine");
-    engine_ = func();
-  }
+  // An engine library and the engine instance created from it. Requests hold
+  // a reference for their whole lifetime, so a replaced engine is only
+  // destroyed once its last stream has finished.
+  // A path of the form "unix:<socket>" talks to an out-of-process engine
+  // host instead of loading the library in-process.
+  struct EngineHandle {
+    explicit EngineHandle(const std::string& engine_path) : path(engine_path) {
+#if defined(__linux__)
+      if (engine_path.rfind("unix:", 0) == 0) {
+        engine = new cortex::ipc::RemoteEngine(engine_path.substr(5));
+        return;
+      }
+#endif
+      lib = std::make_unique<dylib>(engine_path, "engine");
+      auto func = lib->get_function<EngineI*()>("get_engine");
+      engine = func();
+    }
 
-  ~Server() {
-    if (engine_) {
-      delete engine_;
+    ~EngineHandle() {
+      // The engine must be destroyed before its library is unloaded.
+      if (engine) {
+        delete engine;
+      }
     }
+
+    EngineI* operator->() const { return engine; }
+
+    std::string path;
+    std::unique_ptr<dylib> lib;
+    EngineI* engine = nullptr;
+  };
+
+  // Counts a request as in flight while alive.
+  class RequestToken {
+   public:
+    explicit RequestToken(Server& server) : server_(server) {
+      server_.in_flight_.fetch_add(1);
+    }
+    ~RequestToken() {
+      if (server_.in_flight_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> l(server_.drain_mtx_);
+        server_.drain_cond_.notify_all();
+      }
+    }
+
+   private:
+    Server& server_;
+  };
+
+  explicit Server(
+      const std::string& engine_path = "./engines/cortex.tensorrt-llm") {
+    engine_ = std::make_shared<EngineHandle>(engine_path);
+  }
+
+  std::shared_ptr<EngineHandle> engine() const {
+    std::lock_guard<std::mutex> l(engine_mtx_);
+    return engine_;
+  }
+
+  // Atomically routes new requests to `engine`, returns the previous one.
+  std::shared_ptr<EngineHandle> SwapEngine(
+      std::shared_ptr<EngineHandle> engine) {
+    std::lock_guard<std::mutex> l(engine_mtx_);
+    std::swap(engine_, engine);
+    return engine;
+  }
+
+  std::shared_ptr<RequestToken> TrackRequest() {
+    return std::make_shared<RequestToken>(*this);
+  }
+
+  int InFlight() const { return in_flight_.load(); }
+
+  // Returns true if all in-flight requests finished before `timeout`.
+  bool WaitForDrain(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> l(drain_mtx_);
+    return drain_cond_.wait_for(l, timeout,
+                                [this] { return in_flight_.load() == 0; });
   }
 
  public:
-  std::unique_ptr<dylib> dylib_;
-  EngineI* engine_;
+  std::atomic<bool> draining{false};
+  // Serializes hot reloads.
+  std::mutex reload_mtx;
 
   struct SyncQueue {
     void push(std::pair<Json::Value, Json::Value>&& p) {
@@ -45,6 +119,14 @@ class Server {
     // Status and result
     std::queue<std::pair<Json::Value, Json::Value>> q;
   };
+
+ private:
+  mutable std::mutex engine_mtx_;
+  std::shared_ptr<EngineHandle> engine_;
+
+  std::atomic<int> in_flight_{0};
+  std::mutex drain_mtx_;
+  std::condition_variable drain_cond_;
 };
 
 std::function<void(int)> shutdown_handler;
@@ -0,0 +1,102 @@
+#include "added_token_trie.h"
+
+#include <algorithm>
+#include <map>
+
+namespace tensorrtllm {
+
+void AddedTokenTrie::Build(std::vector<AddedToken> tokens) {
+  tokens_.clear();
+  nodes_.clear();
+  edges_.clear();
+  first_byte_.fill(false);
+
+  // Insert into a map-based trie, then flatten each node's children into a
+  // contiguous, byte-ordered edge range.
+  std::vector<std::map<uint8_t, uint32_t>> children(1);
+  std::vector<int32_t> ids(1, -1);
+  for (auto& token : tokens) {
+    if (token.content.empty() || token.id < 0) {
+      continue;
+    }
+    uint32_t node = 0;
+    for (unsigned char byte : token.content) {
+      auto it = children[node].find(byte);
+      if (it == children[node].end()) {
+        it = children[node].emplace(byte, static_cast<uint32_t>(children.size())).first;
+        children.emplace_back();
+        ids.push_back(-1);
+      }
+      node = it->second;
+    }
+    if (ids[node] >= 0) {
+      continue;
+    }
+    ids[node] = token.id;
+    first_byte_[static_cast<unsigned char>(token.content[0])] = true;
+    tokens_.push_back(std::move(token));
+  }
+
+  nodes_.resize(children.size());
+  for (size_t n = 0; n < children.size(); ++n) {
+    nodes_[n].id = ids[n];
+    nodes_[n].first_edge = static_cast<uint32_t>(edges_.size());
+    nodes_[n].edge_count = static_cast<uint32_t>(children[n].size());
+    for (auto const& [byte, child] : children[n]) {
+      edges_.push_back({byte, child});
+    }
+  }
+}
+
+uint32_t AddedTokenTrie::Child(uint32_t node, uint8_t byte) const {
+  auto const begin = edges_.begin() + nodes_[node].first_edge;
+  auto const end = begin + nodes_[node].edge_count;
+  auto it = std::lower_bound(begin, end, byte, [](const Edge& e, uint8_t b) { return e.byte < b; });
+  return it != end && it->byte == byte ? it->child : 0;
+}
+
+size_t AddedTokenTrie::Find(std::string_view text, size_t from, int32_t& id, size_t& length) const {
+  if (tokens_.empty()) {
+    return std::string_view::npos;
+  }
+  for (size_t start = from; start < text.size(); ++start) {
+    if (!first_byte_[static_cast<unsigned char>(text[start])]) {
+      continue;
+    }
+    int32_t best_id = -1;
+    size_t best_end = 0;
+    uint32_t node = 0;
+    for (size_t i = start; i < text.size(); ++i) {
+      node = Child(node, static_cast<uint8_t>(text[i]));
+      if (node == 0) {
+        break;
+      }
+      if (nodes_[node].id >= 0) {
+        best_id = nodes_[node].id;
+        best_end = i + 1;
+      }
+    }
+    if (best_id >= 0) {
+      id = best_id;
+      length = best_end - start;
+      return start;
+    }
+  }
+  return std::string_view::npos;
+}
+
+int32_t AddedTokenTrie::Lookup(std::string_view content) const {
+  if (nodes_.empty() || content.empty()) {
+    return -1;
+  }
+  uint32_t node = 0;
+  for (unsigned char byte : content) {
+    node = Child(node, byte);
+    if (node == 0) {
+      return -1;
+    }
+  }
+  return nodes_[node].id;
+}
+
+}  // namespace tensorrtllm
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tensorrtllm {
+
+struct AddedToken {
+  std::string content;
+  int32_t id;
+  bool special;
+};
+
+// Byte trie over a model's added/special tokens (ChatML markers, <|eot_id|>,
+// ...), used to cut them out of the input before normal encoding so each one
+// becomes its single id instead of being split into pieces.
+//
+// Nodes are stored flat with their edges contiguous and sorted by byte. A
+// first-byte bitmap lets the scan skip positions that cannot start a token,
+// which is almost all of them in ordinary text.
+class AddedTokenTrie {
+ public:
+  // Later duplicates of the same content are ignored.
+  void Build(std::vector<AddedToken> tokens);
+
+  bool Empty() const { return tokens_.empty(); }
+  const std::vector<AddedToken>& Tokens() const { return tokens_; }
+
+  // Finds the leftmost token occurrence at or after `from`, taking the
+  // longest token at that position. Returns its offset and sets `id` and
+  // `length`, or returns npos.
+  size_t Find(std::string_view text, size_t from, int32_t& id, size_t& length) const;
+
+  // Id of the token with exactly this content, -1 if there is none.
+  int32_t Lookup(std::string_view content) const;
+
+ private:
+  struct Node {
+    int32_t id = -1;
+    uint32_t first_edge = 0;
+    uint32_t edge_count = 0;
+  };
+  struct Edge {
+    uint8_t byte;
+    uint32_t child;
+  };
+
+  // Child of `node` along `byte`, 0 (the root, never a child) if none.
+  uint32_t Child(uint32_t node, uint8_t byte) const;
+
+  std::vector<AddedToken> tokens_;
+  std::vector<Node> nodes_;
+  std::vector<Edge> edges_;
+  std::array<bool, 256> first_byte_{};
+};
+
+}  // namespace tensorrtllm
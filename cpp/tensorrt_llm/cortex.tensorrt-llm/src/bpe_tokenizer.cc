@@ -0,0 +1,514 @@
+#include "bpe_tokenizer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "nlohmann/json.hpp"
+#include "unicode_data.h"
+
+namespace tensorrtllm {
+
+namespace {
+
+using json = nlohmann::json;
+
+// Split patterns of the supported pre-tokenizers, as stored in tokenizer.json.
+constexpr std::string_view kGpt2Pattern =
+    R"('s|'t|'re|'ve|'m|'ll|'d| ?\p{L}+| ?\p{N}+| ?[^\s\p{L}\p{N}]+|\s+(?!\S)|\s+)";
+constexpr std::string_view kLlama3PatternPrefix = R"((?i:'s|'t|'re|'ve|'m|'ll|'d)|[^\r\n\p{L}\p{N}]?\p{L}+|)";
+constexpr std::string_view kLlama3PatternSuffix = R"(| ?[^\s\p{L}\p{N}]+[\r\n]*|\s*[\r\n]+|\s+(?!\S)|\s+)";
+
+enum CharClass : uint8_t { kLetter, kNumber, kSpace, kOther };
+
+struct CodePoint {
+  uint32_t cp;
+  CharClass cls;
+};
+
+CharClass Classify(uint32_t cp) {
+  if (unicode::IsLetter(cp)) {
+    return kLetter;
+  }
+  if (unicode::IsNumber(cp)) {
+    return kNumber;
+  }
+  if (unicode::IsWhitespace(cp)) {
+    return kSpace;
+  }
+  return kOther;
+}
+
+bool IsNewline(uint32_t cp) {
+  return cp == '\r' || cp == '\n';
+}
+
+// GPT-2 maps every byte to a printable code point so that vocabulary entries
+// are valid strings: printable Latin-1 bytes map to themselves, the others to
+// U+0100 and up, in byte order.
+std::array<uint32_t, 256> ByteToUnicode() {
+  std::array<uint32_t, 256> table{};
+  uint32_t next = 256;
+  for (uint32_t b = 0; b < 256; ++b) {
+    bool printable = (b >= '!' && b <= '~') || (b >= 0xA1 && b <= 0xAC) || (b >= 0xAE && b <= 0xFF);
+    table[b] = printable ? b : next++;
+  }
+  return table;
+}
+
+// Undoes the byte-to-unicode mapping of a vocabulary entry.
+std::string ByteLevelToBytes(const std::string& token, const std::unordered_map<uint32_t, uint8_t>& unicode_to_byte) {
+  std::string bytes;
+  bytes.reserve(token.size());
+  size_t i = 0;
+  while (i < token.size()) {
+    size_t len;
+    uint32_t cp = unicode::DecodeUtf8(token.data(), token.size(), i, len);
+    auto it = unicode_to_byte.find(cp);
+    if (it == unicode_to_byte.end()) {
+      throw std::runtime_error("Vocabulary entry is not byte-level encoded: " + token);
+    }
+    bytes.push_back(static_cast<char>(it->second));
+    i += len;
+  }
+  return bytes;
+}
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Cannot open tokenizer file " + path);
+  }
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+size_t MatchContraction(const std::vector<CodePoint>& cps, size_t i, size_t n, bool ignore_case) {
+  if (cps[i].cp != '\'' || i + 1 >= n) {
+    return 0;
+  }
+  auto lower = [&](size_t k) {
+    uint32_t c = cps[k].cp;
+    return ignore_case && c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+  };
+  uint32_t a = lower(i + 1);
+  if (a == 's' || a == 't' || a == 'm' || a == 'd') {
+    return i + 2;
+  }
+  if (i + 2 < n) {
+    uint32_t b = lower(i + 2);
+    if ((a == 'r' && b == 'e') || (a == 'v' && b == 'e') || (a == 'l' && b == 'l')) {
+      return i + 3;
+    }
+  }
+  return 0;
+}
+
+// \s*[\r\n]+ (if `newline_rule`), then \s+(?!\S), then \s+.
+size_t MatchWhitespace(const std::vector<CodePoint>& cps, size_t i, size_t n, bool newline_rule) {
+  size_t end = i;
+  while (end < n && cps[end].cls == kSpace) {
+    ++end;
+  }
+  if (newline_rule) {
+    for (size_t k = end; k > i; --k) {
+      if (IsNewline(cps[k - 1].cp)) {
+        return k;
+      }
+    }
+  }
+  if (end == n || end - i == 1) {
+    return end;
+  }
+  // Leave the last whitespace to prefix the following word.
+  return end - 1;
+}
+
+size_t Run(const std::vector<CodePoint>& cps, size_t i, size_t n, CharClass cls) {
+  while (i < n && cps[i].cls == cls) {
+    ++i;
+  }
+  return i;
+}
+
+}  // namespace
+
+void BpeTokenizer::MergeTable::Reserve(size_t count) {
+  size_t capacity = 16;
+  shift_ = 60;
+  while (capacity < count * 2) {
+    capacity <<= 1;
+    --shift_;
+  }
+  keys_.assign(capacity, kEmpty);
+  values_.assign(capacity, Merge{});
+  mask_ = capacity - 1;
+}
+
+void BpeTokenizer::MergeTable::Insert(int32_t left, int32_t right, Merge merge) {
+  uint64_t key = Key(left, right);
+  for (size_t slot = Slot(key);; slot = (slot + 1) & mask_) {
+    if (keys_[slot] == kEmpty) {
+      keys_[slot] = key;
+      values_[slot] = merge;
+      return;
+    }
+    if (keys_[slot] == key) {
+      return;  // Keep the first (lowest) rank of a duplicated merge.
+    }
+  }
+}
+
+const BpeTokenizer::MergeTable::Merge* BpeTokenizer::MergeTable::Find(int32_t left, int32_t right) const {
+  if (keys_.empty()) {
+    return nullptr;
+  }
+  uint64_t key = Key(left, right);
+  for (size_t slot = Slot(key);; slot = (slot + 1) & mask_) {
+    if (keys_[slot] == key) {
+      return &values_[slot];
+    }
+    if (keys_[slot] == kEmpty) {
+      return nullptr;
+    }
+  }
+}
+
+BpeTokenizer::BpeTokenizer(const std::string& tokenizer_json_path) {
+  Load(ReadFile(tokenizer_json_path));
+}
+
+void BpeTokenizer::Load(const std::string& contents) {
+  json const root = json::parse(contents);
+  json const& model = root.at("model");
+  if (model.value("type", "BPE") != "BPE") {
+    throw std::runtime_error("Unsupported tokenizer model type " + model.value("type", ""));
+  }
+
+  json const& normalizer = root.value("normalizer", json());
+  if (!normalizer.is_null() && normalizer.value("type", "") != "NFC") {
+    throw std::runtime_error("Unsupported tokenizer normalizer " + normalizer.dump());
+  }
+
+  // Byte-level BPE uses either a ByteLevel pre-tokenizer with the GPT-2
+  // regex, or a regex Split followed by a ByteLevel without regex.
+  json const& pre = root.value("pre_tokenizer", json());
+  std::vector<json> steps;
+  if (pre.is_object() && pre.value("type", "") == "Sequence") {
+    steps = pre.at("pretokenizers").get<std::vector<json>>();
+  } else if (pre.is_object()) {
+    steps.push_back(pre);
+  }
+  bool byte_level = false;
+  bool has_pattern = false;
+  for (auto const& step : steps) {
+    auto type = step.value("type", "");
+    if (type == "ByteLevel") {
+      byte_level = true;
+      add_prefix_space_ = step.value("add_prefix_space", false);
+      if (step.value("use_regex", true)) {
+        pre_tokenizer_ = PreTokenizer::kGpt2;
+        has_pattern = true;
+      }
+    } else if (type == "Split" && step.contains("pattern") && step["pattern"].contains("Regex")) {
+      auto pattern = step["pattern"]["Regex"].get<std::string>();
+      std::string_view p = pattern;
+      if (p == kGpt2Pattern) {
+        pre_tokenizer_ = PreTokenizer::kGpt2;
+      } else if (p.size() > kLlama3PatternPrefix.size() + kLlama3PatternSuffix.size()
+          && p.substr(0, kLlama3PatternPrefix.size()) == kLlama3PatternPrefix
+          && p.substr(p.size() - kLlama3PatternSuffix.size()) == kLlama3PatternSuffix) {
+        auto digits = p.substr(kLlama3PatternPrefix.size(),
+                               p.size() - kLlama3PatternPrefix.size() - kLlama3PatternSuffix.size());
+        if (digits == R"(\p{N}{1,3})") {
+          max_digits_ = 3;
+        } else if (digits == R"(\p{N})") {
+          max_digits_ = 1;
+        } else if (digits == R"(\p{N}+)") {
+          max_digits_ = 0;
+        } else {
+          throw std::runtime_error("Unsupported pre-tokenizer pattern " + pattern);
+        }
+        pre_tokenizer_ = PreTokenizer::kLlama3;
+      } else {
+        throw std::runtime_error("Unsupported pre-tokenizer pattern " + pattern);
+      }
+      has_pattern = true;
+    } else {
+      throw std::runtime_error("Unsupported pre-tokenizer " + step.dump());
+    }
+  }
+  if (!byte_level || !has_pattern) {
+    throw std::runtime_error("Only byte-level BPE tokenizers with a split pattern are supported");
+  }
+  ignore_merges_ = model.value("ignore_merges", false);
+
+  // Vocabulary, stored as raw bytes.
+  auto const byte_to_unicode = ByteToUnicode();
+  std::unordered_map<uint32_t, uint8_t> unicode_to_byte;
+  for (uint32_t b = 0; b < 256; ++b) {
+    unicode_to_byte[byte_to_unicode[b]] = static_cast<uint8_t>(b);
+  }
+  json const& vocab = model.at("vocab");
+  std::vector<std::string> id_to_bytes;
+  std::vector<bool> is_special;
+  std::vector<AddedToken> added_tokens;
+  std::unordered_map<std::string, int32_t> encoded_to_id;
+  encoded_to_id.reserve(vocab.size());
+  for (auto it = vocab.begin(); it != vocab.end(); ++it) {
+    auto id = it.value().get<int32_t>();
+    if (id < 0) {
+      throw std::runtime_error("Negative token id in vocabulary");
+    }
+    if (static_cast<size_t>(id) >= id_to_bytes.size()) {
+      id_to_bytes.resize(id + 1);
+    }
+    id_to_bytes[id] = ByteLevelToBytes(it.key(), unicode_to_byte);
+    encoded_to_id.emplace(it.key(), id);
+  }
+
+  for (auto const& token : root.value("added_tokens", json::array())) {
+    auto id = token.at("id").get<int32_t>();
+    auto content = token.at("content").get<std::string>();
+    if (id < 0 || content.empty()) {
+      continue;
+    }
+    if (static_cast<size_t>(id) >= id_to_bytes.size()) {
+      id_to_bytes.resize(id + 1);
+    }
+    id_to_bytes[id] = content;
+    if (is_special.size() < id_to_bytes.size()) {
+      is_special.resize(id_to_bytes.size(), false);
+    }
+    is_special[id] = token.value("special", false);
+    added_tokens.push_back({content, id, is_special[id]});
+  }
+  is_special.resize(id_to_bytes.size(), false);
+
+  size_t arena_bytes = 0;
+  for (auto const& bytes : id_to_bytes) {
+    arena_bytes += bytes.size();
+  }
+  pieces_.Reserve(id_to_bytes.size(), arena_bytes);
+  for (size_t id = 0; id < id_to_bytes.size(); ++id) {
+    pieces_.Add(id_to_bytes[id], is_special[id] ? PieceTable::kSkipOnDecode : PieceTable::kNone);
+  }
+
+  added_tokens_.Build(std::move(added_tokens));
+
+  // Views into the piece arena, which is complete at this point.
+  bytes_to_id_.reserve(pieces_.Size());
+  for (size_t id = 0; id < pieces_.Size(); ++id) {
+    auto piece = pieces_.Piece(static_cast<int32_t>(id));
+    if (!piece.empty()) {
+      bytes_to_id_.emplace(piece, static_cast<int32_t>(id));
+    }
+  }
+  for (uint32_t b = 0; b < 256; ++b) {
+    std::string single(1, static_cast<char>(b));
+    auto it = bytes_to_id_.find(single);
+    byte_to_id_[b] = it == bytes_to_id_.end() ? -1 : it->second;
+  }
+
+  // Merges are either "left right" strings or [left, right] pairs.
+  json const& merges = model.value("merges", json::array());
+  merges_.Reserve(merges.size());
+  int32_t rank = 0;
+  for (auto const& merge : merges) {
+    std::string left;
+    std::string right;
+    if (merge.is_array()) {
+      left = merge.at(0).get<std::string>();
+      right = merge.at(1).get<std::string>();
+    } else {
+      auto const& s = merge.get_ref<const std::string&>();
+      auto space = s.find(' ', 1);
+      if (space == std::string::npos) {
+        throw std::runtime_error("Malformed merge " + s);
+      }
+      left = s.substr(0, space);
+      right = s.substr(space + 1);
+    }
+    auto l = encoded_to_id.find(left);
+    auto r = encoded_to_id.find(right);
+    auto m = encoded_to_id.find(left + right);
+    if (l == encoded_to_id.end() || r == encoded_to_id.end() || m == encoded_to_id.end()) {
+      throw std::runtime_error("Merge refers to a token outside the vocabulary: " + left + " " + right);
+    }
+    merges_.Insert(l->second, r->second, {rank++, m->second});
+  }
+}
+
+int32_t BpeTokenizer::TokenToId(std::string_view token) const {
+  auto it = bytes_to_id_.find(token);
+  return it == bytes_to_id_.end() ? -1 : it->second;
+}
+
+void BpeTokenizer::DecodeAppend(const int32_t* ids, size_t count, std::string& text) const {
+  pieces_.DecodeAppend(ids, count, /*strip_leading_space=*/false, text);
+}
+
+void BpeTokenizer::EncodeSegment(std::string_view text, std::vector<int32_t>& ids) const {
+  if (text.empty()) {
+    return;
+  }
+  thread_local std::string prefixed;
+  if (add_prefix_space_ && text.front() != ' ') {
+    prefixed.assign(1, ' ');
+    prefixed.append(text);
+    text = prefixed;
+  }
+
+  thread_local std::vector<CodePoint> cps;
+  thread_local std::vector<uint32_t> offsets;
+  cps.clear();
+  offsets.clear();
+  for (size_t pos = 0; pos < text.size();) {
+    size_t len;
+    uint32_t cp = unicode::DecodeUtf8(text.data(), text.size(), pos, len);
+    cps.push_back({cp, Classify(cp)});
+    offsets.push_back(static_cast<uint32_t>(pos));
+    pos += len;
+  }
+  offsets.push_back(static_cast<uint32_t>(text.size()));
+
+  size_t const n = cps.size();
+  for (size_t i = 0; i < n;) {
+    size_t end = MatchPreToken(cps, i, n);
+    EncodeWord(text.substr(offsets[i], offsets[end] - offsets[i]), ids);
+    i = end;
+  }
+}
+
+template <typename TCodePoints>
+size_t BpeTokenizer::MatchPreToken(const TCodePoints& cps, size_t i, size_t n) const {
+  bool const llama3 = pre_tokenizer_ == PreTokenizer::kLlama3;
+  if (size_t end = MatchContraction(cps, i, n, llama3)) {
+    return end;
+  }
+
+  if (llama3) {
+    // [^\r\n\p{L}\p{N}]?\p{L}+
+    size_t j = i;
+    if (cps[j].cls != kLetter && cps[j].cls != kNumber && !IsNewline(cps[j].cp) && j + 1 < n
+        && cps[j + 1].cls == kLetter) {
+      ++j;
+    }
+    if (cps[j].cls == kLetter) {
+      return Run(cps, j, n, kLetter);
+    }
+    // \p{N}{1,max_digits}
+    if (cps[i].cls == kNumber) {
+      size_t end = Run(cps, i, n, kNumber);
+      return max_digits_ > 0 ? std::min(end, i + max_digits_) : end;
+    }
+    //  ?[^\s\p{L}\p{N}]+[\r\n]*
+    j = cps[i].cp == ' ' && i + 1 < n && cps[i + 1].cls == kOther ? i + 1 : i;
+    if (cps[j].cls == kOther) {
+      size_t end = Run(cps, j, n, kOther);
+      while (end < n && IsNewline(cps[end].cp)) {
+        ++end;
+      }
+      return end;
+    }
+    return MatchWhitespace(cps, i, n, true);
+  }
+
+  //  ?\p{L}+,  ?\p{N}+,  ?[^\s\p{L}\p{N}]+
+  for (auto cls : {kLetter, kNumber, kOther}) {
+    size_t j = cps[i].cp == ' ' && i + 1 < n && cps[i + 1].cls == cls ? i + 1 : i;
+    if (cps[j].cls == cls) {
+      return Run(cps, j, n, cls);
+    }
+  }
+  return MatchWhitespace(cps, i, n, false);
+}
+
+void BpeTokenizer::EncodeWord(std::string_view word, std::vector<int>& ids) const {
+  if (word.size() == 1) {
+    if (auto id = byte_to_id_[static_cast<unsigned char>(word[0])]; id >= 0) {
+      ids.push_back(id);
+    }
+    return;
+  }
+  if (ignore_merges_) {
+    if (auto it = bytes_to_id_.find(word); it != bytes_to_id_.end()) {
+      ids.push_back(it->second);
+      return;
+    }
+  }
+
+  struct Symbol {
+    int32_t id;
+    int32_t prev;
+    int32_t next;
+    uint32_t len;
+  };
+  struct Candidate {
+    int32_t rank;
+    int32_t pos;
+    int32_t id;
+  };
+  // Min-heap on (rank, pos): the lowest rank merges first, leftmost on ties.
+  auto later = [](const Candidate& a, const Candidate& b) {
+    return a.rank != b.rank ? a.rank > b.rank : a.pos > b.pos;
+  };
+
+  int32_t const n = static_cast<int32_t>(word.size());
+  thread_local std::vector<Symbol> symbols;
+  thread_local std::vector<Candidate> heap;
+  symbols.resize(n);
+  heap.clear();
+  for (int32_t k = 0; k < n; ++k) {
+    symbols[k] = {byte_to_id_[static_cast<unsigned char>(word[k])], k - 1, k + 1 < n ? k + 1 : -1, 1};
+  }
+
+  auto push = [&](int32_t left) {
+    int32_t right = symbols[left].next;
+    if (auto const* merge = merges_.Find(symbols[left].id, symbols[right].id)) {
+      heap.push_back({merge->rank, left, merge->id});
+      std::push_heap(heap.begin(), heap.end(), later);
+    }
+  };
+  for (int32_t k = 0; k + 1 < n; ++k) {
+    push(k);
+  }
+
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), later);
+    Candidate top = heap.back();
+    heap.pop_back();
+
+    Symbol& left = symbols[top.pos];
+    if (left.len == 0 || left.next < 0) {
+      continue;
+    }
+    Symbol& right = symbols[left.next];
+    // Skip candidates made stale by an earlier merge of either symbol.
+    auto const* merge = merges_.Find(left.id, right.id);
+    if (merge == nullptr || merge->id != top.id) {
+      continue;
+    }
+    left.id = top.id;
+    left.len += right.len;
+    left.next = right.next;
+    right.len = 0;
+    if (left.next >= 0) {
+      symbols[left.next].prev = top.pos;
+      push(top.pos);
+    }
+    if (left.prev >= 0) {
+      push(left.prev);
+    }
+  }
+
+  for (int32_t k = 0; k >= 0; k = symbols[k].next) {
+    if (symbols[k].id >= 0) {
+      ids.push_back(symbols[k].id);
+    }
+  }
+}
+
+}  // namespace tensorrtllm
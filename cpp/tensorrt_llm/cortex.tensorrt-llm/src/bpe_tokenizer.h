@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "tokenizer.h"
+
+namespace tensorrtllm {
+
+// Byte-level BPE tokenizer loaded from a Hugging Face `tokenizer.json`
+// (GPT-2, Llama-3 and Qwen2 style models).
+//
+// Text between added tokens (split off by Tokenizer) is pre-tokenized with a
+// hand-written matcher for the model's split regex, then every pre-token is
+// merged lowest-rank-first: candidate pairs sit in a min-heap ordered by
+// (rank, position), and ranks come from a flat open-addressing table keyed by
+// the (left id, right id) pair. Vocabulary entries are kept as raw bytes, so
+// the GPT-2 byte-to-unicode mapping is only undone once at load time, when
+// the piece table is built.
+//
+// Scratch buffers are thread-local, so a warm thread encodes without
+// allocating beyond the output vector.
+//
+// Ids match `tokenizers` encode(text, add_special_tokens=False). Only the
+// GPT-2 and Llama-3/Qwen2 split patterns are recognized; normalizers other
+// than NFC are rejected and NFC is assumed to be a no-op on the input.
+class BpeTokenizer : public Tokenizer {
+ public:
+  // Throws std::runtime_error if the file cannot be read or describes a
+  // tokenizer this implementation does not support.
+  explicit BpeTokenizer(const std::string& tokenizer_json_path);
+
+  void DecodeAppend(const int32_t* ids, size_t count, std::string& text) const override;
+
+  // Id of a token given as raw bytes or added-token content, -1 if unknown.
+  int32_t TokenToId(std::string_view token) const;
+
+ private:
+  enum class PreTokenizer {
+    // 's|'t|'re|'ve|'m|'ll|'d| ?\p{L}+| ?\p{N}+| ?[^\s\p{L}\p{N}]+|\s+(?!\S)|\s+
+    kGpt2,
+    // (?i:'s|'t|'re|'ve|'m|'ll|'d)|[^\r\n\p{L}\p{N}]?\p{L}+|\p{N}{1,k}|
+    //  ?[^\s\p{L}\p{N}]+[\r\n]*|\s*[\r\n]+|\s+(?!\S)|\s+
+    kLlama3,
+  };
+
+  // Open-addressing hash table from a (left, right) id pair to its merge.
+  class MergeTable {
+   public:
+    struct Merge {
+      int32_t rank;
+      int32_t id;
+    };
+
+    void Reserve(size_t count);
+    void Insert(int32_t left, int32_t right, Merge merge);
+    const Merge* Find(int32_t left, int32_t right) const;
+
+   private:
+    static constexpr uint64_t kEmpty = ~0ull;
+
+    static uint64_t Key(int32_t left, int32_t right) {
+      return (static_cast<uint64_t>(static_cast<uint32_t>(left)) << 32) | static_cast<uint32_t>(right);
+    }
+    size_t Slot(uint64_t key) const { return (key * 0x9E3779B97F4A7C15ull) >> shift_; }
+
+    std::vector<uint64_t> keys_;
+    std::vector<Merge> values_;
+    size_t mask_ = 0;
+    int shift_ = 64;
+  };
+
+  void Load(const std::string& contents);
+  void EncodeSegment(std::string_view text, std::vector<int32_t>& ids) const override;
+  void EncodeWord(std::string_view word, std::vector<int>& ids) const;
+  // Returns the end (in code points) of the pre-token starting at `i`.
+  template <typename TCodePoints>
+  size_t MatchPreToken(const TCodePoints& cps, size_t i, size_t n) const;
+
+  PreTokenizer pre_tokenizer_ = PreTokenizer::kGpt2;
+  int max_digits_ = 0;  // kLlama3 only, 0 for unbounded
+  bool add_prefix_space_ = false;
+  bool ignore_merges_ = false;
+
+  std::unordered_map<std::string_view, int32_t> bytes_to_id_;  // views into pieces_
+  std::array<int32_t, 256> byte_to_id_;
+  MergeTable merges_;
+};
+
+}  // namespace tensorrtllm
@@ -0,0 +1,86 @@
+#include "context_window.h"
+
+namespace tensorrtllm {
+
+std::optional<TruncationPolicy> ParseTruncationPolicy(std::string_view name) {
+  if (name == "none") {
+    return TruncationPolicy::kNone;
+  }
+  if (name == "drop_oldest") {
+    return TruncationPolicy::kDropOldest;
+  }
+  if (name == "middle_out") {
+    return TruncationPolicy::kMiddleOut;
+  }
+  return std::nullopt;
+}
+
+const char* TruncationPolicyName(TruncationPolicy policy) {
+  switch (policy) {
+    case TruncationPolicy::kDropOldest:
+      return "drop_oldest";
+    case TruncationPolicy::kMiddleOut:
+      return "middle_out";
+    case TruncationPolicy::kNone:
+      break;
+  }
+  return "none";
+}
+
+ContextFit FitToContext(const std::vector<MessageTokens>& messages, int32_t overhead, int32_t budget,
+                        TruncationPolicy policy) {
+  size_t const n = messages.size();
+  int64_t total = overhead;
+  for (auto const& message : messages) {
+    total += message.tokens;
+  }
+
+  // Droppable messages in the order the policy gives them up.
+  std::vector<size_t> candidates;
+  for (size_t i = 0; i + 1 < n; ++i) {
+    if (!messages[i].pinned) {
+      candidates.push_back(i);
+    }
+  }
+  std::vector<bool> drop(n, false);
+  if (policy == TruncationPolicy::kDropOldest) {
+    for (size_t c = 0; c < candidates.size() && total > budget; ++c) {
+      drop[candidates[c]] = true;
+      total -= messages[candidates[c]].tokens;
+    }
+  } else if (policy == TruncationPolicy::kMiddleOut) {
+    while (!candidates.empty() && total > budget) {
+      auto middle = candidates.begin() + candidates.size() / 2;
+      drop[*middle] = true;
+      total -= messages[*middle].tokens;
+      candidates.erase(middle);
+    }
+  }
+
+  ContextFit fit;
+  for (size_t i = 0; i < n; ++i) {
+    (drop[i] ? fit.dropped : fit.kept).push_back(i);
+  }
+  fit.prompt_tokens = static_cast<int32_t>(total);
+  fit.fits = total <= budget;
+  return fit;
+}
+
+int32_t TokenCountCache::Count(const Tokenizer& tokenizer, const std::string& text) {
+  uint64_t const key = EncodeCache::Hash(text);
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+    if (auto it = counts_.find(key); it != counts_.end()) {
+      return it->second;
+    }
+  }
+  auto const count = static_cast<int32_t>(tokenizer.Encode(text).size());
+  std::lock_guard<std::mutex> l(mtx_);
+  if (counts_.size() >= max_entries_) {
+    counts_.clear();
+  }
+  counts_.emplace(key, count);
+  return count;
+}
+
+}  // namespace tensorrtllm
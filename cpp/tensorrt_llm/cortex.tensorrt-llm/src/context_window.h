@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "tokenizer.h"
+
+namespace tensorrtllm {
+
+// What to do with a conversation whose prompt does not fit the context window.
+enum class TruncationPolicy {
+  kNone,        // reject the request
+  kDropOldest,  // drop the oldest turns, keeping system messages
+  kMiddleOut,   // keep the first and the latest turns, drop from the middle
+};
+
+// "none", "drop_oldest" or "middle_out".
+std::optional<TruncationPolicy> ParseTruncationPolicy(std::string_view name);
+const char* TruncationPolicyName(TruncationPolicy policy);
+
+struct MessageTokens {
+  int32_t tokens;
+  bool pinned;  // never dropped (system messages)
+};
+
+struct ContextFit {
+  std::vector<size_t> kept;     // indices of the kept messages, in order
+  std::vector<size_t> dropped;  // indices of the dropped messages, in order
+  int32_t prompt_tokens = 0;    // overhead plus the kept messages
+  bool fits = false;
+};
+
+// Chooses the messages to keep so that `overhead` (template tokens outside
+// any message) plus their token counts is at most `budget`. The last message
+// is never dropped, as it is the turn being answered. Costs O(messages) for
+// kNone/kDropOldest and O(messages^2) at worst for kMiddleOut.
+ContextFit FitToContext(const std::vector<MessageTokens>& messages, int32_t overhead, int32_t budget,
+                        TruncationPolicy policy);
+
+// Token counts of rendered chat messages, keyed by a hash of the text. A
+// conversation resends its history with every turn, so all but the newest
+// message are usually counted without encoding. Collisions only skew the fit
+// estimate; callers check the final encoded prompt.
+class TokenCountCache {
+ public:
+  explicit TokenCountCache(size_t max_entries = 4096) : max_entries_(max_entries) {}
+
+  int32_t Count(const Tokenizer& tokenizer, const std::string& text);
+
+ private:
+  size_t max_entries_;
+  std::mutex mtx_;
+  std::unordered_map<uint64_t, int32_t> counts_;
+};
+
+}  // namespace tensorrtllm
@@ -0,0 +1,152 @@
+#include "encode_cache.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace tensorrtllm {
+
+namespace {
+
+// Assumed size of an average entry when sizing the slot array.
+constexpr size_t kBytesPerSlot = 512;
+
+size_t NextPowerOfTwo(size_t n) {
+  size_t p = 1;
+  while (p < n) {
+    p <<= 1;
+  }
+  return p;
+}
+
+}  // namespace
+
+EncodeCache::EncodeCache(Config config)
+    : config_(config),
+      max_entry_bytes_(config.budget_bytes / 8),
+      mask_(NextPowerOfTwo(std::max<size_t>(config.budget_bytes / kBytesPerSlot, kProbeLength * 2)) - 1),
+      slots_(new Slot[mask_ + 1]) {}
+
+EncodeCache::~EncodeCache() {
+  for (size_t i = 0; i <= mask_; ++i) {
+    delete slots_[i].entry.load(std::memory_order_relaxed);
+  }
+}
+
+uint64_t EncodeCache::Hash(std::string_view text) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : text) {
+    hash = (hash ^ c) * 1099511628211ull;
+  }
+  return hash;
+}
+
+bool EncodeCache::Lookup(std::string_view segment, std::vector<int32_t>& ids) const {
+  uint64_t const hash = Hash(segment);
+  for (size_t probe = 0; probe < kProbeLength; ++probe) {
+    Slot& slot = slots_[(hash + probe) & mask_];
+    // Announcing the read before loading the pointer keeps the entry alive:
+    // Evict unlinks first, then waits for readers to reach zero.
+    slot.readers.fetch_add(1);
+    const Entry* entry = slot.entry.load();
+    bool const hit = entry != nullptr && entry->hash == hash && entry->text == segment;
+    if (hit) {
+      ids.insert(ids.end(), entry->ids.begin(), entry->ids.end());
+    }
+    slot.readers.fetch_sub(1, std::memory_order_release);
+    if (hit) {
+      if (!slot.referenced.load(std::memory_order_relaxed)) {
+        slot.referenced.store(true, std::memory_order_relaxed);
+      }
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      bytes_saved_.fetch_add(segment.size(), std::memory_order_relaxed);
+      return true;
+    }
+  }
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void EncodeCache::Evict(Slot& slot) {
+  Entry* entry = slot.entry.exchange(nullptr);
+  if (entry == nullptr) {
+    return;
+  }
+  // seq_cst pairs with the reader's fetch_add/load: either the reader saw
+  // the slot empty, or its count is visible here.
+  while (slot.readers.load() != 0) {
+    std::this_thread::yield();
+  }
+  resident_bytes_ -= entry->Bytes();
+  --entries_;
+  delete entry;
+  evictions_.fetch_add(1, std::memory_order_relaxed);
+  PublishSizes();
+}
+
+void EncodeCache::PublishSizes() {
+  resident_bytes_stat_.store(resident_bytes_, std::memory_order_relaxed);
+  entries_stat_.store(entries_, std::memory_order_relaxed);
+}
+
+void EncodeCache::Insert(std::string_view segment, const int32_t* ids, size_t count) {
+  auto entry = std::make_unique<Entry>();
+  entry->hash = Hash(segment);
+  entry->text.assign(segment.data(), segment.size());
+  entry->ids.assign(ids, ids + count);
+  size_t const bytes = entry->Bytes();
+  if (bytes > max_entry_bytes_) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  // Home window: skip if another thread inserted it meanwhile, otherwise
+  // take an empty slot, else the first unreferenced one (CLOCK within the
+  // window), else the home slot.
+  Slot* target = nullptr;
+  Slot* unreferenced = nullptr;
+  for (size_t probe = 0; probe < kProbeLength; ++probe) {
+    Slot& slot = slots_[(entry->hash + probe) & mask_];
+    Entry* current = slot.entry.load(std::memory_order_relaxed);
+    if (current == nullptr) {
+      target = target != nullptr ? target : &slot;
+    } else if (current->hash == entry->hash && current->text == entry->text) {
+      return;
+    } else if (unreferenced == nullptr && !slot.referenced.load(std::memory_order_relaxed)) {
+      unreferenced = &slot;
+    }
+  }
+  if (target == nullptr) {
+    target = unreferenced != nullptr ? unreferenced : &slots_[entry->hash & mask_];
+    Evict(*target);
+  }
+
+  // Global CLOCK sweep down to the byte budget.
+  for (size_t steps = 0; resident_bytes_ + bytes > config_.budget_bytes && steps < 2 * (mask_ + 1); ++steps) {
+    Slot& slot = slots_[hand_];
+    hand_ = (hand_ + 1) & mask_;
+    if (&slot == target || slot.entry.load(std::memory_order_relaxed) == nullptr) {
+      continue;
+    }
+    if (slot.referenced.exchange(false, std::memory_order_relaxed)) {
+      continue;
+    }
+    Evict(slot);
+  }
+  if (resident_bytes_ + bytes > config_.budget_bytes) {
+    return;
+  }
+
+  resident_bytes_ += bytes;
+  ++entries_;
+  target->referenced.store(false, std::memory_order_relaxed);
+  target->entry.store(entry.release());
+  PublishSizes();
+}
+
+EncodeCache::Stats EncodeCache::GetStats() const {
+  return {hits_.load(std::memory_order_relaxed),        misses_.load(std::memory_order_relaxed),
+          bytes_saved_.load(std::memory_order_relaxed), evictions_.load(std::memory_order_relaxed),
+          entries_stat_.load(std::memory_order_relaxed), resident_bytes_stat_.load(std::memory_order_relaxed)};
+}
+
+}  // namespace tensorrtllm
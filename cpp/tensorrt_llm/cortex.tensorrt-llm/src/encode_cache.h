@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tensorrtllm {
+
+// Bounded cache of encoded text segments, shared by all threads encoding with
+// one tokenizer.
+//
+// Keys are the segments Tokenizer::EncodeAppend produces between added
+// tokens, so a template's system prompt or few-shot preamble is one entry no
+// matter what follows it. Entries are found by a 64-bit FNV-1a hash and
+// confirmed against the stored text, so a collision costs a miss, never
+// wrong ids.
+//
+// Lookups are lock-free: each slot holds an atomic entry pointer and a reader
+// count, and a writer that unlinks an entry waits for the slot's readers to
+// drain before freeing it. Inserts and evictions take a mutex. Eviction is
+// CLOCK: hits set a slot's reference bit, and the hand clears set bits and
+// evicts the first unreferenced entry until the byte budget (text plus ids
+// of every resident entry) is respected.
+class EncodeCache {
+ public:
+  struct Config {
+    size_t budget_bytes = 16 << 20;
+    // Segments shorter than this are cheaper to encode than to look up.
+    size_t min_segment_bytes = 64;
+  };
+
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t bytes_saved;  // segment bytes served without encoding
+    uint64_t evictions;
+    uint64_t entries;
+    uint64_t resident_bytes;
+  };
+
+  explicit EncodeCache(Config config);
+  ~EncodeCache();
+
+  EncodeCache(const EncodeCache&) = delete;
+  EncodeCache& operator=(const EncodeCache&) = delete;
+
+  bool Cacheable(std::string_view segment) const {
+    return segment.size() >= config_.min_segment_bytes && segment.size() <= max_entry_bytes_;
+  }
+
+  // Appends the cached ids of `segment` to `ids` and returns true on a hit.
+  bool Lookup(std::string_view segment, std::vector<int32_t>& ids) const;
+
+  void Insert(std::string_view segment, const int32_t* ids, size_t count);
+
+  Stats GetStats() const;
+
+  // 64-bit FNV-1a, the key hash.
+  static uint64_t Hash(std::string_view text);
+
+ private:
+  struct Entry {
+    uint64_t hash;
+    std::string text;
+    std::vector<int32_t> ids;
+
+    size_t Bytes() const { return text.size() + ids.size() * sizeof(int32_t); }
+  };
+
+  struct alignas(64) Slot {
+    std::atomic<Entry*> entry{nullptr};
+    std::atomic<uint32_t> readers{0};
+    std::atomic<bool> referenced{false};
+  };
+
+  // Slots probed for a hash, starting at its home slot.
+  static constexpr size_t kProbeLength = 8;
+
+  // Unlinks and frees the entry of `slot`. Caller holds write_mutex_.
+  void Evict(Slot& slot);
+  void PublishSizes();
+
+  Config config_;
+  size_t max_entry_bytes_;
+  size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+
+  std::mutex write_mutex_;
+  size_t hand_ = 0;
+  size_t resident_bytes_ = 0;
+  size_t entries_ = 0;
+
+  mutable std::atomic<uint64_t> hits_{0};
+  mutable std::atomic<uint64_t> misses_{0};
+  mutable std::atomic<uint64_t> bytes_saved_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<uint64_t> resident_bytes_stat_{0};
+  std::atomic<uint64_t> entries_stat_{0};
+};
+
+}  // namespace tensorrtllm
@@ -0,0 +1,63 @@
+#include <filesystem>
+#include <fstream>
+
+#include "bpe_tokenizer.h"
+#include "nlohmann/json.hpp"
+#include "sentencepiece_tokenizer.h"
+#include "tokenizer.h"
+#include "trantor/utils/Logger.h"
+
+namespace tensorrtllm {
+
+namespace {
+
+nlohmann::json ReadJson(const std::filesystem::path& path) {
+  std::ifstream file(path);
+  return nlohmann::json::parse(file, nullptr, /*allow_exceptions=*/false);
+}
+
+// Added tokens of a SentencePiece model as Hugging Face records them, from
+// tokenizer.json, tokenizer_config.json or added_tokens.json, whichever is
+// found first.
+std::vector<AddedToken> LoadAddedTokens(const std::filesystem::path& dir) {
+  std::vector<AddedToken> tokens;
+  if (auto root = ReadJson(dir / "tokenizer.json"); root.is_object() && root.contains("added_tokens")) {
+    for (auto const& token : root["added_tokens"]) {
+      tokens.push_back({token.value("content", ""), token.value("id", -1), token.value("special", false)});
+    }
+  } else if (auto config = ReadJson(dir / "tokenizer_config.json");
+             config.is_object() && config.contains("added_tokens_decoder")) {
+    for (auto const& [id, token] : config["added_tokens_decoder"].items()) {
+      tokens.push_back({token.value("content", ""), std::stoi(id), token.value("special", false)});
+    }
+  } else if (auto added = ReadJson(dir / "added_tokens.json"); added.is_object()) {
+    for (auto const& [content, id] : added.items()) {
+      tokens.push_back({content, id.get<int32_t>(), true});
+    }
+  }
+  return tokens;
+}
+
+}  // namespace
+
+std::unique_ptr<Tokenizer> LoadTokenizer(const std::string& model_dir) {
+  std::filesystem::path dir = model_dir;
+  std::filesystem::path sentencepiece_model = dir / "tokenizer.model";
+  std::filesystem::path tokenizer_json = dir / "tokenizer.json";
+
+  if (!std::filesystem::exists(sentencepiece_model) && std::filesystem::exists(tokenizer_json)) {
+    auto tokenizer = std::make_unique<BpeTokenizer>(tokenizer_json.string());
+    LOG_INFO << "Loaded tokenizer from " << tokenizer_json.string() << ", vocab size "
+             << tokenizer->VocabSize();
+    return tokenizer;
+  }
+
+  auto added_tokens = LoadAddedTokens(dir);
+  size_t const added_count = added_tokens.size();
+  auto tokenizer = std::make_unique<SentencePieceTokenizer>(sentencepiece_model.string(), std::move(added_tokens));
+  LOG_INFO << "Loaded tokenizer from " << sentencepiece_model.string() << " with " << added_count
+           << " added tokens";
+  return tokenizer;
+}
+
+}  // namespace tensorrtllm
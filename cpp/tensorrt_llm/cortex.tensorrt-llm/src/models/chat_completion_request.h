@@ -1,4 +1,6 @@
 #pragma once
+#include <string>
+
 #include "json/value.h"
 
 namespace tensorrtllm::inferences {
@@ -11,6 +13,11 @@ struct ChatCompletionRequest {
   float presence_penalty = 0;
   Json::Value messages = Json::Value(Json::arrayValue);
   Json::Value stop = Json::Value(Json::arrayValue);
+  std::string truncation;  // empty: the model's default policy
+  // Strings no generated token may start, and whole token classes to ban
+  // ("special", "whitespace", "digits")
+  Json::Value bad_words = Json::Value(Json::arrayValue);
+  Json::Value ban_token_classes = Json::Value(Json::arrayValue);
 };
 
 inline ChatCompletionRequest fromJson(std::shared_ptr<Json::Value> json_body) {
@@ -24,6 +31,9 @@ inline ChatCompletionRequest fromJson(std::shared_ptr<Json::Value> json_body) {
     request.presence_penalty  = json_body->get("presence_penalty", 0).asFloat();
     request.messages          = json_body->operator[]("messages");
     request.stop              = json_body->operator[]("stop");
+    request.truncation        = json_body->get("truncation", "").asString();
+    request.bad_words         = json_body->get("bad_words", Json::Value(Json::arrayValue));
+    request.ban_token_classes = json_body->get("ban_token_classes", Json::Value(Json::arrayValue));
   }
   return request;
 }
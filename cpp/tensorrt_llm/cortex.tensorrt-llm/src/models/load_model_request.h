@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string>
 
 #include "json/value.h"
@@ -11,6 +12,19 @@ struct LoadModelRequest {
     std::string user_prompt = "<|im_end|>\n<|im_start|>user\n";
     std::string ai_prompt = "<|im_end|>\n<|im_start|>user\n";
     std::string system_prompt = "<|im_end|>\n<|im_start|>user\n";
+    bool request_coalescing = false;
+    float coalesce_max_temperature = 0.01f;
+    int64_t response_cache_ttl_ms = 5000;
+    int response_cache_max_entries = 128;
+    int tokenizer_cache_mb = 0;
+    // Process wide, an engine loaded while another one is live must use the
+    // same pinned_pool_idle_ms, host_huge_pages and numa_node
+    int64_t pinned_pool_idle_ms = 0;
+    bool host_huge_pages = false;
+    int numa_node = -1;
+    // read, mmap or direct, empty for TLLM_ENGINE_LOAD_MODE
+    std::string engine_load_mode;
+    std::string truncation = "none";
 };
 
 inline LoadModelRequest fromJson(std::shared_ptr<Json::Value> json_body) {
@@ -22,6 +36,16 @@ inline LoadModelRequest fromJson(std::shared_ptr<Json::Value> json_body) {
     request.user_prompt   = json_body->get("user_prompt", "<|im_end|>\n<|im_start|>user\n").asString();
     request.ai_prompt     = json_body->get("ai_prompt", "<|im_end|>\n<|im_start|>assistant\n").asString();
     request.system_prompt = json_body->get("system_prompt", "<|im_start|>system\n").asString();
+    request.request_coalescing          = json_body->get("request_coalescing", false).asBool();
+    request.coalesce_max_temperature    = json_body->get("coalesce_max_temperature", 0.01f).asFloat();
+    request.response_cache_ttl_ms       = json_body->get("response_cache_ttl_ms", 5000).asInt64();
+    request.response_cache_max_entries  = json_body->get("response_cache_max_entries", 128).asInt();
+    request.tokenizer_cache_mb          = json_body->get("tokenizer_cache_mb", 0).asInt();
+    request.truncation                  = json_body->get("truncation", "none").asString();
+    request.pinned_pool_idle_ms         = json_body->get("pinned_pool_idle_ms", 0).asInt64();
+    request.host_huge_pages             = json_body->get("host_huge_pages", false).asBool();
+    request.numa_node                   = json_body->get("numa_node", -1).asInt();
+    request.engine_load_mode            = json_body->get("engine_load_mode", "").asString();
   } 
   return request;
 }
@@ -0,0 +1,55 @@
+#include "piece_table.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace tensorrtllm {
+
+void PieceTable::Reserve(size_t count, size_t bytes) {
+  arena_.reserve(bytes);
+  offsets_.reserve(count + 1);
+  flags_.reserve(count);
+}
+
+void PieceTable::Add(std::string_view bytes, uint8_t flags) {
+  if (arena_.size() + bytes.size() > UINT32_MAX) {
+    throw std::length_error("Token piece table exceeds 4 GiB");
+  }
+  arena_.append(bytes.data(), bytes.size());
+  offsets_.push_back(static_cast<uint32_t>(arena_.size()));
+  flags_.push_back(flags);
+}
+
+void PieceTable::DecodeAppend(const int32_t* ids, size_t count, bool strip_leading_space,
+                              std::string& text) const {
+  size_t const n = flags_.size();
+  size_t total = 0;
+  for (size_t i = 0; i < count; ++i) {
+    auto const id = static_cast<uint32_t>(ids[i]);  // negative ids wrap past n
+    if (id < n && !(flags_[id] & kSkipOnDecode)) {
+      total += offsets_[id + 1] - offsets_[id];
+    }
+  }
+
+  size_t pos = text.size();
+  text.resize(pos + total);
+  char* out = text.data();
+  bool first = true;
+  for (size_t i = 0; i < count; ++i) {
+    auto const id = static_cast<uint32_t>(ids[i]);
+    if (id >= n || (flags_[id] & kSkipOnDecode)) {
+      continue;
+    }
+    uint32_t begin = offsets_[id];
+    uint32_t const end = offsets_[id + 1];
+    if (first && strip_leading_space && (flags_[id] & kWordStart) && begin < end && arena_[begin] == ' ') {
+      ++begin;
+    }
+    first = false;
+    std::memcpy(out + pos, arena_.data() + begin, end - begin);
+    pos += end - begin;
+  }
+  text.resize(pos);
+}
+
+}  // namespace tensorrtllm
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tensorrtllm {
+
+// Final decoded bytes of every token id, built once when a tokenizer loads.
+// All pieces live back to back in one arena and are addressed by an offset
+// array, so looking up a token is two loads and decoding a run of ids is a
+// size pass followed by memcpys into the output.
+class PieceTable {
+ public:
+  enum Flags : uint8_t {
+    kNone = 0,
+    // Control/special tokens: kept in the table (stop strings need their
+    // text) but left out of DecodeAppend.
+    kSkipOnDecode = 1 << 0,
+    // Normal piece whose leading space comes from a word-boundary marker.
+    kWordStart = 1 << 1,
+  };
+
+  void Reserve(size_t count, size_t bytes);
+
+  // Appends the piece for the next id. Ids are dense: the n-th call sets id n.
+  void Add(std::string_view bytes, uint8_t flags = kNone);
+
+  size_t Size() const { return flags_.size(); }
+
+  bool Contains(int32_t id) const { return id >= 0 && static_cast<size_t>(id) < flags_.size(); }
+
+  // Empty for ids outside the table.
+  std::string_view Piece(int32_t id) const {
+    if (!Contains(id)) {
+      return {};
+    }
+    return std::string_view(arena_.data() + offsets_[id], offsets_[id + 1] - offsets_[id]);
+  }
+
+  uint8_t GetFlags(int32_t id) const { return Contains(id) ? flags_[id] : static_cast<uint8_t>(kNone); }
+
+  // Appends the pieces of ids[0, count) to `text`, skipping kSkipOnDecode and
+  // out-of-range ids. With `strip_leading_space`, a leading space on the first
+  // piece appended is dropped if that piece is kWordStart, undoing the dummy
+  // prefix SentencePiece adds while encoding.
+  void DecodeAppend(const int32_t* ids, size_t count, bool strip_leading_space, std::string& text) const;
+
+ private:
+  std::string arena_;
+  std::vector<uint32_t> offsets_{0};
+  std::vector<uint8_t> flags_;
+};
+
+}  // namespace tensorrtllm
@@ -0,0 +1,247 @@
+#include "request_coalescer.h"
+
+#include <algorithm>
+
+#include "json/writer.h"
+#include "models/chat_completion_request.h"
+
+namespace tensorrtllm {
+
+namespace {
+uint64_t Fnv1a64(const std::string& s) {
+  uint64_t h = 14695981039346656037ull;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+// Bans are sets, so their order and repeats do not change the output.
+Json::Value SortedStrings(const Json::Value& values) {
+  std::vector<std::string> strings;
+  for (auto const& value : values) {
+    strings.push_back(value.isConvertibleTo(Json::stringValue)
+                          ? value.asString()
+                          : value.toStyledString());
+  }
+  std::sort(strings.begin(), strings.end());
+  strings.erase(std::unique(strings.begin(), strings.end()), strings.end());
+  Json::Value sorted(Json::arrayValue);
+  for (auto& string : strings) {
+    sorted.append(std::move(string));
+  }
+  return sorted;
+}
+}  // namespace
+
+std::optional<RequestCoalescer::Key> RequestCoalescer::MakeKey(
+    const Json::Value& json_body) const {
+  auto request =
+      inferences::fromJson(std::make_shared<Json::Value>(json_body));
+  if (request.temperature > config_.max_temperature) {
+    return std::nullopt;
+  }
+
+  // Only fields that influence the generated tokens are part of the key.
+  // Json::Value objects are ordered maps, so the compact writer output is
+  // canonical.
+  Json::Value normalized;
+  normalized["model"] = json_body.get("model", "").asString();
+  normalized["max_tokens"] = request.max_tokens;
+  normalized["stream"] = request.stream;
+  normalized["truncation"] = request.truncation;
+  normalized["bad_words"] = SortedStrings(request.bad_words);
+  normalized["ban_token_classes"] = SortedStrings(request.ban_token_classes);
+  normalized["top_p"] = request.top_p;
+  normalized["frequency_penalty"] = request.frequency_penalty;
+  normalized["presence_penalty"] = request.presence_penalty;
+  normalized["stop"] = request.stop;
+  Json::Value messages(Json::arrayValue);
+  for (auto const& message : request.messages) {
+    Json::Value m;
+    m["role"] = message["role"].asString();
+    m["content"] = message["content"].asString();
+    messages.append(std::move(m));
+  }
+  normalized["messages"] = std::move(messages);
+
+  Json::StreamWriterBuilder writer;
+  writer["indentation"] = "";
+  Key key;
+  key.normalized = Json::writeString(writer, normalized);
+  key.hash = Fnv1a64(key.normalized);
+  return key;
+}
+
+void RequestCoalescer::Replay(const std::vector<Chunk>& chunks,
+                              Callback& callback) {
+  for (auto const& [status, res] : chunks) {
+    Json::Value s = status;
+    Json::Value r = res;
+    callback(std::move(s), std::move(r));
+  }
+}
+
+RequestCoalescer::Admission RequestCoalescer::Admit(const Key& key,
+                                                    Callback& callback) {
+  eligible_.fetch_add(1, std::memory_order_relaxed);
+  std::shared_ptr<Flight> flight;
+  std::shared_ptr<const std::vector<Chunk>> cached;
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+    auto now = Clock::now();
+    EvictExpiredLocked(now);
+    auto cached_it = completed_.find(key.hash);
+    auto flight_it = in_flight_.find(key.hash);
+    if (cached_it != completed_.end() &&
+        cached_it->second.normalized == key.normalized) {
+      cached = cached_it->second.chunks;
+    } else if (flight_it != in_flight_.end() &&
+               flight_it->second->normalized == key.normalized) {
+      flight = flight_it->second;
+    } else {
+      // A hash collision with a different in-flight request runs on its own
+      // and is not registered.
+      if (flight_it == in_flight_.end()) {
+        auto f = std::make_shared<Flight>();
+        f->normalized = key.normalized;
+        in_flight_.emplace(key.hash, std::move(f));
+      }
+      leaders_.fetch_add(1, std::memory_order_relaxed);
+      return Admission::kLeader;
+    }
+  }
+
+  if (cached) {
+    cache_hits_.fetch_add(1, std::memory_order_relaxed);
+    Replay(*cached, callback);
+    return Admission::kCacheHit;
+  }
+
+  coalesced_.fetch_add(1, std::memory_order_relaxed);
+  std::vector<Chunk> chunks;
+  std::shared_ptr<Subscriber> subscriber;
+  std::unique_lock<std::mutex> subscriber_lock;
+  {
+    std::lock_guard<std::mutex> l(flight->mtx);
+    chunks = flight->chunks;
+    if (!flight->done) {
+      // Locked before it is published, so the leader cannot deliver a live
+      // chunk ahead of the replay.
+      subscriber = std::make_shared<Subscriber>();
+      subscriber_lock = std::unique_lock<std::mutex>(subscriber->mtx);
+      flight->subscribers.push_back(subscriber);
+    }
+  }
+  Replay(chunks, callback);
+  if (subscriber) {
+    subscriber->callback = std::move(callback);
+  }
+  return Admission::kCoalesced;
+}
+
+RequestCoalescer::Callback RequestCoalescer::Publish(const Key& key,
+                                                     Callback&& leader) {
+  std::shared_ptr<Flight> flight;
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+    if (auto it = in_flight_.find(key.hash);
+        it != in_flight_.end() && it->second->normalized == key.normalized) {
+      flight = it->second;
+    }
+  }
+  if (!flight) {
+    // Not registered (hash collision): nothing to fan out to.
+    return std::move(leader);
+  }
+
+  return [this, key, flight, leader = std::move(leader)](
+             Json::Value&& status, Json::Value&& res) mutable {
+    bool done = status["is_done"].asBool() || status["has_error"].asBool();
+    std::vector<std::shared_ptr<Subscriber>> subscribers;
+    {
+      std::lock_guard<std::mutex> l(flight->mtx);
+      flight->chunks.emplace_back(status, res);
+      if (done) {
+        flight->done = true;
+        flight->failed = status["has_error"].asBool();
+        subscribers.swap(flight->subscribers);
+      } else {
+        subscribers = flight->subscribers;
+      }
+    }
+    // A slow or re-entrant follower must not hold up the flight.
+    for (auto const& subscriber : subscribers) {
+      std::lock_guard<std::mutex> l(subscriber->mtx);
+      Json::Value s = status;
+      Json::Value r = res;
+      subscriber->callback(std::move(s), std::move(r));
+    }
+    leader(std::move(status), std::move(res));
+    if (done) {
+      Finish(key, flight);
+    }
+  };
+}
+
+void RequestCoalescer::Finish(const Key& key,
+                              const std::shared_ptr<Flight>& flight) {
+  std::lock_guard<std::mutex> l(mtx_);
+  if (auto it = in_flight_.find(key.hash);
+      it != in_flight_.end() && it->second == flight) {
+    in_flight_.erase(it);
+  }
+  // `flight` is done, so its chunks are no longer modified.
+  if (flight->failed || config_.cache_ttl_ms <= 0 ||
+      config_.cache_max_entries == 0) {
+    return;
+  }
+  CachedResponse entry;
+  entry.normalized = flight->normalized;
+  entry.chunks = std::make_shared<const std::vector<Chunk>>(flight->chunks);
+  entry.expires_at =
+      Clock::now() + std::chrono::milliseconds(config_.cache_ttl_ms);
+  if (completed_.insert_or_assign(key.hash, std::move(entry)).second) {
+    completed_order_.push_back(key.hash);
+  }
+  while (completed_.size() > config_.cache_max_entries &&
+         !completed_order_.empty()) {
+    completed_.erase(completed_order_.front());
+    completed_order_.pop_front();
+  }
+}
+
+void RequestCoalescer::EvictExpiredLocked(Clock::time_point now) {
+  while (!completed_order_.empty()) {
+    auto it = completed_.find(completed_order_.front());
+    if (it != completed_.end() && it->second.expires_at > now) {
+      break;
+    }
+    if (it != completed_.end()) {
+      completed_.erase(it);
+    }
+    completed_order_.pop_front();
+  }
+}
+
+Json::Value RequestCoalescer::Metrics() const {
+  Json::Value metrics;
+  auto eligible = eligible_.load(std::memory_order_relaxed);
+  auto hits = cache_hits_.load(std::memory_order_relaxed);
+  auto coalesced = coalesced_.load(std::memory_order_relaxed);
+  metrics["eligible_requests"] = Json::UInt64(eligible);
+  metrics["generations"] = Json::UInt64(leaders_.load(std::memory_order_relaxed));
+  metrics["coalesced"] = Json::UInt64(coalesced);
+  metrics["cache_hits"] = Json::UInt64(hits);
+  metrics["cache_hit_rate"] =
+      eligible == 0 ? 0.0 : static_cast<double>(hits) / eligible;
+  metrics["dedup_rate"] =
+      eligible == 0 ? 0.0 : static_cast<double>(hits + coalesced) / eligible;
+  std::lock_guard<std::mutex> l(mtx_);
+  metrics["in_flight"] = Json::UInt64(in_flight_.size());
+  metrics["cached_responses"] = Json::UInt64(completed_.size());
+  return metrics;
+}
+
+}  // namespace tensorrtllm
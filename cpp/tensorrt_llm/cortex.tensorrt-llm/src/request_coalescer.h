@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "json/value.h"
+
+namespace tensorrtllm {
+
+// Deduplicates identical deterministic chat completion requests.
+//
+// A request is eligible when its temperature is at or below
+// `max_temperature`. Eligible requests are normalized (messages and sampling
+// parameters and whether it streams) and hashed:
+//  * if an identical request is generating, the new one attaches as an extra
+//    subscriber and receives the same chunk stream (chunks produced before it
+//    attached are replayed first),
+//  * if an identical request finished less than `cache_ttl_ms` ago, its chunks
+//    are replayed from the completed-response cache without touching the GPU,
+//  * otherwise the caller becomes the leader and drives the generation through
+//    the callback returned by `Publish`.
+class RequestCoalescer {
+ public:
+  using Callback = std::function<void(Json::Value&&, Json::Value&&)>;
+
+  struct Config {
+    float max_temperature = 0.01f;
+    int64_t cache_ttl_ms = 5000;
+    size_t cache_max_entries = 128;
+  };
+
+  enum class Admission {
+    kLeader,     // caller must run the generation
+    kCoalesced,  // attached to an in-flight generation
+    kCacheHit,   // served from the completed-response cache
+  };
+
+  struct Key {
+    uint64_t hash;
+    std::string normalized;
+  };
+
+  explicit RequestCoalescer(Config config) : config_(config) {}
+
+  // Returns the dedup key of a request, or nullopt if it is not eligible.
+  std::optional<Key> MakeKey(const Json::Value& json_body) const;
+
+  // On kCoalesced/kCacheHit `callback` has been consumed and the request is
+  // fully handled. On kLeader `callback` is left untouched.
+  Admission Admit(const Key& key, Callback& callback);
+
+  // Wraps the leader callback so that every chunk is fanned out to the
+  // subscribers and recorded for the completed-response cache.
+  Callback Publish(const Key& key, Callback&& leader);
+
+  Json::Value Metrics() const;
+
+ private:
+  using Chunk = std::pair<Json::Value, Json::Value>;
+  using Clock = std::chrono::steady_clock;
+
+  // A follower's callback runs outside Flight::mtx, under its own mutex, so
+  // the replay of earlier chunks and the live chunks reach it in order.
+  struct Subscriber {
+    std::mutex mtx;
+    Callback callback;
+  };
+
+  struct Flight {
+    std::string normalized;
+    std::mutex mtx;
+    std::vector<Chunk> chunks;
+    std::vector<std::shared_ptr<Subscriber>> subscribers;
+    bool done = false;
+    bool failed = false;
+  };
+
+  struct CachedResponse {
+    std::string normalized;
+    std::shared_ptr<const std::vector<Chunk>> chunks;
+    Clock::time_point expires_at;
+  };
+
+  static void Replay(const std::vector<Chunk>& chunks, Callback& callback);
+  void Finish(const Key& key, const std::shared_ptr<Flight>& flight);
+  void EvictExpiredLocked(Clock::time_point now);
+
+  Config config_;
+  mutable std::mutex mtx_;
+  std::unordered_map<uint64_t, std::shared_ptr<Flight>> in_flight_;
+  std::unordered_map<uint64_t, CachedResponse> completed_;
+  std::deque<uint64_t> completed_order_;
+
+  std::atomic<uint64_t> eligible_{0};
+  std::atomic<uint64_t> leaders_{0};
+  std::atomic<uint64_t> coalesced_{0};
+  std::atomic<uint64_t> cache_hits_{0};
+};
+
+}  // namespace tensorrtllm
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sentencepiece_processor.h"
+#include "tokenizer.h"
+#include "trantor/utils/Logger.h"
+
+namespace tensorrtllm {
+
+class SentencePieceTokenizer : public Tokenizer {
+ private:
+  // SentencePiece's default rendering of the unknown token.
+  static constexpr const char* kUnknownSurface = " \xE2\x81\x87 ";
+
+  sentencepiece::SentencePieceProcessor processor;
+  bool strip_leading_space = false;
+
+  void ReplaceSubstring(std::string& base, const std::string& from, const std::string& to) {
+    size_t start_pos = 0;
+    while ((start_pos = base.find(from, start_pos)) != std::string::npos) {
+        base.replace(start_pos, from.length(), to);
+        start_pos += to.length();
+    }
+  }
+
+  // Renders every piece the way DecodeIds would: "▁" becomes a space,
+  // <0xNN> byte-fallback pieces become the byte, control pieces are kept but
+  // skipped when decoding.
+  void BuildPieceTable() {
+    int const size = processor.GetPieceSize();
+    pieces_.Reserve(size, size * 8);
+    int word_start_id = -1;
+    for (int id = 0; id < size; ++id) {
+      std::string piece = processor.IdToPiece(id);
+      if (processor.IsControl(id)) {
+        pieces_.Add(piece, PieceTable::kSkipOnDecode);
+      } else if (processor.IsUnknown(id)) {
+        pieces_.Add(kUnknownSurface);
+      } else if (processor.IsByte(id)) {
+        // "<0xNN>"
+        pieces_.Add(std::string(1, static_cast<char>(std::stoi(piece.substr(3, 2), nullptr, 16))));
+      } else {
+        bool const word_start = piece.rfind("▁", 0) == 0;
+        if (word_start && word_start_id < 0 && piece.size() > std::strlen("▁")) {
+          word_start_id = id;
+        }
+        ReplaceSubstring(piece, "▁", " ");
+        pieces_.Add(piece, word_start ? PieceTable::kWordStart : PieceTable::kNone);
+      }
+    }
+    // Models encoding with a dummy prefix drop the leading space of the first
+    // piece on decode; ask the processor rather than parsing its normalizer.
+    if (word_start_id >= 0) {
+      strip_leading_space = processor.DecodeIds({word_start_id}) != pieces_.Piece(word_start_id);
+    }
+  }
+
+  // Added tokens past the SentencePiece vocabulary (ChatML markers added by
+  // fine-tunes) extend the piece table; gaps stay empty.
+  void AddTokens(std::vector<AddedToken> tokens) {
+    std::sort(tokens.begin(), tokens.end(), [](const AddedToken& a, const AddedToken& b) { return a.id < b.id; });
+    for (auto const& token : tokens) {
+      if (token.id < static_cast<int32_t>(pieces_.Size())) {
+        continue;
+      }
+      while (static_cast<int32_t>(pieces_.Size()) < token.id) {
+        pieces_.Add({});
+      }
+      pieces_.Add(token.content, token.special ? PieceTable::kSkipOnDecode : PieceTable::kNone);
+    }
+    added_tokens_.Build(std::move(tokens));
+  }
+
+ public:
+  // `added_tokens` come from the Hugging Face files next to the model, see
+  // LoadTokenizer.
+  SentencePieceTokenizer(const std::string& model_path, std::vector<AddedToken> added_tokens = {}) {
+    auto status = processor.Load(model_path);
+    if (!status.ok()) {
+      std::cerr << status.ToString() << std::endl;
+    }
+    BuildPieceTable();
+    AddTokens(std::move(added_tokens));
+    eos_id_ = processor.eos_id();
+    LOG_INFO << "Successully loaded the tokenizer";
+  }
+
+  void DecodeAppend(const int32_t* ids, size_t count, std::string& text) const override {
+    pieces_.DecodeAppend(ids, count, strip_leading_space, text);
+  }
+
+ protected:
+  void EncodeSegment(std::string_view text, std::vector<int32_t>& ids) const override {
+    if (text.empty()) {
+      return;
+    }
+    thread_local std::vector<int> scratch;
+    processor.Encode(std::string(text), &scratch);
+    ids.insert(ids.end(), scratch.begin(), scratch.end());
+  }
+};
+
+}  // namespace tensorrtllm
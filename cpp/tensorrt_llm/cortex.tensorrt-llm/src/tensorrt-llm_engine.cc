@@ -3,9 +3,11 @@
 #include "nlohmann/json.hpp"
 
 #include "src/models/load_model_request.h"
+#include "tensorrt_llm/runtime/allocationAudit.h"
 #include "tensorrt_llm/runtime/generationInput.h"
 #include "tensorrt_llm/runtime/generationOutput.h"
 #include "tensorrt_llm/runtime/samplingConfig.h"
+#include "utf8_json.h"
 #include "utils/tensorrt-llm_utils.h"
 #include "json/writer.h"
 #include <algorithm>
@@ -27,38 +29,87 @@ constexpr const int k400BadRequest = 400;
 constexpr const int k409Conflict = 409;
 constexpr const int k500InternalServerError = 500;
 
-TensorrtllmEngine::~TensorrtllmEngine() {}
+namespace {
+// The host memory policy and the pinned pool idle timeout are process wide,
+// so engines loaded at the same time, as during a hot reload, must agree on
+// them. The first engine sets them, the others are checked against them.
+struct HostMemorySettings {
+  std::mutex mtx;
+  int live_engines = 0;
+  HostMemoryPolicy policy;
+  int64_t pinned_pool_idle_ms = 0;
+};
 
-void RemoveId(std::vector<int>& vec, int id) {
-  vec.erase(std::remove(vec.begin(), vec.end(), id), vec.end());
+HostMemorySettings& GetHostMemorySettings() {
+  static HostMemorySettings settings;
+  return settings;
 }
 
-bool HandleMatch(std::string const& rew_text, std::shared_ptr<InferenceState> infer_state) {
-  if (infer_state->IsComplete()) {
+// Returns false if another live engine uses different settings
+bool AcquireHostMemorySettings(const HostMemoryPolicy& policy, int64_t pinned_pool_idle_ms) {
+  auto& settings = GetHostMemorySettings();
+  std::lock_guard<std::mutex> lock(settings.mtx);
+  if (settings.live_engines == 0) {
+    BufferManager::setHostMemoryPolicy(policy);
+    BufferManager::pinnedPoolSetIdleTimeout(std::chrono::milliseconds{pinned_pool_idle_ms});
+    settings.policy = policy;
+    settings.pinned_pool_idle_ms = pinned_pool_idle_ms;
+  } else if (policy.hugePages != settings.policy.hugePages || policy.numaNode != settings.policy.numaNode
+             || pinned_pool_idle_ms != settings.pinned_pool_idle_ms) {
     return false;
   }
-  if (infer_state->stop_word_match_len == 0) {
-    if (rew_text.find('<') != std::string::npos) { // Found "<" anywhere in the text
-      infer_state->stop_word_match_len++; // Move to next state
-      infer_state->prev_text = rew_text;
-      return true;
-    }
+  ++settings.live_engines;
+  return true;
+}
+
+void ReleaseHostMemorySettings() {
+  auto& settings = GetHostMemorySettings();
+  std::lock_guard<std::mutex> lock(settings.mtx);
+  --settings.live_engines;
+}
+}  // namespace
+
+TensorrtllmEngine::~TensorrtllmEngine() {
+  // An engine replaced by a hot reload is destroyed once its last stream is
+  // done, the inference thread may still be returning from generate()
+  {
+    std::unique_lock<std::mutex> lock(active_inferences_mtx_);
+    active_inferences_cv_.wait(lock, [this]() { return active_inferences_ == 0; });
   }
-  else if (rew_text == infer_state->sequence[infer_state->stop_word_match_len]) {
-    infer_state->stop_word_match_len++; // Move to next state
-    infer_state->prev_text = rew_text;
-    return true;
+  StopPinnedPoolTrimmer();
+  if (holds_host_memory_settings_) {
+    ReleaseHostMemorySettings();
   }
-  else if (infer_state->stop_word_match_len > 0 && rew_text == infer_state->sequence[0]) {
-    infer_state->stop_word_match_len = 1; // Restart from first match if sequence breaks but matches start
-    infer_state->prev_text = rew_text;
-    return true;
+}
+
+void TensorrtllmEngine::StartPinnedPoolTrimmer(std::chrono::milliseconds interval) {
+  StopPinnedPoolTrimmer();
+  pinned_pool_trimmer_stop_ = false;
+  pinned_pool_trimmer_ = std::thread([this, interval]() {
+    std::unique_lock<std::mutex> lock(pinned_pool_trimmer_mtx_);
+    while (!pinned_pool_trimmer_cv_.wait_for(lock, interval, [this]() { return pinned_pool_trimmer_stop_; })) {
+      auto const released = BufferManager::pinnedPoolTrimIdle();
+      if (released > 0) {
+        LOG_DEBUG << "Released " << released << " bytes of idle pinned memory";
+      }
+    }
+  });
+}
+
+void TensorrtllmEngine::StopPinnedPoolTrimmer() {
+  if (!pinned_pool_trimmer_.joinable()) {
+    return;
   }
-  else {
-    infer_state->Reset();
-    return false; // Reset to start if sequence breaks
+  {
+    std::lock_guard<std::mutex> lock(pinned_pool_trimmer_mtx_);
+    pinned_pool_trimmer_stop_ = true;
   }
-  return false;
+  pinned_pool_trimmer_cv_.notify_all();
+  pinned_pool_trimmer_.join();
+}
+
+void RemoveId(std::vector<int>& vec, int id) {
+  vec.erase(std::remove(vec.begin(), vec.end(), id), vec.end());
 }
 
 GenerationInput::TensorPtr TensorrtllmEngine::GetTensorSingleStopWordList(int stopToken) {
@@ -66,30 +117,70 @@ GenerationInput::TensorPtr TensorrtllmEngine::GetTensorSingleStopWordList(int st
   return gpt_session->getBufferManager().copyFrom(stop_words_tokens, ITensor::makeShape({1, 2, 2}), MemoryType::kGPU);
 }
 
-GenerationInput::TensorPtr TensorrtllmEngine::GetTensorChatMLStopWordList() {
-  std::vector<int32_t> stop_words_tokens
-    = {321, 28730, 416, 2, 32000, 3, 4, 5, -1, -1}; // Extend with -1 for increased length
-  return gpt_session->getBufferManager().copyFrom(stop_words_tokens, ITensor::makeShape({1, 2, 5}), MemoryType::kGPU);
+GenerationInput::TensorPtr TensorrtllmEngine::GetTensorStopWordList(const BufferArena::SharedPtr& arena,
+                                                                    CopyBatch& copy_batch) {
+  // One single-token stop word per id
+  WordList stop_words;
+  for (auto id : stop_token_ids) {
+    stop_words.AddWord(&id, 1);
+  }
+  return GetTensorWordList(stop_words, arena, copy_batch);
+}
+
+GenerationInput::TensorPtr TensorrtllmEngine::GetTensorWordList(const WordList& words,
+                                                                const BufferArena::SharedPtr& arena,
+                                                                CopyBatch& copy_batch) {
+  auto const length = static_cast<SizeType>(words.Length());
+  GenerationInput::TensorPtr tensor
+      = BufferManager::allocate(arena, ITensor::makeShape({1, 2, length}), nvinfer1::DataType::kINT32);
+  copy_batch.add(words.Pack(), *tensor);
+  return tensor;
+}
+
+BufferArena::SharedPtr TensorrtllmEngine::CreateRequestArena(int inputLen, const WordList& badWords) {
+  auto const aligned = [](size_t count) {
+    auto const bytes = count * sizeof(int32_t);
+    return (bytes + BufferArena::kAlignment - 1) / BufferArena::kAlignment * BufferArena::kAlignment;
+  };
+  // Input ids and lengths, stop and bad words, then the output ids and
+  // lengths the session reshapes to [batch, beam, max sequence length]
+  size_t const max_seq_len = session_config.maxSequenceLength;
+  size_t const bytes = aligned(batchSize * inputLen) + aligned(batchSize) + aligned(2 * stop_token_ids.size())
+                       + aligned(2 * badWords.Length()) + aligned(batchSize * max_seq_len) + aligned(batchSize);
+  return gpt_session->getBufferManager().createArena(MemoryType::kGPU, bytes);
 }
 
-GenerationInput TensorrtllmEngine::CreateGenerationInput(std::vector<int32_t> input_ids_host) {
+GenerationInput TensorrtllmEngine::CreateGenerationInput(std::vector<int32_t> input_ids_host, int maxNewTokens,
+                                                         const WordList& badWords,
+                                                         const BufferArena::SharedPtr& arena) {
   int input_len = input_ids_host.size();
   std::vector<int32_t> input_lengths_host(batchSize, input_len);
+  // All host data of the request goes to the device with one transfer
+  auto copy_batch = gpt_session->getBufferManager().createCopyBatch();
   GenerationInput::TensorPtr input_lengths
-      = gpt_session->getBufferManager().copyFrom(input_lengths_host, ITensor::makeShape({batchSize}), MemoryType::kGPU);
-  GenerationInput::TensorPtr input_ids = gpt_session->getBufferManager().copyFrom(
-      input_ids_host, ITensor::makeShape({batchSize, input_len}), MemoryType::kGPU);
+      = BufferManager::allocate(arena, ITensor::makeShape({batchSize}), nvinfer1::DataType::kINT32);
+  copy_batch->add(std::move(input_lengths_host), *input_lengths);
+  GenerationInput::TensorPtr input_ids
+      = BufferManager::allocate(arena, ITensor::makeShape({batchSize, input_len}), nvinfer1::DataType::kINT32);
+  copy_batch->add(std::move(input_ids_host), *input_ids);
   GenerationInput generation_input{0, 0, input_ids, input_lengths, model_config->usePackedInput()};
-  generation_input.stopWordsList = GetTensorChatMLStopWordList();
+  generation_input.maxNewTokens = maxNewTokens;
+  if (!stop_token_ids.empty()) {
+    generation_input.stopWordsList = GetTensorStopWordList(arena, *copy_batch);
+  }
+  if (!badWords.Empty()) {
+    generation_input.badWordsList = GetTensorWordList(badWords, arena, *copy_batch);
+  }
+  copy_batch->execute();
 
   LOG_INFO << "Create generation input successfully";
   return generation_input;
 }
 
-GenerationOutput TensorrtllmEngine::CreateGenerationOutput() {
+GenerationOutput TensorrtllmEngine::CreateGenerationOutput(const BufferArena::SharedPtr& arena) {
   GenerationOutput generation_output {
-    gpt_session->getBufferManager().emptyTensor(MemoryType::kGPU, nvinfer1::DataType::kINT32),
-    gpt_session->getBufferManager().emptyTensor(MemoryType::kGPU, nvinfer1::DataType::kINT32)
+    BufferManager::emptyTensor(arena, nvinfer1::DataType::kINT32),
+    BufferManager::emptyTensor(arena, nvinfer1::DataType::kINT32)
   };
   LOG_INFO << "Create generation input successfully";
   return generation_output;
@@ -102,12 +193,17 @@ void InferenceThread(
     TensorrtllmEngine* self,
     SamplingConfig sampling_config,
     int input_len,
-    int outputLen) {
+    int outputLen,
+    WordList bad_words) {
 
   // Input preparation
   LOG_INFO << "Inference thread started";
-  GenerationInput generation_input = self->CreateGenerationInput(input_ids_host);
-  GenerationOutput generation_output = self->CreateGenerationOutput();
+  // Every tensor of the request comes from one arena block, freed when the
+  // last of them goes out of scope at the end of this thread
+  MemoryTagScope const memory_tag{MemoryTag::kREQUEST};
+  auto const arena = self->CreateRequestArena(static_cast<int>(input_ids_host.size()), bad_words);
+  GenerationInput generation_input = self->CreateGenerationInput(input_ids_host, outputLen, bad_words, arena);
+  GenerationOutput generation_output = self->CreateGenerationOutput(arena);
 
   // Define the callback to stream each generated token
   generation_output.onTokenGenerated = [&infer_state, input_len, outputLen, self, &generation_output](
@@ -118,24 +214,26 @@ void InferenceThread(
     // Copy output IDs from GPU to host for printing
     std::vector<int32_t> output_idsHost(output_length);
     self->gpt_session->getBufferManager().copy(*output_ids, output_idsHost.data(), MemoryType::kCPU);
+    // Text ends at the first stop token, a single id compare now that the tokenizer never splits them
+    auto const& stop_ids = self->stop_token_ids;
+    auto output_end = std::find_first_of(
+        output_idsHost.begin() + input_len, output_idsHost.end(), stop_ids.begin(), stop_ids.end());
+    std::vector<int> output_idsHostDecode(output_idsHost.begin() + input_len, output_end);
     // Find the last non-zero value in the output IDs starting from the end of the input sequence
-    std::vector<int> output_idsHostDecode(output_idsHost.begin() + input_len, output_idsHost.end());
     RemoveId(output_idsHostDecode, 0);
-    RemoveId(output_idsHostDecode, 32000);
-    RemoveId(output_idsHostDecode, 32001);
     std::string text = self->cortex_tokenizer->Decode(output_idsHostDecode);
 
-    if (infer_state->prev_pos >= 0 && infer_state->prev_pos < text.size()) {
+    // A code point split over byte-fallback tokens is held back until its
+    // last byte is generated, the final step flushes whatever is left
+    int const complete = static_cast<int>(finished ? text.size() : Utf8CompleteLength(text));
+    if (infer_state->prev_pos >= 0 && infer_state->prev_pos < complete) {
       // Valid prev_pos, proceed with slicing the string from prev_pos to the end
-      std::string string_tok(text.begin() + infer_state->prev_pos, text.end());
+      std::string string_tok(text.begin() + infer_state->prev_pos, text.begin() + complete);
       std::lock_guard<std::mutex> guard(infer_state->queue_mutex); // Protect access with a lock
       infer_state->texts_to_stream.push(string_tok);
       ++infer_state->token_gen_count;
     }
-    else if (infer_state->prev_pos >= text.size()) {
-      infer_state->prev_pos = text.size();
-    }
-    infer_state->prev_pos = text.size();
+    infer_state->prev_pos = complete;
     if (finished) {
       std::lock_guard<std::mutex> guard(infer_state->queue_mutex); // Protect access with a lock
       infer_state->texts_to_stream.push("[DONE]");
@@ -185,53 +283,194 @@ bool TensorrtllmEngine::CheckModelLoaded(std::function<void(Json::Value&&, Json:
   return true;
 }
 
+std::string TensorrtllmEngine::RenderMessage(const Json::Value& message) const {
+  std::string input_role = message["role"].asString();
+  std::string content = message["content"].asString();
+  if (input_role == "user") {
+    return user_prompt + content;
+  }
+  if (input_role == "assistant") {
+    return ai_prompt + content;
+  }
+  if (input_role == "system") {
+    return system_prompt + content;
+  }
+  return input_role + content;
+}
+
+std::string TensorrtllmEngine::FormatPrompt(const Json::Value& messages, const std::vector<size_t>& kept) const {
+  std::string formatted_input = pre_prompt;
+  for (auto i : kept) {
+    auto const& message = messages[static_cast<Json::ArrayIndex>(i)];
+    if (message["role"].asString() == "system") {
+      formatted_input = RenderMessage(message) + formatted_input;
+    } else {
+      formatted_input += RenderMessage(message);
+    }
+  }
+  return formatted_input + ai_prompt;
+}
+
+std::vector<MessageTokens> TensorrtllmEngine::CountMessageTokens(const Json::Value& messages) {
+  std::vector<MessageTokens> counts;
+  counts.reserve(messages.size());
+  for (auto const& message : messages) {
+    counts.push_back({token_counts_->Count(*cortex_tokenizer, RenderMessage(message)),
+                      message["role"].asString() == "system"});
+  }
+  return counts;
+}
+
+int TensorrtllmEngine::PromptBudget(int max_tokens, TruncationPolicy policy) const {
+  int const ctx_len = session_config.maxSequenceLength;
+  if (policy == TruncationPolicy::kNone) {
+    return ctx_len - 1;
+  }
+  return ctx_len - std::clamp(max_tokens, 1, std::max(1, ctx_len / 4));
+}
+
+std::optional<TruncationPolicy> TensorrtllmEngine::GetTruncationPolicy(
+    const inferences::ChatCompletionRequest& request) const {
+  if (request.truncation.empty()) {
+    return truncation_;
+  }
+  return ParseTruncationPolicy(request.truncation);
+}
+
+bool TensorrtllmEngine::PlanPrompt(const inferences::ChatCompletionRequest& request, TruncationPolicy policy,
+                                   PromptPlan& plan, std::string& error) {
+  int const ctx_len = session_config.maxSequenceLength;
+  int const budget = PromptBudget(request.max_tokens, policy);
+  Json::Value const& messages = request.messages;
+
+  // A conversation resends its history with every turn, so the counts of
+  // all but the newest message come from the cache and the fit is a sum.
+  // Only the kept window is encoded.
+  plan.message_tokens = CountMessageTokens(messages);
+  plan.overhead = token_counts_->Count(*cortex_tokenizer, pre_prompt + ai_prompt);
+  plan.fit = FitToContext(plan.message_tokens, plan.overhead, budget, policy);
+  plan.input_ids = cortex_tokenizer->Encode(FormatPrompt(messages, plan.fit.kept));
+
+  // Summed counts can be off by a token or two where messages meet. Refit
+  // once without the excess if that pushed the prompt over.
+  int const excess = static_cast<int>(plan.input_ids.size()) - budget;
+  if (excess > 0 && plan.fit.fits && policy != TruncationPolicy::kNone) {
+    plan.fit = FitToContext(plan.message_tokens, plan.overhead, budget - excess, policy);
+    plan.input_ids = cortex_tokenizer->Encode(FormatPrompt(messages, plan.fit.kept));
+  }
+  plan.fit.prompt_tokens = static_cast<int32_t>(plan.input_ids.size());
+  plan.fit.fits = plan.fit.prompt_tokens <= budget;
+  if (!plan.fit.fits) {
+    error = "Prompt has " + std::to_string(plan.fit.prompt_tokens) + " tokens, the context window of "
+        + std::to_string(ctx_len) + " tokens leaves room for " + std::to_string(budget) + " with truncation '"
+        + TruncationPolicyName(policy) + "'";
+    return false;
+  }
+  plan.max_new_tokens = std::max(1, std::min(request.max_tokens, ctx_len - plan.fit.prompt_tokens));
+  return true;
+}
+
+bool TensorrtllmEngine::BuildBadWords(const inferences::ChatCompletionRequest& request, WordList& bad_words,
+                                      std::string& error) const {
+  if (request.bad_words.empty() && request.ban_token_classes.empty()) {
+    return true;
+  }
+  TokenMask banned(vocab_index_->Size());
+  for (auto const& name : request.ban_token_classes) {
+    auto const token_class = name.asString();
+    if (token_class == "special") {
+      banned |= vocab_index_->SpecialTokens();
+    } else if (token_class == "whitespace") {
+      banned |= vocab_index_->WhitespaceTokens();
+    } else if (token_class == "digits") {
+      banned |= vocab_index_->DigitTokens();
+    } else {
+      error = "Unknown token class " + token_class + ", expected special, whitespace or digits";
+      return false;
+    }
+  }
+  for (auto const& word : request.bad_words) {
+    auto const text = word.asString();
+    if (text.empty()) {
+      continue;
+    }
+    // Any single token that would start the word, with or without a space
+    // in front, and the word as the tokenizer spells it out
+    vocab_index_->AddWithPrefix(text, banned);
+    if (text.front() != ' ') {
+      vocab_index_->AddWithPrefix(" " + text, banned);
+    }
+    auto const ids = cortex_tokenizer->Encode(text);
+    if (ids.size() > 1) {
+      bad_words.AddWord(ids.data(), ids.size());
+    }
+  }
+  // Banning a stop token would make generation run to max_tokens
+  for (auto id : stop_token_ids) {
+    banned.Reset(id);
+  }
+  bad_words.AddTokens(banned);
+  return true;
+}
+
 //#########################
 //### ENGINE END POINTS ###
 //#########################
 
 
 void TensorrtllmEngine::HandleChatCompletion(std::shared_ptr<Json::Value> json_body, std::function<void(Json::Value&&, Json::Value&&)>&& callback) {
+  // Identical deterministic requests share one generation
+  if (coalescer_) {
+    if (auto key = coalescer_->MakeKey(*json_body)) {
+      if (coalescer_->Admit(*key, callback) != RequestCoalescer::Admission::kLeader) {
+        LOG_INFO << "Request served by an identical in-flight or cached generation";
+        return;
+      }
+      callback = coalescer_->Publish(*key, std::move(callback));
+    }
+  }
+
   inferences::ChatCompletionRequest request = inferences::fromJson(json_body);
-  std::string formatted_input = pre_prompt;
   nlohmann::json data;
   // data["stream"] = completion.stream;
   // data["n_predict"] = completion.max_tokens;
   data["presence_penalty"] = request.presence_penalty;
-  Json::Value const& messages = request.messages;
 
-  // Format the input from user
-  for (auto const& message : messages) {
-    std::string input_role = message["role"].asString();
-    std::string role;
-    if (input_role == "user") {
-        role = user_prompt;
-        std::string content = message["content"].asString();
-        formatted_input += role + content;
-    }
-    else if (input_role == "assistant") {
-        role = ai_prompt;
-        std::string content = message["content"].asString();
-        formatted_input += role + content;
-    }
-    else if (input_role == "system") {
-        role = system_prompt;
-        std::string content = message["content"].asString();
-        formatted_input = role + content + formatted_input;
-    }
-    else {
-        role = input_role;
-        std::string content = message["content"].asString();
-        formatted_input += role + content;
-    }
+  auto policy = GetTruncationPolicy(request);
+  PromptPlan plan;
+  WordList bad_words;
+  std::string error;
+  std::string error_code = "context_length_exceeded";
+  if (!policy) {
+    error = "Unknown truncation policy " + request.truncation;
+    error_code = "invalid_truncation";
+  } else if (!BuildBadWords(request, bad_words, error)) {
+    error_code = "invalid_ban_token_class";
+  } else if (!PlanPrompt(request, *policy, plan, error)) {
+    LOG_WARN << error;
+  }
+  if (!error.empty()) {
+    Json::Value json_resp;
+    json_resp["message"] = error;
+    json_resp["data"] = "data: " + tensorrtllm_utils::CreateErrorJson(error, error_code) + "\n\n";
+    Json::Value status;
+    status["is_done"] = true;
+    status["has_error"] = true;
+    status["is_stream"] = true;
+    status["status_code"] = k400BadRequest;
+    callback(std::move(status), std::move(json_resp));
+    return;
+  }
+  if (!plan.fit.dropped.empty()) {
+    LOG_INFO << "Truncated prompt (" << TruncationPolicyName(*policy) << "): dropped " << plan.fit.dropped.size()
+             << " message(s), " << plan.input_ids.size() << " tokens left";
   }
-  formatted_input += ai_prompt;
-  // Format the input from user
 
   std::shared_ptr<InferenceState> infer_state = std::make_shared<InferenceState>();
 
-  std::vector<int32_t> input_ids_host = cortex_tokenizer->Encode(formatted_input);
+  std::vector<int32_t> input_ids_host = std::move(plan.input_ids);
   int const input_len = input_ids_host.size();
-  int const outputLen = request.max_tokens - input_len;
+  int const outputLen = plan.max_new_tokens;
 
   // Create sampling config
   SamplingConfig sampling_config{1};
@@ -239,11 +478,24 @@ void TensorrtllmEngine::HandleChatCompletion(std::shared_ptr<Json::Value> json_b
   sampling_config.randomSeed = std::vector{static_cast<uint64_t>(42ull)};
   sampling_config.topK = std::vector{40};
   sampling_config.topP = std::vector{request.top_p};
-  sampling_config.minLength = std::vector{outputLen};
+  sampling_config.minLength = std::vector{1};
   sampling_config.repetitionPenalty = std::vector{request.frequency_penalty};
   // Input preparation
 
-  std::thread inference_thread(InferenceThread, infer_state, input_ids_host, callback, this, sampling_config, input_len, outputLen);
+  {
+    std::lock_guard<std::mutex> lock(active_inferences_mtx_);
+    ++active_inferences_;
+  }
+  std::thread inference_thread([this, infer_state, input_ids_host, callback, sampling_config, input_len, outputLen,
+                                bad_words = std::move(bad_words)]() mutable {
+    InferenceThread(infer_state, std::move(input_ids_host), std::move(callback), this, sampling_config, input_len,
+                    outputLen, std::move(bad_words));
+    // Notified under the lock, the destructor cannot finish before this
+    // thread is done with the condition variable
+    std::lock_guard<std::mutex> lock(active_inferences_mtx_);
+    --active_inferences_;
+    active_inferences_cv_.notify_all();
+  });
   inference_thread.detach(); // Detach the thread to allow it to run independently
 
   q_->runTaskInQueue([cb = std::move(callback), infer_state]() {
@@ -253,10 +505,6 @@ void TensorrtllmEngine::HandleChatCompletion(std::shared_ptr<Json::Value> json_b
       if (!infer_state->texts_to_stream.empty()) {
         std::string rew_text = infer_state->texts_to_stream.front();
         infer_state->texts_to_stream.pop();
-        if (HandleMatch(rew_text, infer_state) && rew_text != "[DONE]") {
-            continue;
-        };
-
         if (rew_text == "[DONE]") {
           const std::string str
               = "data: " + tensorrtllm_utils::CreateReturnJson(tensorrtllm_utils::GenerateRandomString(20), "_", "", "stop")
@@ -278,8 +526,7 @@ void TensorrtllmEngine::HandleChatCompletion(std::shared_ptr<Json::Value> json_b
             = "data: " + tensorrtllm_utils::CreateReturnJson(tensorrtllm_utils::GenerateRandomString(20), "_", rew_text) + "\n\n";
 
         lock.unlock(); // Unlock as soon as possible
-        infer_state->prev_text = rew_text;
-        
+
         Json::Value resp_data;
         resp_data["data"] = text_to_stream;
         Json::Value status;
@@ -304,6 +551,29 @@ void TensorrtllmEngine::LoadModel(std::shared_ptr<Json::Value> json_body, std::f
     std::filesystem::path model_dir = request.model_path;
 
     int ctx_len = request.ctx_len;
+    auto truncation = ParseTruncationPolicy(request.truncation);
+    if (!truncation) {
+      Json::Value json_resp;
+      json_resp["message"] = "Unknown truncation policy " + request.truncation;
+      Json::Value status_resp;
+      status_resp["status_code"] = k400BadRequest;
+      callback(std::move(status_resp), std::move(json_resp));
+      return;
+    }
+    truncation_ = *truncation;
+    auto load_mode = EngineBlob::getDefaultLoadMode();
+    if (!request.engine_load_mode.empty()) {
+      auto const mode = EngineBlob::parseLoadMode(request.engine_load_mode);
+      if (!mode) {
+        Json::Value json_resp;
+        json_resp["message"] = "Unknown engine load mode " + request.engine_load_mode;
+        Json::Value status_resp;
+        status_resp["status_code"] = k400BadRequest;
+        callback(std::move(status_resp), std::move(json_resp));
+        return;
+      }
+      load_mode = *mode;
+    }
     this->user_prompt = request.user_prompt;
     this->ai_prompt = request.ai_prompt;
     this->system_prompt = request.system_prompt;
@@ -313,9 +583,26 @@ void TensorrtllmEngine::LoadModel(std::shared_ptr<Json::Value> json_body, std::f
     logger->setLevel(nvinfer1::ILogger::Severity::kINFO);
     initTrtLlmPlugins(logger.get());
 
-    std::filesystem::path tokenizer_model_name = model_dir / "tokenizer.model";
-    cortex_tokenizer = std::make_unique<Tokenizer>(tokenizer_model_name.string());
-    LOG_INFO << "Loaded tokenizer from " << tokenizer_model_name.string();
+    try {
+      cortex_tokenizer = LoadTokenizer(model_dir.string());
+      stop_token_ids = cortex_tokenizer->StopTokenIds();
+      token_counts_ = std::make_unique<TokenCountCache>();
+      vocab_index_ = std::make_unique<VocabIndex>(cortex_tokenizer->Pieces());
+      if (request.tokenizer_cache_mb > 0) {
+        EncodeCache::Config cache_config;
+        cache_config.budget_bytes = static_cast<size_t>(request.tokenizer_cache_mb) << 20;
+        cortex_tokenizer->EnableEncodeCache(cache_config);
+        LOG_INFO << "Tokenizer cache enabled, budget: " << request.tokenizer_cache_mb << "MB";
+      }
+    } catch (const std::exception& e) {
+      LOG_ERROR << "Failed to load tokenizer: " << e.what();
+      Json::Value json_resp;
+      json_resp["message"] = std::string("Failed to load tokenizer: ") + e.what();
+      Json::Value status_resp;
+      status_resp["status_code"] = k500InternalServerError;
+      callback(std::move(status_resp), std::move(json_resp));
+      return;
+    }
 
     std::filesystem::path json_file_name = model_dir / "config.json";
     auto json = GptJsonConfig::parse(json_file_name);
@@ -331,9 +618,56 @@ void TensorrtllmEngine::LoadModel(std::shared_ptr<Json::Value> json_body, std::f
     session_config.maxSequenceLength = ctx_len;
     session_config.cudaGraphMode = true; // Fixed for simplicity
 
+    // Place the session's host buffers before it allocates them, so that staging
+    // stays on the socket of the GPU
+    HostMemoryPolicy host_memory_policy;
+    host_memory_policy.hugePages = request.host_huge_pages;
+    host_memory_policy.numaNode = std::max(request.numa_node, HostMemoryPolicy::kAnyNode);
+    auto const pinned_pool_idle_ms = std::max<int64_t>(request.pinned_pool_idle_ms, 0);
+    if (holds_host_memory_settings_) {
+      ReleaseHostMemorySettings();
+      holds_host_memory_settings_ = false;
+    }
+    if (!AcquireHostMemorySettings(host_memory_policy, pinned_pool_idle_ms)) {
+      Json::Value json_resp;
+      json_resp["message"] = "host_huge_pages, numa_node and pinned_pool_idle_ms are process wide and must match "
+                             "the engine that is still loaded";
+      Json::Value status_resp;
+      status_resp["status_code"] = k409Conflict;
+      callback(std::move(status_resp), std::move(json_resp));
+      return;
+    }
+    holds_host_memory_settings_ = true;
+    if (!host_memory_policy.isDefault()) {
+      LOG_INFO << "Host memory: huge pages " << host_memory_policy.hugePages << ", NUMA node "
+               << host_memory_policy.numaNode;
+    }
+
     // Init gpt_session
     auto model_path = model_dir / json.engineFilename(world_config, model_id_);
-    gpt_session = std::make_unique<GptSession>(session_config, *model_config, world_config, model_path.string(), logger);
+    auto engine_blob = EngineBlobRegistry::getInstance().acquire(model_path.string(), load_mode);
+    gpt_session = std::make_unique<GptSession>(session_config, *model_config, world_config, *engine_blob, logger);
+    // A read blob would keep a second copy of the engine in anonymous memory,
+    // mapped pages are clean and can be reclaimed
+    if (engine_blob->getLoadMode() == EngineBlob::LoadMode::kMMAP) {
+      engine_blob_ = std::move(engine_blob);
+    }
+
+    // Hand pinned host memory back after bursts of long prompts instead of keeping it for the process lifetime
+    if (pinned_pool_idle_ms > 0) {
+      // Check twice per timeout, so a chunk is held for at most 1.5 timeouts
+      StartPinnedPoolTrimmer(std::chrono::milliseconds{std::max<int64_t>(1, pinned_pool_idle_ms / 2)});
+      LOG_INFO << "Pinned pool idle timeout: " << pinned_pool_idle_ms << "ms";
+    }
+
+    if (request.request_coalescing) {
+      RequestCoalescer::Config coalescer_config;
+      coalescer_config.max_temperature = request.coalesce_max_temperature;
+      coalescer_config.cache_ttl_ms = request.response_cache_ttl_ms;
+      coalescer_config.cache_max_entries = std::max(0, request.response_cache_max_entries);
+      coalescer_ = std::make_unique<RequestCoalescer>(coalescer_config);
+      LOG_INFO << "Request coalescing enabled, response cache ttl: " << coalescer_config.cache_ttl_ms << "ms";
+    }
 
     model_loaded_ = true;
     if (q_ == nullptr) {
@@ -362,12 +696,25 @@ void TensorrtllmEngine::UnloadModel(std::shared_ptr<Json::Value> json_body, std:
     return;
   }
     
+  StopPinnedPoolTrimmer();
   gpt_session.reset();
+  engine_blob_.reset();
+  if (holds_host_memory_settings_) {
+    ReleaseHostMemorySettings();
+    holds_host_memory_settings_ = false;
+  }
+  vocab_index_.reset();
   cortex_tokenizer.reset();
+  token_counts_.reset();
   q_.reset();
+  coalescer_.reset();
   model_config.reset();
   logger.reset();
   model_loaded_ = false;
+  if (AllocationAudit::isEnabled()) {
+    // Whatever is still live here outlived the model
+    LOG_INFO << AllocationAudit::getInstance().snapshot().toString();
+  }
 
   Json::Value json_resp;
   json_resp["message"] = "Model unloaded successfully";
@@ -390,11 +737,91 @@ void TensorrtllmEngine::HandleEmbedding( std::shared_ptr<Json::Value> json_body,
 }
 
 void TensorrtllmEngine::GetModelStatus(std::shared_ptr<Json::Value> json_body, std::function<void(Json::Value&&, Json::Value&&)>&& callback) {
-  LOG_WARN << "Engine does not support get model status method yet";
+  if (!CheckModelLoaded(callback)) {
+    return;
+  }
+
   Json::Value json_resp;
-  json_resp["message"] = "Engine does not support get model status method yet";
+  json_resp["model_loaded"] = true;
+  json_resp["model"] = model_id_;
+  if (coalescer_) {
+    json_resp["request_coalescing"] = coalescer_->Metrics();
+  }
+  if (auto const* cache = cortex_tokenizer->GetEncodeCache()) {
+    auto const stats = cache->GetStats();
+    Json::Value metrics;
+    metrics["hits"] = Json::UInt64(stats.hits);
+    metrics["misses"] = Json::UInt64(stats.misses);
+    metrics["hit_rate"] =
+        stats.hits + stats.misses == 0 ? 0.0 : static_cast<double>(stats.hits) / (stats.hits + stats.misses);
+    metrics["bytes_saved"] = Json::UInt64(stats.bytes_saved);
+    metrics["evictions"] = Json::UInt64(stats.evictions);
+    metrics["entries"] = Json::UInt64(stats.entries);
+    metrics["resident_bytes"] = Json::UInt64(stats.resident_bytes);
+    json_resp["tokenizer_cache"] = metrics;
+  }
   Json::Value status;
-  status["status_code"] = k409Conflict;
+  status["is_done"] = true;
+  status["has_error"] = false;
+  status["is_stream"] = false;
+  status["status_code"] = k200OK;
+  callback(std::move(status), std::move(json_resp));
+}
+
+void TensorrtllmEngine::CountTokens(std::shared_ptr<Json::Value> json_body, std::function<void(Json::Value&&, Json::Value&&)>&& callback) {
+  if (!CheckModelLoaded(callback)) {
+    return;
+  }
+
+  Json::Value json_resp;
+  json_resp["model"] = model_id_;
+  json_resp["context_length"] = session_config.maxSequenceLength;
+  if (json_body->isMember("text")) {
+    json_resp["tokens"] = static_cast<int>(cortex_tokenizer->Encode((*json_body)["text"].asString()).size());
+  } else {
+    inferences::ChatCompletionRequest request = inferences::fromJson(json_body);
+    auto policy = GetTruncationPolicy(request);
+    if (!policy) {
+      Json::Value error_resp;
+      error_resp["message"] = "Unknown truncation policy " + request.truncation;
+      Json::Value status;
+      status["status_code"] = k400BadRequest;
+      callback(std::move(status), std::move(error_resp));
+      return;
+    }
+    // Per-message counts come from the same cache chat completions use, so
+    // counting a conversation before sending it warms the truncation path
+    PromptPlan plan;
+    std::string error;
+    bool const fits = PlanPrompt(request, *policy, plan, error);
+    int32_t prompt_tokens = plan.overhead;
+    Json::Value message_tokens(Json::arrayValue);
+    for (auto const& count : plan.message_tokens) {
+      prompt_tokens += count.tokens;
+      message_tokens.append(count.tokens);
+    }
+    json_resp["prompt_tokens"] = prompt_tokens;
+    json_resp["message_tokens"] = message_tokens;
+    json_resp["truncation"] = TruncationPolicyName(*policy);
+    json_resp["fits"] = fits;
+    json_resp["prompt_tokens_after_truncation"] = plan.fit.prompt_tokens;
+    Json::Value dropped(Json::arrayValue);
+    for (auto i : plan.fit.dropped) {
+      dropped.append(Json::UInt64(i));
+    }
+    json_resp["dropped_messages"] = dropped;
+    if (fits) {
+      json_resp["max_new_tokens"] = plan.max_new_tokens;
+    } else {
+      json_resp["message"] = error;
+    }
+  }
+
+  Json::Value status;
+  status["is_done"] = true;
+  status["has_error"] = false;
+  status["is_stream"] = false;
+  status["status_code"] = k200OK;
   callback(std::move(status), std::move(json_resp));
 }
 
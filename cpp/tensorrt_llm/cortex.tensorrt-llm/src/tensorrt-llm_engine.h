@@ -1,18 +1,26 @@
 #pragma once
 
+#include <condition_variable>
 #include <cstdint>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <ostream>
 #include <queue>
 #include <string>
+#include <thread>
 
 #include "NvInfer.h"
 #include "base/cortex-common/enginei.h"
+#include "context_window.h"
 #include "models/chat_completion_request.h"
 #include "models/load_model_request.h"
-#include "sentencepiece_processor.h"
+#include "request_coalescer.h"
 #include "tensorrt_llm/plugins/api/tllmPlugin.h"
+#include "tensorrt_llm/runtime/bufferArena.h"
+#include "tensorrt_llm/runtime/copyBatch.h"
+#include "tensorrt_llm/runtime/engineBlob.h"
 #include "tensorrt_llm/runtime/generationInput.h"
 #include "tensorrt_llm/runtime/generationOutput.h"
 #include "tensorrt_llm/runtime/gptJsonConfig.h"
@@ -20,6 +28,8 @@
 #include "tensorrt_llm/runtime/gptSession.h"
 #include "tensorrt_llm/runtime/samplingConfig.h"
 #include "tensorrt_llm/runtime/tllmLogger.h"
+#include "tokenizer.h"
+#include "vocab_index.h"
 #include "trantor/utils/ConcurrentTaskQueue.h"
 #include "trantor/utils/Logger.h"
 #include <nlohmann/json.hpp>
@@ -27,63 +37,12 @@
 
 using namespace tensorrt_llm::runtime;
 
-class Tokenizer {
- private:
-  sentencepiece::SentencePieceProcessor processor;
-
-  void ReplaceSubstring(std::string& base, const std::string& from, const std::string& to) {
-    size_t start_pos = 0;
-    while ((start_pos = base.find(from, start_pos)) != std::string::npos) {
-        base.replace(start_pos, from.length(), to);
-        start_pos += to.length();
-    }
-  }
-
- public:
-  Tokenizer(const std::string& model_path) {
-    auto status = processor.Load(model_path);
-    if (!status.ok()) {
-      std::cerr << status.ToString() << std::endl;
-    }
-    LOG_INFO << "Successully loaded the tokenizer";
-  }
-
-  std::string DecodeWithSpace(const int id) {
-    std::string text = processor.IdToPiece(id);
-    ReplaceSubstring(text, "▁", " ");
-    return text;
-  }
-
-  std::string Decode(const std::vector<int32_t> ids) {
-    std::string text = processor.DecodeIds(ids);
-    return text;
-  }
-
-  std::vector<int> Encode(const std::string& input) {
-    std::vector<int> ids;
-    processor.Encode(input, &ids);
-    return ids;
-  }
-};
-
 struct InferenceState {
   int prev_pos{0};
-  std::string prev_text;
   bool is_finished;
   std::queue<std::string> texts_to_stream;
   std::mutex queue_mutex; // Mutex to protect access to textsToStream
-  size_t stop_word_match_len = 0;
-  std::vector<std::string> sequence{"<", "|", "im", "_", "end", "|", ">"};
   int token_gen_count = 0;
-
-  void Reset() {
-      stop_word_match_len = 0;
-      prev_text = "";
-  }
-
-  bool IsComplete() const {
-      return stop_word_match_len >= sequence.size();
-  }
 };
 
 namespace tensorrtllm {
@@ -112,22 +71,69 @@ class TensorrtllmEngine : public EngineI {
   void GetModels(
       std::shared_ptr<Json::Value> json_body,
       std::function<void(Json::Value&&, Json::Value&&)>&& callback) final;
+  void CountTokens(
+      std::shared_ptr<Json::Value> json_body,
+      std::function<void(Json::Value&&, Json::Value&&)>&& callback) final;
 
   GenerationInput::TensorPtr GetTensorSingleStopWordList(int stopToken);
-  GenerationInput CreateGenerationInput(std::vector<int32_t> inputIds);
-  GenerationOutput CreateGenerationOutput();
-  GenerationInput::TensorPtr GetTensorChatMLStopWordList();
+  // GPU arena sized for every tensor of one request, so that its setup is a
+  // single allocation and its teardown a single free
+  BufferArena::SharedPtr CreateRequestArena(int inputLen, const WordList& badWords);
+  GenerationInput CreateGenerationInput(std::vector<int32_t> inputIds, int maxNewTokens, const WordList& badWords,
+                                        const BufferArena::SharedPtr& arena);
+  GenerationOutput CreateGenerationOutput(const BufferArena::SharedPtr& arena);
+  // The word lists are only queued on copy_batch and must not be read before
+  // it is executed
+  GenerationInput::TensorPtr GetTensorStopWordList(const BufferArena::SharedPtr& arena, CopyBatch& copy_batch);
+  GenerationInput::TensorPtr GetTensorWordList(const WordList& words, const BufferArena::SharedPtr& arena,
+                                               CopyBatch& copy_batch);
 
   std::unique_ptr<GptSession> gpt_session;
   std::unique_ptr<Tokenizer> cortex_tokenizer;
+  // End-of-turn ids of the loaded tokenizer, generation stops on any of them
+  std::vector<int32_t> stop_token_ids;
 
  private:
+  struct PromptPlan {
+    std::vector<int32_t> input_ids;
+    // Cached per-message counts and the template overhead the fit is
+    // planned with
+    std::vector<MessageTokens> message_tokens;
+    int32_t overhead = 0;
+    ContextFit fit;
+    int max_new_tokens = 0;
+  };
+
   bool CheckModelLoaded(
       std::function<void(Json::Value&&, Json::Value&&)>& callback);
 
+  // Message with its role prompt, as it appears in the formatted prompt
+  std::string RenderMessage(const Json::Value& message) const;
+  std::string FormatPrompt(const Json::Value& messages, const std::vector<size_t>& kept) const;
+  std::vector<MessageTokens> CountMessageTokens(const Json::Value& messages);
+  // Largest prompt that leaves room to generate: a single token when not
+  // truncating, otherwise max_tokens up to a quarter of the context window
+  int PromptBudget(int max_tokens, TruncationPolicy policy) const;
+  std::optional<TruncationPolicy> GetTruncationPolicy(const inferences::ChatCompletionRequest& request) const;
+  // Fits the messages from their cached token counts, truncating by
+  // `policy`, then encodes the kept window. Returns false with `error` set
+  // if it cannot be made to fit.
+  bool PlanPrompt(const inferences::ChatCompletionRequest& request, TruncationPolicy policy, PromptPlan& plan,
+                  std::string& error);
+  // Bans the request's bad_words and ban_token_classes. Returns false with
+  // `error` set for an unknown class.
+  bool BuildBadWords(const inferences::ChatCompletionRequest& request, WordList& bad_words, std::string& error) const;
+  // Releases idle pinned pool chunks every `interval` until stopped, the
+  // pool only checks its idle timeout when it allocates or frees
+  void StartPinnedPoolTrimmer(std::chrono::milliseconds interval);
+  void StopPinnedPoolTrimmer();
+
   GptSession::Config session_config{1, 1, 1};
   SamplingConfig sampling_config{1};
   std::unique_ptr<GptModelConfig> model_config;
+  // A mapped engine file is held while the model is loaded, so that the engine
+  // a hot reload loads next to this one shares it when the file is unchanged
+  EngineBlobRegistry::BlobPtr engine_blob_;
   std::shared_ptr<TllmLogger> logger;
   std::string user_prompt;
   std::string ai_prompt;
@@ -138,6 +144,21 @@ class TensorrtllmEngine : public EngineI {
   uint64_t start_time_;
   std::atomic<bool> model_loaded_;
   std::unique_ptr<trantor::ConcurrentTaskQueue> q_;
+  std::unique_ptr<RequestCoalescer> coalescer_;
+  TruncationPolicy truncation_ = TruncationPolicy::kNone;
+  std::unique_ptr<TokenCountCache> token_counts_;
+  std::unique_ptr<VocabIndex> vocab_index_;
+  // Detached inference threads still using this engine
+  int active_inferences_ = 0;
+  std::mutex active_inferences_mtx_;
+  std::condition_variable active_inferences_cv_;
+  std::thread pinned_pool_trimmer_;
+  std::mutex pinned_pool_trimmer_mtx_;
+  std::condition_variable pinned_pool_trimmer_cv_;
+  bool pinned_pool_trimmer_stop_ = false;
+  // Whether this engine counts as a user of the process wide host memory
+  // settings, from LoadModel until it is unloaded
+  bool holds_host_memory_settings_ = false;
 };
 
 } // namespace inferences
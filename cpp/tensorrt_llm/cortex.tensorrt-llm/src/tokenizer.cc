@@ -0,0 +1,56 @@
+#include "tokenizer.h"
+
+#include <algorithm>
+
+namespace tensorrtllm {
+
+namespace {
+
+// End-of-turn markers of the chat templates in common use.
+constexpr std::string_view kStopTokens[] = {
+    "<|im_end|>", "<|eot_id|>", "<|end_of_text|>", "<|endoftext|>", "<|end|>", "</s>",
+};
+
+}  // namespace
+
+void Tokenizer::EncodeAppend(const std::string& input, std::vector<int32_t>& ids) const {
+  std::string_view const text = input;
+  size_t segment_start = 0;
+  int32_t id;
+  size_t length;
+  for (size_t pos; (pos = added_tokens_.Find(text, segment_start, id, length)) != std::string_view::npos;) {
+    EncodeSegmentCached(text.substr(segment_start, pos - segment_start), ids);
+    ids.push_back(id);
+    segment_start = pos + length;
+  }
+  EncodeSegmentCached(text.substr(segment_start), ids);
+}
+
+void Tokenizer::EncodeSegmentCached(std::string_view text, std::vector<int32_t>& ids) const {
+  if (!encode_cache_ || !encode_cache_->Cacheable(text)) {
+    EncodeSegment(text, ids);
+    return;
+  }
+  if (encode_cache_->Lookup(text, ids)) {
+    return;
+  }
+  size_t const before = ids.size();
+  EncodeSegment(text, ids);
+  encode_cache_->Insert(text, ids.data() + before, ids.size() - before);
+}
+
+std::vector<int32_t> Tokenizer::StopTokenIds() const {
+  std::vector<int32_t> ids;
+  if (eos_id_ >= 0) {
+    ids.push_back(eos_id_);
+  }
+  for (auto token : kStopTokens) {
+    int32_t id = added_tokens_.Lookup(token);
+    if (id >= 0 && std::find(ids.begin(), ids.end(), id) == ids.end()) {
+      ids.push_back(id);
+    }
+  }
+  return ids;
+}
+
+}  // namespace tensorrtllm
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "added_token_trie.h"
+#include "encode_cache.h"
+#include "piece_table.h"
+
+namespace tensorrtllm {
+
+// Text <-> token id conversion used by the engine. Implementations:
+//  * SentencePieceTokenizer for models shipping `tokenizer.model`,
+//  * BpeTokenizer for byte-level BPE models shipping only `tokenizer.json`.
+// All encode/decode methods are safe to call concurrently.
+class Tokenizer {
+ public:
+  virtual ~Tokenizer() = default;
+
+  // Text of a single token, with word-boundary markers rendered as spaces and
+  // byte-fallback tokens as their byte. Empty for unknown ids.
+  std::string DecodeWithSpace(const int id) const { return std::string(pieces_.Piece(id)); }
+
+  // Decoded bytes of every id, for incremental decoding and stop matching.
+  const PieceTable& Pieces() const { return pieces_; }
+
+  size_t VocabSize() const { return pieces_.Size(); }
+
+  const AddedTokenTrie& AddedTokens() const { return added_tokens_; }
+
+  // From now on EncodeAppend serves repeated segments (the text between added
+  // tokens) from a bounded cache. Call before encoding concurrently.
+  void EnableEncodeCache(EncodeCache::Config config) { encode_cache_ = std::make_unique<EncodeCache>(config); }
+
+  // Null unless EnableEncodeCache was called.
+  const EncodeCache* GetEncodeCache() const { return encode_cache_.get(); }
+
+  // Ids that end a turn: the EOS id and those of the well-known end-of-turn
+  // tokens (<|im_end|>, <|eot_id|>, ...) the model has as added tokens.
+  std::vector<int32_t> StopTokenIds() const;
+
+  // Appends the text of ids[0, count) to `text`; special/control tokens are
+  // dropped.
+  virtual void DecodeAppend(const int32_t* ids, size_t count, std::string& text) const = 0;
+
+  // Appends the token ids of `input` to `ids`, without BOS/EOS. Added and
+  // special token strings in the input are matched first (leftmost, longest)
+  // and always map to their single id; the text between them goes through
+  // the encode cache, if enabled, and EncodeSegment.
+  void EncodeAppend(const std::string& input, std::vector<int32_t>& ids) const;
+
+  std::string Decode(const std::vector<int32_t>& ids) const {
+    std::string text;
+    DecodeAppend(ids.data(), ids.size(), text);
+    return text;
+  }
+
+  std::vector<int> Encode(const std::string& input) const {
+    std::vector<int> ids;
+    EncodeAppend(input, ids);
+    return ids;
+  }
+
+  // Encodes `inputs` on up to `max_threads` threads (0: all cores) into one
+  // packed buffer: the ids of inputs[i] are ids[offsets[i], offsets[i + 1]).
+  // `ids` and `offsets` are overwritten, their capacity is reused.
+  void EncodeBatch(const std::vector<std::string>& inputs, std::vector<int32_t>& ids,
+                   std::vector<int32_t>& offsets, size_t max_threads = 0) const;
+
+  // Inverse of EncodeBatch: texts[i] is the text of ids[offsets[i], offsets[i + 1]).
+  void DecodeBatch(const std::vector<int32_t>& ids, const std::vector<int32_t>& offsets,
+                   std::vector<std::string>& texts, size_t max_threads = 0) const;
+
+ protected:
+  // Encodes text that contains no added token.
+  virtual void EncodeSegment(std::string_view text, std::vector<int32_t>& ids) const = 0;
+
+  // Filled by the implementation's constructor.
+  PieceTable pieces_;
+  AddedTokenTrie added_tokens_;
+  int32_t eos_id_ = -1;
+
+ private:
+  void EncodeSegmentCached(std::string_view text, std::vector<int32_t>& ids) const;
+
+  std::unique_ptr<EncodeCache> encode_cache_;
+};
+
+// Picks the tokenizer for a model directory: `tokenizer.model` when present,
+// otherwise `tokenizer.json`.
+std::unique_ptr<Tokenizer> LoadTokenizer(const std::string& model_dir);
+
+}  // namespace tensorrtllm
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+#include "tokenizer.h"
+#include "trantor/utils/ConcurrentTaskQueue.h"
+
+namespace tensorrtllm {
+
+namespace {
+
+size_t HardwareThreads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Shared by all tokenizers and never destroyed. The calling thread runs one
+// chunk itself, so the pool has one thread less than the machine.
+trantor::ConcurrentTaskQueue* Pool() {
+  static auto* pool = HardwareThreads() > 1
+                          ? new trantor::ConcurrentTaskQueue(HardwareThreads() - 1, "tokenizer")
+                          : nullptr;
+  return pool;
+}
+
+// Set on the pool's threads, whose tasks must not wait on the pool.
+thread_local bool on_pool_thread = false;
+
+size_t ResolveThreads(size_t max_threads, size_t items) {
+  size_t threads = max_threads == 0 ? HardwareThreads() : std::min(max_threads, HardwareThreads());
+  return std::max<size_t>(1, std::min(threads, items));
+}
+
+// Splits [0, n) into `chunks` contiguous ranges of roughly equal `weight`
+// and returns the chunk boundaries (chunks + 1 entries).
+template <typename TWeight>
+std::vector<size_t> Partition(size_t n, size_t chunks, TWeight&& weight) {
+  std::vector<size_t> bounds{0};
+  uint64_t total = 0;
+  for (size_t i = 0; i < n; ++i) {
+    total += weight(i) + 1;
+  }
+  uint64_t acc = 0;
+  for (size_t i = 0; i < n && bounds.size() < chunks; ++i) {
+    acc += weight(i) + 1;
+    if (acc * chunks >= total * bounds.size()) {
+      bounds.push_back(i + 1);
+    }
+  }
+  while (bounds.size() <= chunks) {
+    bounds.push_back(n);
+  }
+  return bounds;
+}
+
+// Runs task(0..chunks-1) on the pool and the calling thread, rethrowing the
+// first exception once all chunks are done. A batch started from a pool
+// thread runs inline: waiting there for chunks queued behind it deadlocks
+// once every pool thread does the same.
+void RunChunks(size_t chunks, const std::function<void(size_t)>& task) {
+  if (chunks <= 1 || Pool() == nullptr || on_pool_thread) {
+    for (size_t c = 0; c < chunks; ++c) {
+      task(c);
+    }
+    return;
+  }
+
+  std::mutex mtx;
+  std::condition_variable cond;
+  size_t remaining = chunks - 1;
+  std::exception_ptr error;
+  for (size_t c = 1; c < chunks; ++c) {
+    Pool()->runTaskInQueue([&, c]() {
+      on_pool_thread = true;
+      std::exception_ptr e;
+      try {
+        task(c);
+      } catch (...) {
+        e = std::current_exception();
+      }
+      std::lock_guard<std::mutex> l(mtx);
+      if (e && !error) {
+        error = e;
+      }
+      if (--remaining == 0) {
+        cond.notify_one();
+      }
+    });
+  }
+  try {
+    task(0);
+  } catch (...) {
+    std::lock_guard<std::mutex> l(mtx);
+    if (!error) {
+      error = std::current_exception();
+    }
+  }
+  std::unique_lock<std::mutex> l(mtx);
+  cond.wait(l, [&] { return remaining == 0; });
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace
+
+void Tokenizer::EncodeBatch(const std::vector<std::string>& inputs, std::vector<int32_t>& ids,
+                            std::vector<int32_t>& offsets, size_t max_threads) const {
+  size_t const n = inputs.size();
+  size_t const chunks = ResolveThreads(max_threads, n);
+  auto const bounds = Partition(n, chunks, [&](size_t i) { return inputs[i].size(); });
+
+  // Chunks encode into per-chunk buffers (kept by the calling thread across
+  // calls), then get copied into place once all sizes are known. A batch
+  // nested in one of this thread's chunks gets its own buffers.
+  thread_local std::vector<std::vector<int32_t>> scratch;
+  thread_local bool scratch_in_use = false;
+  std::vector<std::vector<int32_t>> nested;
+  // Named reference: lambdas would otherwise see the worker's thread_local.
+  auto& chunk_ids = scratch_in_use ? nested : scratch;
+  if (chunk_ids.size() < chunks) {
+    chunk_ids.resize(chunks);
+  }
+  bool const owns_scratch = !scratch_in_use;
+  scratch_in_use = true;
+  struct Release {
+    bool owns;
+    ~Release() {
+      if (owns) {
+        scratch_in_use = false;
+      }
+    }
+  } release{owns_scratch};
+  offsets.assign(n + 1, 0);
+  RunChunks(chunks, [&](size_t c) {
+    auto& out = chunk_ids[c];
+    out.clear();
+    for (size_t i = bounds[c]; i < bounds[c + 1]; ++i) {
+      size_t const before = out.size();
+      EncodeAppend(inputs[i], out);
+      offsets[i + 1] = static_cast<int32_t>(out.size() - before);
+    }
+  });
+
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  ids.resize(offsets[n]);
+  for (size_t c = 0; c < chunks; ++c) {
+    std::copy(chunk_ids[c].begin(), chunk_ids[c].end(), ids.begin() + offsets[bounds[c]]);
+  }
+}
+
+void Tokenizer::DecodeBatch(const std::vector<int32_t>& ids, const std::vector<int32_t>& offsets,
+                            std::vector<std::string>& texts, size_t max_threads) const {
+  size_t const n = offsets.empty() ? 0 : offsets.size() - 1;
+  size_t const chunks = ResolveThreads(max_threads, n);
+  auto const bounds = Partition(n, chunks, [&](size_t i) { return offsets[i + 1] - offsets[i]; });
+
+  texts.resize(n);
+  RunChunks(chunks, [&](size_t c) {
+    for (size_t i = bounds[c]; i < bounds[c + 1]; ++i) {
+      texts[i].clear();
+      DecodeAppend(ids.data() + offsets[i], offsets[i + 1] - offsets[i], texts[i]);
+    }
+  });
+}
+
+}  // namespace tensorrtllm
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Unicode character classes used by the BPE pre-tokenizers. They follow the
+// regex classes of the Hugging Face tokenizers patterns: \p{L}, \p{N} and \s
+// (the White_Space property).
+namespace tensorrtllm::unicode {
+
+bool IsLetterNonAscii(uint32_t cp);
+bool IsNumberNonAscii(uint32_t cp);
+
+inline bool IsLetter(uint32_t cp) {
+  if (cp < 0x80) {
+    return static_cast<uint32_t>((cp | 0x20) - 'a') < 26;
+  }
+  return IsLetterNonAscii(cp);
+}
+
+inline bool IsNumber(uint32_t cp) {
+  if (cp < 0x80) {
+    return static_cast<uint32_t>(cp - '0') < 10;
+  }
+  return IsNumberNonAscii(cp);
+}
+
+inline bool IsWhitespace(uint32_t cp) {
+  if (cp < 0x80) {
+    return cp == ' ' || (cp >= 0x09 && cp <= 0x0D);
+  }
+  return cp == 0x85 || cp == 0xA0 || cp == 0x1680 || (cp >= 0x2000 && cp <= 0x200A) || cp == 0x2028
+      || cp == 0x2029 || cp == 0x202F || cp == 0x205F || cp == 0x3000;
+}
+
+// Decodes the code point starting at `s[i]` and stores its byte length in
+// `len`. Malformed or truncated sequences decode as U+FFFD of length 1, so
+// every byte of the input is covered exactly once.
+inline uint32_t DecodeUtf8(const char* s, size_t n, size_t i, size_t& len) {
+  auto const c = static_cast<unsigned char>(s[i]);
+  if (c < 0x80) {
+    len = 1;
+    return c;
+  }
+  size_t need;
+  uint32_t cp;
+  uint32_t min;
+  if ((c & 0xE0) == 0xC0) {
+    need = 2;
+    cp = c & 0x1F;
+    min = 0x80;
+  } else if ((c & 0xF0) == 0xE0) {
+    need = 3;
+    cp = c & 0x0F;
+    min = 0x800;
+  } else if ((c & 0xF8) == 0xF0) {
+    need = 4;
+    cp = c & 0x07;
+    min = 0x10000;
+  } else {
+    len = 1;
+    return 0xFFFD;
+  }
+  if (i + need > n) {
+    len = 1;
+    return 0xFFFD;
+  }
+  for (size_t k = 1; k < need; ++k) {
+    auto const cc = static_cast<unsigned char>(s[i + k]);
+    if ((cc & 0xC0) != 0x80) {
+      len = 1;
+      return 0xFFFD;
+    }
+    cp = (cp << 6) | (cc & 0x3F);
+  }
+  if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+    len = 1;
+    return 0xFFFD;
+  }
+  len = need;
+  return cp;
+}
+
+// Appends the UTF-8 encoding of `cp` to `out`.
+template <typename TString>
+void AppendUtf8(uint32_t cp, TString& out) {
+  if (cp < 0x80) {
+    out.push_back(static_cast<char>(cp));
+  } else if (cp < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x10000) {
+    out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else {
+    out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  }
+}
+
+}  // namespace tensorrtllm::unicode
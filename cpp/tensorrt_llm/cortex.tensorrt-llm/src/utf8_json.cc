@@ -0,0 +1,236 @@
+#include "utf8_json.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#define CORTEX_UTF8_X86 1
+#if defined(__GNUC__)
+#define CORTEX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CORTEX_TARGET_AVX2
+#endif
+#endif
+
+namespace tensorrtllm {
+
+namespace {
+
+constexpr char kReplacement[] = "\xEF\xBF\xBD";  // U+FFFD
+constexpr char kHex[] = "0123456789abcdef";
+
+enum class SequenceStatus {
+  kValid,
+  kTruncated,  // a well-formed start with bytes missing at the end of input
+  kInvalid,
+};
+
+// Checks the sequence starting at p[0] against the well-formed byte ranges of
+// the Unicode standard (table 3-7), which rule out overlong forms, surrogates
+// and code points past U+10FFFF. `length` is set to the sequence length when
+// valid, and otherwise to the maximal subpart: the bytes that one U+FFFD
+// replaces.
+SequenceStatus CheckSequence(const unsigned char* p, size_t n, size_t& length) {
+  unsigned char const lead = p[0];
+  length = 1;
+  if (lead < 0x80) {
+    return SequenceStatus::kValid;
+  }
+  size_t needed;
+  unsigned char lo = 0x80;
+  unsigned char hi = 0xBF;
+  if (lead < 0xC2) {
+    return SequenceStatus::kInvalid;
+  } else if (lead < 0xE0) {
+    needed = 2;
+  } else if (lead < 0xF0) {
+    needed = 3;
+    lo = lead == 0xE0 ? 0xA0 : lo;
+    hi = lead == 0xED ? 0x9F : hi;
+  } else if (lead < 0xF5) {
+    needed = 4;
+    lo = lead == 0xF0 ? 0x90 : lo;
+    hi = lead == 0xF4 ? 0x8F : hi;
+  } else {
+    return SequenceStatus::kInvalid;
+  }
+  for (; length < needed; ++length) {
+    if (length == n) {
+      return SequenceStatus::kTruncated;
+    }
+    if (p[length] < lo || p[length] > hi) {
+      return SequenceStatus::kInvalid;
+    }
+    lo = 0x80;
+    hi = 0xBF;
+  }
+  return SequenceStatus::kValid;
+}
+
+// Bytes that cannot be copied to a JSON string as they are: quote, backslash,
+// control characters and everything outside ASCII, which has to be checked.
+inline bool NeedsWork(unsigned char c) {
+  return c < 0x20 || c == '"' || c == '\\' || c >= 0x80;
+}
+
+size_t FindNeedsWorkScalar(const unsigned char* p, size_t n) {
+  size_t i = 0;
+  while (i < n && !NeedsWork(p[i])) {
+    ++i;
+  }
+  return i;
+}
+
+#ifdef CORTEX_UTF8_X86
+
+inline unsigned TrailingZeros(unsigned mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+// A signed compare against 0x20 catches both control characters and bytes
+// with the high bit set, which are negative as int8.
+size_t FindNeedsWorkSse2(const unsigned char* p, size_t n) {
+  __m128i const quote = _mm_set1_epi8('"');
+  __m128i const backslash = _mm_set1_epi8('\\');
+  __m128i const space = _mm_set1_epi8(0x20);
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    __m128i const hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                                      _mm_cmplt_epi8(v, space));
+    if (int const mask = _mm_movemask_epi8(hits)) {
+      return i + TrailingZeros(static_cast<unsigned>(mask));
+    }
+  }
+  return i + FindNeedsWorkScalar(p + i, n - i);
+}
+
+CORTEX_TARGET_AVX2 size_t FindNeedsWorkAvx2(const unsigned char* p, size_t n) {
+  __m256i const quote = _mm256_set1_epi8('"');
+  __m256i const backslash = _mm256_set1_epi8('\\');
+  __m256i const space = _mm256_set1_epi8(0x20);
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i const v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+    __m256i const hits = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)), _mm256_cmpgt_epi8(space, v));
+    if (unsigned const mask = static_cast<unsigned>(_mm256_movemask_epi8(hits))) {
+      return i + TrailingZeros(mask);
+    }
+  }
+  return i + FindNeedsWorkSse2(p + i, n - i);
+}
+
+#endif
+
+size_t FindNeedsWork(const unsigned char* p, size_t n, SimdLevel level) {
+#ifdef CORTEX_UTF8_X86
+  switch (level) {
+    case SimdLevel::kAvx2:
+      return FindNeedsWorkAvx2(p, n);
+    case SimdLevel::kSse2:
+      return FindNeedsWorkSse2(p, n);
+    case SimdLevel::kScalar:
+      break;
+  }
+#endif
+  return FindNeedsWorkScalar(p, n);
+}
+
+void AppendEscapedAscii(unsigned char c, std::string& out) {
+  switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\b':
+      out += "\\b";
+      break;
+    case '\f':
+      out += "\\f";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      out += "\\u00";
+      out += kHex[c >> 4];
+      out += kHex[c & 0xF];
+  }
+}
+
+}  // namespace
+
+SimdLevel DetectSimdLevel() {
+#if defined(CORTEX_UTF8_X86) && defined(__GNUC__)
+  static SimdLevel const level = __builtin_cpu_supports("avx2") ? SimdLevel::kAvx2 : SimdLevel::kSse2;
+  return level;
+#elif defined(CORTEX_UTF8_X86)
+  return SimdLevel::kSse2;
+#else
+  return SimdLevel::kScalar;
+#endif
+}
+
+size_t Utf8CompleteLength(std::string_view text) {
+  auto const* p = reinterpret_cast<const unsigned char*>(text.data());
+  size_t const n = text.size();
+  // A truncated sequence is a lead byte and at most two continuation bytes.
+  size_t const stop = n > 3 ? n - 3 : 0;
+  for (size_t i = n; i > stop;) {
+    --i;
+    if ((p[i] & 0xC0) != 0x80) {
+      size_t length;
+      return CheckSequence(p + i, n - i, length) == SequenceStatus::kTruncated ? i : n;
+    }
+  }
+  return n;
+}
+
+void AppendJsonEscaped(std::string_view text, std::string& out, SimdLevel level) {
+  level = std::min(level, DetectSimdLevel());
+  auto const* p = reinterpret_cast<const unsigned char*>(text.data());
+  size_t const n = text.size();
+  size_t i = 0;
+  while (i < n) {
+    size_t const plain = FindNeedsWork(p + i, n - i, level);
+    out.append(text.data() + i, plain);
+    i += plain;
+    // Non-ASCII text comes in runs, so stay here until the next plain byte
+    // rather than going back to the vector scan for every code point.
+    while (i < n && NeedsWork(p[i])) {
+      if (p[i] < 0x80) {
+        AppendEscapedAscii(p[i], out);
+        ++i;
+        continue;
+      }
+      size_t length;
+      if (CheckSequence(p + i, n - i, length) == SequenceStatus::kValid) {
+        out.append(text.data() + i, length);
+      } else {
+        out += kReplacement;
+      }
+      i += length;
+    }
+  }
+}
+
+}  // namespace tensorrtllm
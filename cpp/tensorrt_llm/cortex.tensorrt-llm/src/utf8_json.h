@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// UTF-8 checks and JSON string escaping for text streamed to clients.
+//
+// Decoded text is not always valid UTF-8: a code point split over
+// byte-fallback tokens is incomplete until its last byte is generated, and a
+// model can emit byte tokens that never form a code point at all. Streaming
+// holds the first kind back with Utf8CompleteLength and the escaper replaces
+// the second kind with U+FFFD, so every chunk sent is valid UTF-8 and JSON.
+namespace tensorrtllm {
+
+enum class SimdLevel {
+  kScalar,
+  kSse2,
+  kAvx2,
+};
+
+// Best level supported by this CPU, detected once.
+SimdLevel DetectSimdLevel();
+
+// Length of the longest prefix of `text` that does not end inside a code
+// point: trailing bytes that start a well-formed sequence but are too few to
+// finish it are left out. Ill-formed trailing bytes are kept, as no later byte
+// can make them valid.
+size_t Utf8CompleteLength(std::string_view text);
+
+// Appends `text` to `out` as the contents of a JSON string (no quotes).
+// Quotes, backslashes and control characters are escaped, well-formed UTF-8
+// is copied as is, and each maximal ill-formed subsequence becomes U+FFFD.
+// Runs of bytes that need no escaping are found 16 or 32 at a time.
+void AppendJsonEscaped(std::string_view text, std::string& out, SimdLevel level);
+
+inline void AppendJsonEscaped(std::string_view text, std::string& out) {
+  AppendJsonEscaped(text, out, DetectSimdLevel());
+}
+
+}  // namespace tensorrtllm
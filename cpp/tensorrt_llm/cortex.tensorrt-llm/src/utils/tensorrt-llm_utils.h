@@ -11,6 +11,7 @@
 #include <ostream>
 #include <regex>
 #include <vector>
+#include "src/utf8_json.h"
 // Include platform-specific headers
 #ifdef _WIN32
 #include <windows.h>
@@ -31,29 +32,42 @@ inline std::string GenerateRandomString(std::size_t length) {
   return random_string;
 }
 
-inline std::string CreateReturnJson(std::string const& id, std::string const& model, std::string const& content, 
+// Streamed chunks are built by hand rather than through Json::Value, one per
+// generated token. Fields are in the order jsoncpp used to write them.
+inline std::string CreateReturnJson(std::string const& id, std::string const& model, std::string const& content,
                                     Json::Value finish_reason = Json::Value()) {
-    Json::Value root;
-    root["id"] = id;
-    root["model"] = model;
-    root["created"] = static_cast<int>(std::time(nullptr));
-    root["object"] = "chat.completion.chunk";
-
-    Json::Value choices_array(Json::arrayValue);
-    Json::Value choice;
-
-    choice["index"] = 0;
-    Json::Value delta;
-    delta["content"] = content;
-    choice["delta"] = delta;
-    choice["finish_reason"] = finish_reason;
+    std::string json;
+    json.reserve(content.size() + id.size() + model.size() + 128);
+    json += "{\"choices\":[{\"delta\":{\"content\":\"";
+    tensorrtllm::AppendJsonEscaped(content, json);
+    json += "\"},\"finish_reason\":";
+    if (finish_reason.isNull()) {
+        json += "null";
+    } else {
+        json += '"';
+        tensorrtllm::AppendJsonEscaped(finish_reason.asString(), json);
+        json += '"';
+    }
+    json += ",\"index\":0}],\"created\":";
+    json += std::to_string(static_cast<int>(std::time(nullptr)));
+    json += ",\"id\":\"";
+    tensorrtllm::AppendJsonEscaped(id, json);
+    json += "\",\"model\":\"";
+    tensorrtllm::AppendJsonEscaped(model, json);
+    json += "\",\"object\":\"chat.completion.chunk\"}";
+    return json;
+}
 
-    choices_array.append(choice);
-    root["choices"] = choices_array;
+inline std::string CreateErrorJson(std::string const& message, std::string const& code) {
+    Json::Value error;
+    error["message"] = message;
+    error["type"] = "invalid_request_error";
+    error["code"] = code;
+    Json::Value root;
+    root["error"] = error;
 
     Json::StreamWriterBuilder writer;
-    writer["indentation"] = ""; // This sets the indentation to an empty string,
-                                // producing compact output.
+    writer["indentation"] = "";
     return Json::writeString(writer, root);
 }
 
@@ -0,0 +1,149 @@
+#include "vocab_index.h"
+
+#include <algorithm>
+#include <bitset>
+
+namespace tensorrtllm {
+
+namespace {
+
+bool IsWhitespaceByte(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+bool IsDigits(std::string_view piece) {
+  if (!piece.empty() && piece.front() == ' ') {
+    piece.remove_prefix(1);
+  }
+  return !piece.empty() &&
+         std::all_of(piece.begin(), piece.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+}  // namespace
+
+TokenMask& TokenMask::operator|=(const TokenMask& other) {
+  size_t const n = std::min(words_.size(), other.words_.size());
+  for (size_t w = 0; w < n; ++w) {
+    words_[w] |= other.words_[w];
+  }
+  if (n > 0 && other.size_ > size_ && (size_ & 63) != 0) {
+    words_[n - 1] &= (uint64_t{1} << (size_ & 63)) - 1;
+  }
+  return *this;
+}
+
+TokenMask& TokenMask::operator&=(const TokenMask& other) {
+  size_t const n = std::min(words_.size(), other.words_.size());
+  for (size_t w = 0; w < n; ++w) {
+    words_[w] &= other.words_[w];
+  }
+  std::fill(words_.begin() + n, words_.end(), 0);
+  return *this;
+}
+
+TokenMask& TokenMask::AndNot(const TokenMask& other) {
+  size_t const n = std::min(words_.size(), other.words_.size());
+  for (size_t w = 0; w < n; ++w) {
+    words_[w] &= ~other.words_[w];
+  }
+  return *this;
+}
+
+size_t TokenMask::Count() const {
+  size_t count = 0;
+  for (auto word : words_) {
+    count += std::bitset<64>(word).count();
+  }
+  return count;
+}
+
+bool TokenMask::Any() const {
+  return std::any_of(words_.begin(), words_.end(), [](uint64_t word) { return word != 0; });
+}
+
+void WordList::AddWord(const int32_t* ids, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  ids_.insert(ids_.end(), ids, ids + count);
+  offsets_.push_back(static_cast<int32_t>(ids_.size()));
+}
+
+void WordList::AddTokens(const TokenMask& mask) {
+  mask.ForEach([this](int32_t id) {
+    ids_.push_back(id);
+    offsets_.push_back(static_cast<int32_t>(ids_.size()));
+  });
+}
+
+std::vector<int32_t> WordList::Pack() const {
+  std::vector<int32_t> packed(ids_);
+  packed.insert(packed.end(), offsets_.begin(), offsets_.end());
+  packed.resize(2 * ids_.size(), -1);
+  return packed;
+}
+
+void ApplyBias(const TokenMask& mask, float value, float* bias) {
+  mask.ForEach([&](int32_t id) { bias[id] += value; });
+}
+
+VocabIndex::VocabIndex(const PieceTable& pieces)
+    : pieces_(&pieces),
+      leading_space_(pieces.Size()),
+      special_(pieces.Size()),
+      whitespace_(pieces.Size()),
+      digits_(pieces.Size()) {
+  auto const n = static_cast<int32_t>(pieces.Size());
+  sorted_.reserve(n);
+  for (int32_t id = 0; id < n; ++id) {
+    auto const piece = pieces.Piece(id);
+    if (pieces.GetFlags(id) & PieceTable::kSkipOnDecode) {
+      special_.Set(id);
+      continue;
+    }
+    if (piece.empty()) {
+      continue;
+    }
+    sorted_.push_back(id);
+    if (piece.front() == ' ') {
+      leading_space_.Set(id);
+    }
+    if (std::all_of(piece.begin(), piece.end(), IsWhitespaceByte)) {
+      whitespace_.Set(id);
+    } else if (IsDigits(piece)) {
+      digits_.Set(id);
+    }
+  }
+  // Ties (several ids decoding to the same bytes) keep id order.
+  std::stable_sort(sorted_.begin(), sorted_.end(),
+                   [&](int32_t a, int32_t b) { return pieces.Piece(a) < pieces.Piece(b); });
+}
+
+std::pair<size_t, size_t> VocabIndex::PrefixRange(std::string_view prefix) const {
+  auto const begin = std::lower_bound(sorted_.begin(), sorted_.end(), prefix,
+                                      [&](int32_t id, std::string_view p) { return pieces_->Piece(id) < p; });
+  auto const end = std::upper_bound(begin, sorted_.end(), prefix, [&](std::string_view p, int32_t id) {
+    return p < pieces_->Piece(id).substr(0, p.size());
+  });
+  return {static_cast<size_t>(begin - sorted_.begin()), static_cast<size_t>(end - sorted_.begin())};
+}
+
+void VocabIndex::AddWithPrefix(std::string_view prefix, TokenMask& mask) const {
+  if (prefix.empty()) {
+    return;
+  }
+  auto const [begin, end] = PrefixRange(prefix);
+  for (size_t i = begin; i < end; ++i) {
+    mask.Set(sorted_[i]);
+  }
+}
+
+int32_t VocabIndex::Find(std::string_view bytes) const {
+  auto const [begin, end] = PrefixRange(bytes);
+  if (begin < end && pieces_->Piece(sorted_[begin]) == bytes) {
+    return sorted_[begin];
+  }
+  return -1;
+}
+
+}  // namespace tensorrtllm
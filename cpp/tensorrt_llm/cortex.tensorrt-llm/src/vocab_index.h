@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "piece_table.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace tensorrtllm {
+
+// One bit per vocabulary id.
+class TokenMask {
+ public:
+  TokenMask() = default;
+  explicit TokenMask(size_t size) : size_(size), words_((size + 63) / 64) {}
+
+  size_t Size() const { return size_; }
+
+  void Set(int32_t id) {
+    if (id >= 0 && static_cast<size_t>(id) < size_) {
+      words_[id >> 6] |= uint64_t{1} << (id & 63);
+    }
+  }
+  void Reset(int32_t id) {
+    if (id >= 0 && static_cast<size_t>(id) < size_) {
+      words_[id >> 6] &= ~(uint64_t{1} << (id & 63));
+    }
+  }
+  bool Test(int32_t id) const {
+    return id >= 0 && static_cast<size_t>(id) < size_ && (words_[id >> 6] >> (id & 63) & 1);
+  }
+
+  // Masks of different sizes combine over the shorter one.
+  TokenMask& operator|=(const TokenMask& other);
+  TokenMask& operator&=(const TokenMask& other);
+  TokenMask& AndNot(const TokenMask& other);
+
+  size_t Count() const;
+  bool Any() const;
+
+  // Calls fn(id) for every set id in increasing order, a word at a time.
+  template <typename TFn>
+  void ForEach(TFn&& fn) const {
+    for (size_t w = 0; w < words_.size(); ++w) {
+      for (uint64_t bits = words_[w]; bits != 0; bits &= bits - 1) {
+        fn(static_cast<int32_t>(w * 64 + TrailingZeros(bits)));
+      }
+    }
+  }
+
+ private:
+  static unsigned TrailingZeros(uint64_t bits) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return index;
+#else
+    return __builtin_ctzll(bits);
+#endif
+  }
+
+  size_t size_ = 0;
+  std::vector<uint64_t> words_;
+};
+
+// Token word list in the layout GenerationInput takes for stopWordsList and
+// badWordsList: one row with the ids of every word back to back, one with the
+// inclusive prefix sum of the word lengths padded with -1.
+class WordList {
+ public:
+  void AddWord(const int32_t* ids, size_t count);
+  // Each set id as a single-token word.
+  void AddTokens(const TokenMask& mask);
+
+  bool Empty() const { return offsets_.empty(); }
+  // Number of columns of the packed [2, Length()] list.
+  size_t Length() const { return ids_.size(); }
+  std::vector<int32_t> Pack() const;
+
+ private:
+  std::vector<int32_t> ids_;
+  std::vector<int32_t> offsets_;
+};
+
+// Adds `value` at every set id of a [vocab] logits bias, such as
+// GenerationInput::embeddingBias once converted to the logits type.
+void ApplyBias(const TokenMask& mask, float value, float* bias);
+
+// Load-time index of what every vocabulary id decodes to, for building
+// sampling masks without touching the tokenizer per request.
+//
+// Byte lengths and leading spaces come straight from the piece table. The
+// normal (non-special) ids are also kept sorted by their decoded bytes, which
+// is a prefix trie laid out flat: the ids under any prefix form one
+// contiguous range, found with two binary searches.
+class VocabIndex {
+ public:
+  VocabIndex() = default;
+  // `pieces` must outlive the index.
+  explicit VocabIndex(const PieceTable& pieces);
+
+  size_t Size() const { return pieces_ == nullptr ? 0 : pieces_->Size(); }
+
+  size_t ByteLength(int32_t id) const { return pieces_->Piece(id).size(); }
+  bool LeadingSpace(int32_t id) const { return leading_space_.Test(id); }
+  bool Special(int32_t id) const { return special_.Test(id); }
+
+  // Control and added special tokens, including EOS.
+  const TokenMask& SpecialTokens() const { return special_; }
+  // Tokens made only of spaces, tabs and line breaks.
+  const TokenMask& WhitespaceTokens() const { return whitespace_; }
+  // Tokens made only of ASCII digits, with or without a leading space.
+  const TokenMask& DigitTokens() const { return digits_; }
+
+  // Sets every normal id whose decoded bytes start with `prefix`.
+  void AddWithPrefix(std::string_view prefix, TokenMask& mask) const;
+
+  // Normal id decoding to exactly `bytes`, -1 if there is none.
+  int32_t Find(std::string_view bytes) const;
+
+ private:
+  // Range of sorted_ whose pieces start with `prefix`.
+  std::pair<size_t, size_t> PrefixRange(std::string_view prefix) const;
+
+  const PieceTable* pieces_ = nullptr;
+  std::vector<int32_t> sorted_;
+  TokenMask leading_space_;
+  TokenMask special_;
+  TokenMask whitespace_;
+  TokenMask digits_;
+};
+
+}  // namespace tensorrtllm
@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/allocationAudit.h"
+
+#include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/common/stringUtils.h"
+#include "tensorrt_llm/common/tllmException.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <sstream>
+#include <utility>
+#if !defined(_MSC_VER)
+#include <dlfcn.h>
+#include <execinfo.h>
+#endif
+// Only with FRAME_POINTERS, without them the frame pointer register holds other values that may look like a chain
+#if defined(TLLM_FRAME_POINTERS) && defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+#include <pthread.h>
+#define TLLM_AUDIT_FRAME_POINTERS 1
+#endif
+
+namespace tc = tensorrt_llm::common;
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+// By MemoryType
+auto constexpr kMemoryTypeNames = std::array{"GPU", "CPU", "PINNED", "UVM"};
+
+struct SiteHash
+{
+    std::size_t operator()(AllocationAudit::Site const& site) const
+    {
+        return site.hash();
+    }
+};
+
+std::string frameToString(void* frame)
+{
+#if !defined(_MSC_VER)
+    Dl_info info;
+    if (dladdr(frame, &info) && info.dli_sname)
+    {
+        return tc::fmtstr("%p %s + %zd", frame, tc::TllmException::demangle(info.dli_sname).c_str(),
+            static_cast<char*>(frame) - static_cast<char*>(info.dli_saddr));
+    }
+    if (info.dli_fname != nullptr)
+    {
+        return tc::fmtstr("%p (%s)", frame, info.dli_fname);
+    }
+#endif
+    return tc::fmtstr("%p", frame);
+}
+
+#if defined(TLLM_AUDIT_FRAME_POINTERS)
+// The stack of the calling thread, [low, high)
+std::pair<std::uintptr_t, std::uintptr_t> getStackBounds()
+{
+    thread_local auto const bounds = []
+    {
+        std::pair<std::uintptr_t, std::uintptr_t> result{0, 0};
+        pthread_attr_t attr;
+        if (pthread_getattr_np(pthread_self(), &attr) == 0)
+        {
+            void* addr = nullptr;
+            std::size_t size = 0;
+            if (pthread_attr_getstack(&attr, &addr, &size) == 0)
+            {
+                auto const low = reinterpret_cast<std::uintptr_t>(addr);
+                result = {low, low + size};
+            }
+            pthread_attr_destroy(&attr);
+        }
+        return result;
+    }();
+    return bounds;
+}
+
+// Follows the saved frame pointers from `framePointer`, which on x86-64 and AArch64 point at the caller's frame
+// pointer followed by the return address. Stops where the chain leaves the stack or stops growing towards its base,
+// as it does in code built without frame pointers, so it may return fewer frames than a full unwind.
+std::size_t walkFramePointers(void* framePointer, void** frames, std::size_t maxFrames)
+{
+    auto const [low, high] = getStackBounds();
+    auto addr = reinterpret_cast<std::uintptr_t>(framePointer);
+    std::size_t numFrames = 0;
+    while (numFrames < maxFrames && addr >= low && addr + 2 * sizeof(void*) <= high && addr % sizeof(void*) == 0)
+    {
+        auto const* const frame = reinterpret_cast<void* const*>(addr);
+        if (frame[1] == nullptr)
+        {
+            break;
+        }
+        frames[numFrames++] = frame[1];
+        auto const next = reinterpret_cast<std::uintptr_t>(frame[0]);
+        if (next <= addr)
+        {
+            break;
+        }
+        addr = next;
+    }
+    return numFrames;
+}
+#endif
+
+std::string ageToString(AllocationAudit::Clock::duration age)
+{
+    return tc::fmtstr("%.1f s", std::chrono::duration<double>(age).count());
+}
+
+// Applies TLLM_ALLOCATION_AUDIT when the library is loaded, before anything is allocated
+[[maybe_unused]] bool const kEnabledFromEnv = []
+{
+    auto const* numFrames = std::getenv("TLLM_ALLOCATION_AUDIT");
+    if (numFrames == nullptr || *numFrames == '\0')
+    {
+        return false;
+    }
+    AllocationAudit::getInstance().enable(static_cast<std::size_t>(std::strtoul(numFrames, nullptr, 10)));
+    return true;
+}();
+
+} // namespace
+
+bool AllocationAudit::Site::operator==(Site const& other) const
+{
+    return numFrames == other.numFrames && memoryType == other.memoryType && tag == other.tag
+        && std::equal(frames.begin(), frames.begin() + numFrames, other.frames.begin());
+}
+
+std::size_t AllocationAudit::Site::hash() const
+{
+    auto seed = std::hash<std::size_t>{}((static_cast<std::size_t>(memoryType) << 8) | static_cast<std::size_t>(tag));
+    for (std::size_t i = 0; i < numFrames; ++i)
+    {
+        seed ^= std::hash<void*>{}(frames[i]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+std::string AllocationAudit::Site::toString() const
+{
+    std::ostringstream ss;
+    ss << kMemoryTypeNames[static_cast<std::size_t>(memoryType)] << ", " << MemoryCounters::tagToString(tag);
+    for (std::size_t i = 0; i < numFrames; ++i)
+    {
+        ss << "\n    #" << i << " " << frameToString(frames[i]);
+    }
+    return ss.str();
+}
+
+std::size_t AllocationAudit::Snapshot::getBytes() const
+{
+    std::size_t bytes{0};
+    for (auto const& usage : sites)
+    {
+        bytes += usage.bytes;
+    }
+    return bytes;
+}
+
+std::size_t AllocationAudit::Snapshot::getCount() const
+{
+    std::size_t count{0};
+    for (auto const& usage : sites)
+    {
+        count += usage.count;
+    }
+    return count;
+}
+
+std::string AllocationAudit::Snapshot::toString(std::size_t maxSites) const
+{
+    std::ostringstream ss;
+    ss << "Live buffers: " << MemoryCounters::bytesToString(getBytes()) << " in " << getCount() << " buffers from "
+       << sites.size() << " sites";
+    for (std::size_t i = 0; i < std::min(maxSites, sites.size()); ++i)
+    {
+        auto const& usage = sites[i];
+        ss << "\n  " << MemoryCounters::bytesToString(usage.bytes) << " in " << usage.count << " buffers, oldest "
+           << ageToString(time - usage.oldest) << " old, " << usage.site.toString();
+    }
+    return ss.str();
+}
+
+std::ptrdiff_t AllocationAudit::SnapshotDiff::getBytes() const
+{
+    std::ptrdiff_t bytes{0};
+    for (auto const& siteDiff : sites)
+    {
+        bytes += siteDiff.bytes;
+    }
+    return bytes;
+}
+
+std::string AllocationAudit::SnapshotDiff::toString(std::size_t maxSites) const
+{
+    std::ostringstream ss;
+    ss << "Live buffers changed by " << MemoryCounters::bytesToString(getBytes()) << " in " << ageToString(elapsed)
+       << " at " << sites.size() << " sites";
+    for (std::size_t i = 0; i < std::min(maxSites, sites.size()); ++i)
+    {
+        auto const& siteDiff = sites[i];
+        ss << "\n  " << (siteDiff.bytes >= 0 ? "+" : "") << MemoryCounters::bytesToString(siteDiff.bytes) << " in "
+           << (siteDiff.count >= 0 ? "+" : "") << siteDiff.count << " buffers, " << siteDiff.site.toString();
+    }
+    return ss.str();
+}
+
+AllocationAudit& AllocationAudit::getInstance()
+{
+    static AllocationAudit instance;
+    return instance;
+}
+
+void AllocationAudit::enable(std::size_t numFrames)
+{
+    TLLM_LOG_INFO("Auditing allocations with %zu stack frames", std::min(numFrames, kMaxFrames));
+    mNumFrames.store(std::min(numFrames, kMaxFrames), std::memory_order_relaxed);
+    sEnabled.store(true, std::memory_order_relaxed);
+}
+
+void AllocationAudit::disable()
+{
+    sEnabled.store(false, std::memory_order_relaxed);
+    for (auto& shard : mShards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.records.clear();
+    }
+}
+
+AllocationAudit::Shard& AllocationAudit::getShard(void* ptr)
+{
+    // Allocations are aligned to as much as 2 MB, so take the shard from the high bits of a Fibonacci hash
+    auto const hash = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(ptr)) * 0x9e3779b97f4a7c15ULL;
+    return mShards[hash >> (64 - 4)];
+}
+
+void AllocationAudit::recordAllocation(void* ptr, std::size_t size, MemoryType memoryType, MemoryTag tag)
+{
+    if (ptr == nullptr || suppressed() > 0)
+    {
+        return;
+    }
+    Record record{Site{}, size, Clock::now()};
+#if !defined(_MSC_VER)
+    // Captured here rather than in a helper so that exactly one frame, this one, is skipped
+    if (auto const numFrames = mNumFrames.load(std::memory_order_relaxed); numFrames > 0)
+    {
+        std::size_t captured = 0;
+#if defined(TLLM_AUDIT_FRAME_POINTERS)
+        // The first frame walked is the return address into our caller
+        captured = walkFramePointers(__builtin_frame_address(0), record.site.frames.data(), numFrames);
+#endif
+        // A short chain means a caller was built without frame pointers, unwinding is slower but complete
+        if (captured < numFrames)
+        {
+            std::array<void*, kMaxFrames + 1> frames{};
+            captured = static_cast<std::size_t>(backtrace(frames.data(), static_cast<int>(numFrames + 1)));
+            captured = captured > 1 ? captured - 1 : 0;
+            std::copy_n(frames.begin() + 1, captured, record.site.frames.begin());
+        }
+        record.site.numFrames = captured;
+    }
+#endif
+    record.site.memoryType = memoryType;
+    record.site.tag = tag;
+    auto& shard = getShard(ptr);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.records.insert_or_assign(ptr, record);
+}
+
+void AllocationAudit::recordDeallocation(void* ptr)
+{
+    auto& shard = getShard(ptr);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.records.erase(ptr);
+}
+
+AllocationAudit::Snapshot AllocationAudit::snapshot() const
+{
+    Snapshot snapshot{Clock::now(), {}};
+    std::unordered_map<Site, SiteUsage, SiteHash> usages;
+    for (auto const& shard : mShards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto const& [ptr, record] : shard.records)
+        {
+            auto [it, inserted] = usages.try_emplace(record.site, SiteUsage{record.site, 0, 0, record.time});
+            auto& usage = it->second;
+            ++usage.count;
+            usage.bytes += record.size;
+            usage.oldest = std::min(usage.oldest, record.time);
+        }
+    }
+    snapshot.sites.reserve(usages.size());
+    for (auto& [site, usage] : usages)
+    {
+        snapshot.sites.push_back(std::move(usage));
+    }
+    std::sort(snapshot.sites.begin(), snapshot.sites.end(),
+        [](SiteUsage const& lhs, SiteUsage const& rhs) { return lhs.bytes > rhs.bytes; });
+    return snapshot;
+}
+
+AllocationAudit::SnapshotDiff AllocationAudit::diff(Snapshot const& before, Snapshot const& after)
+{
+    std::unordered_map<Site, SiteDiff, SiteHash> diffs;
+    for (auto const& usage : after.sites)
+    {
+        diffs.try_emplace(usage.site, SiteDiff{usage.site, static_cast<std::ptrdiff_t>(usage.count),
+                                          static_cast<std::ptrdiff_t>(usage.bytes)});
+    }
+    for (auto const& usage : before.sites)
+    {
+        auto [it, inserted] = diffs.try_emplace(usage.site, SiteDiff{usage.site, 0, 0});
+        it->second.count -= static_cast<std::ptrdiff_t>(usage.count);
+        it->second.bytes -= static_cast<std::ptrdiff_t>(usage.bytes);
+    }
+    SnapshotDiff result{after.time - before.time, {}};
+    for (auto& [site, siteDiff] : diffs)
+    {
+        if (siteDiff.count != 0 || siteDiff.bytes != 0)
+        {
+            result.sites.push_back(std::move(siteDiff));
+        }
+    }
+    std::sort(result.sites.begin(), result.sites.end(),
+        [](SiteDiff const& lhs, SiteDiff const& rhs) { return std::abs(lhs.bytes) > std::abs(rhs.bytes); });
+    return result;
+}
+
+} // namespace tensorrt_llm::runtime
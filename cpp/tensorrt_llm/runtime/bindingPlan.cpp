@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "bindingPlan.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace tensorrt_llm::runtime;
+
+BindingPlan::BindingPlan(std::vector<IOTensorDesc> tensors)
+    : mTensors{std::move(tensors)}
+{
+    mSlotByName.reserve(mTensors.size());
+    for (SizeType slot = 0; slot < getNbSlots(); ++slot)
+    {
+        auto const& desc = mTensors[slot];
+        TLLM_CHECK_WITH_INFO(
+            mSlotByName.emplace(desc.name, slot).second, "Duplicate engine I/O tensor '%s'", desc.name.c_str());
+        if (desc.ioMode == nvinfer1::TensorIOMode::kINPUT)
+        {
+            mInputSlots.push_back(slot);
+        }
+        else if (desc.ioMode == nvinfer1::TensorIOMode::kOUTPUT)
+        {
+            mOutputSlots.push_back(slot);
+        }
+    }
+}
+
+std::vector<IOTensorDesc> BindingPlan::describeEngine(nvinfer1::ICudaEngine const& engine)
+{
+    std::vector<IOTensorDesc> tensors;
+    tensors.reserve(engine.getNbIOTensors());
+    for (std::int32_t i = 0; i < engine.getNbIOTensors(); ++i)
+    {
+        auto const* const name = engine.getIOTensorName(i);
+        tensors.push_back(IOTensorDesc{name, engine.getTensorIOMode(name), engine.getTensorDataType(name),
+            engine.getTensorShape(name), engine.isShapeInferenceIO(name)});
+    }
+    return tensors;
+}
+
+SizeType BindingPlan::findSlot(std::string const& name) const
+{
+    auto const pos = mSlotByName.find(name);
+    return pos != mSlotByName.end() ? pos->second : kNoSlot;
+}
+
+void BindingPlan::validateDataType(SizeType slot, ITensor const& tensor) const
+{
+    auto const& desc = mTensors.at(slot);
+    auto const tensorDtype = tensor.getDataType();
+    auto const engineDtype = desc.dataType;
+    // WAR: TRT does not support mixed FP8 and FP16 input, so engine expects FP16 tensors.
+    TLLM_CHECK_WITH_INFO(tensorDtype == engineDtype
+            || (tensorDtype == nvinfer1::DataType::kFP8 && engineDtype == nvinfer1::DataType::kHALF),
+        "%s: expected type %d, provided type %d", desc.name.c_str(), static_cast<std::int32_t>(engineDtype),
+        static_cast<std::int32_t>(tensorDtype));
+}
+
+void BindingPlan::validateInput(SizeType slot, ITensor const& tensor) const
+{
+    validateDataType(slot, tensor);
+    auto const& desc = mTensors.at(slot);
+    auto const* const name = desc.name.c_str();
+    auto const& shapeExpected = desc.shape;
+    auto const& shapeProvided = tensor.getShape();
+    TLLM_CHECK_WITH_INFO(shapeExpected.nbDims == shapeProvided.nbDims, "%s: expected %d dims, provided %d dims", name,
+        shapeExpected.nbDims, shapeProvided.nbDims);
+    for (SizeType j = 0; j < shapeExpected.nbDims; ++j)
+    {
+        auto const dimExpected = shapeExpected.d[j];
+        auto const dimProvided = shapeProvided.d[j];
+        if (dimExpected >= 0 && dimExpected != dimProvided)
+        {
+            TLLM_LOG_WARNING("%s: expected dim[%d] = %d, provided dim[%d] = %d", name, j, dimExpected, j, dimProvided);
+        }
+    }
+}
+
+void BindingPlan::validateOutput(SizeType slot, ITensor const& tensor) const
+{
+    validateDataType(slot, tensor);
+}
+
+BindingPlan::Bindings::Change BindingPlan::Bindings::compare(
+    SizeType slot, void const* data, nvinfer1::DataType dataType, nvinfer1::Dims const& shape) const
+{
+    auto const& bound = mBound.at(slot);
+    if (!bound.valid)
+    {
+        return {true, true};
+    }
+    return {bound.data != data, bound.dataType != dataType || !ITensor::shapeEquals(bound.shape, shape)};
+}
+
+void BindingPlan::Bindings::set(
+    SizeType slot, void const* data, nvinfer1::DataType dataType, nvinfer1::Dims const& shape)
+{
+    auto& bound = mBound.at(slot);
+    bound.valid = true;
+    bound.data = data;
+    bound.dataType = dataType;
+    bound.shape = shape;
+}
+
+void BindingPlan::Bindings::clear()
+{
+    std::fill(mBound.begin(), mBound.end(), Bound{});
+}
+
+nvinfer1::Dims const* BindingPlan::Bindings::getOutputShape(SizeType slot) const
+{
+    auto const& bound = mBound.at(slot);
+    return bound.outputShapeValid ? &bound.outputShape : nullptr;
+}
+
+void BindingPlan::Bindings::setOutputShape(SizeType slot, nvinfer1::Dims const& shape)
+{
+    auto& bound = mBound.at(slot);
+    bound.outputShapeValid = true;
+    bound.outputShape = shape;
+}
+
+void BindingPlan::Bindings::clearOutputShapes()
+{
+    for (auto& bound : mBound)
+    {
+        bound.outputShapeValid = false;
+    }
+}
+
+TensorMapSlots::TensorSlots& TensorMapSlots::update(BindingPlan const& plan, TensorMap const& tensorMap)
+{
+    auto const nbSlots = static_cast<std::size_t>(plan.getNbSlots());
+    if (&plan != mPlan || &tensorMap != mMap || tensorMap.size() != mMapSize)
+    {
+        mPlan = &plan;
+        mMap = &tensorMap;
+        mMapSize = tensorMap.size();
+        mEntries.assign(nbSlots, nullptr);
+        for (std::size_t slot = 0; slot < nbSlots; ++slot)
+        {
+            auto const pos = tensorMap.find(plan.getTensorDesc(static_cast<SizeType>(slot)).name);
+            if (pos != tensorMap.end())
+            {
+                mEntries[slot] = &pos->second;
+            }
+        }
+    }
+    mSlots.resize(nbSlots);
+    for (std::size_t slot = 0; slot < nbSlots; ++slot)
+    {
+        auto const* const entry = mEntries[slot];
+        mSlots[slot] = entry != nullptr ? *entry : nullptr;
+    }
+    return mSlots;
+}
+
+void TensorMapSlots::storeMissing(TensorMap& tensorMap) const
+{
+    TLLM_CHECK_WITH_INFO(&tensorMap == mMap, "Slots were updated from another map");
+    for (std::size_t slot = 0; slot < mEntries.size(); ++slot)
+    {
+        if (mEntries[slot] == nullptr && mSlots[slot])
+        {
+            // Changes the size of the map, so the next update() looks it up again
+            tensorMap.emplace(mPlan->getTensorDesc(static_cast<SizeType>(slot)).name, mSlots[slot]);
+        }
+    }
+}
+
+void TensorMapSlots::release()
+{
+    mSlots.clear();
+}
+
+void TensorMapSlots::clear()
+{
+    mPlan = nullptr;
+    mMap = nullptr;
+    mMapSize = 0;
+    mEntries.clear();
+    mSlots.clear();
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "tensorrt_llm/runtime/common.h"
+#include "tensorrt_llm/runtime/iTensor.h"
+#include <NvInferRuntime.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Name, direction, data type and shape of an engine I/O tensor. Dynamic dims are -1.
+struct IOTensorDesc
+{
+    std::string name;
+    nvinfer1::TensorIOMode ioMode;
+    nvinfer1::DataType dataType;
+    nvinfer1::Dims shape;
+    //! \brief The values of the tensor are read by shape inference, so binding it always infers shapes again.
+    bool isShapeInferenceIO{false};
+};
+
+//! \brief The I/O tensors of an engine resolved once to integer slots, in the engine's order.
+//!
+//! \details TllmRuntime binds tensors by slot, so that a step does not have to query the engine by name, and keeps
+//!          Bindings per execution context to only validate and set what changed since the previous step.
+class BindingPlan
+{
+public:
+    using TensorPtr = ITensor::SharedPtr;
+    using TensorMap = StringPtrMap<ITensor>;
+    //! \brief Tensors indexed by slot, nullptr where there is none.
+    using TensorSlots = std::vector<TensorPtr>;
+
+    static SizeType constexpr kNoSlot{-1};
+
+    explicit BindingPlan(std::vector<IOTensorDesc> tensors);
+
+    //! \brief The I/O tensors of `engine`, the descriptor a plan is built from.
+    [[nodiscard]] static std::vector<IOTensorDesc> describeEngine(nvinfer1::ICudaEngine const& engine);
+
+    [[nodiscard]] SizeType getNbSlots() const
+    {
+        return static_cast<SizeType>(mTensors.size());
+    }
+
+    [[nodiscard]] IOTensorDesc const& getTensorDesc(SizeType slot) const
+    {
+        return mTensors.at(slot);
+    }
+
+    [[nodiscard]] std::vector<SizeType> const& getInputSlots() const
+    {
+        return mInputSlots;
+    }
+
+    [[nodiscard]] std::vector<SizeType> const& getOutputSlots() const
+    {
+        return mOutputSlots;
+    }
+
+    //! \brief The slot of tensor `name`, or kNoSlot if the engine has none.
+    [[nodiscard]] SizeType findSlot(std::string const& name) const;
+
+    //! \brief Throws if `tensor` does not have the data type and rank of input `slot`, and warns about static dims it
+    //!        does not match.
+    void validateInput(SizeType slot, ITensor const& tensor) const;
+
+    //! \brief Throws if `tensor` does not have the data type of output `slot`.
+    void validateOutput(SizeType slot, ITensor const& tensor) const;
+
+    //! \brief What was last bound to each slot of one execution context.
+    class Bindings
+    {
+    public:
+        struct Change
+        {
+            bool address{false};
+            //! \brief The shape or data type changed, so the binding must be validated again.
+            bool shape{false};
+        };
+
+        explicit Bindings(SizeType nbSlots)
+            : mBound(static_cast<std::size_t>(nbSlots))
+        {
+        }
+
+        //! \brief How binding `data` with `dataType` and `shape` to `slot` differs from what is bound.
+        [[nodiscard]] Change compare(
+            SizeType slot, void const* data, nvinfer1::DataType dataType, nvinfer1::Dims const& shape) const;
+
+        //! \brief Records a binding after it was validated and set on the context.
+        void set(SizeType slot, void const* data, nvinfer1::DataType dataType, nvinfer1::Dims const& shape);
+
+        //! \brief Forgets all bindings, so that the next ones are validated and set again.
+        void clear();
+
+        //! \brief The shape the context reported for output `slot` after the last shape inference, if any.
+        [[nodiscard]] nvinfer1::Dims const* getOutputShape(SizeType slot) const;
+
+        void setOutputShape(SizeType slot, nvinfer1::Dims const& shape);
+
+        //! \brief Forgets the output shapes, to be queried again after the input shapes changed.
+        void clearOutputShapes();
+
+    private:
+        struct Bound
+        {
+            bool valid{false};
+            void const* data{nullptr};
+            nvinfer1::DataType dataType{};
+            nvinfer1::Dims shape{};
+            bool outputShapeValid{false};
+            nvinfer1::Dims outputShape{};
+        };
+
+        std::vector<Bound> mBound;
+    };
+
+private:
+    void validateDataType(SizeType slot, ITensor const& tensor) const;
+
+    std::vector<IOTensorDesc> mTensors;
+    std::vector<SizeType> mInputSlots;
+    std::vector<SizeType> mOutputSlots;
+    std::unordered_map<std::string, SizeType> mSlotByName;
+};
+
+//! \brief The tensors of one TensorMap by slot of a BindingPlan, for the slot overloads of TllmRuntime.
+//!
+//! \details The map is looked up by name when it is first updated and again only after it gained entries. Otherwise
+//!          update() reads each slot's tensor through a pointer to its map entry, which stays valid while entries are
+//!          only added or replaced. Call release() after binding and clear() when the map is cleared or loses
+//!          entries. A copy starts cleared, as it would point into the copied map.
+class TensorMapSlots
+{
+public:
+    using TensorMap = BindingPlan::TensorMap;
+    using TensorSlots = BindingPlan::TensorSlots;
+
+    TensorMapSlots() = default;
+
+    TensorMapSlots(TensorMapSlots const&) {}
+
+    TensorMapSlots& operator=(TensorMapSlots const&)
+    {
+        clear();
+        return *this;
+    }
+
+    //! \brief The tensors of `tensorMap` by slot of `plan`, nullptr where the map has none. The slots may be set, for
+    //!        outputs TllmRuntime allocates, until the next update().
+    [[nodiscard]] TensorSlots& update(BindingPlan const& plan, TensorMap const& tensorMap);
+
+    //! \brief Adds the tensors set in slots that `tensorMap` has no entry for since update() to it.
+    void storeMissing(TensorMap& tensorMap) const;
+
+    //! \brief Drops the references to the tensors once they are bound, keeping the resolved entries. Until then the
+    //!        slots share the views in the map, which utils::updateTensorView only reshapes in place when the map
+    //!        holds the only reference.
+    void release();
+
+    //! \brief Forgets the map and releases the tensors.
+    void clear();
+
+private:
+    BindingPlan const* mPlan{nullptr};
+    TensorMap const* mMap{nullptr};
+    std::size_t mMapSize{0};
+    //! \brief The map entry of each slot, nullptr where there is none.
+    std::vector<BindingPlan::TensorPtr const*> mEntries;
+    TensorSlots mSlots;
+};
+
+} // namespace tensorrt_llm::runtime
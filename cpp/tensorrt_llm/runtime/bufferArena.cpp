@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/bufferArena.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tllmBuffers.h"
+
+#include <algorithm>
+
+using namespace tensorrt_llm::runtime;
+
+namespace tc = tensorrt_llm::common;
+
+BufferArena::BufferArena(MemoryType memoryType, std::size_t blockSize, CudaStreamPtr stream)
+    : mMemoryType{memoryType}
+    , mBlockSize{blockSize}
+    , mStream{std::move(stream)}
+{
+    TLLM_CHECK_WITH_INFO(memoryType != MemoryType::kGPU || static_cast<bool>(mStream), "Undefined CUDA stream");
+}
+
+void* BufferArena::allocate(std::size_t size)
+{
+    // Like MemoryPool, a request of 0 B still gets a distinct pointer
+    auto const alignedSize = size == 0 ? kAlignment : tc::ceilDiv(size, kAlignment) * kAlignment;
+    if (mBlocks.empty() || mOffset + alignedSize > mBlocks.back()->getSize())
+    {
+        auto const blockSize = std::max(mBlockSize, alignedSize);
+        mBlocks.push_back(allocateBlock(blockSize));
+        mOffset = 0;
+        mReservedSize += blockSize;
+    }
+    auto* const ptr = static_cast<std::uint8_t*>(mBlocks.back()->data()) + mOffset;
+    mOffset += alignedSize;
+    mUsedSize += alignedSize;
+    return ptr;
+}
+
+IBuffer::UniquePtr BufferArena::allocateBlock(std::size_t size) const
+{
+    auto constexpr type = nvinfer1::DataType::kUINT8;
+    // Blocks may be added later by another subsystem's code, e.g. when an output grows
+    MemoryTagScope const memoryTag{mMemoryTag};
+    switch (mMemoryType)
+    {
+    case MemoryType::kCPU: return std::make_unique<HostBuffer>(size, type);
+    case MemoryType::kGPU: return std::make_unique<DeviceBuffer>(size, type, CudaAllocatorAsync{mStream});
+    case MemoryType::kPINNED: return std::make_unique<PinnedPoolBuffer>(size, type);
+    case MemoryType::kUVM: return std::make_unique<UVMBuffer>(size, type);
+    }
+    TLLM_THROW("Unknown memory type");
+}
@@ -17,6 +17,7 @@
 #include "tensorrt_llm/common/assert.h"
 #include "tllmBuffers.h"
 
+#include <atomic>
 #include <cstring>
 #include <cuda_runtime_api.h>
 #include <limits>
@@ -27,6 +28,13 @@ using namespace tensorrt_llm::runtime;
 
 namespace tc = tensorrt_llm::common;
 
+namespace
+{
+// Read on every cpu() and pinned() call, so a snapshot that is read without a lock
+std::atomic<HostMemoryPolicy> gHostMemoryPolicy{HostMemoryPolicy{}};
+static_assert(std::atomic<HostMemoryPolicy>::is_always_lock_free, "HostMemoryPolicy must fit into a lock-free atomic");
+} // namespace
+
 BufferManager::BufferManager(CudaStreamPtr stream, bool trimPool)
     : mStream{std::move(stream)}
     , mTrimPool{trimPool}
@@ -63,21 +71,37 @@ BufferManager::ITensorPtr BufferManager::gpuSync(nvinfer1::Dims dims, nvinfer1::
 
 BufferManager::IBufferPtr BufferManager::cpu(std::size_t size, nvinfer1::DataType type)
 {
+    if (auto const policy = getHostMemoryPolicy(); !policy.isDefault())
+    {
+        return std::make_unique<PlacedHostBuffer>(size, type, PlacedCpuAllocator{policy});
+    }
     return std::make_unique<HostBuffer>(size, type);
 }
 
 BufferManager::ITensorPtr BufferManager::cpu(nvinfer1::Dims dims, nvinfer1::DataType type)
 {
+    if (auto const policy = getHostMemoryPolicy(); !policy.isDefault())
+    {
+        return std::make_unique<PlacedHostTensor>(dims, type, PlacedCpuAllocator{policy});
+    }
     return std::make_unique<HostTensor>(dims, type);
 }
 
 BufferManager::IBufferPtr BufferManager::pinned(std::size_t size, nvinfer1::DataType type)
 {
+    if (auto const policy = getHostMemoryPolicy(); !policy.isDefault())
+    {
+        return std::make_unique<PlacedPinnedBuffer>(size, type, PlacedPinnedAllocator{policy});
+    }
     return std::make_unique<PinnedBuffer>(size, type);
 }
 
 BufferManager::ITensorPtr BufferManager::pinned(nvinfer1::Dims dims, nvinfer1::DataType type)
 {
+    if (auto const policy = getHostMemoryPolicy(); !policy.isDefault())
+    {
+        return std::make_unique<PlacedPinnedTensor>(dims, type, PlacedPinnedAllocator{policy});
+    }
     return std::make_unique<PinnedTensor>(dims, type);
 }
 
@@ -185,6 +209,56 @@ BufferManager::ITensorPtr BufferManager::allocate(
     TLLM_THROW("Unknown memory type");
 }
 
+BufferArena::SharedPtr BufferManager::createArena(MemoryType memoryType, std::size_t blockSize) const
+{
+    return std::make_shared<BufferArena>(memoryType, blockSize, mStream);
+}
+
+CopyBatch::UniquePtr BufferManager::createCopyBatch() const
+{
+    return std::make_unique<CopyBatch>(mStream);
+}
+
+BufferManager::IBufferPtr BufferManager::allocate(
+    BufferArena::SharedPtr const& arena, std::size_t size, nvinfer1::DataType type)
+{
+    TLLM_CHECK_WITH_INFO(static_cast<bool>(arena), "Undefined arena");
+    switch (arena->getMemoryType())
+    {
+    case MemoryType::kCPU:
+        return std::make_unique<HostArenaBuffer>(size, type, ArenaAllocator<MemoryType::kCPU>{arena});
+    case MemoryType::kGPU:
+        return std::make_unique<DeviceArenaBuffer>(size, type, ArenaAllocator<MemoryType::kGPU>{arena});
+    case MemoryType::kPINNED:
+        return std::make_unique<PinnedArenaBuffer>(size, type, ArenaAllocator<MemoryType::kPINNED>{arena});
+    case MemoryType::kUVM:
+        return std::make_unique<GenericBuffer<ArenaAllocator<MemoryType::kUVM>>>(
+            size, type, ArenaAllocator<MemoryType::kUVM>{arena});
+    }
+
+    TLLM_THROW("Unknown memory type");
+}
+
+BufferManager::ITensorPtr BufferManager::allocate(
+    BufferArena::SharedPtr const& arena, nvinfer1::Dims dims, nvinfer1::DataType type)
+{
+    TLLM_CHECK_WITH_INFO(static_cast<bool>(arena), "Undefined arena");
+    switch (arena->getMemoryType())
+    {
+    case MemoryType::kCPU:
+        return std::make_unique<HostArenaTensor>(dims, type, ArenaAllocator<MemoryType::kCPU>{arena});
+    case MemoryType::kGPU:
+        return std::make_unique<DeviceArenaTensor>(dims, type, ArenaAllocator<MemoryType::kGPU>{arena});
+    case MemoryType::kPINNED:
+        return std::make_unique<PinnedArenaTensor>(dims, type, ArenaAllocator<MemoryType::kPINNED>{arena});
+    case MemoryType::kUVM:
+        return std::make_unique<GenericTensor<ArenaAllocator<MemoryType::kUVM>>>(
+            dims, type, ArenaAllocator<MemoryType::kUVM>{arena});
+    }
+
+    TLLM_THROW("Unknown memory type");
+}
+
 BufferManager::IBufferPtr BufferManager::copyFrom(IBuffer const& src, MemoryType memoryType) const
 {
     auto dst = allocate(memoryType, src.getSize(), src.getDataType());
@@ -279,3 +353,36 @@ void BufferManager::memoryPoolTrimTo(std::size_t size)
     mStream->synchronize();
     memoryPoolTrimTo(mStream->getDevice(), size);
 }
+
+std::size_t BufferManager::pinnedPoolTrimTo(std::size_t size)
+{
+    PinnedPoolAllocator::requestFlushAll();
+    return PinnedPoolAllocator::getPool().trimTo(size);
+}
+
+void BufferManager::pinnedPoolSetIdleTimeout(std::chrono::milliseconds timeout)
+{
+    PinnedPoolAllocator::getPool().setIdleTimeout(timeout);
+}
+
+std::size_t BufferManager::pinnedPoolTrimIdle()
+{
+    PinnedPoolAllocator::requestFlushAll();
+    return PinnedPoolAllocator::getPool().trimIdle();
+}
+
+MemoryPoolReport BufferManager::pinnedPoolReport()
+{
+    return PinnedPoolAllocator::getPool().getReport();
+}
+
+void BufferManager::setHostMemoryPolicy(HostMemoryPolicy const& policy)
+{
+    TLLM_CHECK_WITH_INFO(policy.numaNode >= HostMemoryPolicy::kAnyNode, "Invalid NUMA node %d", policy.numaNode);
+    gHostMemoryPolicy.store(policy, std::memory_order_release);
+}
+
+HostMemoryPolicy BufferManager::getHostMemoryPolicy()
+{
+    return gHostMemoryPolicy.load(std::memory_order_acquire);
+}
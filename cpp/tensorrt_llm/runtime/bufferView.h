@@ -89,6 +89,17 @@ public:
         mSize = 0;
     }
 
+    //! \brief The buffer this is a view of.
+    [[nodiscard]] IBuffer::SharedPtr const& getBuffer() const
+    {
+        return mBuffer;
+    }
+
+    [[nodiscard]] std::size_t getOffset() const
+    {
+        return mOffset;
+    }
+
     ~BufferView() override = default;
 
 private:
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/copyBatch.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/runtime/copyBatchPlanner.h"
+#include "tensorrt_llm/runtime/runtimeKernels.h"
+#include "tllmBuffers.h"
+
+#include <cstring>
+
+using namespace tensorrt_llm::runtime;
+
+namespace tc = tensorrt_llm::common;
+
+CopyBatch::CopyBatch(CudaStreamPtr stream)
+    : mStream{std::move(stream)}
+{
+    TLLM_CHECK_WITH_INFO(static_cast<bool>(mStream), "Undefined CUDA stream");
+}
+
+CopyBatch::~CopyBatch()
+{
+    if (mStagingInUse)
+    {
+        try
+        {
+            mStagingDone.synchronize();
+        }
+        catch (std::exception const& e)
+        {
+            TLLM_LOG_EXCEPTION(e);
+        }
+    }
+}
+
+void CopyBatch::add(void const* src, void* dst, std::size_t size)
+{
+    TLLM_CHECK_WITH_INFO(IBuffer::memoryType(dst) == MemoryType::kGPU, "CopyBatch copies to device memory only");
+    mRegions.push_back({src, dst, size});
+}
+
+void CopyBatch::add(void const* src, IBuffer& dst)
+{
+    add(src, dst.getSizeInBytes(), dst);
+}
+
+void CopyBatch::add(IBuffer const& src, IBuffer& dst)
+{
+    TLLM_CHECK_WITH_INFO(src.getMemoryType() != MemoryType::kGPU, "CopyBatch copies from host memory only");
+    add(src.data(), src.getSizeInBytes(), dst);
+}
+
+void CopyBatch::add(void const* src, std::size_t size, IBuffer& dst)
+{
+    TLLM_CHECK_WITH_INFO(dst.getMemoryType() == MemoryType::kGPU, "CopyBatch copies to device memory only");
+    TLLM_CHECK_WITH_INFO(size == dst.getSizeInBytes(), "Incompatible buffer sizes %zu and %zu", size,
+        dst.getSizeInBytes());
+    mRegions.push_back({src, dst.data(), size});
+}
+
+void CopyBatch::execute()
+{
+    if (mRegions.empty())
+    {
+        return;
+    }
+    std::vector<CopyBatchPlanner::Region> regions;
+    regions.reserve(mRegions.size());
+    for (auto const& region : mRegions)
+    {
+        regions.push_back({region.src, region.dst, region.size});
+    }
+    mRegions.clear();
+    auto const plan = CopyBatchPlanner::plan(std::move(regions));
+    mNumTransfers = plan.transfers.size();
+    if (plan.transfers.empty())
+    {
+        mOwnedSources.clear();
+        return;
+    }
+
+    // A single transfer goes straight to its destination, more are scattered on the device using a table in front
+    auto const scatter = plan.transfers.size() > 1;
+    auto constexpr alignment = CopyBatchPlanner::kAlignment;
+    auto const tableSize = scatter
+        ? tc::ceilDiv(plan.transfers.size() * sizeof(kernels::ScatterCopyRegion), alignment) * alignment
+        : 0;
+    auto const stagingSize = tableSize + plan.stagingSize;
+
+    if (mStagingInUse)
+    {
+        mStagingDone.synchronize();
+        mStagingInUse = false;
+    }
+    if (!mStaging || mStaging->getCapacity() < stagingSize)
+    {
+        mStaging.reset();
+        mStaging = std::make_unique<PinnedPoolBuffer>(stagingSize, nvinfer1::DataType::kUINT8);
+    }
+    else
+    {
+        mStaging->resize(stagingSize);
+    }
+    auto* const staging = static_cast<std::uint8_t*>(mStaging->data());
+    for (auto const& gather : plan.gathers)
+    {
+        std::memcpy(staging + tableSize + gather.offset, gather.src, gather.size);
+    }
+    mOwnedSources.clear();
+
+    auto const cudaStream = mStream->get();
+    if (!scatter)
+    {
+        auto const& transfer = plan.transfers.front();
+        TLLM_CUDA_CHECK(cudaMemcpyAsync(
+            transfer.dst, staging + tableSize + transfer.offset, transfer.size, cudaMemcpyHostToDevice, cudaStream));
+    }
+    else
+    {
+        auto* const table = reinterpret_cast<kernels::ScatterCopyRegion*>(staging);
+        for (std::size_t i = 0; i < plan.transfers.size(); ++i)
+        {
+            auto const& transfer = plan.transfers[i];
+            table[i] = {reinterpret_cast<std::uint64_t>(transfer.dst), tableSize + transfer.offset, transfer.size};
+        }
+        // Only used on mStream, so the next copy into it is ordered after this scatter. A smaller one is freed in
+        // stream order once the scatter has read it.
+        if (!mScratch || mScratch->getCapacity() < stagingSize)
+        {
+            mScratch.reset();
+            mScratch
+                = std::make_unique<DeviceBuffer>(stagingSize, nvinfer1::DataType::kUINT8, CudaAllocatorAsync{mStream});
+        }
+        else
+        {
+            mScratch->resize(stagingSize);
+        }
+        TLLM_CUDA_CHECK(cudaMemcpyAsync(mScratch->data(), staging, stagingSize, cudaMemcpyHostToDevice, cudaStream));
+        kernels::invokeScatterCopy(*mScratch, plan.transfers.size(), plan.maxTransferSize, *mStream);
+    }
+    mStream->record(mStagingDone);
+    mStagingInUse = true;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/copyBatchPlanner.h"
+#include "tensorrt_llm/common/assert.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+std::uintptr_t address(void const* ptr)
+{
+    return reinterpret_cast<std::uintptr_t>(ptr);
+}
+
+void addGather(CopyBatchPlanner::Plan& plan, void const* src, std::size_t offset, std::size_t size)
+{
+    if (!plan.gathers.empty())
+    {
+        auto& last = plan.gathers.back();
+        if (address(last.src) + last.size == address(src) && last.offset + last.size == offset)
+        {
+            last.size += size;
+            return;
+        }
+    }
+    plan.gathers.push_back({src, offset, size});
+}
+} // namespace
+
+CopyBatchPlanner::Plan CopyBatchPlanner::plan(std::vector<Region> regions)
+{
+    regions.erase(
+        std::remove_if(regions.begin(), regions.end(), [](auto const& region) { return region.size == 0; }),
+        regions.end());
+    std::sort(regions.begin(), regions.end(),
+        [](auto const& lhs, auto const& rhs) { return address(lhs.dst) < address(rhs.dst); });
+
+    Plan plan;
+    for (auto const& region : regions)
+    {
+        auto const dst = address(region.dst);
+        if (!plan.transfers.empty())
+        {
+            auto& last = plan.transfers.back();
+            auto const lastEnd = address(last.dst) + last.size;
+            TLLM_CHECK_WITH_INFO(lastEnd <= dst, "Copy destinations %p and %p overlap", last.dst, region.dst);
+            if (lastEnd == dst)
+            {
+                addGather(plan, region.src, last.offset + last.size, region.size);
+                last.size += region.size;
+                plan.stagingSize += region.size;
+                plan.maxTransferSize = std::max(plan.maxTransferSize, last.size);
+                continue;
+            }
+        }
+        // The next offset congruent to the destination
+        auto const offset = plan.stagingSize + ((dst - plan.stagingSize) & (kAlignment - 1));
+        plan.transfers.push_back({offset, region.dst, region.size});
+        addGather(plan, region.src, offset, region.size);
+        plan.stagingSize = offset + region.size;
+        plan.maxTransferSize = std::max(plan.maxTransferSize, region.size);
+    }
+    return plan;
+}
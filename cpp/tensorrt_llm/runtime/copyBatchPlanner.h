@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace tensorrt_llm::runtime
+{
+
+//! \brief Lays out a batch of host to device copies in one staging buffer.
+//!
+//! \details Regions are ordered by destination, and regions whose destinations are adjacent share one transfer, so
+//!          that the staging buffer can be sent with a single copy and scattered with one entry per transfer. Sources
+//!          that are adjacent as well are gathered with a single memcpy. Each transfer starts at a staging offset
+//!          congruent to its destination modulo kAlignment, which lets the scatter use vector loads and stores. Host
+//!          code only, so the plan can be checked without a GPU.
+class CopyBatchPlanner
+{
+public:
+    static std::size_t constexpr kAlignment{16};
+
+    //! \brief `size` bytes to copy from host `src` to device `dst`.
+    struct Region
+    {
+        void const* src;
+        void* dst;
+        std::size_t size;
+    };
+
+    //! \brief A host copy from `src` into the staging buffer at `offset`.
+    struct Gather
+    {
+        void const* src;
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    //! \brief A copy from the staging buffer at `offset` to the device at `dst`.
+    struct Transfer
+    {
+        std::size_t offset;
+        void* dst;
+        std::size_t size;
+    };
+
+    struct Plan
+    {
+        std::vector<Gather> gathers;
+        std::vector<Transfer> transfers;
+        std::size_t stagingSize{0};
+        std::size_t maxTransferSize{0};
+    };
+
+    //! \brief Plans the copies of `regions`, skipping empty ones. Throws if destinations overlap.
+    [[nodiscard]] static Plan plan(std::vector<Region> regions);
+};
+
+} // namespace tensorrt_llm::runtime
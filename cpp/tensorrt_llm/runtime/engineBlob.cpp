@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/engineBlob.h"
+
+#include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#if defined(_WIN32)
+#include <filesystem>
+#include <functional>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tensorrt_llm::runtime
+{
+
+namespace
+{
+
+char const* loadModeToString(EngineBlob::LoadMode mode)
+{
+    switch (mode)
+    {
+    case EngineBlob::LoadMode::kREAD: return "read";
+    case EngineBlob::LoadMode::kMMAP: return "mmap";
+    case EngineBlob::LoadMode::kDIRECT: return "direct";
+    }
+    return "unknown";
+}
+
+#if !defined(_WIN32)
+// Closes a file descriptor when leaving scope
+class FileDescriptor
+{
+public:
+    explicit FileDescriptor(int fd)
+        : mFd{fd}
+    {
+    }
+
+    ~FileDescriptor()
+    {
+        if (mFd >= 0)
+        {
+            ::close(mFd);
+        }
+    }
+
+    FileDescriptor(FileDescriptor const&) = delete;
+    FileDescriptor& operator=(FileDescriptor const&) = delete;
+
+    [[nodiscard]] int get() const
+    {
+        return mFd;
+    }
+
+private:
+    int mFd;
+};
+
+// O_DIRECT requires the buffer, offsets and sizes to be aligned to the logical block size of the device
+std::size_t constexpr kDirectAlignment{4096};
+std::size_t constexpr kDirectChunkSize{64 << 20};
+#endif
+
+} // namespace
+
+EngineBlob::EngineBlob(LoadMode loadMode, FileId const& fileId)
+    : mLoadMode{loadMode}
+    , mFileId{fileId}
+{
+}
+
+EngineBlob::~EngineBlob()
+{
+#if !defined(_WIN32)
+    if (mMapping != nullptr)
+    {
+        ::munmap(mMapping, mSize);
+    }
+#endif
+    std::free(mDirectBuffer);
+}
+
+std::optional<EngineBlob::LoadMode> EngineBlob::parseLoadMode(std::string_view name)
+{
+    if (name == "read")
+    {
+        return LoadMode::kREAD;
+    }
+    if (name == "mmap")
+    {
+        return LoadMode::kMMAP;
+    }
+    if (name == "direct")
+    {
+        return LoadMode::kDIRECT;
+    }
+    return std::nullopt;
+}
+
+EngineBlob::LoadMode EngineBlob::getDefaultLoadMode()
+{
+    auto const* const name = std::getenv("TLLM_ENGINE_LOAD_MODE");
+    if (name == nullptr || *name == '\0')
+    {
+        return LoadMode::kREAD;
+    }
+    auto const mode = parseLoadMode(name);
+    if (!mode)
+    {
+        TLLM_LOG_WARNING("Unknown TLLM_ENGINE_LOAD_MODE %s, expected read, mmap or direct", name);
+        return LoadMode::kREAD;
+    }
+    return *mode;
+}
+
+EngineBlob::FileId EngineBlob::getFileId(std::string const& path)
+{
+    FileId fileId;
+#if defined(_WIN32)
+    std::error_code error;
+    auto const canonical = std::filesystem::canonical(path, error);
+    TLLM_CHECK_WITH_INFO(!error, "Error opening engine file: %s", path.c_str());
+    fileId.inode = std::hash<std::string>{}(canonical.string());
+    fileId.size = std::filesystem::file_size(canonical);
+    auto const modified = std::filesystem::last_write_time(canonical).time_since_epoch();
+    fileId.modifiedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(modified).count();
+#else
+    struct stat status = {};
+    TLLM_CHECK_WITH_INFO(::stat(path.c_str(), &status) == 0, "Error opening engine file %s: %s", path.c_str(),
+        std::strerror(errno));
+    fileId.device = static_cast<std::uint64_t>(status.st_dev);
+    fileId.inode = static_cast<std::uint64_t>(status.st_ino);
+    fileId.size = static_cast<std::uint64_t>(status.st_size);
+    fileId.modifiedNs = static_cast<std::int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+#endif
+    return fileId;
+}
+
+std::unique_ptr<EngineBlob> EngineBlob::load(std::string const& path, LoadMode mode)
+{
+    auto const start = std::chrono::steady_clock::now();
+    auto const fileId = getFileId(path);
+    TLLM_CHECK_WITH_INFO(fileId.size > 0, "Engine file %s is empty", path.c_str());
+#if defined(_WIN32)
+    mode = LoadMode::kREAD;
+#endif
+    std::unique_ptr<EngineBlob> blob{new EngineBlob{mode, fileId}};
+    switch (mode)
+    {
+    case LoadMode::kREAD: blob->read(path); break;
+    case LoadMode::kMMAP: blob->map(path); break;
+    case LoadMode::kDIRECT:
+        if (!blob->readDirect(path))
+        {
+            TLLM_LOG_WARNING("Cannot read engine file %s with O_DIRECT, reading it instead", path.c_str());
+            blob->mLoadMode = LoadMode::kREAD;
+            blob->read(path);
+        }
+        break;
+    }
+    auto const elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    TLLM_LOG_INFO("Loaded engine %s (%zu bytes) with %s in %.1f ms", path.c_str(), blob->size(),
+        loadModeToString(blob->getLoadMode()), elapsed.count());
+    return blob;
+}
+
+// follows https://github.com/NVIDIA/TensorRT/blob/release/8.6/samples/common/sampleEngines.cpp
+void EngineBlob::read(std::string const& path)
+{
+    std::ifstream engineFile(path, std::ios::binary);
+    TLLM_CHECK_WITH_INFO(engineFile.good(), std::string("Error opening engine file: " + path));
+    mBuffer.resize(mFileId.size);
+    engineFile.read(reinterpret_cast<char*>(mBuffer.data()), static_cast<std::streamsize>(mBuffer.size()));
+    TLLM_CHECK_WITH_INFO(engineFile.good(), std::string("Error loading engine file: " + path));
+    mData = mBuffer.data();
+    mSize = mBuffer.size();
+}
+
+void EngineBlob::map(std::string const& path)
+{
+#if !defined(_WIN32)
+    FileDescriptor const file{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    TLLM_CHECK_WITH_INFO(file.get() >= 0, "Error opening engine file %s: %s", path.c_str(), std::strerror(errno));
+    auto const size = static_cast<std::size_t>(mFileId.size);
+    auto* const mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.get(), 0);
+    TLLM_CHECK_WITH_INFO(mapping != MAP_FAILED, "Error mapping engine file %s: %s", path.c_str(), std::strerror(errno));
+    mMapping = mapping;
+    mData = mapping;
+    mSize = size;
+    // TensorRT reads the engine once from front to back. Start reading ahead now, the hints are only advisory.
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+    ::madvise(mapping, size, MADV_WILLNEED);
+#else
+    read(path);
+#endif
+}
+
+bool EngineBlob::readDirect(std::string const& path)
+{
+#if !defined(_WIN32) && defined(O_DIRECT)
+    FileDescriptor const file{::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT)};
+    if (file.get() < 0)
+    {
+        return false;
+    }
+    auto const size = static_cast<std::size_t>(mFileId.size);
+    auto const capacity = (size + kDirectAlignment - 1) / kDirectAlignment * kDirectAlignment;
+    void* buffer{nullptr};
+    TLLM_CHECK_WITH_INFO(::posix_memalign(&buffer, kDirectAlignment, capacity) == 0,
+        "Error allocating %zu bytes for engine file %s", capacity, path.c_str());
+    mDirectBuffer = buffer;
+
+    std::size_t offset{0};
+    while (offset < size)
+    {
+        auto const count = std::min(kDirectChunkSize, capacity - offset);
+        auto const bytesRead = ::pread(file.get(), static_cast<char*>(buffer) + offset, count, offset);
+        if (bytesRead < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytesRead < 0 && errno == EINVAL && offset == 0)
+        {
+            // The file system accepted O_DIRECT on open but not for reads
+            std::free(mDirectBuffer);
+            mDirectBuffer = nullptr;
+            return false;
+        }
+        TLLM_CHECK_WITH_INFO(
+            bytesRead > 0, "Error loading engine file %s: %s", path.c_str(), bytesRead < 0 ? std::strerror(errno) : "");
+        offset += static_cast<std::size_t>(bytesRead);
+    }
+    mData = buffer;
+    mSize = size;
+    return true;
+#else
+    return false;
+#endif
+}
+
+EngineBlobRegistry& EngineBlobRegistry::getInstance()
+{
+    static EngineBlobRegistry instance;
+    return instance;
+}
+
+EngineBlobRegistry::BlobPtr EngineBlobRegistry::acquire(std::string const& path, EngineBlob::LoadMode mode)
+{
+    auto const fileId = EngineBlob::getFileId(path);
+    Key const key{fileId.device, fileId.inode};
+
+    // Loading under the lock makes concurrent sessions wait for one load rather than each loading the file
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto it = mBlobs.begin(); it != mBlobs.end();)
+    {
+        it = it->second.expired() ? mBlobs.erase(it) : std::next(it);
+    }
+    if (auto const pos = mBlobs.find(key); pos != mBlobs.end())
+    {
+        if (auto blob = pos->second.lock(); blob && blob->getFileId() == fileId)
+        {
+            TLLM_LOG_DEBUG("Sharing the loaded blob of engine %s", path.c_str());
+            return blob;
+        }
+    }
+    BlobPtr blob{EngineBlob::load(path, mode)};
+    mBlobs.insert_or_assign(key, blob);
+    return blob;
+}
+
+std::size_t EngineBlobRegistry::getNbBlobs() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return static_cast<std::size_t>(
+        std::count_if(mBlobs.begin(), mBlobs.end(), [](auto const& entry) { return !entry.second.expired(); }));
+}
+
+} // namespace tensorrt_llm::runtime
@@ -20,6 +20,7 @@
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/cudaEvent.h"
 #include "tensorrt_llm/runtime/runtimeKernels.h"
+#include "tensorrt_llm/runtime/tensorSpan.h"
 
 #include <algorithm>
 #include <cassert>
@@ -1071,7 +1072,8 @@ void GptDecoderBatch::forwardAsync(decoder::Output& output, decoder::Input const
 
     mForwardToken = forwardAsync(batchOutput, batchInput);
     mBufferManager.setZero(*mFinishedSum);
-    kernels::reduce(*mFinishedSum, *ITensor::slice(mJointDecodingOutput->finishedSum, 0, mActualBatchSize), *mStream);
+    kernels::reduce(
+        *mFinishedSum, SpanTensor{TensorSpan{*mJointDecodingOutput->finishedSum}.slice(0, mActualBatchSize)}, *mStream);
     mStream->record(mForwardEvent);
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
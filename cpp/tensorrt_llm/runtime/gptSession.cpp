@@ -26,10 +26,12 @@
 #include "tensorrt_llm/common/stringUtils.h"
 #include "tensorrt_llm/runtime/gptDecoderBatch.h"
 #include "tensorrt_llm/runtime/ipcUtils.h"
+#include "tensorrt_llm/runtime/memoryCounters.h"
 #include "tensorrt_llm/runtime/ncclCommunicator.h"
 #include "tensorrt_llm/runtime/runtimeBuffers.h"
 #include "tensorrt_llm/runtime/runtimeKernels.h"
 #include "tensorrt_llm/runtime/statefulGptDecoder.h"
+#include "tensorrt_llm/runtime/tensorSpan.h"
 #include "tensorrt_llm/runtime/tllmLogger.h"
 #include "tensorrt_llm/runtime/tllmRuntime.h"
 #include "tensorrt_llm/runtime/utils/sessionUtils.h"
@@ -133,6 +135,7 @@ void GptSession::createBuffers(SizeType numMicroBatches)
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
     mBuffers.clear();
 
+    MemoryTagScope const memoryTag{MemoryTag::kRUNTIME};
     for (SizeType i = 0; i < numMicroBatches; ++i)
     {
         mBuffers.emplace_back(std::make_shared<RuntimeBuffers>());
@@ -152,6 +155,7 @@ void GptSession::createDecoders(SizeType batchSize, SizeType beamWidth, SizeType
 
     mDecoders.clear();
 
+    MemoryTagScope const memoryTag{MemoryTag::kDECODER};
     for (SizeType i = 0; i < numMicroBatches; ++i)
     {
         if (decoderPerRequest)
@@ -189,6 +193,7 @@ void GptSession::createKvCacheManager(SizeType batchSize, SizeType beamWidth, Si
     auto const nbKvHeads = mModelConfig.getNbKvHeads();
     auto const sizePerHead = mModelConfig.getSizePerHead();
     bool constexpr enableBlockReuse{false};
+    MemoryTagScope const memoryTag{MemoryTag::kKV_CACHE};
     mKvCacheManager = std::make_shared<bmkv::KVCacheManager>(localNbLayers, nbKvHeads, sizePerHead, tokensPerBlock,
         blocksInPrimaryPool, blocksInSecondaryPool, batchSize, beamWidth, maxAttentionWindow, sinkTokenLength,
         useOneMoreBlock, kvDtype, mRuntime->getStreamPtr(), enableBlockReuse, kvCacheConfig.useUvm,
@@ -203,6 +208,7 @@ void GptSession::createCustomAllReduceWorkspace(
     setPeerAccess(mWorldConfig, true);
 
     mIpcMemoryHandles.clear();
+    MemoryTagScope const memoryTag{MemoryTag::kWORKSPACE};
     const std::size_t bufferSize = std::min(static_cast<std::size_t>(maxBatchSize) * maxBeamWidth * maxSequenceLength
             * mModelConfig.getHiddenSize() * mWorldConfig.getTensorParallelism() * sizeof(float),
         ::tensorrt_llm::utils::customAllReduceUtils::getMaxRequiredWorkspaceSize(mWorldConfig.getTensorParallelism()));
@@ -376,7 +382,8 @@ ITensor::SharedPtr GptSession::initDecoder(ITensor& outputIds, GenerationInput c
         {
             inputOffsets->reshape(ITensor::makeShape({batchSize + 1}));
             manager.setZero(*inputOffsets);
-            kernels::invokeInclusiveSum(*ITensor::slice(inputOffsets, 1), *inputLengths, manager, *stream);
+            SpanTensor inputOffsetsTail{TensorSpan{*inputOffsets}.slice(1)};
+            kernels::invokeInclusiveSum(inputOffsetsTail, *inputLengths, manager, *stream);
         }
 
         kernels::initOutputIds(outputIds, *inputs.ids, *inputLengths, *inputOffsets, inputs.padId, inputs.endId,
@@ -635,6 +642,10 @@ void GptSession::generate(GenerationOutput& outputs, GenerationInput const& inpu
         }
     }
 
+    // Outputs are allocated, so this sample shows the memory this call starts from
+    auto& memoryCounters = MemoryCounters::getInstance();
+    memoryCounters.sample();
+
     // callbacks
     auto const onTokenGenerated = createOnTokenGeneratedCallback(outputs);
 
@@ -650,6 +661,7 @@ void GptSession::generate(GenerationOutput& outputs, GenerationInput const& inpu
         auto microBatchesOutputs = splitOutputs(outputs, mMicroBatchConfig.genBatchSize);
         generateBatched(microBatchesOutputs, microBatchesInputs, samplingConfig, onTokenGenerated, generationProfiler);
     }
+    memoryCounters.sample();
 
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -829,12 +841,12 @@ void GptSession::generateBatched(std::vector<GenerationOutput>& microBatchesOutp
             auto& microBatchOutputs = microBatchesOutputs.at(microBatchId);
 
             auto const beamWidth = generationConfig.beamWidth;
-            TensorPtr cachePointerDevice
-                = ITensor::slice(buffers.cacheGenerationFragmentPointerDevice, microBatchId, 1);
-            TensorPtr cachePointerHost = ITensor::slice(buffers.cacheGenerationFragmentPointerHost, microBatchId, 1);
+            SpanTensor cachePointerDevice{
+                TensorSpan{*buffers.cacheGenerationFragmentPointerDevice}.slice(microBatchId, 1)};
+            SpanTensor cachePointerHost{TensorSpan{*buffers.cacheGenerationFragmentPointerHost}.slice(microBatchId, 1)};
             tensorrt_llm::runtime::kernels::mergeLogitsFragments(manager, *microBatchOutputs.generationLogits,
-                *buffers.generationLogitsFragments, *cachePointerDevice, *cachePointerHost, 0, microBatchSize,
-                beamWidth, manager.getStream(), 0);
+                *buffers.generationLogitsFragments, cachePointerDevice, cachePointerHost, 0, microBatchSize, beamWidth,
+                manager.getStream(), 0);
             buffers.generationLogitsFragments->clear();
         }
     }
@@ -848,6 +860,7 @@ void GptSession::executeContextStep(std::vector<GenerationInput> const& generati
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
     auto& manager = mRuntime->getBufferManager();
+    auto const& bindingPlan = mRuntime->getBindingPlan();
 
     auto const numGenerationBatches = static_cast<SizeType>(generationBatchesInputs.size());
     auto constexpr step = 0;
@@ -870,13 +883,18 @@ void GptSession::executeContextStep(std::vector<GenerationInput> const& generati
             auto& buffers = contextBuffers.at(contextBatchId);
             auto& inputBuffer = buffers.inputBuffers[0];
             auto& outputBuffer = buffers.outputBuffers[0];
+            auto& outputSlots = buffers.outputSlots[0];
 
             buffers.prepareContextStep(inputIds.at(contextBatchId), generationBatchInputs.padId, manager,
                 kvCacheManager, batchOffset, mModelConfig, mWorldConfig);
             buffers.getRuntimeBuffers(
                 inputBuffer, outputBuffer, step, inputIds.at(contextBatchId), mCommPtrs, mModelConfig, mWorldConfig);
-            mRuntime->setInputTensors(contextId, inputBuffer);
-            mRuntime->setOutputTensors(contextId, outputBuffer);
+            auto& inputSlots = buffers.inputSlots[0];
+            mRuntime->setInputTensors(contextId, inputSlots.update(bindingPlan, inputBuffer));
+            mRuntime->setOutputTensors(contextId, outputSlots.update(bindingPlan, outputBuffer));
+            outputSlots.storeMissing(outputBuffer);
+            inputSlots.release();
+            outputSlots.release();
 
             TLLM_CHECK_WITH_INFO(mRuntime->executeContext(contextId), "Executing TRT engine in context step failed!");
             sync_check_cuda_error();
@@ -915,6 +933,7 @@ SizeType GptSession::executeGenerationStep(SizeType step, std::vector<Generation
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
     TLLM_CHECK(microBatchesInputs.size() == microBatchesOutputs.size());
     auto& manager = mRuntime->getBufferManager();
+    auto const& bindingPlan = mRuntime->getBindingPlan();
 
     auto const numMicroBatches = static_cast<SizeType>(microBatchesInputs.size());
     SizeType numBatchesFinished{0};
@@ -932,12 +951,18 @@ SizeType GptSession::executeGenerationStep(SizeType step, std::vector<Generation
         auto const graphId = mMicroBatchConfig.getGenGraphId(flipFlopId, generationBatchId);
         auto& inputBuffer = buffers.inputBuffers[flipFlopId];
         auto& outputBuffer = buffers.outputBuffers[flipFlopId];
+        auto& outputSlots = buffers.outputSlots[flipFlopId];
 
         auto nextInputIds = buffers.prepareNextStep(
             step - 1, manager, kvCacheManager, microBatchOffsets.at(generationBatchId), mModelConfig, mWorldConfig);
         buffers.getRuntimeBuffers(inputBuffer, outputBuffer, step, nextInputIds, mCommPtrs, mModelConfig, mWorldConfig);
-        mRuntime->setInputTensors(contextId, inputBuffer);
-        mRuntime->setOutputTensors(contextId, outputBuffer);
+        auto& inputSlots = buffers.inputSlots[flipFlopId];
+        mRuntime->setInputTensors(contextId, inputSlots.update(bindingPlan, inputBuffer));
+        mRuntime->setOutputTensors(contextId, outputSlots.update(bindingPlan, outputBuffer));
+        outputSlots.storeMissing(outputBuffer);
+        // Leaves the maps the only holders of their views, which getRuntimeBuffers reshapes in place
+        inputSlots.release();
+        outputSlots.release();
 
         if (useCudaGraphs())
         {
@@ -24,6 +24,8 @@
 #include "tensorrt_llm/common/logger.h"
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/runtime/loraUtils.h"
+#include "tensorrt_llm/runtime/memoryCounters.h"
+#include "tensorrt_llm/runtime/tensorSpan.h"
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -47,6 +49,7 @@ void LoraCachePageManager::initialize(BufferManager const& bufferManager)
 
     TLLM_LOG_DEBUG("pageConfig: " + to_string(mConfig));
 
+    MemoryTagScope const memoryTag{MemoryTag::kLORA};
     std::size_t pageIdx = 0;
     while (pageIdx < static_cast<size_t>(mConfig.getTotalNumPages()))
     {
@@ -445,7 +448,7 @@ SizeType LoraCache::determineNumPages(TensorPtr loraConfig) const
     SizeType const pageWidth = mPageManagerConfig.getPageWidth();
     for (SizeType row = 0; row < loraConfig->getShape().d[0]; ++row)
     {
-        auto const rowPtr = bufferCast<int32_t>(*ITensor::slice(loraConfig, row, 1));
+        auto const rowPtr = bufferCast<int32_t const>(TensorSpan{*loraConfig}.slice(row, 1));
         auto const layerId = rowPtr[lora::kLORA_CONFIG_LAYER_OFF];
         if (layerId >= firstLayerId && layerId < lastLayerId)
         {
@@ -572,7 +575,7 @@ std::vector<LoraCache::TaskLayerModuleConfig> LoraCache::copyToPages(TensorPtr s
     auto const numRows = config->getShape().d[0];
     for (SizeType row = 0; row < numRows; ++row)
     {
-        auto const configPtr = bufferCast<int32_t>(*ITensor::slice(config, row, 1));
+        auto const configPtr = bufferCast<int32_t const>(TensorSpan{*config}.slice(row, 1));
         auto const layerId = configPtr[lora::kLORA_CONFIG_LAYER_OFF];
         if (layerId >= firstLayerId && layerId < lastLayerId)
         {
@@ -604,7 +607,7 @@ std::vector<LoraCache::TaskLayerModuleConfig> LoraCache::copyToPages(TensorPtr s
             auto const row = rowIndices[i];
             auto const currPage = rowPage[i];
             auto const currSlot = rowSlot[i];
-            auto const configPtr = bufferCast<int32_t>(*ITensor::slice(config, row, 1));
+            auto const configPtr = bufferCast<int32_t const>(TensorSpan{*config}.slice(row, 1));
             auto const layerId = configPtr[lora::kLORA_CONFIG_LAYER_OFF];
 
             auto const adapterSize = configPtr[lora::kLORA_CONFIG_ADAPTER_SIZE_OFF];
@@ -18,8 +18,10 @@
 
 #include "tensorrt_llm/common/stringUtils.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <sstream>
 
 namespace tc = tensorrt_llm::common;
 
@@ -28,6 +30,9 @@ namespace
 
 auto constexpr kByteUnits = std::array{"B", "KB", "MB", "GB", "TB", "PB", "EB"};
 
+// Column order of the timeline dumps, by MemoryType
+auto constexpr kMemoryTypeNames = std::array{"gpu", "cpu", "pinned", "uvm"};
+
 std::string doubleBytesToString(double bytes, int precision)
 {
     std::uint32_t unitIdx{0};
@@ -61,28 +66,230 @@ std::string MemoryCounters::toString() const
         bytesToString(this->getCpu()).c_str(), bytesToString(this->getPinned()).c_str());
 }
 
-void MemoryCounters::allocate(MemoryType memoryType, MemoryCounters::SizeType size)
+char const* MemoryCounters::tagToString(MemoryTag tag)
+{
+    switch (tag)
+    {
+    case MemoryTag::kUNTAGGED: return "untagged";
+    case MemoryTag::kRUNTIME: return "runtime";
+    case MemoryTag::kDECODER: return "decoder";
+    case MemoryTag::kKV_CACHE: return "kv_cache";
+    case MemoryTag::kLORA: return "lora";
+    case MemoryTag::kWORKSPACE: return "workspace";
+    case MemoryTag::kREQUEST: return "request";
+    }
+    TLLM_THROW("Unknown memory tag");
+}
+
+std::string MemoryCounters::tagsToString() const
+{
+    std::ostringstream ss;
+    ss << "[MemUsage] by subsystem (current / peak):";
+    for (std::size_t tagIdx = 0; tagIdx < kNumMemoryTags; ++tagIdx)
+    {
+        auto const tag = static_cast<MemoryTag>(tagIdx);
+        for (std::size_t typeIdx = 0; typeIdx < kNumMemoryTypes; ++typeIdx)
+        {
+            auto const memoryType = static_cast<MemoryType>(typeIdx);
+            auto const peak = getTaggedPeak(tag, memoryType);
+            if (peak > 0)
+            {
+                ss << " " << tagToString(tag) << " " << kMemoryTypeNames[typeIdx] << " "
+                   << bytesToString(getTagged(tag, memoryType)) << " / " << bytesToString(peak) << ";";
+            }
+        }
+    }
+    return ss.str();
+}
+
+std::string MemoryPoolReport::toString() const
+{
+    std::ostringstream ss;
+    ss << "[MemoryPool] reserved " << MemoryCounters::bytesToString(reservedSize) << " in " << numChunks
+       << " chunks (" << numFreeChunks << " free), used " << MemoryCounters::bytesToString(usedSize) << ", free "
+       << MemoryCounters::bytesToString(freeSize) << " in " << numFreeSegments << " segments, largest "
+       << MemoryCounters::bytesToString(largestFreeSegment) << ", fragmentation "
+       << tc::fmtstr("%.2f", getFragmentation());
+    for (std::size_t sc = 0; sc < freeBytesHistogram.size(); ++sc)
+    {
+        if (freeBytesHistogram[sc] > 0)
+        {
+            ss << "\n  free in [" << MemoryCounters::bytesToString(std::size_t{1} << sc, 0) << ", "
+               << MemoryCounters::bytesToString(std::size_t{2} << sc, 0)
+               << "): " << MemoryCounters::bytesToString(freeBytesHistogram[sc]);
+        }
+    }
+    return ss.str();
+}
+
+void MemoryCounters::allocate(MemoryType memoryType, MemoryCounters::SizeType size, MemoryTag tag)
 {
     switch (memoryType)
     {
-    case MemoryType::kGPU: allocate<MemoryType::kGPU>(size); break;
-    case MemoryType::kCPU: allocate<MemoryType::kCPU>(size); break;
-    case MemoryType::kPINNED: allocate<MemoryType::kPINNED>(size); break;
+    case MemoryType::kGPU: allocate<MemoryType::kGPU>(size, tag); break;
+    case MemoryType::kCPU: allocate<MemoryType::kCPU>(size, tag); break;
+    case MemoryType::kPINNED: allocate<MemoryType::kPINNED>(size, tag); break;
     default: TLLM_THROW("Unknown memory type");
     }
 }
 
-void MemoryCounters::deallocate(MemoryType memoryType, MemoryCounters::SizeType size)
+void MemoryCounters::deallocate(MemoryType memoryType, MemoryCounters::SizeType size, MemoryTag tag)
 {
     switch (memoryType)
     {
-    case MemoryType::kGPU: deallocate<MemoryType::kGPU>(size); break;
-    case MemoryType::kCPU: deallocate<MemoryType::kCPU>(size); break;
-    case MemoryType::kPINNED: deallocate<MemoryType::kPINNED>(size); break;
+    case MemoryType::kGPU: deallocate<MemoryType::kGPU>(size, tag); break;
+    case MemoryType::kCPU: deallocate<MemoryType::kCPU>(size, tag); break;
+    case MemoryType::kPINNED: deallocate<MemoryType::kPINNED>(size, tag); break;
     default: TLLM_THROW("Unknown memory type");
     }
 }
 
+void MemoryCounters::resetPeaks()
+{
+    auto const totals = std::array<SizeType, kNumMemoryTypes>{getGpu(), getCpu(), getPinned(), getUVM()};
+    for (std::size_t typeIdx = 0; typeIdx < kNumMemoryTypes; ++typeIdx)
+    {
+        mPeaks[typeIdx].store(totals[typeIdx], std::memory_order_relaxed);
+    }
+    for (auto& counters : mTagged)
+    {
+        for (auto& counter : counters)
+        {
+            counter.peak.store(counter.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+}
+
+void MemoryCounters::enableTimeline(std::size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(mTimelineMutex);
+    mTimeline.clear();
+    mTimeline.reserve(capacity);
+    mTimelineNext = 0;
+    mTimelineCapacity = capacity;
+    mTimelineStart = std::chrono::steady_clock::now();
+    mTimelineEnabled.store(capacity > 0, std::memory_order_relaxed);
+}
+
+MemoryCounters::Sample MemoryCounters::takeSample() const
+{
+    Sample sample{};
+    sample.timeUs
+        = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - mTimelineStart)
+              .count();
+    sample.total = {getGpu(), getCpu(), getPinned(), getUVM()};
+    for (std::size_t tagIdx = 0; tagIdx < kNumMemoryTags; ++tagIdx)
+    {
+        for (std::size_t typeIdx = 0; typeIdx < kNumMemoryTypes; ++typeIdx)
+        {
+            sample.tagged[tagIdx][typeIdx] = mTagged[tagIdx][typeIdx].current.load(std::memory_order_relaxed);
+        }
+    }
+    return sample;
+}
+
+void MemoryCounters::sample()
+{
+    if (!mTimelineEnabled.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mTimelineMutex);
+    if (mTimelineCapacity == 0)
+    {
+        return;
+    }
+    if (mTimeline.size() < mTimelineCapacity)
+    {
+        mTimeline.push_back(takeSample());
+    }
+    else
+    {
+        mTimeline[mTimelineNext] = takeSample();
+        mTimelineNext = (mTimelineNext + 1) % mTimelineCapacity;
+    }
+}
+
+std::vector<MemoryCounters::Sample> MemoryCounters::getTimeline() const
+{
+    std::lock_guard<std::mutex> lock(mTimelineMutex);
+    std::vector<Sample> timeline;
+    timeline.reserve(mTimeline.size());
+    timeline.insert(timeline.end(), mTimeline.begin() + static_cast<std::ptrdiff_t>(mTimelineNext), mTimeline.end());
+    timeline.insert(timeline.end(), mTimeline.begin(), mTimeline.begin() + static_cast<std::ptrdiff_t>(mTimelineNext));
+    return timeline;
+}
+
+std::string MemoryCounters::timelineToCsv() const
+{
+    std::ostringstream ss;
+    ss << "time_us,tag";
+    for (auto const* name : kMemoryTypeNames)
+    {
+        ss << "," << name;
+    }
+    ss << "\n";
+    auto const writeRow = [&ss](std::int64_t timeUs, char const* tag, Sizes const& sizes)
+    {
+        ss << timeUs << "," << tag;
+        for (auto const size : sizes)
+        {
+            ss << "," << size;
+        }
+        ss << "\n";
+    };
+    for (auto const& sample : getTimeline())
+    {
+        writeRow(sample.timeUs, "total", sample.total);
+        for (std::size_t tagIdx = 0; tagIdx < kNumMemoryTags; ++tagIdx)
+        {
+            auto const& sizes = sample.tagged[tagIdx];
+            if (std::any_of(sizes.begin(), sizes.end(), [](auto const size) { return size > 0; }))
+            {
+                writeRow(sample.timeUs, tagToString(static_cast<MemoryTag>(tagIdx)), sizes);
+            }
+        }
+    }
+    return ss.str();
+}
+
+std::string MemoryCounters::timelineToJson() const
+{
+    std::ostringstream ss;
+    auto const writeSizes = [&ss](Sizes const& sizes)
+    {
+        ss << "{";
+        for (std::size_t typeIdx = 0; typeIdx < kNumMemoryTypes; ++typeIdx)
+        {
+            ss << (typeIdx > 0 ? ", " : "") << "\"" << kMemoryTypeNames[typeIdx] << "\": " << sizes[typeIdx];
+        }
+        ss << "}";
+    };
+    ss << "[";
+    auto first = true;
+    for (auto const& sample : getTimeline())
+    {
+        ss << (first ? "" : ",") << "\n  {\"time_us\": " << sample.timeUs << ", \"total\": ";
+        first = false;
+        writeSizes(sample.total);
+        ss << ", \"tags\": {";
+        auto firstTag = true;
+        for (std::size_t tagIdx = 0; tagIdx < kNumMemoryTags; ++tagIdx)
+        {
+            auto const& sizes = sample.tagged[tagIdx];
+            if (std::any_of(sizes.begin(), sizes.end(), [](auto const size) { return size > 0; }))
+            {
+                ss << (firstTag ? "" : ", ") << "\"" << tagToString(static_cast<MemoryTag>(tagIdx)) << "\": ";
+                firstTag = false;
+                writeSizes(sizes);
+            }
+        }
+        ss << "}}";
+    }
+    ss << (first ? "]" : "\n]");
+    return ss.str();
+}
+
 MemoryCounters& MemoryCounters::getInstance()
 {
     static MemoryCounters mInstance;
@@ -18,6 +18,7 @@
 
 #include "tensorrt_llm/batch_manager/kvCacheManager.h"
 #include "tensorrt_llm/common/assert.h"
+#include "tensorrt_llm/common/logger.h"
 #include "tensorrt_llm/common/stlUtils.h"
 #include "tensorrt_llm/runtime/runtimeKernels.h"
 #include "tensorrt_llm/runtime/tllmRuntime.h"
@@ -47,6 +48,7 @@ void RuntimeBuffers::clear()
 
     hiddenStates = nullptr;
 
+    clearTensorMaps();
     allocated = false;
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
@@ -58,6 +60,10 @@ void RuntimeBuffers::clearTensorMaps()
         buffer.clear();
     for (auto& buffer : outputBuffers)
         buffer.clear();
+    for (auto& slots : inputSlots)
+        slots.clear();
+    for (auto& slots : outputSlots)
+        slots.clear();
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
@@ -441,8 +447,13 @@ void RuntimeBuffers::getRuntimeBuffers(TensorMap& inputBuffers, TensorMap& outpu
     WorldConfig const& worldConfig) const
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
-    inputBuffers.clear();
-    outputBuffers.clear();
+    // The maps are filled on the first step after reset() and then only updated where a tensor changed, so that
+    // the same two maps are reused for the whole generation.
+#ifndef NDEBUG
+    auto const reportChanges = tc::Logger::getLogger()->getLevel() <= tc::Logger::DEBUG;
+    auto const inputsBefore = reportChanges ? utils::snapshotTensorMap(inputBuffers) : utils::TensorMapSnapshot{};
+    auto const outputsBefore = reportChanges ? utils::snapshotTensorMap(outputBuffers) : utils::TensorMapSnapshot{};
+#endif
 
     if (transformerBuffers)
     {
@@ -458,15 +469,27 @@ void RuntimeBuffers::getRuntimeBuffers(TensorMap& inputBuffers, TensorMap& outpu
 
     if (modelConfig.useCustomAllReduce() && worldConfig.getTensorParallelism())
     {
-        inputBuffers.insert_or_assign("all_reduce_workspace", commPtrs);
+        utils::updateTensor(inputBuffers, "all_reduce_workspace", commPtrs);
     }
 
     if (modelConfig.usePromptTuning())
     {
-        inputBuffers.insert_or_assign("prompt_embedding_table", promptTuningParams.embeddingTable);
-        inputBuffers.insert_or_assign("tasks", promptTuningParams.tasks);
-        inputBuffers.insert_or_assign("prompt_vocab_size", promptTuningParams.vocabSize);
+        utils::updateTensor(inputBuffers, "prompt_embedding_table", promptTuningParams.embeddingTable);
+        utils::updateTensor(inputBuffers, "tasks", promptTuningParams.tasks);
+        utils::updateTensor(inputBuffers, "prompt_vocab_size", promptTuningParams.vocabSize);
+    }
+
+#ifndef NDEBUG
+    if (reportChanges)
+    {
+        auto const inputChanges = utils::diffTensorMap(inputsBefore, inputBuffers);
+        auto const outputChanges = utils::diffTensorMap(outputsBefore, outputBuffers);
+        TLLM_LOG_DEBUG("Step %d changed inputs:%s%s", step, inputChanges.empty() ? " none" : "\n",
+            inputChanges.c_str());
+        TLLM_LOG_DEBUG("Step %d changed outputs:%s%s", step, outputChanges.empty() ? " none" : "\n",
+            outputChanges.c_str());
     }
+#endif
 
     // utils::printTensorMap(std::cerr, inputBuffers);
     // utils::printTensorMap(std::cerr, outputBuffers);
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "tensorrt_llm/runtime/bindingPlan.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/generationConfig.h"
 #include "tensorrt_llm/runtime/gptModelConfig.h"
@@ -50,6 +51,9 @@ public:
     GenerationConfig generationConfig{};
     std::array<TensorMap, 2> inputBuffers{};
     std::array<TensorMap, 2> outputBuffers{};
+    // The tensors of the maps above by binding slot, looked up again only when a map gains entries
+    std::array<TensorMapSlots, 2> inputSlots{};
+    std::array<TensorMapSlots, 2> outputSlots{};
 
     // general
     TensorPtr contextLengthsHost;
@@ -133,6 +137,11 @@ public:
     TensorPtr prepareNextStep(SizeType step, BufferManager& manager, KvCacheManager* kvCacheManager,
         SizeType firstBatchSlotIdx, GptModelConfig const& modelConfig, WorldConfig const& worldConfig);
 
+    //! \brief Fills the engine inputs and outputs of `step` into one pair of the maps above, the one of step % 2.
+    //!
+    //! \details The maps are kept between steps and cleared by reset(), so that the KV cache tensors, which alternate
+    //!          with the parity of the step, are set once per map. Later steps only replace the entries whose tensor
+    //!          changed. Debug builds log which entries each step added, replaced, moved or reshaped at debug level.
     void getRuntimeBuffers(TensorMap& inputBuffers, TensorMap& outputBuffers, SizeType const step,
         TensorPtr const& inputIds, TensorPtr const& commPtrs, GptModelConfig const& modelConfig,
         WorldConfig const& worldConfig) const;
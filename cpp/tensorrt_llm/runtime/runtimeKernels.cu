@@ -21,9 +21,11 @@
 #include "tensorrt_llm/kernels/parallelDecoding/kvCacheUpdateKernels.h"
 #include "tensorrt_llm/runtime/runtimeKernels.h"
 
+#include <algorithm>
 #include <cub/cub.cuh>
 #include <cuda_fp16.h>
 #include <cuda_runtime.h>
+#include <limits>
 
 using namespace tensorrt_llm::runtime;
 namespace tc = tensorrt_llm::common;
@@ -178,6 +180,58 @@ void invokeCopyBatch(IBuffer const& srcBuffer, IBuffer& dstBuffer, IBuffer const
         srcDataPtr, dstDataPtr, srcOffsetsPtr, dstOffsetsPtr, sizesPtr, static_cast<int32_t>(dataTypeSize));
 }
 
+namespace
+{
+__global__ void scatterCopy(std::uint8_t const* staging, ScatterCopyRegion const* regions)
+{
+    auto const region = regions[blockIdx.y];
+    auto const* src = staging + region.srcOffset;
+    auto* dst = reinterpret_cast<std::uint8_t*>(region.dst);
+    auto const tidx = static_cast<std::size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    auto const stride = static_cast<std::size_t>(blockDim.x) * gridDim.x;
+
+    // Bytes up to the first aligned address, which is the same for source and destination if they are congruent
+    auto constexpr vectorSize = sizeof(uint4);
+    auto const congruent = (region.dst - reinterpret_cast<std::uint64_t>(src)) % vectorSize == 0;
+    auto const toAligned = (vectorSize - region.dst % vectorSize) % vectorSize;
+    auto const head = congruent && toAligned < region.size ? toAligned : region.size;
+    auto const numVectors = (region.size - head) / vectorSize;
+    auto const tail = head + numVectors * vectorSize;
+
+    for (auto idx = tidx; idx < head; idx += stride)
+    {
+        dst[idx] = src[idx];
+    }
+    auto const* srcVectors = reinterpret_cast<uint4 const*>(src + head);
+    auto* dstVectors = reinterpret_cast<uint4*>(dst + head);
+    for (auto idx = tidx; idx < numVectors; idx += stride)
+    {
+        dstVectors[idx] = srcVectors[idx];
+    }
+    for (auto idx = tail + tidx; idx < region.size; idx += stride)
+    {
+        dst[idx] = src[idx];
+    }
+}
+} // namespace
+
+void invokeScatterCopy(
+    IBuffer const& staging, std::size_t numRegions, std::size_t maxRegionSize, CudaStream const& stream)
+{
+    TLLM_CHECK_WITH_INFO(numRegions <= std::numeric_limits<std::uint16_t>::max(), "Too many regions to scatter: %zu",
+        numRegions);
+    TLLM_CHECK(numRegions * sizeof(ScatterCopyRegion) <= staging.getSizeInBytes());
+    auto const* stagingPtr = static_cast<std::uint8_t const*>(staging.data());
+    auto const* regionsPtr = reinterpret_cast<ScatterCopyRegion const*>(stagingPtr);
+
+    dim3 const blockSize{256};
+    // Enough threads for one vector per thread in the largest region
+    std::size_t const gridx{tc::ceilDiv(tc::ceilDiv(maxRegionSize, sizeof(uint4)), blockSize.x)};
+    dim3 const gridSize{static_cast<std::uint32_t>(std::clamp<std::size_t>(gridx, 1, 1024)),
+        static_cast<std::uint32_t>(numRegions)};
+    scatterCopy<<<gridSize, blockSize, 0, stream.get()>>>(stagingPtr, regionsPtr);
+}
+
 namespace
 {
 template <typename T>
@@ -36,6 +36,19 @@ void invokeFillBatch(
 void invokeCopyBatch(IBuffer const& srcBuffer, IBuffer& dstBuffer, IBuffer const& srcOffsets, IBuffer const& dstOffsets,
     IBuffer const& sizes, std::size_t maxStride, CudaStream const& stream);
 
+//! \brief An entry of the table at the front of the buffer passed to invokeScatterCopy.
+struct ScatterCopyRegion
+{
+    std::uint64_t dst;
+    std::uint64_t srcOffset;
+    std::uint64_t size;
+};
+
+//! \brief Copies `numRegions` regions of `staging` to the device addresses in the table at its front. Regions whose
+//! source and destination are equally aligned are copied with vector loads and stores.
+void invokeScatterCopy(
+    IBuffer const& staging, std::size_t numRegions, std::size_t maxRegionSize, CudaStream const& stream);
+
 template <typename T>
 void invokeAdd(IBuffer& buffer, T value, CudaStream const& stream);
 
@@ -87,6 +87,14 @@ SsmStateBuffers::SsmStateBuffers(
         mambaConvStatePtrs = nullptr;
     }
 
+    auto const firstLayerId = worldConfig.getPipelineParallelRank() * localNbLayers;
+    mPastConvStateNames = utils::makeTensorNames("past_conv_state_", localNbLayers, firstLayerId);
+    mPresentConvStateNames = utils::makeTensorNames("present_conv_state_", localNbLayers, firstLayerId);
+    mPastSsmStateNames = utils::makeTensorNames("past_ssm_state_", localNbLayers, firstLayerId);
+    mPresentSsmStateNames = utils::makeTensorNames("present_ssm_state_", localNbLayers, firstLayerId);
+    mConvStatePtrNames = utils::makeTensorNames("conv_state_ptr_", localNbLayers, firstLayerId);
+    mSsmStatePtrNames = utils::makeTensorNames("ssm_state_ptr_", localNbLayers, firstLayerId);
+
     reshape(maxBatchSize);
     TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
 }
@@ -202,6 +210,12 @@ SsmStateBuffers SsmStateBuffers::sliceTo(SizeType offset, SizeType size)
         }
         buffers.fillStatePtrs();
     }
+    buffers.mPastConvStateNames = mPastConvStateNames;
+    buffers.mPresentConvStateNames = mPresentConvStateNames;
+    buffers.mPastSsmStateNames = mPastSsmStateNames;
+    buffers.mPresentSsmStateNames = mPresentSsmStateNames;
+    buffers.mConvStatePtrNames = mConvStatePtrNames;
+    buffers.mSsmStatePtrNames = mSsmStatePtrNames;
     TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
     return buffers;
 }
@@ -296,44 +310,41 @@ void SsmStateBuffers::getRuntimeBuffers(RuntimeBuffers const* runtimeBuffers, Te
     if (worldConfig.isLastPipelineParallelRank())
     {
         // feed a view to TensorRT runtime so reshaping does not change logits buffer
-        outputBuffers.insert_or_assign("logits", ITensor::view(logits));
+        utils::updateTensorView(outputBuffers, "logits", logits, logits->getShape());
     }
     else
     {
-        outputBuffers.insert_or_assign("hidden_states_output", hiddenStates);
+        utils::updateTensor(outputBuffers, "hidden_states_output", hiddenStates);
     }
 
     if (worldConfig.isFirstPipelineParallelRank())
     {
-        inputBuffers.insert_or_assign("input_ids", inputIds);
+        utils::updateTensor(inputBuffers, "input_ids", inputIds);
     }
     else
     {
-        inputBuffers.insert_or_assign("hidden_states_input", hiddenStates);
+        utils::updateTensor(inputBuffers, "hidden_states_input", hiddenStates);
     }
 
-    inputBuffers.insert_or_assign("last_token_ids", lastTokenIds);
-
-    auto const localNbLayers = modelConfig.getNbLayers(worldConfig.getPipelineParallelism());
-    auto const firstLayerId = worldConfig.getPipelineParallelRank() * localNbLayers;
+    utils::updateTensor(inputBuffers, "last_token_ids", lastTokenIds);
 
     if (modelConfig.usePagedState())
     {
-        inputBuffers.insert_or_assign("slot_mapping", slotMappingDevice);
-        utils::insertTensorVector(inputBuffers, "conv_state_ptr_", mambaConvStatePtr, firstLayerId);
-        utils::insertTensorVector(inputBuffers, "ssm_state_ptr_", mambaSsmStatePtr, firstLayerId);
+        utils::updateTensor(inputBuffers, "slot_mapping", slotMappingDevice);
+        utils::updateTensorVector(inputBuffers, mConvStatePtrNames, mambaConvStatePtr);
+        utils::updateTensorVector(inputBuffers, mSsmStatePtrNames, mambaSsmStatePtr);
     }
     else
     {
-        utils::insertTensorVector(
-            inputBuffers, "past_conv_state_", (step % 2) ? mambaConvState : mambaConvStateAlt, firstLayerId);
-        utils::insertTensorVector(
-            outputBuffers, "present_conv_state_", (step % 2) ? mambaConvStateAlt : mambaConvState, firstLayerId);
-        utils::insertTensorVector(inputBuffers, "past_ssm_state_", mambaSsmState, firstLayerId);
-        utils::insertTensorVector(outputBuffers, "present_ssm_state_", mambaSsmState, firstLayerId);
+        utils::updateTensorVector(
+            inputBuffers, mPastConvStateNames, (step % 2) ? mambaConvState : mambaConvStateAlt);
+        utils::updateTensorVector(
+            outputBuffers, mPresentConvStateNames, (step % 2) ? mambaConvStateAlt : mambaConvState);
+        utils::updateTensorVector(inputBuffers, mPastSsmStateNames, mambaSsmState);
+        utils::updateTensorVector(outputBuffers, mPresentSsmStateNames, mambaSsmState);
     }
 
-    inputBuffers.insert_or_assign("host_request_types", requestTypes);
-    inputBuffers.insert_or_assign("host_context_lengths", runtimeBuffers->contextLengthsHost);
+    utils::updateTensor(inputBuffers, "host_request_types", requestTypes);
+    utils::updateTensor(inputBuffers, "host_context_lengths", runtimeBuffers->contextLengthsHost);
     TLLM_LOG_DEBUG("%s stop", __PRETTY_FUNCTION__);
 }
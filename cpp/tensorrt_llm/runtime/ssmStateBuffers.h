@@ -89,6 +89,14 @@ private:
     int mMaxBeamWidth = 0;
 
     bool mUseMambaConv1dPlugin = true;
+
+    // names of the per-layer state tensors, built once for the local layers
+    std::vector<std::string> mPastConvStateNames;
+    std::vector<std::string> mPresentConvStateNames;
+    std::vector<std::string> mPastSsmStateNames;
+    std::vector<std::string> mPresentSsmStateNames;
+    std::vector<std::string> mConvStatePtrNames;
+    std::vector<std::string> mSsmStatePtrNames;
 };
 
 } // namespace tensorrt_llm::runtime
@@ -19,6 +19,7 @@
 #include "tensorrt_llm/common/memoryUtils.h"
 #include "tensorrt_llm/kernels/decodingCommon.h"
 #include "tensorrt_llm/runtime/runtimeKernels.h"
+#include "tensorrt_llm/runtime/tensorSpan.h"
 
 #include <algorithm>
 
@@ -173,7 +174,8 @@ void StatefulGptDecoder::newBatch(
     {
         inputOffsets->reshape(ITensor::makeShape({batchSize + 1}));
         manager.setZero(*inputOffsets);
-        kernels::invokeInclusiveSum(*ITensor::slice(inputOffsets, 1), *inputLengths, manager, *stream);
+        SpanTensor inputOffsetsTail{TensorSpan{*inputOffsets}.slice(1)};
+        kernels::invokeInclusiveSum(inputOffsetsTail, *inputLengths, manager, *stream);
     }
 
     TLLM_CHECK(inputIds->getDataType() == TRTDataType<TokenIdType>::value);
@@ -329,7 +331,8 @@ void StatefulGptDecoder::forwardAsync(decoder::Output& output, decoder::Input co
     dOutput.lengths = output.sequenceLengths;
 
     mDecoder->forwardAsync(dOutput, dInput);
-    kernels::reduce(*mFinishedSum, *ITensor::slice(mDecodingOutput->finishedSum, 0, batchSize), *mStream);
+    kernels::reduce(
+        *mFinishedSum, SpanTensor{TensorSpan{*mDecodingOutput->finishedSum}.slice(0, batchSize)}, *mStream);
     mStream->record(mDecodedEvent.get());
 
     dInput.step += 1;
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tensorrt_llm/runtime/tensorSpan.h"
+#include "tensorrt_llm/common/assert.h"
+#include "tensorView.h"
+
+#include <memory>
+
+using namespace tensorrt_llm::runtime;
+
+ITensor::UniquePtr TensorSpan::toTensor(IBuffer::SharedPtr owner) const
+{
+    TLLM_CHECK_WITH_INFO(static_cast<bool>(owner), "Undefined owner");
+    TLLM_CHECK_WITH_INFO(owner->getDataType() == mType, "Span and owner have different data types");
+    std::size_t offset = 0;
+    if (getSize() > 0)
+    {
+        auto const* base = static_cast<std::uint8_t const*>(owner->data());
+        auto const* begin = static_cast<std::uint8_t const*>(mData);
+        TLLM_CHECK_WITH_INFO(base != nullptr && begin >= base
+                && begin + getSizeInBytes() <= base + owner->getSizeInBytes(),
+            "Span does not lie in its owner");
+        offset = static_cast<std::size_t>(begin - base) / BufferDataType(mType).getSize();
+    }
+    return std::make_unique<TensorView>(std::move(owner), offset, getSize(), mShape);
+}
@@ -16,9 +16,156 @@
 
 #include "tensorrt_llm/runtime/tllmBuffers.h"
 
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace tensorrt_llm::runtime
 {
 
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+#if defined(__linux__)
+auto constexpr kHugePageSize = HostMemoryPolicy::kHugePageSize;
+
+bool usesHugePages(std::size_t size, HostMemoryPolicy const& policy)
+{
+    return policy.hugePages && size >= kHugePageSize;
+}
+
+// Whole pages of the size the mapping uses
+std::size_t getMappedSize(std::size_t size, HostMemoryPolicy const& policy)
+{
+    auto const pageSize
+        = usesHugePages(size, policy) ? kHugePageSize : static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return tc::ceilDiv(size, pageSize) * pageSize;
+}
+
+void* mapAnonymous(std::size_t size, int flags)
+{
+    return ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+}
+
+void* mapHugePages(std::size_t size)
+{
+    auto flags = MAP_HUGETLB;
+#ifdef MAP_HUGE_2MB
+    flags |= MAP_HUGE_2MB;
+#endif
+    if (auto* ptr = mapAnonymous(size, flags); ptr != MAP_FAILED)
+    {
+        return ptr;
+    }
+
+    static std::once_flag warned;
+    std::call_once(warned,
+        []() { TLLM_LOG_WARNING("No 2 MB huge pages are reserved, falling back to transparent huge pages"); });
+    // Transparent huge pages need 2 MB aligned ranges, so map one page more and cut off both ends
+    auto const paddedSize = size + kHugePageSize;
+    auto* const padded = static_cast<std::uint8_t*>(mapAnonymous(paddedSize, 0));
+    if (padded == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+    auto* const ptr = padded + (tc::ceilDiv(reinterpret_cast<std::uintptr_t>(padded), kHugePageSize) * kHugePageSize
+                          - reinterpret_cast<std::uintptr_t>(padded));
+    auto const head = static_cast<std::size_t>(ptr - padded);
+    if (head > 0)
+    {
+        ::munmap(padded, head);
+    }
+    if (auto const tail = paddedSize - head - size; tail > 0)
+    {
+        ::munmap(ptr + size, tail);
+    }
+    // Fails if transparent huge pages are disabled, which leaves regular pages
+    ::madvise(ptr, size, MADV_HUGEPAGE);
+    return ptr;
+}
+
+void bindToNode(void* ptr, std::size_t size, int node)
+{
+    auto constexpr kMpolBind = 2;
+    auto constexpr kBitsPerWord = sizeof(unsigned long) * 8;
+    std::vector<unsigned long> nodeMask(static_cast<std::size_t>(node) / kBitsPerWord + 1);
+    nodeMask.back() |= 1UL << (static_cast<std::size_t>(node) % kBitsPerWord);
+    // The kernel ignores the last bit of maxnode
+    if (::syscall(SYS_mbind, ptr, size, kMpolBind, nodeMask.data(), nodeMask.size() * kBitsPerWord + 1, 0) != 0)
+    {
+        static std::once_flag warned;
+        auto const error = errno;
+        std::call_once(warned,
+            [node, error]() {
+                TLLM_LOG_WARNING("Cannot bind host memory to NUMA node %d: %s", node, std::strerror(error));
+            });
+    }
+}
+#endif
+// Live thread caches of one PoolAllocator and the counters of those that have exited
+template <typename TCache>
+struct ThreadCacheRegistry
+{
+    std::mutex lock;
+    std::vector<TCache const*> caches;
+    ThreadCacheStats retired;
+};
+
+template <typename TCache>
+ThreadCacheRegistry<TCache>& getThreadCacheRegistry()
+{
+    static ThreadCacheRegistry<TCache> registry;
+    return registry;
+}
+} // namespace
+
+void* allocateHostMemory(std::size_t size, HostMemoryPolicy const& policy)
+{
+    if (policy.isMapped(size))
+    {
+#if defined(__linux__)
+        auto const mappedSize = getMappedSize(size, policy);
+        auto* const ptr = usesHugePages(size, policy) ? mapHugePages(mappedSize) : mapAnonymous(mappedSize, 0);
+        if (ptr == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+        if (policy.numaNode != HostMemoryPolicy::kAnyNode)
+        {
+            bindToNode(ptr, mappedSize, policy.numaNode);
+        }
+        return ptr;
+#else
+        static std::once_flag warned;
+        std::call_once(warned, []() { TLLM_LOG_WARNING("Huge pages and NUMA binding are only supported on Linux"); });
+#endif
+    }
+    auto* const ptr = std::malloc(size);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void freeHostMemory(void* ptr, std::size_t size, [[maybe_unused]] HostMemoryPolicy const& policy)
+{
+#if defined(__linux__)
+    if (policy.isMapped(size))
+    {
+        ::munmap(ptr, getMappedSize(size, policy));
+        return;
+    }
+#endif
+    std::free(ptr);
+}
+
 template <typename TAllocator>
 typename PoolAllocator<TAllocator>::PoolType& PoolAllocator<TAllocator>::getPool()
 {
@@ -26,6 +173,92 @@ typename PoolAllocator<TAllocator>::PoolType& PoolAllocator<TAllocator>::getPool
     return pool;
 }
 
+template <typename TAllocator>
+typename PoolAllocator<TAllocator>::ThreadCache* PoolAllocator<TAllocator>::getThreadCache()
+{
+    // Trivially destructible, so still readable by buffers freed after the cache during thread exit
+    static thread_local bool destroyed{false};
+    if (destroyed)
+    {
+        return nullptr;
+    }
+    static thread_local ThreadCache cache{getPool(), getFlushEpoch(), destroyed};
+    return &cache;
+}
+
+template <typename TAllocator>
+void PoolAllocator<TAllocator>::flushThreadCache()
+{
+    if (auto* cache = getThreadCache())
+    {
+        cache->flush();
+    }
+}
+
+template <typename TAllocator>
+void PoolAllocator<TAllocator>::requestFlushAll()
+{
+    getFlushEpoch().fetch_add(1, std::memory_order_relaxed);
+    flushThreadCache();
+}
+
+template <typename TAllocator>
+std::atomic<std::uint64_t>& PoolAllocator<TAllocator>::getFlushEpoch()
+{
+    static std::atomic<std::uint64_t> epoch{0};
+    return epoch;
+}
+
+template <typename TAllocator>
+ThreadCacheStats PoolAllocator<TAllocator>::getThreadCacheStats()
+{
+    auto& registry = getThreadCacheRegistry<ThreadCache>();
+    std::lock_guard<std::mutex> lock(registry.lock);
+    auto stats = registry.retired;
+    for (auto const* cache : registry.caches)
+    {
+        cache->addStats(stats);
+    }
+    return stats;
+}
+
+template <typename TAllocator>
+PoolAllocator<TAllocator>::ThreadCache::ThreadCache(
+    PoolType& pool, std::atomic<std::uint64_t> const& flushEpoch, bool& destroyed)
+    : mPool{pool}
+    , mFlushEpoch{flushEpoch}
+    , mSeenFlushEpoch{flushEpoch.load(std::memory_order_relaxed)}
+    , mDestroyed{destroyed}
+{
+    for (auto& magazine : mMagazines)
+    {
+        magazine.reserve(kMagazineCapacity + 1);
+    }
+    mBatchSizes.fill(1);
+    auto& registry = getThreadCacheRegistry<ThreadCache>();
+    std::lock_guard<std::mutex> lock(registry.lock);
+    registry.caches.push_back(this);
+}
+
+template <typename TAllocator>
+PoolAllocator<TAllocator>::ThreadCache::~ThreadCache()
+{
+    try
+    {
+        flush();
+    }
+    catch (std::exception const& e)
+    {
+        TLLM_LOG_EXCEPTION(e);
+    }
+    mDestroyed = true;
+    auto& registry = getThreadCacheRegistry<ThreadCache>();
+    std::lock_guard<std::mutex> lock(registry.lock);
+    addStats(registry.retired);
+    registry.caches.erase(std::find(registry.caches.begin(), registry.caches.end(), this));
+}
+
 // explicit instantiations
 template class PoolAllocator<PinnedAllocator>;
+template class PoolAllocator<HostAllocator>;
 } // namespace tensorrt_llm::runtime
@@ -19,7 +19,10 @@
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/logger.h"
+#include "tensorrt_llm/runtime/allocationAudit.h"
+#include "tensorrt_llm/runtime/bufferArena.h"
 #include "tensorrt_llm/runtime/cudaStream.h"
+#include "tensorrt_llm/runtime/hostMemoryPolicy.h"
 #include "tensorrt_llm/runtime/iBuffer.h"
 #include "tensorrt_llm/runtime/iTensor.h"
 #include "tensorrt_llm/runtime/memoryCounters.h"
@@ -28,14 +31,27 @@
 #include <cuda_runtime_api.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <limits>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <numeric>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace tensorrt_llm::runtime
 {
 
@@ -52,9 +68,30 @@ public:
     PointerType allocate(SizeType n)
     {
         PointerType ptr{};
-        static_cast<TDerived*>(this)->allocateImpl(&ptr, n);
         if constexpr (count)
-            MemoryCounters::getInstance().allocate<memoryType>(n);
+        {
+            try
+            {
+                static_cast<TDerived*>(this)->allocateImpl(&ptr, n);
+            }
+            catch (std::exception const&)
+            {
+                auto const& counters = MemoryCounters::getInstance();
+                TLLM_LOG_ERROR("Failed to allocate %s of %s memory for %s. %s", MemoryCounters::bytesToString(n).c_str(),
+                    MemoryTypeString<memoryType>::value, MemoryCounters::tagToString(mMemoryTag),
+                    counters.tagsToString().c_str());
+                throw;
+            }
+            MemoryCounters::getInstance().allocate<memoryType>(n, mMemoryTag);
+            if (AllocationAudit::isEnabled())
+            {
+                AllocationAudit::getInstance().recordAllocation(ptr, n, memoryType, mMemoryTag);
+            }
+        }
+        else
+        {
+            static_cast<TDerived*>(this)->allocateImpl(&ptr, n);
+        }
         return ptr;
     }
 
@@ -62,9 +99,16 @@ public:
     {
         if (ptr)
         {
+            if constexpr (count)
+            {
+                if (AllocationAudit::isEnabled())
+                {
+                    AllocationAudit::getInstance().recordDeallocation(ptr);
+                }
+            }
             static_cast<TDerived*>(this)->deallocateImpl(ptr, n);
             if constexpr (count)
-                MemoryCounters::getInstance().deallocate<memoryType>(n);
+                MemoryCounters::getInstance().deallocate<memoryType>(n, mMemoryTag);
         }
     }
 
@@ -72,6 +116,16 @@ public:
     {
         return memoryType;
     }
+
+    //! \brief The subsystem this allocator's memory is attributed to, taken from the MemoryTagScope it was
+    //!        constructed in.
+    [[nodiscard]] MemoryTag getMemoryTag() const
+    {
+        return mMemoryTag;
+    }
+
+private:
+    MemoryTag mMemoryTag{MemoryCounters::getCurrentTag()};
 };
 
 class CudaAllocator : public BaseAllocator<CudaAllocator, MemoryType::kGPU>
@@ -194,6 +248,81 @@ protected:
     }
 };
 
+//! \brief Allocates `size` bytes of host memory placed as `policy` asks. Sizes it does not map come from malloc.
+[[nodiscard]] void* allocateHostMemory(std::size_t size, HostMemoryPolicy const& policy);
+
+//! \brief Frees memory from allocateHostMemory, given the same size and policy.
+void freeHostMemory(void* ptr, std::size_t size, HostMemoryPolicy const& policy);
+
+//! \brief Host or pinned allocations with the page size and NUMA node of a HostMemoryPolicy.
+//!
+//! \details Mapped pinned memory is registered with CUDA after it has been bound, so that the pages are faulted in on
+//!          the requested node. Allocations the policy leaves alone behave like HostAllocator and PinnedAllocator.
+template <MemoryType memoryType>
+class PlacedHostAllocator : public BaseAllocator<PlacedHostAllocator<memoryType>, memoryType>
+{
+    static_assert(memoryType == MemoryType::kCPU || memoryType == MemoryType::kPINNED);
+    friend class BaseAllocator<PlacedHostAllocator<memoryType>, memoryType>;
+
+public:
+    using Base = BaseAllocator<PlacedHostAllocator<memoryType>, memoryType>;
+    using PointerType = typename Base::PointerType;
+    using SizeType = typename Base::SizeType;
+
+    explicit PlacedHostAllocator(HostMemoryPolicy const& policy) noexcept
+        : mPolicy{policy}
+    {
+    }
+
+    [[nodiscard]] HostMemoryPolicy const& getPolicy() const
+    {
+        return mPolicy;
+    }
+
+protected:
+    void allocateImpl(PointerType* ptr, SizeType n)
+    {
+        if constexpr (memoryType == MemoryType::kPINNED)
+        {
+            if (!mPolicy.isMapped(n))
+            {
+                TLLM_CUDA_CHECK(::cudaHostAlloc(ptr, n, cudaHostAllocDefault));
+                return;
+            }
+        }
+        *ptr = allocateHostMemory(n, mPolicy);
+        if constexpr (memoryType == MemoryType::kPINNED)
+        {
+            auto const status = ::cudaHostRegister(*ptr, n, cudaHostRegisterDefault);
+            if (status != cudaSuccess)
+            {
+                freeHostMemory(*ptr, n, mPolicy);
+                TLLM_CUDA_CHECK(status);
+            }
+        }
+    }
+
+    void deallocateImpl(PointerType ptr, SizeType n)
+    {
+        if constexpr (memoryType == MemoryType::kPINNED)
+        {
+            if (!mPolicy.isMapped(n))
+            {
+                TLLM_CUDA_CHECK(::cudaFreeHost(ptr));
+                return;
+            }
+            TLLM_CUDA_CHECK(::cudaHostUnregister(ptr));
+        }
+        freeHostMemory(ptr, n, mPolicy);
+    }
+
+private:
+    HostMemoryPolicy mPolicy;
+};
+
+using PlacedCpuAllocator = PlacedHostAllocator<MemoryType::kCPU>;
+using PlacedPinnedAllocator = PlacedHostAllocator<MemoryType::kPINNED>;
+
 template <MemoryType memoryType>
 class BorrowingAllocator : public BaseAllocator<BorrowingAllocator<memoryType>, memoryType, false>
 {
@@ -245,6 +374,14 @@ using ManagedBorrowingAllocator = BorrowingAllocator<MemoryType::kUVM>;
 /**
  * A memory manager that acts as a memory pool, preallocating a configurable
  * amount of memory. It is able to grow in size and allocate memory chunks as required.
+ *
+ * Segments are kept in address order, so a freed segment finds its neighbours for coalescing in O(1). Free segments
+ * are also indexed by power-of-two size class, ordered by size and address within a class, and a bitmap records the
+ * non-empty classes: allocation takes the best fit in the request's class or the smallest segment of the next
+ * non-empty class, and freeing looks its segment up by tag in a hash map. Both are O(log n) in the number of free
+ * segments of one class.
+ *
+ * Chunks are kept until the pool is destroyed unless trimTo() or an idle timeout hands back those without used segments.
  */
 template <typename TAllocator>
 class MemoryPool : public BaseAllocator<MemoryPool<TAllocator>, TAllocator::kMemoryType, false>
@@ -304,17 +441,29 @@ public:
     [[nodiscard]] SizeType getUsedSize() const
     {
         std::lock_guard<std::mutex> lock(mLock);
-        return std::accumulate(mMemorySegments.cbegin(), mMemorySegments.cend(), SizeType{0},
-            [](SizeType sum, auto const& chunk) { return chunk.tag ? sum + chunk.size : sum; });
+        return mUsedSize;
     }
 
     [[nodiscard]] SizeType getReservedSize() const
     {
         std::lock_guard<std::mutex> lock(mLock);
-        return std::accumulate(mAllocatedChunks.cbegin(), mAllocatedChunks.cend(), SizeType{0},
-            [](SizeType sum, auto const& chunk) { return sum + std::get<1>(chunk); });
+        return getReservedSizeUnlocked();
     }
 
+    //! \brief Returns chunks without used segments to the allocator, newest and so largest first, until at most
+    //!        `reservedSize` B are reserved. Returns the number of bytes released.
+    SizeType trimTo(SizeType reservedSize = 0);
+
+    //! \brief Releases chunks once they have been without used segments for `timeout`, checked on every allocation
+    //!        and free and in trimIdle(). A timeout of 0 disables the policy.
+    void setIdleTimeout(std::chrono::milliseconds timeout);
+
+    //! \brief Releases the chunks that have been idle for longer than the idle timeout. For callers that want chunks
+    //!        released while the pool sees no traffic. Returns the number of bytes released.
+    SizeType trimIdle();
+
+    [[nodiscard]] MemoryPoolReport getReport() const;
+
     class MemorySegment
     {
     public:
@@ -342,12 +491,53 @@ public:
     // for debugging purposes only
     void logSegments() const;
 
+    //! \brief Allocates `count` blocks of `size` B each into `ptrs`, taking the lock once. Either all blocks are
+    //!        allocated or none.
+    void allocateBatch(PointerType* ptrs, SizeType size, std::size_t count);
+
+    //! \brief Frees `count` blocks of `size` B each, taking the lock once.
+    void deallocateBatch(PointerType const* ptrs, SizeType size, std::size_t count);
+
 protected:
     void allocateImpl(PointerType* ptr, SizeType requestedSize);
 
     void deallocateImpl(PointerType tag, SizeType n);
 
 private:
+    using Clock = std::chrono::steady_clock;
+
+    void allocateUnlocked(PointerType* ptr, SizeType requestedSize);
+
+    void deallocateUnlocked(PointerType tag, SizeType n);
+
+    [[nodiscard]] SizeType getReservedSizeUnlocked() const
+    {
+        return std::accumulate(mAllocatedChunks.cbegin(), mAllocatedChunks.cend(), SizeType{0},
+            [](SizeType sum, auto const& chunk) { return sum + std::get<1>(chunk); });
+    }
+
+    //! \brief Releases the chunk at `chunkIdx` in mAllocatedChunks if it has no used segments.
+    bool releaseChunkIfFree(std::size_t chunkIdx);
+
+    //! \brief Releases chunks idle since before `now - mIdleTimeout`.
+    SizeType releaseIdleChunks(Clock::time_point now);
+
+    //! \brief Applies the idle timeout policy if there are idle chunks.
+    void checkIdleChunks()
+    {
+        if (!mIdleChunks.empty())
+        {
+            releaseIdleChunks(Clock::now());
+        }
+    }
+
+    using SegmentIterator = typename std::list<MemorySegment>::iterator;
+    // (size, address) of a free segment
+    using FreeKey = std::pair<SizeType, std::uintptr_t>;
+
+    static auto constexpr kNumSizeClasses = std::numeric_limits<SizeType>::digits;
+    static_assert(kNumSizeClasses <= 64, "Size class bitmap holds 64 classes");
+
     SizeType mChunkSize;
     TAllocator mAllocator;
     std::mutex mutable mLock{};
@@ -355,12 +545,97 @@ private:
     std::list<MemorySegment> mMemorySegments = {};
     std::vector<std::tuple<PointerType, SizeType>> mAllocatedChunks = {};
 
+    // Free segments by floor(log2(size))
+    std::array<std::map<FreeKey, SegmentIterator>, kNumSizeClasses> mFreeSegments{};
+    std::uint64_t mNonEmptyClasses{0};
+    std::unordered_map<PointerType, SegmentIterator> mUsedSegments{};
+    SizeType mUsedSize{0};
+
+    // Chunks without used segments and since when, only tracked while an idle timeout is set
+    Clock::duration mIdleTimeout{0};
+    std::vector<std::pair<PointerType, Clock::time_point>> mIdleChunks{};
+
+    static std::size_t sizeClass(SizeType size)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, size);
+        return index;
+#else
+        return kNumSizeClasses - 1 - __builtin_clzll(size);
+#endif
+    }
+
+    static std::size_t lowestClass(std::uint64_t classes)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, classes);
+        return index;
+#else
+        return __builtin_ctzll(classes);
+#endif
+    }
+
+    static FreeKey freeKey(MemorySegment const& segment)
+    {
+        return {segment.size,
+            reinterpret_cast<std::uintptr_t>(static_cast<std::uint8_t*>(segment.basePointer) + segment.offset)};
+    }
+
+    void insertFree(SegmentIterator segment)
+    {
+        auto const sc = sizeClass(segment->size);
+        mFreeSegments[sc].emplace(freeKey(*segment), segment);
+        mNonEmptyClasses |= std::uint64_t{1} << sc;
+    }
+
+    void eraseFree(SegmentIterator segment)
+    {
+        auto const sc = sizeClass(segment->size);
+        auto& freeSegments = mFreeSegments[sc];
+        freeSegments.erase(freeKey(*segment));
+        if (freeSegments.empty())
+        {
+            mNonEmptyClasses &= ~(std::uint64_t{1} << sc);
+        }
+    }
+
+    // Best-fitting free segment, or the end of mMemorySegments
+    SegmentIterator findFree(SizeType size)
+    {
+        auto const sc = sizeClass(size);
+        auto const& freeSegments = mFreeSegments[sc];
+        if (auto fit = freeSegments.lower_bound(FreeKey{size, 0}); fit != freeSegments.end())
+        {
+            return fit->second;
+        }
+        // Every segment of a larger class fits, the smallest one is the best fit
+        auto const larger = mNonEmptyClasses & ~((std::uint64_t{2} << sc) - 1);
+        if (larger == 0)
+        {
+            return mMemorySegments.end();
+        }
+        return mFreeSegments[lowestClass(larger)].begin()->second;
+    }
+
+    // Whether `segment` is free and spans its whole chunk
+    bool isFreeChunk(SegmentIterator segment) const
+    {
+        auto const next = std::next(segment);
+        return segment->tag == nullptr && segment->offset == 0
+            && (next == mMemorySegments.end() || next->basePointer != segment->basePointer);
+    }
+
     void allocateChunk()
     {
         TLLM_LOG_DEBUG("MemoryPool: Allocating %zu B", mChunkSize);
+        // The blocks are audited by PoolAllocator, chunks would count them twice
+        AllocationAudit::SuppressScope const suppressAudit;
         auto basePointer = mAllocator.allocate(mChunkSize);
         mAllocatedChunks.emplace_back(basePointer, mChunkSize);
         mMemorySegments.push_back(MemorySegment{basePointer, mChunkSize});
+        insertFree(std::prev(mMemorySegments.end()));
     }
 };
 
@@ -368,6 +643,177 @@ template <typename TAllocator>
 void MemoryPool<TAllocator>::allocateImpl(MemoryPool::PointerType* ptr, MemoryPool::SizeType requestedSize)
 {
     std::lock_guard<std::mutex> lock(mLock);
+    allocateUnlocked(ptr, requestedSize);
+    checkIdleChunks();
+}
+
+template <typename TAllocator>
+void MemoryPool<TAllocator>::deallocateImpl(PointerType tag, SizeType n)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    deallocateUnlocked(tag, n);
+    checkIdleChunks();
+}
+
+template <typename TAllocator>
+typename MemoryPool<TAllocator>::SizeType MemoryPool<TAllocator>::trimTo(SizeType reservedSize)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    auto const initReservedSize = getReservedSizeUnlocked();
+    auto currentReservedSize = initReservedSize;
+    for (auto chunkIdx = mAllocatedChunks.size(); chunkIdx > 0 && currentReservedSize > reservedSize; --chunkIdx)
+    {
+        auto const chunkSize = std::get<1>(mAllocatedChunks[chunkIdx - 1]);
+        if (releaseChunkIfFree(chunkIdx - 1))
+        {
+            currentReservedSize -= chunkSize;
+        }
+    }
+    return initReservedSize - currentReservedSize;
+}
+
+template <typename TAllocator>
+void MemoryPool<TAllocator>::setIdleTimeout(std::chrono::milliseconds timeout)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    mIdleTimeout = timeout;
+    mIdleChunks.clear();
+    if (timeout.count() > 0)
+    {
+        // Chunks that are free already are idle from now on
+        auto const now = Clock::now();
+        for (auto it = mMemorySegments.begin(); it != mMemorySegments.end(); ++it)
+        {
+            if (isFreeChunk(it))
+            {
+                mIdleChunks.emplace_back(it->basePointer, now);
+            }
+        }
+    }
+}
+
+template <typename TAllocator>
+typename MemoryPool<TAllocator>::SizeType MemoryPool<TAllocator>::trimIdle()
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    return mIdleChunks.empty() ? 0 : releaseIdleChunks(Clock::now());
+}
+
+template <typename TAllocator>
+typename MemoryPool<TAllocator>::SizeType MemoryPool<TAllocator>::releaseIdleChunks(Clock::time_point now)
+{
+    std::vector<PointerType> expired;
+    for (auto const& [basePointer, idleSince] : mIdleChunks)
+    {
+        if (now - idleSince >= mIdleTimeout)
+        {
+            expired.push_back(basePointer);
+        }
+    }
+    SizeType releasedSize{0};
+    for (auto const basePointer : expired)
+    {
+        auto const chunk = std::find_if(mAllocatedChunks.begin(), mAllocatedChunks.end(),
+            [basePointer](auto const& chunk) { return std::get<0>(chunk) == basePointer; });
+        auto const chunkSize = std::get<1>(*chunk);
+        if (releaseChunkIfFree(static_cast<std::size_t>(std::distance(mAllocatedChunks.begin(), chunk))))
+        {
+            releasedSize += chunkSize;
+        }
+    }
+    return releasedSize;
+}
+
+template <typename TAllocator>
+bool MemoryPool<TAllocator>::releaseChunkIfFree(std::size_t chunkIdx)
+{
+    auto const [basePointer, chunkSize] = mAllocatedChunks[chunkIdx];
+    // The segments of a chunk are adjacent and in address order
+    auto const segment = std::find_if(mMemorySegments.begin(), mMemorySegments.end(),
+        [basePointer = basePointer](auto const& segment) { return segment.basePointer == basePointer; });
+    TLLM_CHECK(segment != mMemorySegments.end());
+    if (!isFreeChunk(segment))
+    {
+        return false;
+    }
+    TLLM_LOG_DEBUG("MemoryPool: Releasing chunk of %zu B", chunkSize);
+    mAllocator.deallocate(basePointer, chunkSize);
+    eraseFree(segment);
+    mMemorySegments.erase(segment);
+    mAllocatedChunks.erase(mAllocatedChunks.begin() + static_cast<std::ptrdiff_t>(chunkIdx));
+    mIdleChunks.erase(std::remove_if(mIdleChunks.begin(), mIdleChunks.end(),
+                          [basePointer = basePointer](auto const& idle) { return idle.first == basePointer; }),
+        mIdleChunks.end());
+    return true;
+}
+
+template <typename TAllocator>
+MemoryPoolReport MemoryPool<TAllocator>::getReport() const
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    MemoryPoolReport report{};
+    report.reservedSize = getReservedSizeUnlocked();
+    report.usedSize = mUsedSize;
+    report.numChunks = mAllocatedChunks.size();
+    for (std::size_t sc = 0; sc < kNumSizeClasses; ++sc)
+    {
+        auto const& freeSegments = mFreeSegments[sc];
+        if (freeSegments.empty())
+        {
+            continue;
+        }
+        report.freeBytesHistogram.resize(sc + 1, 0);
+        for (auto const& [key, segment] : freeSegments)
+        {
+            report.freeBytesHistogram[sc] += segment->size;
+            report.numFreeChunks += isFreeChunk(segment) ? 1 : 0;
+        }
+        report.numFreeSegments += freeSegments.size();
+        report.freeSize += report.freeBytesHistogram[sc];
+        // Ordered by size within the class
+        report.largestFreeSegment = std::prev(freeSegments.end())->first.first;
+    }
+    return report;
+}
+
+template <typename TAllocator>
+void MemoryPool<TAllocator>::allocateBatch(PointerType* ptrs, SizeType size, std::size_t count)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    std::size_t i = 0;
+    try
+    {
+        for (; i < count; ++i)
+        {
+            allocateUnlocked(ptrs + i, size);
+        }
+        checkIdleChunks();
+    }
+    catch (...)
+    {
+        // All or nothing
+        while (i > 0)
+        {
+            deallocateUnlocked(ptrs[--i], size);
+        }
+        throw;
+    }
+}
+
+template <typename TAllocator>
+void MemoryPool<TAllocator>::deallocateBatch(PointerType const* ptrs, SizeType size, std::size_t count)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        deallocateUnlocked(ptrs[i], size);
+    }
+    checkIdleChunks();
+}
+
+template <typename TAllocator>
+void MemoryPool<TAllocator>::allocateUnlocked(PointerType* ptr, SizeType requestedSize)
+{
     // Align requested size to kAlignment
     // When requesting 0 B, default to allocating 1 B (from "Effective C++", item 51)
     // See https://stackoverflow.com/questions/2660076/returning-aligned-memory-with-new
@@ -376,9 +822,7 @@ void MemoryPool<TAllocator>::allocateImpl(MemoryPool::PointerType* ptr, MemoryPo
 
     TLLM_LOG_DEBUG("MemoryPool: Requested to reserve %zu B (%zu B aligned)", requestedSize, alignedRequest);
 
-    // Finds first free segment providing sufficient space
-    auto it = std::find_if(mMemorySegments.begin(), mMemorySegments.end(),
-        [alignedRequest](auto const& ms) { return ms.tag == nullptr && ms.size >= alignedRequest; });
+    auto it = findFree(alignedRequest);
 
     if (it == mMemorySegments.end())
     {
@@ -401,32 +845,47 @@ void MemoryPool<TAllocator>::allocateImpl(MemoryPool::PointerType* ptr, MemoryPo
     auto const offset = it->offset;
     auto const basePointer = it->basePointer;
 
+    if (offset == 0 && !mIdleChunks.empty())
+    {
+        // The chunk may have been idle
+        mIdleChunks.erase(std::remove_if(mIdleChunks.begin(), mIdleChunks.end(),
+                              [basePointer](auto const& idle) { return idle.first == basePointer; }),
+            mIdleChunks.end());
+    }
+
     // Update current segment
+    eraseFree(it);
     it->offset += alignedRequest;
     it->size -= alignedRequest;
     if (it->size == 0)
     {
         it = mMemorySegments.erase(it);
     }
+    else
+    {
+        insertFree(it);
+    }
 
     // Update pointer
     *ptr = static_cast<PointerType>(static_cast<std::uint8_t*>(basePointer) + offset);
 
     // Insert an occupied segment
-    mMemorySegments.insert(it, MemorySegment{basePointer, alignedRequest, offset, *ptr});
+    mUsedSegments.emplace(*ptr, mMemorySegments.insert(it, MemorySegment{basePointer, alignedRequest, offset, *ptr}));
+    mUsedSize += alignedRequest;
 }
 
 template <typename TAllocator>
-void MemoryPool<TAllocator>::deallocateImpl(PointerType tag, SizeType n)
+void MemoryPool<TAllocator>::deallocateUnlocked(PointerType tag, SizeType n)
 {
-    std::lock_guard<std::mutex> lock(mLock);
-    auto it = std::find_if(mMemorySegments.begin(), mMemorySegments.end(),
-        [&tag](MemorySegment const& segment) { return segment.tag == tag; });
+    auto const used = mUsedSegments.find(tag);
 
-    TLLM_CHECK_WITH_INFO(it != mMemorySegments.end(), "MemoryPool free: Requested tag %p could not be found", tag);
+    TLLM_CHECK_WITH_INFO(used != mUsedSegments.end(), "MemoryPool free: Requested tag %p could not be found", tag);
 
     // Free found tag
+    auto it = used->second;
+    mUsedSegments.erase(used);
     it->tag = nullptr;
+    mUsedSize -= it->size;
 
     if (it->size < n)
     {
@@ -439,6 +898,7 @@ void MemoryPool<TAllocator>::deallocateImpl(PointerType tag, SizeType n)
         auto previousIt = std::prev(it);
         if (previousIt->tag == nullptr && previousIt->basePointer == it->basePointer)
         {
+            eraseFree(previousIt);
             previousIt->size += it->size;
             // Remove current element, and point to previous one
             it = std::prev(mMemorySegments.erase(it));
@@ -451,11 +911,19 @@ void MemoryPool<TAllocator>::deallocateImpl(PointerType tag, SizeType n)
         auto nextIt = std::next(it);
         if (nextIt->tag == nullptr && nextIt->basePointer == it->basePointer)
         {
+            eraseFree(nextIt);
             it->size += nextIt->size;
             // Remove next tag
             mMemorySegments.erase(nextIt);
         }
     }
+
+    insertFree(it);
+
+    if (mIdleTimeout.count() > 0 && isFreeChunk(it))
+    {
+        mIdleChunks.emplace_back(it->basePointer, Clock::now());
+    }
 }
 
 template <typename TAllocator>
@@ -469,6 +937,26 @@ void MemoryPool<TAllocator>::logSegments() const
     }
 }
 
+//! \brief Counters of the per-thread caches of a PoolAllocator, summed over all threads.
+struct ThreadCacheStats
+{
+    std::size_t hits{0};    // allocations served from a thread cache
+    std::size_t misses{0};  // allocations that went to the pool
+    std::size_t refills{0}; // batches taken from the pool
+    std::size_t flushes{0}; // batches returned to the pool
+    std::size_t cachedBytes{0};
+};
+
+//! \brief Allocator for a process-wide MemoryPool.
+//!
+//! \details Each thread keeps magazines of recently freed blocks, one per size class, so that most allocations and
+//!          frees do not take the pool lock. Requests up to kMaxCachedSize are rounded up to one of four size classes
+//!          per power of two (at most 25% larger), which lets a block freed on any thread serve any request of its
+//!          class. An empty magazine is refilled with a batch from the pool, starting at one block and doubling on
+//!          every refill of that class, and a full one gives its older half back to the pool. A thread caches at most
+//!          kMaxThreadCacheBytes and flushes everything when it exits. Blocks in a thread cache count as used by the
+//!          pool and keep their chunks from being released; call flushThreadCache() before inspecting it, and
+//!          requestFlushAll() to have the other threads flush theirs on their next allocation or free.
 template <typename TAllocator>
 class PoolAllocator : public BaseAllocator<PoolAllocator<TAllocator>, TAllocator::kMemoryType, false>
 {
@@ -480,23 +968,301 @@ public:
     using SizeType = typename Base::SizeType;
     using PoolType = MemoryPool<TAllocator>;
 
+    static SizeType constexpr kMaxCachedSize{SizeType{1} << 20}; // 1 MB
+    static SizeType constexpr kMaxThreadCacheBytes{SizeType{1} << 23}; // 8 MB
+    static std::size_t constexpr kMagazineCapacity{16};
+
     static PoolType& getPool();
 
+    //! \brief Returns the blocks cached by the calling thread to the pool.
+    static void flushThreadCache();
+
+    //! \brief Flushes the calling thread's cache and has every other thread flush its own on its next allocation or
+    //!        free. A thread that does neither keeps its blocks until it exits.
+    static void requestFlushAll();
+
+    static ThreadCacheStats getThreadCacheStats();
+
 protected:
     void allocateImpl(PointerType* ptr, SizeType n) // NOLINT(readability-convert-member-functions-to-static)
     {
-        *ptr = getPool().allocate(n);
+        // A cacheable block is always of its class size, wherever it is allocated or freed: a thread whose cache is
+        // gone at exit allocates and frees through the pool, and its blocks can end up in another thread's cache.
+        auto* cache = n <= kMaxCachedSize ? getThreadCache() : nullptr;
+        *ptr = cache != nullptr ? cache->allocate(n) : getPool().allocate(blockSize(n));
+        if (AllocationAudit::isEnabled())
+        {
+            AllocationAudit::getInstance().recordAllocation(*ptr, n, Base::kMemoryType, this->getMemoryTag());
+        }
     }
 
     void deallocateImpl( // NOLINT(readability-convert-member-functions-to-static)
         typename TAllocator::PointerType ptr, SizeType n)
     {
-        getPool().deallocate(ptr, n);
+        if (AllocationAudit::isEnabled())
+        {
+            AllocationAudit::getInstance().recordDeallocation(ptr);
+        }
+        auto* cache = n <= kMaxCachedSize ? getThreadCache() : nullptr;
+        if (cache != nullptr)
+        {
+            cache->deallocate(ptr, n);
+        }
+        else
+        {
+            getPool().deallocate(ptr, blockSize(n));
+        }
+    }
+
+private:
+    class ThreadCache;
+
+    //! \brief The size of the pool block backing an allocation of `n` B.
+    static SizeType blockSize(SizeType n);
+
+    //! \brief The calling thread's cache, or nullptr once it has been destroyed at thread exit.
+    static ThreadCache* getThreadCache();
+
+    //! \brief Incremented by requestFlushAll(), a cache flushes when it sees a new value.
+    static std::atomic<std::uint64_t>& getFlushEpoch();
+};
+
+template <typename TAllocator>
+class PoolAllocator<TAllocator>::ThreadCache
+{
+public:
+    static auto constexpr kAlignment = PoolType::kAlignment;
+    // Sizes 1-4 in units of kAlignment, then four classes per power of two up to kMaxCachedSize
+    static std::size_t constexpr kNumClasses{44};
+    static_assert(kMaxCachedSize == (4 * kAlignment) << ((kNumClasses - 4) / 4));
+
+    ThreadCache(PoolType& pool, std::atomic<std::uint64_t> const& flushEpoch, bool& destroyed);
+
+    ~ThreadCache();
+
+    ThreadCache(ThreadCache const&) = delete;
+    ThreadCache& operator=(ThreadCache const&) = delete;
+
+    static SizeType blockSize(SizeType n)
+    {
+        return classSize(sizeClass(n));
+    }
+
+    PointerType allocate(SizeType n)
+    {
+        auto const sc = sizeClass(n);
+        if (isFlushRequested())
+        {
+            // Rather than refilling, which would cache a batch again right away
+            flush();
+            bump(mStats.misses);
+            return mPool.allocate(classSize(sc));
+        }
+        auto& magazine = mMagazines[sc];
+        if (magazine.empty())
+        {
+            refill(sc);
+        }
+        else
+        {
+            bump(mStats.hits);
+        }
+        auto* const ptr = magazine.back();
+        magazine.pop_back();
+        setCachedBytes(mCachedBytes - classSize(sc));
+        return ptr;
+    }
+
+    void deallocate(PointerType ptr, SizeType n)
+    {
+        auto const sc = sizeClass(n);
+        auto& magazine = mMagazines[sc];
+        magazine.push_back(ptr);
+        setCachedBytes(mCachedBytes + classSize(sc));
+        if (magazine.size() > kMagazineCapacity)
+        {
+            flush(sc, magazine.size() / 2);
+        }
+        if (mCachedBytes > kMaxThreadCacheBytes)
+        {
+            flush(sc, magazine.size());
+        }
+        if (isFlushRequested())
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        mSeenFlushEpoch = mFlushEpoch.load(std::memory_order_relaxed);
+        for (std::size_t sc = 0; sc < kNumClasses; ++sc)
+        {
+            flush(sc, mMagazines[sc].size());
+        }
     }
+
+    //! \brief Adds this cache's counters to `stats`. May be called from any thread.
+    void addStats(ThreadCacheStats& stats) const
+    {
+        stats.hits += mStats.hits.load(std::memory_order_relaxed);
+        stats.misses += mStats.misses.load(std::memory_order_relaxed);
+        stats.refills += mStats.refills.load(std::memory_order_relaxed);
+        stats.flushes += mStats.flushes.load(std::memory_order_relaxed);
+        stats.cachedBytes += mStats.cachedBytes.load(std::memory_order_relaxed);
+    }
+
+private:
+    // Written by the owning thread only, read by getThreadCacheStats()
+    struct AtomicStats
+    {
+        std::atomic<std::size_t> hits{0};
+        std::atomic<std::size_t> misses{0};
+        std::atomic<std::size_t> refills{0};
+        std::atomic<std::size_t> flushes{0};
+        std::atomic<std::size_t> cachedBytes{0};
+    };
+
+    static std::size_t floorLog2(std::size_t x)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, x);
+        return index;
+#else
+        return 63 - __builtin_clzll(x);
+#endif
+    }
+
+    static std::size_t sizeClass(SizeType n)
+    {
+        auto const units = std::max(common::ceilDiv(n, kAlignment), SizeType{1});
+        if (units <= 4)
+        {
+            return units - 1;
+        }
+        auto const shift = floorLog2(units - 1) - 2;
+        return 4 * shift + ((units - 1) >> shift);
+    }
+
+    static SizeType classSize(std::size_t sc)
+    {
+        if (sc < 4)
+        {
+            return (sc + 1) * kAlignment;
+        }
+        auto const shift = sc / 4 - 1;
+        return ((sc % 4 + 5) << shift) * kAlignment;
+    }
+
+    static void bump(std::atomic<std::size_t>& counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool isFlushRequested() const
+    {
+        return mFlushEpoch.load(std::memory_order_relaxed) != mSeenFlushEpoch;
+    }
+
+    void setCachedBytes(SizeType bytes)
+    {
+        mCachedBytes = bytes;
+        mStats.cachedBytes.store(bytes, std::memory_order_relaxed);
+    }
+
+    void refill(std::size_t sc)
+    {
+        auto const size = classSize(sc);
+        auto& batch = mBatchSizes[sc];
+        // At least the block asked for, the rest within the byte budget
+        auto const count = std::max<std::size_t>(
+            1, std::min<std::size_t>(batch, (kMaxThreadCacheBytes - std::min(mCachedBytes, kMaxThreadCacheBytes)) / size));
+        batch = std::min(batch * 2, kMagazineCapacity / 2);
+        auto& magazine = mMagazines[sc];
+        magazine.resize(count);
+        try
+        {
+            mPool.allocateBatch(magazine.data(), size, count);
+        }
+        catch (...)
+        {
+            magazine.clear();
+            throw;
+        }
+        setCachedBytes(mCachedBytes + count * size);
+        bump(mStats.misses);
+        bump(mStats.refills);
+    }
+
+    //! \brief Returns the oldest `count` blocks of class `sc` to the pool.
+    void flush(std::size_t sc, std::size_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        auto& magazine = mMagazines[sc];
+        auto const size = classSize(sc);
+        mPool.deallocateBatch(magazine.data(), size, count);
+        magazine.erase(magazine.begin(), magazine.begin() + static_cast<std::ptrdiff_t>(count));
+        setCachedBytes(mCachedBytes - count * size);
+        bump(mStats.flushes);
+    }
+
+    PoolType& mPool;
+    std::atomic<std::uint64_t> const& mFlushEpoch;
+    std::uint64_t mSeenFlushEpoch;
+    bool& mDestroyed;
+    std::array<std::vector<PointerType>, kNumClasses> mMagazines{};
+    std::array<std::size_t, kNumClasses> mBatchSizes{};
+    SizeType mCachedBytes{0};
+    AtomicStats mStats{};
 };
 
+template <typename TAllocator>
+typename PoolAllocator<TAllocator>::SizeType PoolAllocator<TAllocator>::blockSize(SizeType n)
+{
+    return n <= kMaxCachedSize ? ThreadCache::blockSize(n) : n;
+}
+
 using PinnedPoolAllocator = PoolAllocator<PinnedAllocator>;
 
+//! \brief Allocator carving buffers from a BufferArena. Freeing is a no-op, the memory goes back with the arena.
+template <MemoryType memoryType>
+class ArenaAllocator : public BaseAllocator<ArenaAllocator<memoryType>, memoryType, false>
+{
+    friend class BaseAllocator<ArenaAllocator<memoryType>, memoryType, false>;
+
+public:
+    using Base = BaseAllocator<ArenaAllocator<memoryType>, memoryType, false>;
+    using PointerType = typename Base::PointerType;
+    using SizeType = typename Base::SizeType;
+
+    explicit ArenaAllocator(BufferArena::SharedPtr arena)
+        : mArena{std::move(arena)}
+    {
+        TLLM_CHECK_WITH_INFO(static_cast<bool>(mArena), "Undefined arena");
+        TLLM_CHECK_WITH_INFO(mArena->getMemoryType() == memoryType, "Arena memory type mismatch");
+    }
+
+    [[nodiscard]] BufferArena::SharedPtr const& getArena() const
+    {
+        return mArena;
+    }
+
+protected:
+    void allocateImpl(PointerType* ptr, SizeType n)
+    {
+        *ptr = mArena->allocate(n);
+    }
+
+    void deallocateImpl([[maybe_unused]] PointerType ptr, [[maybe_unused]] SizeType n) {}
+
+private:
+    BufferArena::SharedPtr mArena;
+};
+
 // Adopted from https://github.com/NVIDIA/TensorRT/blob/release/8.6/samples/common/buffers.h
 
 //!
@@ -673,6 +1439,11 @@ using HostBuffer = GenericBuffer<HostAllocator>;
 using PinnedBuffer = GenericBuffer<PinnedAllocator>;
 using PinnedPoolBuffer = GenericBuffer<PinnedPoolAllocator>;
 using UVMBuffer = GenericBuffer<UVMAllocator>;
+using PlacedHostBuffer = GenericBuffer<PlacedCpuAllocator>;
+using PlacedPinnedBuffer = GenericBuffer<PlacedPinnedAllocator>;
+using HostArenaBuffer = GenericBuffer<ArenaAllocator<MemoryType::kCPU>>;
+using PinnedArenaBuffer = GenericBuffer<ArenaAllocator<MemoryType::kPINNED>>;
+using DeviceArenaBuffer = GenericBuffer<ArenaAllocator<MemoryType::kGPU>>;
 
 template <typename T>
 typename std::make_unsigned<T>::type nonNegative(T value)
@@ -763,5 +1534,10 @@ using HostTensor = GenericTensor<HostAllocator>;
 using PinnedTensor = GenericTensor<PinnedAllocator>;
 using PinnedPoolTensor = GenericTensor<PinnedPoolAllocator>;
 using UVMTensor = GenericTensor<UVMAllocator>;
+using PlacedHostTensor = GenericTensor<PlacedCpuAllocator>;
+using PlacedPinnedTensor = GenericTensor<PlacedPinnedAllocator>;
+using HostArenaTensor = GenericTensor<ArenaAllocator<MemoryType::kCPU>>;
+using PinnedArenaTensor = GenericTensor<ArenaAllocator<MemoryType::kPINNED>>;
+using DeviceArenaTensor = GenericTensor<ArenaAllocator<MemoryType::kGPU>>;
 
 } // namespace tensorrt_llm::runtime
@@ -15,6 +15,7 @@
  */
 #include "tllmRuntime.h"
 #include "tensorrt_llm/common/nvtxUtils.h"
+#include "tensorrt_llm/runtime/memoryCounters.h"
 #include "tllmLogger.h"
 
 #include <limits>
@@ -64,9 +65,11 @@ TllmRuntime::TllmRuntime(void const* engineData, std::size_t engineSize, nvinfer
     , mBufferManager{mStream, true} // Ensure to trim the memory pool on destruction.
     , mRuntime{nvinfer1::createInferRuntime(logger)}
     , mEngine{mRuntime->deserializeCudaEngine(engineData, engineSize)}
+    , mBindingPlan{mEngine != nullptr ? BindingPlan::describeEngine(*mEngine) : std::vector<IOTensorDesc>{}}
 {
     TLLM_CHECK_WITH_INFO(mEngine != nullptr, "Failed to deserialize cuda engine");
     auto const devMemorySize = mEngine->getDeviceMemorySize();
+    MemoryTagScope const memoryTag{MemoryTag::kWORKSPACE};
     mEngineBuffer = mBufferManager.gpu(devMemorySize);
 }
 
@@ -79,6 +82,7 @@ nvinfer1::IExecutionContext& TllmRuntime::addContext(std::int32_t profileIndex)
 {
     TLLM_CHECK(0 <= profileIndex && profileIndex < mEngine->getNbOptimizationProfiles());
     mContexts.emplace_back(mEngine->createExecutionContextWithoutDeviceMemory());
+    mBindings.emplace_back(mBindingPlan.getNbSlots());
     auto& context = *mContexts.back();
     context.setDeviceMemory(mEngineBuffer->data());
     context.setOptimizationProfileAsync(profileIndex, mStream->get());
@@ -92,6 +96,7 @@ void TllmRuntime::clearContexts()
         context.reset();
     }
     mContexts.clear();
+    mBindings.clear();
 }
 
 bool TllmRuntime::executeContext(SizeType contextIndex) const
@@ -102,48 +107,42 @@ bool TllmRuntime::executeContext(SizeType contextIndex) const
 }
 
 void TllmRuntime::setInputTensors(SizeType contextIndex, TensorMap const& tensorMap)
+{
+    // Callers of the TensorMap overloads may pass a different map at the same address every time
+    mMapSlots.clear();
+    setInputTensors(contextIndex, mMapSlots.update(mBindingPlan, tensorMap));
+    mMapSlots.clear();
+}
+
+void TllmRuntime::setInputTensors(SizeType contextIndex, TensorSlots const& tensorSlots)
 {
     NVTX3_FUNC_RANGE();
     auto& context = getContext(contextIndex);
-    for (std::int32_t i = 0; i < mEngine->getNbIOTensors(); ++i)
+    auto& bindings = mBindings.at(contextIndex);
+    TLLM_CHECK(static_cast<SizeType>(tensorSlots.size()) == mBindingPlan.getNbSlots());
+    bool shapesChanged{false};
+    for (auto const slot : mBindingPlan.getInputSlots())
     {
-        auto const name = mEngine->getIOTensorName(i);
-        if (mEngine->getTensorIOMode(name) == nvinfer1::TensorIOMode::kINPUT)
+        auto const& desc = mBindingPlan.getTensorDesc(slot);
+        auto const* const name = desc.name.c_str();
+        auto const& tensor = tensorSlots[slot];
+        if (!tensor)
         {
-            auto pos = tensorMap.find(name);
-            if (pos == tensorMap.end())
-            {
-                auto expectedShape = mEngine->getTensorShape(name);
-                TLLM_THROW(
-                    "Input tensor '%s' not found; expected shape: %s", name, ITensor::toString(expectedShape).c_str());
-            }
-            auto const& tensor = pos->second;
-            auto const tensorDtype = tensor->getDataType();
-            auto const engineDtype = mEngine->getTensorDataType(name);
-            // WAR: TRT does not support mixed FP8 and FP16 input, so engine expects FP16 tensors.
-            TLLM_CHECK_WITH_INFO(tensorDtype == engineDtype
-                    || (tensorDtype == nvinfer1::DataType::kFP8 && engineDtype == nvinfer1::DataType::kHALF),
-                "%s: expected type %d, provided type %d", name, static_cast<std::int32_t>(engineDtype),
-                static_cast<std::int32_t>(tensorDtype));
-
-            auto const shapeExpected = mEngine->getTensorShape(name);
-            auto const shapeProvided = tensor->getShape();
-            TLLM_CHECK_WITH_INFO(shapeExpected.nbDims == shapeProvided.nbDims, "%s: expected %d dims, provided %d dims",
-                name, shapeExpected.nbDims, shapeProvided.nbDims);
-            for (SizeType j = 0; j < shapeExpected.nbDims; ++j)
-            {
-                auto const dimExpected = shapeExpected.d[j];
-                auto const dimProvided = shapeProvided.d[j];
-                if (dimExpected >= 0 && dimExpected != dimProvided)
-                {
-                    TLLM_LOG_WARNING(
-                        "%s: expected dim[%d] = %d, provided dim[%d] = %d", name, j, dimExpected, j, dimProvided);
-                }
-            }
+            TLLM_THROW("Input tensor '%s' not found; expected shape: %s", name, ITensor::toString(desc.shape).c_str());
+        }
+        auto const& shapeProvided = tensor->getShape();
+        auto* const data = tensor->data();
+        auto const change = bindings.compare(slot, data, tensor->getDataType(), shapeProvided);
+        if (change.shape || desc.isShapeInferenceIO)
+        {
+            mBindingPlan.validateInput(slot, *tensor);
             TLLM_CHECK_WITH_INFO(context.setInputShape(name, shapeProvided),
                 "Tensor '%s' has invalid shape %s, expected %s", name, ITensor::toString(shapeProvided).c_str(),
-                ITensor::toString(shapeExpected).c_str());
-            auto* const data = tensor->data();
+                ITensor::toString(desc.shape).c_str());
+            shapesChanged = true;
+        }
+        if (change.address)
+        {
             if (data)
             {
                 context.setInputTensorAddress(name, data);
@@ -159,61 +158,90 @@ void TllmRuntime::setInputTensors(SizeType contextIndex, TensorMap const& tensor
                 context.setInputTensorAddress(name, mDummyTensor->data());
             }
         }
+        bindings.set(slot, data, tensor->getDataType(), shapeProvided);
     }
 
+    if (!shapesChanged)
+    {
+        return;
+    }
+    bindings.clearOutputShapes();
+
+    try
     {
-        NVTX3_SCOPED_RANGE(infer_shapes);
-        char const* missing;
-        auto const nbMissing = context.inferShapes(1, &missing);
-        if (nbMissing > 0)
         {
-            TLLM_THROW("Input shape not specified: %s", missing);
+            NVTX3_SCOPED_RANGE(infer_shapes);
+            char const* missing;
+            auto const nbMissing = context.inferShapes(1, &missing);
+            if (nbMissing > 0)
+            {
+                TLLM_THROW("Input shape not specified: %s", missing);
+            }
+            else if (nbMissing < 0)
+            {
+                TLLM_THROW("Invalid input shape");
+            }
         }
-        else if (nbMissing < 0)
+
         {
-            TLLM_THROW("Invalid input shape");
+            NVTX3_SCOPED_RANGE(final_checks);
+            TLLM_CHECK_WITH_INFO(context.allInputDimensionsSpecified(), "Input dimensions not specified");
+            TLLM_CHECK_WITH_INFO(context.allInputShapesSpecified(), "Input shapes not specified");
         }
     }
-
+    catch (std::exception const&)
     {
-        NVTX3_SCOPED_RANGE(final_checks);
-        TLLM_CHECK_WITH_INFO(context.allInputDimensionsSpecified(), "Input dimensions not specified");
-        TLLM_CHECK_WITH_INFO(context.allInputShapesSpecified(), "Input shapes not specified");
+        // Check the shapes again on the next call instead of skipping them as unchanged
+        bindings.clear();
+        throw;
     }
 }
 
 void TllmRuntime::setOutputTensors(SizeType contextIndex, TensorMap& tensorMap)
+{
+    mMapSlots.clear();
+    setOutputTensors(contextIndex, mMapSlots.update(mBindingPlan, tensorMap));
+    // Add the outputs allocated for the map
+    mMapSlots.storeMissing(tensorMap);
+    mMapSlots.clear();
+}
+
+void TllmRuntime::setOutputTensors(SizeType contextIndex, TensorSlots& tensorSlots)
 {
     NVTX3_FUNC_RANGE();
     auto& context = getContext(contextIndex);
-    for (std::int32_t i = 0; i < mEngine->getNbIOTensors(); ++i)
+    auto& bindings = mBindings.at(contextIndex);
+    TLLM_CHECK(static_cast<SizeType>(tensorSlots.size()) == mBindingPlan.getNbSlots());
+    for (auto const slot : mBindingPlan.getOutputSlots())
     {
-        auto const name = mEngine->getIOTensorName(i);
-        if (mEngine->getTensorIOMode(name) == nvinfer1::TensorIOMode::kOUTPUT)
+        auto const& desc = mBindingPlan.getTensorDesc(slot);
+        auto const* const name = desc.name.c_str();
+        // Output shapes only change after the input shapes did
+        auto const* dims = bindings.getOutputShape(slot);
+        if (dims == nullptr)
         {
-            auto const dims = context.getTensorShape(name);
-            auto const engineDtype = mEngine->getTensorDataType(name);
-            auto pos = tensorMap.find(name);
-            if (pos != tensorMap.end())
-            {
-                auto const& tensor = pos->second;
-                auto const tensorDtype = tensor->getDataType();
-                // WAR: TRT does not support mixed FP8 and FP16 input, so engine expects FP16 tensors.
-                TLLM_CHECK_WITH_INFO(tensorDtype == engineDtype
-                        || (tensorDtype == nvinfer1::DataType::kFP8 && engineDtype == nvinfer1::DataType::kHALF),
-                    "%s: expected type %d, provided type %d", name, static_cast<std::int32_t>(engineDtype),
-                    static_cast<std::int32_t>(tensorDtype));
-
-                tensor->reshape(dims);
-                context.setTensorAddress(name, tensor->data());
-            }
-            else
+            bindings.setOutputShape(slot, context.getTensorShape(name));
+            dims = bindings.getOutputShape(slot);
+        }
+        auto& tensor = tensorSlots[slot];
+        if (tensor)
+        {
+            if (bindings.compare(slot, tensor->data(), tensor->getDataType(), *dims).shape)
             {
-                auto tensor = ITensor::SharedPtr(mBufferManager.gpu(dims, engineDtype));
-                tensorMap.insert(pos, std::make_pair(name, tensor));
-                context.setTensorAddress(name, tensor->data());
+                mBindingPlan.validateOutput(slot, *tensor);
             }
+            tensor->reshape(*dims);
+        }
+        else
+        {
+            tensor = mBufferManager.gpu(*dims, desc.dataType);
+        }
+        auto* const data = tensor->data();
+        if (bindings.compare(slot, data, tensor->getDataType(), *dims).address)
+        {
+            context.setTensorAddress(name, data);
         }
+        bindings.set(slot, data, tensor->getDataType(), *dims);
     }
 }
 
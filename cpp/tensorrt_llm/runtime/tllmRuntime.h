@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include "tensorrt_llm/runtime/bindingPlan.h"
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/common.h"
 #include "tensorrt_llm/runtime/iTensor.h"
@@ -30,6 +31,7 @@ class TllmRuntime
 {
 public:
     using TensorMap = StringPtrMap<ITensor>;
+    using TensorSlots = BindingPlan::TensorSlots;
 
     explicit TllmRuntime(void const* engineData, std::size_t engineSize, nvinfer1::ILogger& logger);
 
@@ -66,8 +68,20 @@ public:
 
     void setInputTensors(SizeType contextIndex, TensorMap const& tensorMap);
 
+    //! \brief Binds the input tensors by slot of getBindingPlan(). Only inputs whose shape or data type changed since
+    //!        the last call for this context are validated, and shapes are only inferred again if one changed.
+    void setInputTensors(SizeType contextIndex, TensorSlots const& tensorSlots);
+
     void setOutputTensors(SizeType contextIndex, TensorMap& tensorMap);
 
+    //! \brief Binds the output tensors by slot of getBindingPlan(), allocating those that are missing.
+    void setOutputTensors(SizeType contextIndex, TensorSlots& tensorSlots);
+
+    [[nodiscard]] BindingPlan const& getBindingPlan() const
+    {
+        return mBindingPlan;
+    }
+
     bool executeContext(SizeType contextIndex) const;
 
     CudaStream const& getStream() const;
@@ -105,5 +119,10 @@ private:
     BufferManager::IBufferPtr mEngineBuffer;
     std::vector<std::unique_ptr<nvinfer1::IExecutionContext>> mContexts;
     std::unique_ptr<ITensor> mDummyTensor;
+    BindingPlan mBindingPlan;
+    //! \brief What is bound to each context, parallel to mContexts.
+    std::vector<BindingPlan::Bindings> mBindings;
+    //! \brief Reused by the TensorMap overloads to resolve the maps to slots.
+    TensorMapSlots mMapSlots;
 };
 } // namespace tensorrt_llm::runtime
@@ -81,6 +81,9 @@ TransformerBuffers::TransformerBuffers(
         presentKeysValsAlt = utils::createBufferVector(runtime, localNbLayers, MemoryType::kGPU, kvDtype);
     }
 
+    mPastKeyValueNames = utils::makeTensorNames("past_key_value_", localNbLayers, firstLayerId);
+    mPresentKeyValueNames = utils::makeTensorNames("present_key_value_", localNbLayers, firstLayerId);
+
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
 }
 
@@ -179,6 +182,8 @@ TransformerBuffers TransformerBuffers::sliceTo(
     {
         buffers.presentKeysValsAlt = utils::sliceBufferVector(presentKeysValsAlt, offset, batchSize);
     }
+    buffers.mPastKeyValueNames = mPastKeyValueNames;
+    buffers.mPresentKeyValueNames = mPresentKeyValueNames;
     TLLM_LOG_TRACE("%s stop", __PRETTY_FUNCTION__);
     return buffers;
 }
@@ -646,8 +651,7 @@ void TransformerBuffers::getRuntimeBuffers(RuntimeBuffers const* runtimeBuffers,
     GptModelConfig const& modelConfig, WorldConfig const& worldConfig) const
 {
     TLLM_LOG_TRACE("%s start", __PRETTY_FUNCTION__);
-    inputBuffers.clear();
-    outputBuffers.clear();
+    // The maps are kept across steps, so only entries whose tensor changed are touched
 
     auto& logits = runtimeBuffers->logits;
     auto& hiddenStates = runtimeBuffers->hiddenStates;
@@ -659,79 +663,74 @@ void TransformerBuffers::getRuntimeBuffers(RuntimeBuffers const* runtimeBuffers,
     if (worldConfig.isLastPipelineParallelRank())
     {
         // feed a view to TensorRT runtime so reshaping does not change logits buffer
-        outputBuffers.insert_or_assign("logits", ITensor::view(logits));
+        utils::updateTensorView(outputBuffers, "logits", logits, logits->getShape());
     }
     else
     {
-        outputBuffers.insert_or_assign("hidden_states_output", hiddenStates);
+        utils::updateTensor(outputBuffers, "hidden_states_output", hiddenStates);
     }
 
     if (worldConfig.isFirstPipelineParallelRank())
     {
-        inputBuffers.insert_or_assign("input_ids", inputIds);
+        utils::updateTensor(inputBuffers, "input_ids", inputIds);
     }
     else
     {
-        inputBuffers.insert_or_assign("hidden_states_input", hiddenStates);
+        utils::updateTensor(inputBuffers, "hidden_states_input", hiddenStates);
     }
 
-    inputBuffers.insert_or_assign("context_lengths", contextLengthsDevice);
+    utils::updateTensor(inputBuffers, "context_lengths", contextLengthsDevice);
     if (!modelConfig.computeContextLogits())
     {
-        inputBuffers.insert_or_assign("last_token_ids", lastTokenIds);
+        utils::updateTensor(inputBuffers, "last_token_ids", lastTokenIds);
     }
-    inputBuffers.insert_or_assign("position_ids", positionIds);
-
-    auto const localNbLayers = modelConfig.getNbLayers(worldConfig.getPipelineParallelism());
-    auto const firstLayerId = worldConfig.getPipelineParallelRank() * localNbLayers;
+    utils::updateTensor(inputBuffers, "position_ids", positionIds);
 
     if (modelConfig.useGptAttentionPlugin())
     {
-        inputBuffers.insert_or_assign("cache_indirection", runtimeBuffers->cacheIndirectionDecoderOutput);
-        inputBuffers.insert_or_assign("host_past_key_value_lengths", pastKeyValueLengths);
-        inputBuffers.insert_or_assign("host_request_types", requestTypes);
-        inputBuffers.insert_or_assign("sequence_length", runtimeBuffers->sequenceLengths);
-        inputBuffers.insert_or_assign("host_sink_token_length", sinkTokenLengths);
-        inputBuffers.insert_or_assign("host_max_attention_window_sizes", maxAttentionWindows);
+        utils::updateTensor(inputBuffers, "cache_indirection", runtimeBuffers->cacheIndirectionDecoderOutput);
+        utils::updateTensor(inputBuffers, "host_past_key_value_lengths", pastKeyValueLengths);
+        utils::updateTensor(inputBuffers, "host_request_types", requestTypes);
+        utils::updateTensor(inputBuffers, "sequence_length", runtimeBuffers->sequenceLengths);
+        utils::updateTensor(inputBuffers, "host_sink_token_length", sinkTokenLengths);
+        utils::updateTensor(inputBuffers, "host_max_attention_window_sizes", maxAttentionWindows);
 
         if (modelConfig.usePackedInput())
         {
-            inputBuffers.insert_or_assign("host_context_lengths", contextLengthsHost);
+            utils::updateTensor(inputBuffers, "host_context_lengths", contextLengthsHost);
         }
         if (modelConfig.usePagedKvCache())
         {
-            inputBuffers.insert_or_assign("kv_cache_block_pointers", kvCacheBlockPointersDevice);
-            inputBuffers.insert_or_assign("host_kv_cache_block_pointers", kvCacheBlockPointersHost);
+            utils::updateTensor(inputBuffers, "kv_cache_block_pointers", kvCacheBlockPointersDevice);
+            utils::updateTensor(inputBuffers, "host_kv_cache_block_pointers", kvCacheBlockPointersHost);
         }
         else
         {
-            utils::insertTensorVector(inputBuffers, "past_key_value_", presentKeysVals, firstLayerId);
-            utils::insertTensorVector(outputBuffers, "present_key_value_", presentKeysVals, firstLayerId);
+            utils::updateTensorVector(inputBuffers, mPastKeyValueNames, presentKeysVals);
+            utils::updateTensorVector(outputBuffers, mPresentKeyValueNames, presentKeysVals);
         }
     }
     else
     {
-        inputBuffers.insert_or_assign("attention_mask", attentionMask);
-        inputBuffers.insert_or_assign("cache_indirection", runtimeBuffers->cacheIndirectionDecoderOutput);
-        utils::insertTensorVector(
-            outputBuffers, "present_key_value_", (step % 2) ? presentKeysValsAlt : presentKeysVals, firstLayerId);
+        utils::updateTensor(inputBuffers, "attention_mask", attentionMask);
+        utils::updateTensor(inputBuffers, "cache_indirection", runtimeBuffers->cacheIndirectionDecoderOutput);
+        utils::updateTensorVector(
+            outputBuffers, mPresentKeyValueNames, (step % 2) ? presentKeysValsAlt : presentKeysVals);
 
         if (step == 0)
         {
             auto kvCacheShape = presentKeysValsAlt.at(0)->getShape();
             kvCacheShape.d[3] = 0;
 
-            for (SizeType i = 0; i < localNbLayers; ++i)
+            for (std::size_t i = 0; i < presentKeysValsAlt.size(); ++i)
             {
-                std::string name = "past_key_value_" + std::to_string(firstLayerId + i);
-                TensorPtr tmp = ITensor::view(presentKeysValsAlt.at(i), kvCacheShape);
-                inputBuffers.insert_or_assign(name, std::move(tmp));
+                utils::updateTensorView(inputBuffers, mPastKeyValueNames.at(i), presentKeysValsAlt[i], kvCacheShape);
             }
         }
         else
         {
-            utils::insertTensorVector(
-                inputBuffers, "past_key_value_", (step % 2) ? presentKeysVals : presentKeysValsAlt, firstLayerId);
+            utils::updateTensorVector(
+                inputBuffers, mPastKeyValueNames, (step % 2) ? presentKeysVals : presentKeysValsAlt);
         }
     }
 
@@ -88,6 +88,11 @@ public:
     TensorPtr sinkTokenLengths;                // with attention plugin, host tensor
     TensorPtr kvCacheBlockPointersHost;        // [numLayers, batchSize * beamWidth, 2, maxBlocksPerSeq * 2]
     TensorPtr kvCacheBlockPointersDevice;      // [numLayers, batchSize * beamWidth, 2, maxBlocksPerSeq * 2]
+
+private:
+    // names of the per-layer KV cache tensors, built once for the local layers
+    std::vector<std::string> mPastKeyValueNames;
+    std::vector<std::string> mPresentKeyValueNames;
 };
 
 } // namespace tensorrt_llm::runtime
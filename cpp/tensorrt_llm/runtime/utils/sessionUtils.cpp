@@ -18,10 +18,12 @@
 
 #include "tensorrt_llm/common/assert.h"
 #include "tensorrt_llm/runtime/runtimeKernels.h"
+#include "tensorrt_llm/runtime/tensorView.h"
 #include "tensorrt_llm/runtime/tllmRuntime.h"
 
 #include <algorithm>
 #include <cassert>
+#include <sstream>
 
 using namespace tensorrt_llm::runtime;
 namespace tc = tensorrt_llm::common;
@@ -115,6 +117,121 @@ void insertTensorSlices(
     }
 }
 
+std::vector<std::string> makeTensorNames(std::string const& key, SizeType const count, SizeType const indexOffset)
+{
+    std::vector<std::string> names;
+    names.reserve(count);
+    for (SizeType i = 0; i < count; ++i)
+        names.push_back(key + std::to_string(indexOffset + i));
+    return names;
+}
+
+void updateTensor(StringPtrMap<ITensor>& map, std::string const& key, ITensor::SharedPtr const& tensor)
+{
+    auto const pos = map.find(key);
+    if (pos == map.end())
+    {
+        map.emplace(key, tensor);
+    }
+    else if (pos->second != tensor)
+    {
+        pos->second = tensor;
+    }
+}
+
+void updateTensorVector(
+    StringPtrMap<ITensor>& map, std::vector<std::string> const& keys, std::vector<ITensor::SharedPtr> const& vec)
+{
+    TLLM_CHECK_WITH_INFO(keys.size() >= vec.size(), "%zu names for %zu tensors", keys.size(), vec.size());
+    for (std::size_t i = 0; i < vec.size(); ++i)
+        updateTensor(map, keys[i], vec[i]);
+}
+
+void updateTensorView(StringPtrMap<ITensor>& map, std::string const& key, ITensor::SharedPtr const& tensor,
+    ITensor::Shape const& shape)
+{
+    auto const pos = map.find(key);
+    if (pos != map.end())
+    {
+        auto& view = pos->second;
+        // Only a view no one else holds may be reshaped
+        auto const* const tensorView = dynamic_cast<TensorView const*>(view.get());
+        if (view.use_count() == 1 && tensorView != nullptr && tensorView->getBuffer() == tensor
+            && tensorView->getOffset() == 0)
+        {
+            if (!ITensor::shapeEquals(view->getShape(), shape))
+            {
+                view->reshape(shape);
+            }
+            return;
+        }
+    }
+    map.insert_or_assign(key, ITensor::view(tensor, shape));
+}
+
+TensorMapSnapshot snapshotTensorMap(StringPtrMap<ITensor> const& map)
+{
+    TensorMapSnapshot snapshot;
+    snapshot.reserve(map.size());
+    for (auto const& [name, tensor] : map)
+    {
+        snapshot.emplace(name, TensorMapEntry{tensor.get(), tensor->data(), tensor->getShape()});
+    }
+    return snapshot;
+}
+
+std::string diffTensorMap(TensorMapSnapshot const& before, StringPtrMap<ITensor> const& map)
+{
+    std::vector<std::string> lines;
+    for (auto const& [name, tensor] : map)
+    {
+        std::ostringstream line;
+        auto const pos = before.find(name);
+        if (pos == before.end())
+        {
+            line << name << ": added " << tensor->getShape();
+        }
+        else
+        {
+            auto const& entry = pos->second;
+            if (entry.tensor == tensor.get() && entry.data == tensor->data()
+                && ITensor::shapeEquals(entry.shape, tensor->getShape()))
+            {
+                continue;
+            }
+            line << name << ":";
+            if (entry.tensor != tensor.get())
+            {
+                line << " replaced";
+            }
+            if (entry.data != tensor->data())
+            {
+                line << " moved " << entry.data << " -> " << tensor->data();
+            }
+            if (!ITensor::shapeEquals(entry.shape, tensor->getShape()))
+            {
+                line << " reshaped " << entry.shape << " -> " << tensor->getShape();
+            }
+        }
+        lines.push_back(line.str());
+    }
+    for (auto const& [name, entry] : before)
+    {
+        if (map.find(name) == map.end())
+        {
+            lines.push_back(name + ": removed");
+        }
+    }
+    std::sort(lines.begin(), lines.end());
+
+    std::string diff;
+    for (auto const& line : lines)
+    {
+        diff += diff.empty() ? line : '\n' + line;
+    }
+    return diff;
+}
+
 void printTensorMap(std::ostream& stream, StringPtrMap<ITensor> const& map)
 {
     for (auto const& [name, tensor] : map)
@@ -24,6 +24,7 @@
 
 #include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace tensorrt_llm::runtime
@@ -64,6 +65,39 @@ void insertTensorVector(StringPtrMap<ITensor>& map, std::string const& key, std:
 void insertTensorSlices(
     StringPtrMap<ITensor>& map, std::string const& key, ITensor::SharedPtr const& tensor, SizeType indexOffset);
 
+//! \brief The names `key + index` for `count` indices from `indexOffset`, built once for updateTensorVector.
+std::vector<std::string> makeTensorNames(std::string const& key, SizeType count, SizeType indexOffset);
+
+//! \brief Sets `map[key]` to `tensor`, leaving the entry untouched if it already holds `tensor`.
+void updateTensor(StringPtrMap<ITensor>& map, std::string const& key, ITensor::SharedPtr const& tensor);
+
+//! \brief Sets `map[keys[i]]` to `vec[i]`, leaving the entries that already hold their tensor untouched.
+void updateTensorVector(
+    StringPtrMap<ITensor>& map, std::vector<std::string> const& keys, std::vector<ITensor::SharedPtr> const& vec);
+
+//! \brief Sets `map[key]` to a view of `tensor` with `shape`.
+//!
+//! \details A view of `tensor` that only the map holds is reshaped rather than created again, so the entry keeps its
+//!          tensor across steps for as long as `tensor` is the same object.
+void updateTensorView(StringPtrMap<ITensor>& map, std::string const& key, ITensor::SharedPtr const& tensor,
+    ITensor::Shape const& shape);
+
+//! \brief The tensor, address and shape of one TensorMap entry.
+struct TensorMapEntry
+{
+    ITensor const* tensor;
+    void const* data;
+    ITensor::Shape shape;
+};
+
+using TensorMapSnapshot = std::unordered_map<std::string, TensorMapEntry>;
+
+TensorMapSnapshot snapshotTensorMap(StringPtrMap<ITensor> const& map);
+
+//! \brief One line per entry added, removed, replaced, moved or reshaped in `map` since `before`, sorted by name.
+//!        Empty if nothing changed.
+std::string diffTensorMap(TensorMapSnapshot const& before, StringPtrMap<ITensor> const& map);
+
 void printTensorMap(std::ostream& stream, StringPtrMap<ITensor> const& map);
 
 void setRawPointers(ITensor& pointers, ITensor::SharedPtr const& input, int32_t pointersSlot, int32_t inputSlot);
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bpe_tokenizer.h"
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+// Fixtures need to be generated using cpp/tests/resources/scripts/generate_tokenizer_fixtures.py.
+auto const TEST_RESOURCE_PATH = fs::path{TOP_LEVEL_DIR} / "cpp/tests/resources/data/tokenizer";
+
+struct Case
+{
+    std::string text;
+    std::vector<int> ids;
+};
+
+std::vector<Case> loadCases(fs::path const& path)
+{
+    std::ifstream file(path);
+    auto const expected = nlohmann::json::parse(file);
+    std::vector<Case> cases;
+    for (auto const& entry : expected)
+    {
+        cases.push_back({entry.at("text").get<std::string>(), entry.at("ids").get<std::vector<int>>()});
+    }
+    return cases;
+}
+
+fs::path writeTokenizerJson(nlohmann::json const& tokenizer, std::string const& name)
+{
+    auto const path = fs::temp_directory_path() / name;
+    std::ofstream(path) << tokenizer.dump();
+    return path;
+}
+
+} // namespace
+
+namespace tensorrtllm
+{
+
+class BpeTokenizerTest : public ::testing::TestWithParam<std::string> // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+};
+
+TEST_P(BpeTokenizerTest, MatchesReferenceIds)
+{
+    auto const dir = TEST_RESOURCE_PATH / GetParam();
+    BpeTokenizer tokenizer((dir / "tokenizer.json").string());
+    for (auto const& c : loadCases(dir / "expected.json"))
+    {
+        EXPECT_EQ(tokenizer.Encode(c.text), c.ids) << "text: \"" << c.text << "\"";
+    }
+}
+
+TEST_P(BpeTokenizerTest, DecodeRoundTrips)
+{
+    auto const dir = TEST_RESOURCE_PATH / GetParam();
+    BpeTokenizer tokenizer((dir / "tokenizer.json").string());
+    for (auto const& c : loadCases(dir / "expected.json"))
+    {
+        if (c.text.find("<|") != std::string::npos)
+        {
+            continue; // special tokens are dropped by Decode
+        }
+        EXPECT_EQ(tokenizer.Decode(c.ids), c.text);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Fixtures, BpeTokenizerTest, ::testing::Values("gpt2", "llama3"));
+
+TEST(BpeTokenizerLoadTest, DropsSpecialTokensOnDecode)
+{
+    BpeTokenizer tokenizer((TEST_RESOURCE_PATH / "llama3/tokenizer.json").string());
+    auto const eot = tokenizer.TokenToId("<|eot_id|>");
+    ASSERT_GE(eot, 0);
+    auto ids = tokenizer.Encode("hello");
+    ids.push_back(eot);
+    EXPECT_EQ(tokenizer.Decode(ids), "hello");
+    EXPECT_EQ(tokenizer.DecodeWithSpace(tokenizer.TokenToId(" ")), " ");
+}
+
+TEST(BpeTokenizerLoadTest, PieceTableHoldsEveryToken)
+{
+    BpeTokenizer tokenizer((TEST_RESOURCE_PATH / "llama3/tokenizer.json").string());
+    auto const& pieces = tokenizer.Pieces();
+    ASSERT_EQ(pieces.Size(), tokenizer.VocabSize());
+    auto const eot = tokenizer.TokenToId("<|eot_id|>");
+    EXPECT_EQ(pieces.Piece(eot), "<|eot_id|>");
+    EXPECT_TRUE(pieces.GetFlags(eot) & PieceTable::kSkipOnDecode);
+    for (int32_t id = 0; id < static_cast<int32_t>(pieces.Size()); ++id)
+    {
+        if (!pieces.Piece(id).empty())
+        {
+            EXPECT_EQ(tokenizer.TokenToId(pieces.Piece(id)), id);
+        }
+    }
+    EXPECT_TRUE(pieces.Piece(-1).empty());
+    EXPECT_TRUE(pieces.Piece(static_cast<int32_t>(pieces.Size())).empty());
+}
+
+TEST(PieceTableTest, StripsDummyPrefixOfFirstPiece)
+{
+    PieceTable pieces;
+    pieces.Add("<s>", PieceTable::kSkipOnDecode);
+    pieces.Add(" Hello", PieceTable::kWordStart);
+    pieces.Add(" world", PieceTable::kWordStart);
+    pieces.Add("\n");
+
+    std::vector<int32_t> const ids{0, 1, 2, 3, 42, -7};
+    std::string text;
+    pieces.DecodeAppend(ids.data(), ids.size(), /*strip_leading_space=*/false, text);
+    EXPECT_EQ(text, " Hello world\n");
+    text = "> ";
+    pieces.DecodeAppend(ids.data(), ids.size(), /*strip_leading_space=*/true, text);
+    EXPECT_EQ(text, "> Hello world\n");
+
+    // Only a word-start piece in first position loses its space.
+    std::vector<int32_t> const byteFirst{3, 1};
+    text.clear();
+    pieces.DecodeAppend(byteFirst.data(), byteFirst.size(), /*strip_leading_space=*/true, text);
+    EXPECT_EQ(text, "\n Hello");
+}
+
+TEST(BpeTokenizerLoadTest, NeverSplitsSpecialTokens)
+{
+    BpeTokenizer tokenizer((TEST_RESOURCE_PATH / "llama3/tokenizer.json").string());
+    auto const imStart = tokenizer.TokenToId("<|im_start|>");
+    auto const imEnd = tokenizer.TokenToId("<|im_end|>");
+    auto const ids = tokenizer.Encode("<|im_start|>user\nhi<|im_end|>\n<|im_start|>assistant\n");
+    EXPECT_EQ(std::count(ids.begin(), ids.end(), imStart), 2);
+    EXPECT_EQ(std::count(ids.begin(), ids.end(), imEnd), 1);
+    EXPECT_EQ(ids.front(), imStart);
+
+    auto const stopIds = tokenizer.StopTokenIds();
+    EXPECT_NE(std::find(stopIds.begin(), stopIds.end(), imEnd), stopIds.end());
+    EXPECT_NE(std::find(stopIds.begin(), stopIds.end(), tokenizer.TokenToId("<|eot_id|>")), stopIds.end());
+    EXPECT_EQ(std::find(stopIds.begin(), stopIds.end(), imStart), stopIds.end());
+}
+
+TEST(AddedTokenTrieTest, FindsLeftmostLongest)
+{
+    AddedTokenTrie trie;
+    trie.Build({{"<|im", 10, true}, {"<|im_start|>", 11, true}, {"<|im_end|>", 12, true}, {"<|im_end|>", 13, true}});
+    ASSERT_EQ(trie.Tokens().size(), 3u);
+
+    int32_t id = -1;
+    size_t length = 0;
+    std::string_view const text = "a <|i <|im_end|><|im_start|> <|imx";
+    auto pos = trie.Find(text, 0, id, length);
+    EXPECT_EQ(pos, 6u);
+    EXPECT_EQ(id, 12);
+    EXPECT_EQ(length, 10u);
+    pos = trie.Find(text, pos + length, id, length);
+    EXPECT_EQ(pos, 16u);
+    EXPECT_EQ(id, 11);
+    pos = trie.Find(text, pos + length, id, length);
+    EXPECT_EQ(pos, 29u);
+    EXPECT_EQ(id, 10);
+    EXPECT_EQ(length, 4u);
+    EXPECT_EQ(trie.Find(text, pos + length, id, length), std::string_view::npos);
+
+    EXPECT_EQ(trie.Lookup("<|im_end|>"), 12);
+    EXPECT_EQ(trie.Lookup("<|im_"), -1);
+    EXPECT_EQ(AddedTokenTrie{}.Lookup("<|im"), -1);
+}
+
+TEST(BpeTokenizerLoadTest, AcceptsStringMerges)
+{
+    auto tokenizer = nlohmann::json::parse(std::ifstream(TEST_RESOURCE_PATH / "gpt2/tokenizer.json"));
+    auto& merges = tokenizer["model"]["merges"];
+    for (auto& merge : merges)
+    {
+        merge = merge[0].get<std::string>() + " " + merge[1].get<std::string>();
+    }
+    auto const path = writeTokenizerJson(tokenizer, "bpe_string_merges.json");
+    BpeTokenizer fromStrings(path.string());
+    BpeTokenizer fromPairs((TEST_RESOURCE_PATH / "gpt2/tokenizer.json").string());
+    std::string const text = "The quick brown fox, 12345 times!";
+    EXPECT_EQ(fromStrings.Encode(text), fromPairs.Encode(text));
+    fs::remove(path);
+}
+
+TEST(BpeTokenizerLoadTest, RejectsUnsupportedTokenizers)
+{
+    auto const base = nlohmann::json::parse(std::ifstream(TEST_RESOURCE_PATH / "llama3/tokenizer.json"));
+
+    auto unknownPattern = base;
+    unknownPattern["pre_tokenizer"]["pretokenizers"][0]["pattern"]["Regex"] = "\\w+";
+    auto path = writeTokenizerJson(unknownPattern, "bpe_unknown_pattern.json");
+    EXPECT_THROW(BpeTokenizer{path.string()}, std::runtime_error);
+
+    auto wordPiece = base;
+    wordPiece["model"]["type"] = "WordPiece";
+    path = writeTokenizerJson(wordPiece, "bpe_word_piece.json");
+    EXPECT_THROW(BpeTokenizer{path.string()}, std::runtime_error);
+
+    EXPECT_THROW(BpeTokenizer{(TEST_RESOURCE_PATH / "missing.json").string()}, std::runtime_error);
+    fs::remove(path);
+}
+
+} // namespace tensorrtllm
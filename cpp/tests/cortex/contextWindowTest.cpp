@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "bpe_tokenizer.h"
+#include "context_window.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+auto const TEST_RESOURCE_PATH = fs::path{TOP_LEVEL_DIR} / "cpp/tests/resources/data/tokenizer";
+
+using Indices = std::vector<size_t>;
+
+} // namespace
+
+namespace tensorrtllm
+{
+
+TEST(ContextWindowTest, ParsesPolicyNames)
+{
+    for (auto policy : {TruncationPolicy::kNone, TruncationPolicy::kDropOldest, TruncationPolicy::kMiddleOut})
+    {
+        EXPECT_EQ(ParseTruncationPolicy(TruncationPolicyName(policy)), policy);
+    }
+    EXPECT_FALSE(ParseTruncationPolicy("oldest").has_value());
+    EXPECT_FALSE(ParseTruncationPolicy("").has_value());
+}
+
+TEST(ContextWindowTest, KeepsEverythingThatFits)
+{
+    std::vector<MessageTokens> const messages{{10, true}, {20, false}, {30, false}};
+    for (auto policy : {TruncationPolicy::kNone, TruncationPolicy::kDropOldest, TruncationPolicy::kMiddleOut})
+    {
+        auto const fit = FitToContext(messages, 5, 65, policy);
+        EXPECT_TRUE(fit.fits);
+        EXPECT_EQ(fit.kept, (Indices{0, 1, 2}));
+        EXPECT_TRUE(fit.dropped.empty());
+        EXPECT_EQ(fit.prompt_tokens, 65);
+    }
+}
+
+TEST(ContextWindowTest, NoneNeverDrops)
+{
+    std::vector<MessageTokens> const messages{{10, false}, {20, false}, {30, false}};
+    auto const fit = FitToContext(messages, 0, 40, TruncationPolicy::kNone);
+    EXPECT_FALSE(fit.fits);
+    EXPECT_EQ(fit.kept, (Indices{0, 1, 2}));
+    EXPECT_EQ(fit.prompt_tokens, 60);
+}
+
+TEST(ContextWindowTest, DropOldestKeepsSystemAndLastMessage)
+{
+    // system, user, assistant, user, assistant, user
+    std::vector<MessageTokens> const messages{
+        {10, true}, {20, false}, {20, false}, {20, false}, {20, false}, {20, false}};
+    auto const fit = FitToContext(messages, 4, 80, TruncationPolicy::kDropOldest);
+    EXPECT_TRUE(fit.fits);
+    EXPECT_EQ(fit.dropped, (Indices{1, 2}));
+    EXPECT_EQ(fit.kept, (Indices{0, 3, 4, 5}));
+    EXPECT_EQ(fit.prompt_tokens, 74);
+
+    // Nothing left to drop but the system prompt and the question.
+    auto const tight = FitToContext(messages, 4, 20, TruncationPolicy::kDropOldest);
+    EXPECT_FALSE(tight.fits);
+    EXPECT_EQ(tight.kept, (Indices{0, 5}));
+    EXPECT_EQ(tight.prompt_tokens, 34);
+}
+
+TEST(ContextWindowTest, MiddleOutDropsFromTheMiddle)
+{
+    std::vector<MessageTokens> const messages{
+        {10, true}, {10, false}, {10, false}, {10, false}, {10, false}, {10, false}, {10, false}};
+    // Droppable 1..5 go 3, then 4, then 2.
+    auto const fit = FitToContext(messages, 0, 40, TruncationPolicy::kMiddleOut);
+    EXPECT_TRUE(fit.fits);
+    EXPECT_EQ(fit.dropped, (Indices{2, 3, 4}));
+    EXPECT_EQ(fit.kept, (Indices{0, 1, 5, 6}));
+}
+
+TEST(ContextWindowTest, CountsTokensOnce)
+{
+    BpeTokenizer tokenizer((TEST_RESOURCE_PATH / "llama3/tokenizer.json").string());
+    TokenCountCache cache(2);
+    std::string const text = "You are a helpful assistant.";
+    auto const expected = static_cast<int32_t>(tokenizer.Encode(text).size());
+
+    EXPECT_EQ(cache.Count(tokenizer, text), expected);
+    EXPECT_EQ(cache.Count(tokenizer, text), expected);
+    EXPECT_EQ(cache.Count(tokenizer, ""), 0);
+    // Filling the cache starts it over rather than growing past the limit.
+    EXPECT_EQ(cache.Count(tokenizer, "Hello, world"), static_cast<int32_t>(tokenizer.Encode("Hello, world").size()));
+    EXPECT_EQ(cache.Count(tokenizer, text), expected);
+}
+
+} // namespace tensorrtllm
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bpe_tokenizer.h"
+#include "encode_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+auto const TEST_RESOURCE_PATH = fs::path{TOP_LEVEL_DIR} / "cpp/tests/resources/data/tokenizer";
+
+std::string segment(int index, size_t size = 100)
+{
+    auto text = "segment " + std::to_string(index) + " ";
+    text.resize(size, 'x');
+    return text;
+}
+
+} // namespace
+
+namespace tensorrtllm
+{
+
+TEST(EncodeCacheTest, ServesInsertedSegments)
+{
+    EncodeCache cache({1 << 20, 16});
+    auto const text = segment(1);
+    std::vector<int32_t> const ids{1, 2, 3};
+    std::vector<int32_t> out{9};
+
+    EXPECT_FALSE(cache.Lookup(text, out));
+    cache.Insert(text, ids.data(), ids.size());
+    EXPECT_TRUE(cache.Lookup(text, out));
+    EXPECT_EQ(out, (std::vector<int32_t>{9, 1, 2, 3}));
+    EXPECT_FALSE(cache.Lookup(segment(2), out));
+
+    EXPECT_FALSE(cache.Cacheable("short"));
+    EXPECT_FALSE(cache.Cacheable(std::string(1 << 20, 'x')));
+
+    auto const stats = cache.GetStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.bytes_saved, text.size());
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_EQ(stats.resident_bytes, text.size() + ids.size() * sizeof(int32_t));
+}
+
+TEST(EncodeCacheTest, EvictsUnreferencedEntriesUnderBudget)
+{
+    size_t const budget = 64 << 10;
+    EncodeCache cache({budget, 16});
+    std::vector<int32_t> const ids(25, 7);
+    std::vector<int32_t> out;
+
+    auto const hot = segment(-1);
+    cache.Insert(hot, ids.data(), ids.size());
+    for (int i = 0; i < 2000; ++i)
+    {
+        auto const text = segment(i);
+        cache.Insert(text, ids.data(), ids.size());
+        // Referencing the hot entry between sweeps keeps it resident.
+        EXPECT_TRUE(cache.Lookup(hot, out)) << "evicted after " << i << " inserts";
+        EXPECT_LE(cache.GetStats().resident_bytes, budget);
+    }
+    EXPECT_GT(cache.GetStats().evictions, 0u);
+}
+
+TEST(EncodeCacheTest, TokenizerResultsMatchUncached)
+{
+    auto const path = (TEST_RESOURCE_PATH / "llama3/tokenizer.json").string();
+    BpeTokenizer plain(path);
+    BpeTokenizer cached(path);
+    cached.EnableEncodeCache({1 << 20, 16});
+
+    std::string const system = "<|im_start|>system\nYou are a helpful assistant. Answer briefly and cite sources.<|im_end|>\n";
+    for (int i = 0; i < 3; ++i)
+    {
+        auto const prompt = system + "<|im_start|>user\nquestion number " + std::to_string(i) + "<|im_end|>\n";
+        EXPECT_EQ(cached.Encode(prompt), plain.Encode(prompt));
+    }
+    auto const stats = cached.GetEncodeCache()->GetStats();
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_GT(stats.bytes_saved, 0u);
+}
+
+TEST(EncodeCacheTest, ConcurrentReadersSeeConsistentIds)
+{
+    // A budget far below the working set keeps writers evicting while readers hit.
+    EncodeCache cache({16 << 10, 16});
+    auto idsFor = [](int index) { return std::vector<int32_t>(10 + index % 7, index); };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back(
+            [&, t]()
+            {
+                std::mt19937 rng(t);
+                std::vector<int32_t> out;
+                for (int i = 0; i < 20000; ++i)
+                {
+                    int const index = static_cast<int>(rng() % 300);
+                    auto const text = segment(index);
+                    out.clear();
+                    if (cache.Lookup(text, out))
+                    {
+                        ASSERT_EQ(out, idsFor(index));
+                    }
+                    else
+                    {
+                        auto const ids = idsFor(index);
+                        cache.Insert(text, ids.data(), ids.size());
+                    }
+                }
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    auto const stats = cache.GetStats();
+    EXPECT_GT(stats.hits, 0u);
+    EXPECT_GT(stats.evictions, 0u);
+    EXPECT_LE(stats.resident_bytes, 16u << 10);
+}
+
+} // namespace tensorrtllm
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cortex-common/ipc/remote_engine.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using cortex::ipc::RemoteEngine;
+using cortex::ipc::ShmRing;
+
+Json::Value makeStatus(int code, bool done, bool stream)
+{
+    Json::Value status;
+    status["is_done"] = done;
+    status["has_error"] = false;
+    status["is_stream"] = stream;
+    status["status_code"] = code;
+    return status;
+}
+
+// An engine host serving one connection at a time on a thread, as examples/engine-host does. `handle` answers a
+// request through the ring, and returns false for the host to drop the connection as if it had died.
+class TestHost
+{
+public:
+    using Handler = std::function<bool(Json::Value const& request, ShmRing& ring)>;
+
+    explicit TestHost(Handler handle)
+        : mHandle{std::move(handle)}
+    {
+        char dir[] = "/tmp/remoteEngineTestXXXXXX";
+        EXPECT_NE(mkdtemp(dir), nullptr);
+        mDir = dir;
+        mPath = mDir + "/host.sock";
+        mListenFd = cortex::ipc::ListenUnix(mPath);
+        EXPECT_GE(mListenFd, 0);
+        mThread = std::thread([this]() { serve(); });
+    }
+
+    ~TestHost()
+    {
+        ::shutdown(mListenFd, SHUT_RDWR);
+        mThread.join();
+        close(mListenFd);
+        unlink(mPath.c_str());
+        rmdir(mDir.c_str());
+    }
+
+    std::string const& path() const
+    {
+        return mPath;
+    }
+
+    int connections() const
+    {
+        return mConnections;
+    }
+
+    static void reply(ShmRing& ring, Json::Value const& request, Json::Value status, Json::Value result)
+    {
+        Json::Value record;
+        record["id"] = request["id"];
+        record["status"] = std::move(status);
+        record["result"] = std::move(result);
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        ring.Push(Json::writeString(writer, record));
+    }
+
+private:
+    void serve()
+    {
+        while (true)
+        {
+            int const fd = accept4(mListenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0)
+            {
+                return;
+            }
+            ++mConnections;
+            auto const ringFd = cortex::ipc::RecvFd(fd);
+            auto ring = ShmRing::Attach(ringFd);
+            cortex::ipc::SendFrame(fd, "ok");
+            Json::CharReaderBuilder builder;
+            std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+            std::string frame;
+            while (cortex::ipc::RecvFrame(fd, frame))
+            {
+                Json::Value request;
+                std::string error;
+                ASSERT_TRUE(reader->parse(frame.data(), frame.data() + frame.size(), &request, &error));
+                if (!mHandle(request, *ring))
+                {
+                    break;
+                }
+            }
+            close(fd);
+        }
+    }
+
+    Handler mHandle;
+    std::string mDir;
+    std::string mPath;
+    int mListenFd{-1};
+    std::atomic<int> mConnections{0};
+    std::thread mThread;
+};
+
+// Collects the chunks of a streamed call, which arrive on the engine's reader thread
+class StreamRecorder
+{
+public:
+    RemoteEngine::Callback callback()
+    {
+        return [this](Json::Value&& status, Json::Value&& result)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStatuses.push_back(status);
+            mResults.push_back(result);
+            mDone = status["is_done"].asBool();
+            mCv.notify_all();
+        };
+    }
+
+    bool waitDone()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        return mCv.wait_for(lock, std::chrono::seconds(10), [this]() { return mDone; });
+    }
+
+    std::vector<Json::Value> statuses() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStatuses;
+    }
+
+    std::vector<Json::Value> results() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mResults;
+    }
+
+private:
+    mutable std::mutex mMutex;
+    std::condition_variable mCv;
+    std::vector<Json::Value> mStatuses;
+    std::vector<Json::Value> mResults;
+    bool mDone{false};
+};
+
+// Streams `n` chunks for a chat completion and answers anything else at once
+bool echo(Json::Value const& request, ShmRing& ring, int numChunks = 3)
+{
+    if (request["method"].asString() == "HandleChatCompletion")
+    {
+        for (int i = 0; i < numChunks; ++i)
+        {
+            Json::Value result;
+            result["index"] = i;
+            TestHost::reply(ring, request, makeStatus(200, i + 1 == numChunks, true), result);
+        }
+        return true;
+    }
+    Json::Value result;
+    result["method"] = request["method"];
+    result["body"] = request["body"];
+    TestHost::reply(ring, request, makeStatus(200, true, false), result);
+    return true;
+}
+
+} // namespace
+
+TEST(RemoteEngineTest, Calls)
+{
+    TestHost host{[](Json::Value const& request, ShmRing& ring) { return echo(request, ring); }};
+    RemoteEngine engine{host.path()};
+
+    // A non-streaming call returns once its callback ran
+    auto body = std::make_shared<Json::Value>();
+    (*body)["model"] = "model";
+    Json::Value result;
+    engine.GetModelStatus(body, [&result](Json::Value&&, Json::Value&& res) { result = std::move(res); });
+    EXPECT_EQ(result["method"].asString(), "GetModelStatus");
+    EXPECT_EQ(result["body"]["model"].asString(), "model");
+
+    StreamRecorder stream;
+    engine.HandleChatCompletion(body, stream.callback());
+    ASSERT_TRUE(stream.waitDone());
+    auto const results = stream.results();
+    ASSERT_EQ(results.size(), 3);
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(results[i]["index"].asInt(), i);
+    }
+    EXPECT_EQ(host.connections(), 1);
+}
+
+TEST(RemoteEngineTest, HostUnavailable)
+{
+    RemoteEngine engine{"/tmp/remoteEngineTest-missing.sock"};
+    Json::Value status;
+    engine.GetModels(std::make_shared<Json::Value>(), [&status](Json::Value&& s, Json::Value&&) { status = s; });
+    EXPECT_EQ(status["status_code"].asInt(), 503);
+    EXPECT_TRUE(status["has_error"].asBool());
+}
+
+TEST(RemoteEngineTest, HostDeath)
+{
+    // The host dies in the middle of a stream on its first connection
+    std::atomic<bool> died{false};
+    TestHost host{[&died](Json::Value const& request, ShmRing& ring)
+        {
+            if (request["method"].asString() == "HandleChatCompletion" && !died.exchange(true))
+            {
+                Json::Value result;
+                result["index"] = 0;
+                TestHost::reply(ring, request, makeStatus(200, false, true), result);
+                return false;
+            }
+            return echo(request, ring);
+        }};
+    RemoteEngine engine{host.path()};
+
+    StreamRecorder stream;
+    engine.HandleChatCompletion(std::make_shared<Json::Value>(), stream.callback());
+    ASSERT_TRUE(stream.waitDone());
+    auto const statuses = stream.statuses();
+    ASSERT_EQ(statuses.size(), 2);
+    EXPECT_EQ(stream.results()[0]["index"].asInt(), 0);
+    EXPECT_EQ(statuses[1]["status_code"].asInt(), 503);
+    EXPECT_TRUE(statuses[1]["has_error"].asBool());
+
+    // The next call reconnects
+    Json::Value status;
+    engine.GetModels(std::make_shared<Json::Value>(), [&status](Json::Value&& s, Json::Value&&) { status = s; });
+    EXPECT_EQ(status["status_code"].asInt(), 200);
+    EXPECT_EQ(host.connections(), 2);
+}
+
+TEST(RemoteEngineTest, DestroyedFromCallback)
+{
+    TestHost host{[](Json::Value const& request, ShmRing& ring) { return echo(request, ring); }};
+    auto engine = std::make_unique<RemoteEngine>(host.path());
+
+    // The last chunk releases the engine on its reader thread, which cannot join itself
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool destroyed{false};
+    engine->HandleChatCompletion(std::make_shared<Json::Value>(),
+        [&](Json::Value&& status, Json::Value&&)
+        {
+            if (!status["is_done"].asBool())
+            {
+                return;
+            }
+            engine.reset();
+            std::lock_guard<std::mutex> lock(mutex);
+            destroyed = true;
+            cv.notify_all();
+        });
+    std::unique_lock<std::mutex> lock(mutex);
+    EXPECT_TRUE(cv.wait_for(lock, std::chrono::seconds(10), [&destroyed]() { return destroyed; }));
+    EXPECT_EQ(engine, nullptr);
+}
@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "request_coalescer.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using tensorrtllm::RequestCoalescer;
+using Admission = RequestCoalescer::Admission;
+
+Json::Value request(std::string const& content, float temperature = 0.0f)
+{
+    Json::Value body;
+    body["model"] = "model";
+    body["temperature"] = temperature;
+    Json::Value message;
+    message["role"] = "user";
+    message["content"] = content;
+    body["messages"].append(message);
+    return body;
+}
+
+// Collects the indices of the chunks a callback receives
+class Recorder
+{
+public:
+    RequestCoalescer::Callback callback()
+    {
+        return [this](Json::Value&& status, Json::Value&& res)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mChunks.push_back(res["index"].asInt());
+            mDone = mDone || status["is_done"].asBool();
+        };
+    }
+
+    std::vector<int> chunks() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mChunks;
+    }
+
+    bool done() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mDone;
+    }
+
+private:
+    mutable std::mutex mMutex;
+    std::vector<int> mChunks;
+    bool mDone{false};
+};
+
+void publish(RequestCoalescer::Callback& callback, int index, bool done = false, bool error = false)
+{
+    Json::Value status;
+    status["is_done"] = done;
+    status["has_error"] = error;
+    Json::Value res;
+    res["index"] = index;
+    callback(std::move(status), std::move(res));
+}
+
+std::vector<int> iota(int count)
+{
+    std::vector<int> values(count);
+    for (int i = 0; i < count; ++i)
+    {
+        values[i] = i;
+    }
+    return values;
+}
+
+// Runs a generation of `count` chunks for `key` as its leader
+void generate(RequestCoalescer& coalescer, RequestCoalescer::Key const& key, Recorder& recorder, int count)
+{
+    auto callback = recorder.callback();
+    ASSERT_EQ(coalescer.Admit(key, callback), Admission::kLeader);
+    auto published = coalescer.Publish(key, std::move(callback));
+    for (int i = 0; i < count; ++i)
+    {
+        publish(published, i, i + 1 == count);
+    }
+}
+
+} // namespace
+
+TEST(RequestCoalescerTest, MakeKey)
+{
+    RequestCoalescer coalescer{RequestCoalescer::Config{}};
+    auto const key = coalescer.MakeKey(request("hello"));
+    ASSERT_TRUE(key.has_value());
+    EXPECT_EQ(key->hash, coalescer.MakeKey(request("hello"))->hash);
+    EXPECT_NE(key->normalized, coalescer.MakeKey(request("world"))->normalized);
+    // Sampled requests are not deterministic
+    EXPECT_FALSE(coalescer.MakeKey(request("hello", 0.7f)).has_value());
+
+    // Bans are sets
+    auto first = request("hello");
+    first["bad_words"].append("b");
+    first["bad_words"].append("a");
+    auto second = request("hello");
+    second["bad_words"].append("a");
+    second["bad_words"].append("b");
+    second["bad_words"].append("a");
+    EXPECT_EQ(coalescer.MakeKey(first)->normalized, coalescer.MakeKey(second)->normalized);
+}
+
+TEST(RequestCoalescerTest, FanOut)
+{
+    RequestCoalescer coalescer{RequestCoalescer::Config{}};
+    auto const key = *coalescer.MakeKey(request("hello"));
+
+    Recorder leader;
+    auto leaderCallback = leader.callback();
+    ASSERT_EQ(coalescer.Admit(key, leaderCallback), Admission::kLeader);
+
+    auto constexpr numFollowers = 4;
+    std::vector<Recorder> followers(numFollowers);
+    for (auto& follower : followers)
+    {
+        auto callback = follower.callback();
+        EXPECT_EQ(coalescer.Admit(key, callback), Admission::kCoalesced);
+    }
+
+    auto published = coalescer.Publish(key, std::move(leaderCallback));
+    auto constexpr numChunks = 5;
+    for (int i = 0; i < numChunks; ++i)
+    {
+        publish(published, i, i + 1 == numChunks);
+    }
+    EXPECT_EQ(leader.chunks(), iota(numChunks));
+    for (auto const& follower : followers)
+    {
+        EXPECT_EQ(follower.chunks(), iota(numChunks));
+        EXPECT_TRUE(follower.done());
+    }
+
+    auto const metrics = coalescer.Metrics();
+    EXPECT_EQ(metrics["generations"].asUInt64(), 1);
+    EXPECT_EQ(metrics["coalesced"].asUInt64(), numFollowers);
+    EXPECT_EQ(metrics["in_flight"].asUInt64(), 0);
+}
+
+TEST(RequestCoalescerTest, ReplayBeforeLive)
+{
+    RequestCoalescer coalescer{RequestCoalescer::Config{}};
+    auto const key = *coalescer.MakeKey(request("hello"));
+
+    Recorder leader;
+    auto leaderCallback = leader.callback();
+    ASSERT_EQ(coalescer.Admit(key, leaderCallback), Admission::kLeader);
+    auto published = coalescer.Publish(key, std::move(leaderCallback));
+
+    // Followers attach from their own threads while the leader publishes, whatever they attach to they receive
+    // every chunk once and in order
+    auto constexpr numFollowers = 8;
+    auto constexpr numChunks = 2000;
+    std::vector<Recorder> followers(numFollowers);
+    std::vector<Admission> admissions(numFollowers);
+    std::vector<std::thread> threads;
+    for (int f = 0; f < numFollowers; ++f)
+    {
+        threads.emplace_back(
+            [&, f]()
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(100 * f));
+                auto callback = followers[f].callback();
+                admissions[f] = coalescer.Admit(key, callback);
+            });
+    }
+    for (int i = 0; i < numChunks; ++i)
+    {
+        publish(published, i, i + 1 == numChunks);
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (int f = 0; f < numFollowers; ++f)
+    {
+        EXPECT_NE(admissions[f], Admission::kLeader);
+        EXPECT_EQ(followers[f].chunks(), iota(numChunks)) << "follower " << f;
+    }
+}
+
+TEST(RequestCoalescerTest, CacheTtl)
+{
+    RequestCoalescer::Config config;
+    config.cache_ttl_ms = 50;
+    RequestCoalescer coalescer{config};
+    auto const key = *coalescer.MakeKey(request("hello"));
+
+    Recorder leader;
+    generate(coalescer, key, leader, 3);
+
+    Recorder hit;
+    auto callback = hit.callback();
+    EXPECT_EQ(coalescer.Admit(key, callback), Admission::kCacheHit);
+    EXPECT_EQ(hit.chunks(), iota(3));
+    EXPECT_EQ(coalescer.Metrics()["cached_responses"].asUInt64(), 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    Recorder expired;
+    callback = expired.callback();
+    EXPECT_EQ(coalescer.Admit(key, callback), Admission::kLeader);
+    EXPECT_TRUE(expired.chunks().empty());
+    EXPECT_EQ(coalescer.Metrics()["cached_responses"].asUInt64(), 0);
+}
+
+TEST(RequestCoalescerTest, CacheEviction)
+{
+    RequestCoalescer::Config config;
+    config.cache_max_entries = 2;
+    RequestCoalescer coalescer{config};
+    std::vector<RequestCoalescer::Key> keys;
+    for (auto const* content : {"a", "b", "c"})
+    {
+        keys.push_back(*coalescer.MakeKey(request(content)));
+        Recorder leader;
+        generate(coalescer, keys.back(), leader, 2);
+    }
+    EXPECT_EQ(coalescer.Metrics()["cached_responses"].asUInt64(), 2);
+
+    // The oldest response went first
+    Recorder recorder;
+    auto callback = recorder.callback();
+    EXPECT_EQ(coalescer.Admit(keys[1], callback), Admission::kCacheHit);
+    callback = recorder.callback();
+    EXPECT_EQ(coalescer.Admit(keys[2], callback), Admission::kCacheHit);
+    callback = recorder.callback();
+    EXPECT_EQ(coalescer.Admit(keys[0], callback), Admission::kLeader);
+}
+
+TEST(RequestCoalescerTest, FailedNotCached)
+{
+    RequestCoalescer coalescer{RequestCoalescer::Config{}};
+    auto const key = *coalescer.MakeKey(request("hello"));
+
+    Recorder leader;
+    auto callback = leader.callback();
+    ASSERT_EQ(coalescer.Admit(key, callback), Admission::kLeader);
+    Recorder follower;
+    auto followerCallback = follower.callback();
+    ASSERT_EQ(coalescer.Admit(key, followerCallback), Admission::kCoalesced);
+    auto published = coalescer.Publish(key, std::move(callback));
+    publish(published, 0);
+    publish(published, 1, false, true);
+    EXPECT_EQ(follower.chunks(), iota(2));
+
+    Recorder retry;
+    callback = retry.callback();
+    EXPECT_EQ(coalescer.Admit(key, callback), Admission::kLeader);
+}
+
+TEST(RequestCoalescerTest, HashCollision)
+{
+    RequestCoalescer coalescer{RequestCoalescer::Config{}};
+    RequestCoalescer::Key const first{42, "first"};
+    RequestCoalescer::Key const second{42, "second"};
+
+    Recorder firstLeader;
+    auto firstCallback = firstLeader.callback();
+    ASSERT_EQ(coalescer.Admit(first, firstCallback), Admission::kLeader);
+    Recorder firstFollower;
+    auto followerCallback = firstFollower.callback();
+    ASSERT_EQ(coalescer.Admit(first, followerCallback), Admission::kCoalesced);
+
+    // The colliding request runs on its own and is neither coalesced nor cached
+    Recorder secondLeader;
+    auto secondCallback = secondLeader.callback();
+    ASSERT_EQ(coalescer.Admit(second, secondCallback), Admission::kLeader);
+    auto secondPublished = coalescer.Publish(second, std::move(secondCallback));
+    publish(secondPublished, 7, true);
+    EXPECT_EQ(secondLeader.chunks(), std::vector<int>{7});
+    EXPECT_TRUE(firstFollower.chunks().empty());
+
+    auto firstPublished = coalescer.Publish(first, std::move(firstCallback));
+    publish(firstPublished, 0, true);
+    EXPECT_EQ(firstFollower.chunks(), iota(1));
+
+    // Only the registered request was cached
+    Recorder recorder;
+    auto callback = recorder.callback();
+    EXPECT_EQ(coalescer.Admit(first, callback), Admission::kCacheHit);
+    callback = recorder.callback();
+    EXPECT_EQ(coalescer.Admit(second, callback), Admission::kLeader);
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cortex-common/ipc/shm_ring.h"
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using cortex::ipc::ShmRing;
+
+// A record whose contents depend on its index, so that a torn or misplaced one is caught
+std::string makeRecord(int index, std::size_t maxSize)
+{
+    auto const size = static_cast<std::size_t>(index * 7919) % (maxSize + 1);
+    std::string record(size, '\0');
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        record[i] = static_cast<char>(index + i);
+    }
+    return record;
+}
+
+// The peer's view of the mapping, to write what the ring itself never would. Its header is everything before the
+// `capacity` data bytes, and starts with the head index.
+class RawMapping
+{
+public:
+    RawMapping(int fd, std::size_t capacity)
+    {
+        mSize = static_cast<std::size_t>(lseek(fd, 0, SEEK_END));
+        mHeaderSize = mSize - capacity;
+        mBase = static_cast<char*>(mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+    }
+
+    ~RawMapping()
+    {
+        munmap(mBase, mSize);
+    }
+
+    std::atomic<std::uint64_t>& head()
+    {
+        return *reinterpret_cast<std::atomic<std::uint64_t>*>(mBase);
+    }
+
+    char* data()
+    {
+        return mBase + mHeaderSize;
+    }
+
+private:
+    char* mBase{nullptr};
+    std::size_t mSize{0};
+    std::size_t mHeaderSize{0};
+};
+
+} // namespace
+
+TEST(ShmRingTest, WrapAround)
+{
+    // Small enough that records wrap around the end of the ring and the producer waits for space
+    auto constexpr capacity = 64;
+    auto constexpr maxRecordSize = capacity - sizeof(std::uint32_t);
+    auto constexpr numRecords = 20000;
+    auto ring = ShmRing::Create(capacity);
+
+    std::thread producer(
+        [&ring]()
+        {
+            for (int i = 0; i < numRecords; ++i)
+            {
+                ASSERT_TRUE(ring->Push(makeRecord(i, maxRecordSize)));
+            }
+        });
+    std::string record;
+    for (int i = 0; i < numRecords; ++i)
+    {
+        ASSERT_TRUE(ring->Pop(record));
+        ASSERT_EQ(record, makeRecord(i, maxRecordSize)) << "record " << i;
+    }
+    producer.join();
+
+    // A record larger than the ring is refused rather than waited for
+    EXPECT_FALSE(ring->Push(std::string(maxRecordSize + 1, 'x')));
+}
+
+TEST(ShmRingTest, ForkedProducer)
+{
+    auto constexpr capacity = 1024;
+    auto constexpr numRecords = 5000;
+    auto ring = ShmRing::Create(capacity);
+
+    auto const pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0)
+    {
+        // The child maps the ring from its descriptor, as the engine host does
+        auto peer = ShmRing::Attach(dup(ring->fd()));
+        bool ok = true;
+        for (int i = 0; i < numRecords && ok; ++i)
+        {
+            ok = peer->Push(makeRecord(i, 200));
+        }
+        peer->Close();
+        _exit(ok ? 0 : 1);
+    }
+
+    std::string record;
+    int received = 0;
+    while (ring->Pop(record))
+    {
+        ASSERT_EQ(record, makeRecord(received, 200)) << "record " << received;
+        ++received;
+    }
+    EXPECT_EQ(received, numRecords);
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+TEST(ShmRingTest, CloseDrains)
+{
+    auto ring = ShmRing::Create(1024);
+    for (auto const* record : {"a", "bb", "ccc"})
+    {
+        ASSERT_TRUE(ring->Push(std::string(record)));
+    }
+    ring->Close();
+    EXPECT_FALSE(ring->Push(std::string("d")));
+
+    // What was written before the close is still delivered
+    std::string record;
+    for (auto const* expected : {"a", "bb", "ccc"})
+    {
+        ASSERT_TRUE(ring->Pop(record));
+        EXPECT_EQ(record, expected);
+    }
+    EXPECT_FALSE(ring->Pop(record));
+}
+
+TEST(ShmRingTest, CloseWakesConsumer)
+{
+    auto ring = ShmRing::Create(1024);
+    bool popped{true};
+    std::thread consumer(
+        [&]()
+        {
+            std::string record;
+            popped = ring->Pop(record);
+        });
+    // Long enough for the consumer to stop spinning and sleep
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ring->Close();
+    consumer.join();
+    EXPECT_FALSE(popped);
+}
+
+TEST(ShmRingTest, InvalidLength)
+{
+    auto constexpr capacity = 1024;
+    auto ring = ShmRing::Create(capacity);
+    auto peer = ShmRing::Attach(dup(ring->fd()));
+    RawMapping raw{ring->fd(), capacity};
+
+    // The peer claims a record longer than kMaxRecordSize
+    ASSERT_TRUE(peer->Push(std::string(8, 'x')));
+    std::uint32_t const length = ShmRing::kMaxRecordSize + 1;
+    std::memcpy(raw.data(), &length, sizeof(length));
+    std::string record;
+    EXPECT_FALSE(ring->Pop(record));
+    // The ring is closed for both sides
+    EXPECT_FALSE(peer->Push(std::string("y")));
+    EXPECT_FALSE(ring->Pop(record));
+}
+
+TEST(ShmRingTest, InvalidHead)
+{
+    auto constexpr capacity = 1024;
+    auto ring = ShmRing::Create(capacity);
+    auto peer = ShmRing::Attach(dup(ring->fd()));
+    RawMapping raw{ring->fd(), capacity};
+
+    // A length that runs past what the head says was written
+    ASSERT_TRUE(peer->Push(std::string(8, 'x')));
+    std::uint32_t const length = 100;
+    std::memcpy(raw.data(), &length, sizeof(length));
+    std::string record;
+    EXPECT_FALSE(ring->Pop(record));
+
+    // A head further ahead than the ring holds
+    auto fresh = ShmRing::Create(capacity);
+    RawMapping freshRaw{fresh->fd(), capacity};
+    freshRaw.head().store(capacity + 100);
+    EXPECT_FALSE(fresh->Pop(record));
+}
+
+TEST(ShmRingTest, AttachChecksSize)
+{
+    auto ring = ShmRing::Create(1024);
+    auto const fd = dup(ring->fd());
+    // The peer shrank the file below its recorded capacity
+    ASSERT_EQ(ftruncate(fd, lseek(fd, 0, SEEK_END) - 64), 0);
+    EXPECT_THROW(ShmRing::Attach(fd), std::runtime_error);
+}
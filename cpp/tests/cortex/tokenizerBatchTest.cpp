@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bpe_tokenizer.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+auto const TEST_RESOURCE_PATH = fs::path{TOP_LEVEL_DIR} / "cpp/tests/resources/data/tokenizer";
+
+std::vector<std::string> makeInputs(size_t count)
+{
+    std::vector<std::string> inputs;
+    for (size_t i = 0; i < count; ++i)
+    {
+        // Uneven sizes and a few empty inputs, so chunks differ in length
+        auto text = i % 7 == 3 ? std::string{} : "Item " + std::to_string(i) + ": the quick brown fox";
+        for (size_t j = 0; j < i % 5; ++j)
+        {
+            text += " jumps over the lazy dog " + std::to_string(j * i);
+        }
+        inputs.push_back(std::move(text));
+    }
+    return inputs;
+}
+
+} // namespace
+
+namespace tensorrtllm
+{
+
+namespace
+{
+
+// Encodes each segment through a batch of the inner tokenizer, so that every chunk of an outer batch starts a
+// batch of its own, on the pool threads as well as on the calling thread.
+class NestedBatchTokenizer : public Tokenizer
+{
+public:
+    explicit NestedBatchTokenizer(Tokenizer const& inner)
+        : mInner(inner)
+    {
+    }
+
+    void DecodeAppend(int32_t const* ids, size_t count, std::string& text) const override
+    {
+        mInner.DecodeAppend(ids, count, text);
+    }
+
+protected:
+    void EncodeSegment(std::string_view text, std::vector<int32_t>& ids) const override
+    {
+        std::vector<std::string> const inputs{std::string(text), std::string(text)};
+        std::vector<int32_t> batchIds;
+        std::vector<int32_t> offsets;
+        mInner.EncodeBatch(inputs, batchIds, offsets);
+        ids.insert(ids.end(), batchIds.begin(), batchIds.begin() + offsets[1]);
+    }
+
+private:
+    Tokenizer const& mInner;
+};
+
+} // namespace
+
+class TokenizerBatchTest : public ::testing::TestWithParam<size_t> // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+};
+
+TEST_P(TokenizerBatchTest, MatchesPerItemEncode)
+{
+    BpeTokenizer tokenizer((TEST_RESOURCE_PATH / "gpt2/tokenizer.json").string());
+    auto const inputs = makeInputs(97);
+
+    std::vector<int32_t> ids;
+    std::vector<int32_t> offsets;
+    tokenizer.EncodeBatch(inputs, ids, offsets, GetParam());
+    ASSERT_EQ(offsets.size(), inputs.size() + 1);
+    EXPECT_EQ(offsets.front(), 0);
+    EXPECT_EQ(static_cast<size_t>(offsets.back()), ids.size());
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        std::vector<int32_t> const itemIds(ids.begin() + offsets[i], ids.begin() + offsets[i + 1]);
+        EXPECT_EQ(itemIds, tokenizer.Encode(inputs[i])) << "input " << i;
+    }
+
+    std::vector<std::string> texts;
+    tokenizer.DecodeBatch(ids, offsets, texts, GetParam());
+    ASSERT_EQ(texts.size(), inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        std::vector<int32_t> const itemIds(ids.begin() + offsets[i], ids.begin() + offsets[i + 1]);
+        EXPECT_EQ(texts[i], tokenizer.Decode(itemIds)) << "input " << i;
+        EXPECT_EQ(texts[i], inputs[i]) << "input " << i;
+    }
+}
+
+TEST_P(TokenizerBatchTest, NestedBatchesRunInline)
+{
+    BpeTokenizer inner((TEST_RESOURCE_PATH / "gpt2/tokenizer.json").string());
+    NestedBatchTokenizer tokenizer(inner);
+    auto const inputs = makeInputs(257);
+
+    std::vector<int32_t> ids;
+    std::vector<int32_t> offsets;
+    tokenizer.EncodeBatch(inputs, ids, offsets, GetParam());
+    ASSERT_EQ(offsets.size(), inputs.size() + 1);
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        std::vector<int32_t> const itemIds(ids.begin() + offsets[i], ids.begin() + offsets[i + 1]);
+        EXPECT_EQ(itemIds, inner.Encode(inputs[i])) << "input " << i;
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Threads, TokenizerBatchTest, ::testing::Values(1, 3, 0));
+
+TEST(TokenizerBatchEmptyTest, EmptyBatch)
+{
+    BpeTokenizer tokenizer((TEST_RESOURCE_PATH / "gpt2/tokenizer.json").string());
+    std::vector<int32_t> ids{1, 2, 3};
+    std::vector<int32_t> offsets;
+    tokenizer.EncodeBatch({}, ids, offsets);
+    EXPECT_TRUE(ids.empty());
+    EXPECT_EQ(offsets, std::vector<int32_t>{0});
+
+    std::vector<std::string> texts{"stale"};
+    tokenizer.DecodeBatch(ids, offsets, texts);
+    EXPECT_TRUE(texts.empty());
+}
+
+} // namespace tensorrtllm
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utf8_json.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using tensorrtllm::SimdLevel;
+
+std::vector<SimdLevel> supportedLevels()
+{
+    std::vector<SimdLevel> levels{SimdLevel::kScalar};
+    for (auto level : {SimdLevel::kSse2, SimdLevel::kAvx2})
+    {
+        if (level <= tensorrtllm::DetectSimdLevel())
+        {
+            levels.push_back(level);
+        }
+    }
+    return levels;
+}
+
+std::string escaped(std::string const& text, SimdLevel level = SimdLevel::kScalar)
+{
+    std::string out;
+    tensorrtllm::AppendJsonEscaped(text, out, level);
+    return out;
+}
+
+void appendCodePoint(uint32_t cp, std::string& out)
+{
+    if (cp < 0x80)
+    {
+        out += static_cast<char>(cp);
+    }
+    else if (cp < 0x800)
+    {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000)
+    {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else
+    {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// Valid UTF-8 with the code point boundaries, mostly ASCII with runs of
+// escapes and multi-byte characters of every length.
+std::string randomText(std::mt19937& rng, size_t codePoints, std::vector<size_t>* boundaries = nullptr)
+{
+    std::string text;
+    for (size_t i = 0; i < codePoints; ++i)
+    {
+        uint32_t cp;
+        switch (rng() % 8)
+        {
+        case 0: cp = rng() % 0x20; break;
+        case 1: cp = "\"\\/"[rng() % 3]; break;
+        case 2: cp = 0x80 + rng() % 0x780; break;
+        case 3: cp = 0x800 + rng() % 0xD000; break;
+        case 4: cp = 0x10000 + rng() % 0x100000; break;
+        default: cp = 0x20 + rng() % 0x5F;
+        }
+        if (boundaries != nullptr)
+        {
+            boundaries->push_back(text.size());
+        }
+        appendCodePoint(cp, text);
+    }
+    if (boundaries != nullptr)
+    {
+        boundaries->push_back(text.size());
+    }
+    return text;
+}
+
+} // namespace
+
+namespace tensorrtllm
+{
+
+TEST(Utf8JsonTest, EscapesJsonSpecials)
+{
+    EXPECT_EQ(escaped("plain text"), "plain text");
+    EXPECT_EQ(escaped("say \"hi\"\\n"), "say \\\"hi\\\"\\\\n");
+    EXPECT_EQ(escaped("a\nb\tc\rd\be\ff"), "a\\nb\\tc\\rd\\be\\ff");
+    EXPECT_EQ(escaped(std::string("\x00\x01\x1f\x7f", 4)), "\\u0000\\u0001\\u001f\x7f");
+    EXPECT_EQ(escaped("Grüße 你好 👋"), "Grüße 你好 👋");
+}
+
+TEST(Utf8JsonTest, ReplacesIllFormedSequences)
+{
+    std::string const fffd = "\xEF\xBF\xBD";
+    // One replacement per maximal subpart, as the Unicode standard recommends.
+    EXPECT_EQ(escaped("a\x80z"), "a" + fffd + "z");
+    EXPECT_EQ(escaped("a\xF0\x9F\x98z"), "a" + fffd + "z");
+    EXPECT_EQ(escaped("\xC0\xAF"), fffd + fffd);
+    EXPECT_EQ(escaped("\xED\xA0\x80"), fffd + fffd + fffd);
+    EXPECT_EQ(escaped("\xF4\x90\x80\x80"), fffd + fffd + fffd + fffd);
+    EXPECT_EQ(escaped("\xE2\x82"), fffd);
+    EXPECT_EQ(escaped("\xFF\"\xFE"), fffd + "\\\"" + fffd);
+}
+
+TEST(Utf8JsonTest, HoldsBackIncompleteCodePoints)
+{
+    EXPECT_EQ(Utf8CompleteLength(""), 0u);
+    EXPECT_EQ(Utf8CompleteLength("abc"), 3u);
+    EXPECT_EQ(Utf8CompleteLength("ab\xE2\x82"), 2u);
+    EXPECT_EQ(Utf8CompleteLength("ab\xE2\x82\xAC"), 5u);
+    EXPECT_EQ(Utf8CompleteLength("\xF0\x9F\x98"), 0u);
+    // Ill-formed tails cannot be completed, so they are not held back.
+    EXPECT_EQ(Utf8CompleteLength("ab\x80"), 3u);
+    EXPECT_EQ(Utf8CompleteLength("ab\xE0\x80"), 4u);
+    EXPECT_EQ(Utf8CompleteLength("ab\xF5"), 3u);
+}
+
+TEST(Utf8JsonTest, CompleteLengthFindsLastBoundary)
+{
+    std::mt19937 rng(7);
+    for (int round = 0; round < 200; ++round)
+    {
+        std::vector<size_t> boundaries;
+        auto const text = randomText(rng, 1 + rng() % 40, &boundaries);
+        size_t b = 0;
+        for (size_t cut = 0; cut <= text.size(); ++cut)
+        {
+            while (b + 1 < boundaries.size() && boundaries[b + 1] <= cut)
+            {
+                ++b;
+            }
+            ASSERT_EQ(Utf8CompleteLength(std::string_view(text).substr(0, cut)), boundaries[b]) << "cut " << cut;
+        }
+    }
+}
+
+TEST(Utf8JsonTest, StreamedChunksReassembleTheText)
+{
+    std::mt19937 rng(11);
+    for (int round = 0; round < 200; ++round)
+    {
+        auto const text = randomText(rng, 1 + rng() % 100);
+        std::string streamed;
+        size_t sent = 0;
+        for (size_t end = 0; end < text.size();)
+        {
+            end = std::min(text.size(), end + 1 + rng() % 4);
+            size_t const complete = end == text.size() ? end : Utf8CompleteLength(std::string_view(text).substr(0, end));
+            std::string const chunk = text.substr(sent, complete - sent);
+            // Every chunk is whole code points: escaping never replaces anything.
+            ASSERT_EQ(escaped(chunk).find("\xEF\xBF\xBD"), std::string::npos);
+            streamed += chunk;
+            sent = complete;
+        }
+        EXPECT_EQ(streamed, text);
+    }
+}
+
+TEST(Utf8JsonTest, VectorLevelsMatchScalar)
+{
+    std::mt19937 rng(42);
+    auto const levels = supportedLevels();
+    for (int round = 0; round < 2000; ++round)
+    {
+        std::string text;
+        if (round % 2 == 0)
+        {
+            text = randomText(rng, rng() % 200);
+        }
+        else
+        {
+            // Arbitrary bytes, mostly printable ASCII so the vector paths see
+            // long plain runs between the bytes they have to stop at.
+            text.resize(rng() % 300);
+            for (auto& c : text)
+            {
+                c = static_cast<char>(rng() % 4 == 0 ? rng() % 256 : 0x20 + rng() % 0x5F);
+            }
+        }
+        auto const expected = escaped(text);
+        for (auto level : levels)
+        {
+            ASSERT_EQ(escaped(text, level), expected) << "level " << static_cast<int>(level) << " round " << round;
+        }
+    }
+}
+
+} // namespace tensorrtllm
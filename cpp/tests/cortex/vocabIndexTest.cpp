@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "bpe_tokenizer.h"
+#include "vocab_index.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+auto const TEST_RESOURCE_PATH = fs::path{TOP_LEVEL_DIR} / "cpp/tests/resources/data/tokenizer";
+
+using Ids = std::vector<int32_t>;
+
+tensorrtllm::PieceTable makePieces(std::vector<std::string> const& pieces)
+{
+    tensorrtllm::PieceTable table;
+    for (auto const& piece : pieces)
+    {
+        table.Add(piece, piece.front() == '<' ? tensorrtllm::PieceTable::kSkipOnDecode : tensorrtllm::PieceTable::kNone);
+    }
+    return table;
+}
+
+Ids setIds(tensorrtllm::TokenMask const& mask)
+{
+    Ids ids;
+    mask.ForEach([&](int32_t id) { ids.push_back(id); });
+    return ids;
+}
+
+} // namespace
+
+namespace tensorrtllm
+{
+
+TEST(TokenMaskTest, SetsAndCombinesBits)
+{
+    std::mt19937 rng(3);
+    size_t const size = 1000;
+    TokenMask a(size);
+    TokenMask b(size);
+    std::vector<bool> refA(size);
+    std::vector<bool> refB(size);
+    for (int i = 0; i < 300; ++i)
+    {
+        auto const x = static_cast<int32_t>(rng() % size);
+        auto const y = static_cast<int32_t>(rng() % size);
+        a.Set(x);
+        b.Set(y);
+        refA[x] = true;
+        refB[y] = true;
+    }
+    a.Set(-1);
+    a.Set(size);
+    EXPECT_FALSE(a.Test(static_cast<int32_t>(size)));
+
+    TokenMask both = a;
+    both &= b;
+    TokenMask either = a;
+    either |= b;
+    TokenMask onlyA = a;
+    onlyA.AndNot(b);
+    size_t countA = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        auto const id = static_cast<int32_t>(i);
+        ASSERT_EQ(a.Test(id), refA[i]);
+        ASSERT_EQ(both.Test(id), refA[i] && refB[i]);
+        ASSERT_EQ(either.Test(id), refA[i] || refB[i]);
+        ASSERT_EQ(onlyA.Test(id), refA[i] && !refB[i]);
+        countA += refA[i];
+    }
+    EXPECT_EQ(a.Count(), countA);
+    EXPECT_EQ(setIds(a).size(), countA);
+
+    // A larger mask does not spill past the end of a smaller one.
+    TokenMask small(70);
+    TokenMask large(200);
+    large.Set(70);
+    large.Set(69);
+    small |= large;
+    EXPECT_EQ(setIds(small), (Ids{69}));
+}
+
+TEST(TokenMaskTest, PacksWordLists)
+{
+    WordList words;
+    EXPECT_TRUE(words.Empty());
+    Ids const phrase{7, 8, 9};
+    words.AddWord(phrase.data(), phrase.size());
+    TokenMask mask(100);
+    mask.Set(3);
+    mask.Set(64);
+    words.AddTokens(mask);
+    ASSERT_EQ(words.Length(), 5u);
+    EXPECT_EQ(words.Pack(), (Ids{7, 8, 9, 3, 64, 3, 4, 5, -1, -1}));
+
+    std::vector<float> bias(100, 0.f);
+    ApplyBias(mask, -1.f, bias.data());
+    EXPECT_EQ(bias[3], -1.f);
+    EXPECT_EQ(bias[64], -1.f);
+    EXPECT_EQ(bias[4], 0.f);
+}
+
+TEST(VocabIndexTest, ClassifiesTokens)
+{
+    auto const pieces = makePieces({"<s>", " ", "\n\n", "12", " 3", "a", " ab", "abc", "1a", "</s>", " \t"});
+    VocabIndex const index(pieces);
+    EXPECT_EQ(index.Size(), pieces.Size());
+    EXPECT_EQ(setIds(index.SpecialTokens()), (Ids{0, 9}));
+    EXPECT_EQ(setIds(index.WhitespaceTokens()), (Ids{1, 2, 10}));
+    EXPECT_EQ(setIds(index.DigitTokens()), (Ids{3, 4}));
+    EXPECT_TRUE(index.LeadingSpace(6));
+    EXPECT_FALSE(index.LeadingSpace(7));
+    EXPECT_TRUE(index.Special(9));
+    EXPECT_EQ(index.ByteLength(7), 3u);
+}
+
+TEST(VocabIndexTest, FindsTokensByPrefix)
+{
+    auto const pieces = makePieces({"<ab>", "ab", "a", "abc", "b", " ab", "abd", "ac", "ab"});
+    VocabIndex const index(pieces);
+    TokenMask mask(index.Size());
+    index.AddWithPrefix("ab", mask);
+    EXPECT_EQ(setIds(mask), (Ids{1, 3, 6, 8}));
+    index.AddWithPrefix("", mask);
+    EXPECT_EQ(mask.Count(), 4u);
+
+    EXPECT_EQ(index.Find("ab"), 1);
+    EXPECT_EQ(index.Find("abc"), 3);
+    EXPECT_EQ(index.Find(" ab"), 5);
+    EXPECT_EQ(index.Find("<ab>"), -1);
+    EXPECT_EQ(index.Find("abe"), -1);
+    EXPECT_EQ(index.Find(""), -1);
+}
+
+TEST(VocabIndexTest, PrefixMatchesLinearScan)
+{
+    BpeTokenizer tokenizer((TEST_RESOURCE_PATH / "llama3/tokenizer.json").string());
+    auto const& pieces = tokenizer.Pieces();
+    VocabIndex const index(pieces);
+    for (std::string prefix : {" the", "ing", "\n", " 1", "zzzz", "\xE4\xBD"})
+    {
+        TokenMask mask(index.Size());
+        index.AddWithPrefix(prefix, mask);
+        Ids expected;
+        for (int32_t id = 0; id < static_cast<int32_t>(pieces.Size()); ++id)
+        {
+            auto const piece = pieces.Piece(id);
+            if (!(pieces.GetFlags(id) & PieceTable::kSkipOnDecode) && piece.substr(0, prefix.size()) == prefix)
+            {
+                expected.push_back(id);
+            }
+        }
+        EXPECT_EQ(setIds(mask), expected) << prefix;
+    }
+    EXPECT_EQ(index.Find(" the"), tokenizer.Encode(" the").front());
+}
+
+} // namespace tensorrtllm
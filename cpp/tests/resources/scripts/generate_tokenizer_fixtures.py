@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: Copyright (c) 2022-2024 NVIDIA CORPORATION &
+# AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Generates the byte-level BPE fixtures used by bpeTokenizerTest.
+
+Trains two small tokenizers with the Hugging Face `tokenizers` package, one
+per supported pre-tokenizer family, and records the reference ids of a set of
+tricky inputs:
+
+    pip install tokenizers
+    python3 cpp/tests/resources/scripts/generate_tokenizer_fixtures.py
+"""
+
+import json
+from pathlib import Path
+
+from tokenizers import Regex, Tokenizer, decoders, models, pre_tokenizers, trainers
+
+ROOT = Path(__file__).resolve().parents[4]
+OUTPUT = ROOT / "cpp/tests/resources/data/tokenizer"
+
+LLAMA3_PATTERN = (r"(?i:'s|'t|'re|'ve|'m|'ll|'d)|[^\r\n\p{L}\p{N}]?\p{L}+|\p{N}{1,3}|"
+                  r" ?[^\s\p{L}\p{N}]+[\r\n]*|\s*[\r\n]+|\s+(?!\S)|\s+")
+
+MULTILINGUAL = [
+    "Xin chào, hôm nay trời đẹp quá!",
+    "Grüße aus München, das Wetter ist schön.",
+    "Привет, как дела? Всё хорошо.",
+    "你好，世界！今天天气很好。",
+    "こんにちは、世界。カタカナとひらがな。",
+    "안녕하세요 세계",
+    "مرحبا بالعالم",
+    "नमस्ते दुनिया",
+    "Ελληνικά γράμματα και αριθμοί ٣٤٥ ۱۲۳",
+    "emoji 👋🏽 🚀 ❤️ and combining é marks",
+]
+
+CASES = [
+    "",
+    "Hello world",
+    "Hello, world! How's it going? I'M fine, they'LL see, we'Re done.",
+    "   leading and trailing spaces   ",
+    "tabs\tand\nnewlines\r\n\r\nmixed \n  \n\t x",
+    "numbers 1 12 123 1234 12345678 3.14159 1e-9 0x7fff",
+    "punctuation!!! ...??? (brackets) [x] {y} <z> \"quotes\" 'single'",
+    "int main() {\n    return a->b[i] + c::d<int>(e);\n}\n",
+    "<|im_start|>system\nYou are a helpful assistant.<|im_end|>\n<|im_start|>user\nhi<|im_end|>",
+    "<|begin_of_text|><|start_header_id|>user<|end_header_id|>\n\nhello<|eot_id|>",
+    "<|endoftext|>text after end<|endoftext|>",
+    "<|im_start|<|im_end|><|im_end|x",
+    "Don't 'quote' o'clock 'S 'T",
+    "  \n",
+    " ",
+    "\n\n\n",
+    "a  b   c    d",
+    "unicode spaces nbsp　ideographic thin",
+] + MULTILINGUAL
+
+
+def corpus():
+    texts = list(MULTILINGUAL)
+    for path in sorted((ROOT / "cpp/include/tensorrt_llm/runtime").glob("*.h")):
+        texts.append(path.read_text(encoding="utf-8"))
+    return texts
+
+
+def train(name, pre_tokenizer, special_tokens, ignore_merges):
+    tokenizer = Tokenizer(models.BPE(ignore_merges=ignore_merges))
+    tokenizer.pre_tokenizer = pre_tokenizer
+    tokenizer.decoder = decoders.ByteLevel()
+    trainer = trainers.BpeTrainer(vocab_size=1200,
+                                  initial_alphabet=pre_tokenizers.ByteLevel.alphabet(),
+                                  special_tokens=special_tokens,
+                                  show_progress=False)
+    tokenizer.train_from_iterator(corpus(), trainer)
+
+    directory = OUTPUT / name
+    directory.mkdir(parents=True, exist_ok=True)
+    tokenizer.save(str(directory / "tokenizer.json"))
+
+    expected = []
+    for text in CASES:
+        ids = tokenizer.encode(text, add_special_tokens=False).ids
+        expected.append({"text": text, "ids": ids})
+    with open(directory / "expected.json", "w", encoding="utf-8") as f:
+        json.dump(expected, f, ensure_ascii=False, indent=1)
+        f.write("\n")
+
+
+def main():
+    train("gpt2",
+          pre_tokenizers.ByteLevel(add_prefix_space=False),
+          ["<|endoftext|>"],
+          ignore_merges=False)
+    train("llama3",
+          pre_tokenizers.Sequence([
+              pre_tokenizers.Split(Regex(LLAMA3_PATTERN), behavior="isolated"),
+              pre_tokenizers.ByteLevel(add_prefix_space=False, use_regex=False),
+          ]),
+          [
+              "<|begin_of_text|>", "<|end_of_text|>", "<|start_header_id|>", "<|end_header_id|>", "<|eot_id|>",
+              "<|im_start|>", "<|im_end|>"
+          ],
+          ignore_merges=True)
+
+
+if __name__ == "__main__":
+    main()
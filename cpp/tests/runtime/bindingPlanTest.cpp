@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/bindingPlan.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/utils/sessionUtils.h"
+
+#include <string>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+using nvinfer1::DataType;
+using nvinfer1::TensorIOMode;
+
+// Stands in for an engine with two layers of KV cache
+std::vector<IOTensorDesc> makeEngineDesc()
+{
+    return {
+        {"input_ids", TensorIOMode::kINPUT, DataType::kINT32, ITensor::makeShape({-1})},
+        {"past_key_value_0", TensorIOMode::kINPUT, DataType::kHALF, ITensor::makeShape({-1, 2, 4, -1, 8})},
+        {"past_key_value_1", TensorIOMode::kINPUT, DataType::kHALF, ITensor::makeShape({-1, 2, 4, -1, 8})},
+        {"host_request_types", TensorIOMode::kINPUT, DataType::kINT32, ITensor::makeShape({-1}), true},
+        {"logits", TensorIOMode::kOUTPUT, DataType::kFLOAT, ITensor::makeShape({-1, 16})},
+        {"present_key_value_0", TensorIOMode::kOUTPUT, DataType::kHALF, ITensor::makeShape({-1, 2, 4, -1, 8})},
+        {"present_key_value_1", TensorIOMode::kOUTPUT, DataType::kHALF, ITensor::makeShape({-1, 2, 4, -1, 8})},
+    };
+}
+} // namespace
+
+TEST(BindingPlanTest, Slots)
+{
+    BindingPlan const plan{makeEngineDesc()};
+    EXPECT_EQ(plan.getNbSlots(), 7);
+    EXPECT_EQ(plan.getInputSlots(), (std::vector<SizeType>{0, 1, 2, 3}));
+    EXPECT_EQ(plan.getOutputSlots(), (std::vector<SizeType>{4, 5, 6}));
+    EXPECT_EQ(plan.findSlot("past_key_value_1"), 2);
+    EXPECT_EQ(plan.findSlot("logits"), 4);
+    EXPECT_EQ(plan.findSlot("attention_mask"), BindingPlan::kNoSlot);
+    EXPECT_EQ(plan.getTensorDesc(5).name, "present_key_value_0");
+    EXPECT_TRUE(plan.getTensorDesc(3).isShapeInferenceIO);
+
+    auto desc = makeEngineDesc();
+    desc.push_back(desc.front());
+    EXPECT_THROW(BindingPlan{desc}, tc::TllmException);
+}
+
+TEST(BindingPlanTest, TensorMapSlots)
+{
+    BindingPlan const plan{makeEngineDesc()};
+    BindingPlan::TensorMap tensorMap;
+    ITensor::SharedPtr const inputIds{BufferManager::cpu(ITensor::makeShape({3}), DataType::kINT32)};
+    ITensor::SharedPtr const logits{BufferManager::cpu(ITensor::makeShape({3, 16}), DataType::kFLOAT)};
+    tensorMap.emplace("input_ids", inputIds);
+    tensorMap.emplace("logits", logits);
+    tensorMap.emplace("not_in_engine", inputIds);
+
+    TensorMapSlots mapSlots;
+    auto* slots = &mapSlots.update(plan, tensorMap);
+    ASSERT_EQ(slots->size(), 7u);
+    EXPECT_EQ((*slots)[0], inputIds);
+    EXPECT_EQ((*slots)[4], logits);
+    for (auto const slot : {1, 2, 3, 5, 6})
+    {
+        EXPECT_EQ((*slots)[slot], nullptr);
+    }
+
+    // Replaced entries are seen without looking the map up again
+    ITensor::SharedPtr const newLogits{BufferManager::cpu(ITensor::makeShape({3, 16}), DataType::kFLOAT)};
+    tensorMap.insert_or_assign("logits", newLogits);
+    slots = &mapSlots.update(plan, tensorMap);
+    EXPECT_EQ((*slots)[4], newLogits);
+
+    // Tensors set for missing entries are stored, and the grown map is looked up again
+    ITensor::SharedPtr const present{BufferManager::cpu(ITensor::makeShape({1, 2, 4, 3, 8}), DataType::kHALF)};
+    (*slots)[5] = present;
+    mapSlots.storeMissing(tensorMap);
+    EXPECT_EQ(tensorMap.at("present_key_value_0"), present);
+    EXPECT_EQ(tensorMap.count("present_key_value_1"), 0u);
+    slots = &mapSlots.update(plan, tensorMap);
+    EXPECT_EQ((*slots)[5], present);
+    tensorMap.insert_or_assign("present_key_value_0", logits);
+    EXPECT_EQ(mapSlots.update(plan, tensorMap)[5], logits);
+
+    // Another map is looked up, and a copy starts cleared
+    BindingPlan::TensorMap otherMap;
+    otherMap.emplace("logits", logits);
+    slots = &mapSlots.update(plan, otherMap);
+    EXPECT_EQ((*slots)[0], nullptr);
+    EXPECT_EQ((*slots)[4], logits);
+    EXPECT_THROW(mapSlots.storeMissing(tensorMap), tc::TllmException);
+    TensorMapSlots copy{mapSlots};
+    EXPECT_EQ(copy.update(plan, tensorMap)[0], inputIds);
+
+    mapSlots.clear();
+    tensorMap.clear();
+    tensorMap.emplace("input_ids", logits);
+    EXPECT_EQ(mapSlots.update(plan, tensorMap)[0], logits);
+}
+
+TEST(BindingPlanTest, TensorMapSlotsKeepViewsReusable)
+{
+    BindingPlan const plan{makeEngineDesc()};
+    BindingPlan::TensorMap tensorMap;
+    ITensor::SharedPtr const logits{BufferManager::cpu(ITensor::makeShape({4, 16}), DataType::kFLOAT)};
+    TensorMapSlots mapSlots;
+
+    // Two steps as GptSession runs them: update the map, bind its slots, then release them
+    utils::updateTensorView(tensorMap, "logits", logits, ITensor::makeShape({3, 16}));
+    ITensor const* const view = tensorMap.at("logits").get();
+    EXPECT_EQ(mapSlots.update(plan, tensorMap)[4].get(), view);
+    mapSlots.release();
+
+    utils::updateTensorView(tensorMap, "logits", logits, ITensor::makeShape({2, 16}));
+    EXPECT_EQ(tensorMap.at("logits").get(), view);
+    EXPECT_EQ(view->getShape().d[0], 2);
+    auto const& slots = mapSlots.update(plan, tensorMap);
+    EXPECT_EQ(slots[4].get(), view);
+    EXPECT_EQ(slots[4]->getShape().d[0], 2);
+
+    // Slots that are still held keep the view from being reshaped in place
+    utils::updateTensorView(tensorMap, "logits", logits, ITensor::makeShape({1, 16}));
+    EXPECT_NE(tensorMap.at("logits").get(), view);
+}
+
+TEST(BindingPlanTest, Validate)
+{
+    BindingPlan const plan{makeEngineDesc()};
+    auto const kvSlot = plan.findSlot("past_key_value_0");
+
+    auto const kvCache = BufferManager::cpu(ITensor::makeShape({2, 2, 4, 0, 8}), DataType::kHALF);
+    EXPECT_NO_THROW(plan.validateInput(kvSlot, *kvCache));
+    // Static dims that differ only warn, as TensorRT rejects the shape when it is set
+    auto const otherHeads = BufferManager::cpu(ITensor::makeShape({2, 2, 3, 0, 8}), DataType::kHALF);
+    EXPECT_NO_THROW(plan.validateInput(kvSlot, *otherHeads));
+    // FP8 tensors are passed to FP16 inputs
+    auto const fp8 = BufferManager::cpu(ITensor::makeShape({2, 2, 4, 0, 8}), DataType::kFP8);
+    EXPECT_NO_THROW(plan.validateInput(kvSlot, *fp8));
+
+    auto const wrongType = BufferManager::cpu(ITensor::makeShape({2, 2, 4, 0, 8}), DataType::kFLOAT);
+    EXPECT_THROW(plan.validateInput(kvSlot, *wrongType), tc::TllmException);
+    auto const wrongRank = BufferManager::cpu(ITensor::makeShape({2, 2, 4, 8}), DataType::kHALF);
+    EXPECT_THROW(plan.validateInput(kvSlot, *wrongRank), tc::TllmException);
+
+    auto const logitsSlot = plan.findSlot("logits");
+    auto const logits = BufferManager::cpu(ITensor::makeShape({0}), DataType::kFLOAT);
+    EXPECT_NO_THROW(plan.validateOutput(logitsSlot, *logits));
+    EXPECT_THROW(plan.validateOutput(logitsSlot, *wrongRank), tc::TllmException);
+}
+
+TEST(BindingPlanTest, Bindings)
+{
+    BindingPlan const plan{makeEngineDesc()};
+    BindingPlan::Bindings bindings{plan.getNbSlots()};
+    auto const shape = ITensor::makeShape({3});
+    int data[3];
+
+    // Nothing is bound at first
+    auto change = bindings.compare(0, data, DataType::kINT32, shape);
+    EXPECT_TRUE(change.address);
+    EXPECT_TRUE(change.shape);
+    bindings.set(0, data, DataType::kINT32, shape);
+
+    change = bindings.compare(0, data, DataType::kINT32, shape);
+    EXPECT_FALSE(change.address);
+    EXPECT_FALSE(change.shape);
+
+    change = bindings.compare(0, data + 1, DataType::kINT32, shape);
+    EXPECT_TRUE(change.address);
+    EXPECT_FALSE(change.shape);
+
+    change = bindings.compare(0, data, DataType::kINT32, ITensor::makeShape({2}));
+    EXPECT_FALSE(change.address);
+    EXPECT_TRUE(change.shape);
+
+    change = bindings.compare(0, data, DataType::kFLOAT, shape);
+    EXPECT_TRUE(change.shape);
+
+    // Other slots are independent
+    EXPECT_TRUE(bindings.compare(1, data, DataType::kINT32, shape).shape);
+
+    auto const logitsSlot = plan.findSlot("logits");
+    EXPECT_EQ(bindings.getOutputShape(logitsSlot), nullptr);
+    bindings.setOutputShape(logitsSlot, ITensor::makeShape({3, 16}));
+    ASSERT_NE(bindings.getOutputShape(logitsSlot), nullptr);
+    EXPECT_TRUE(ITensor::shapeEquals(*bindings.getOutputShape(logitsSlot), ITensor::makeShape({3, 16})));
+    bindings.clearOutputShapes();
+    EXPECT_EQ(bindings.getOutputShape(logitsSlot), nullptr);
+    // Clearing the output shapes keeps the bindings
+    EXPECT_FALSE(bindings.compare(0, data, DataType::kINT32, shape).shape);
+    bindings.clear();
+    EXPECT_TRUE(bindings.compare(0, data, DataType::kINT32, shape).shape);
+}
@@ -21,6 +21,7 @@
 
 #include <limits>
 #include <memory>
+#include <numeric>
 
 using namespace tensorrt_llm::runtime;
 namespace tc = tensorrt_llm::common;
@@ -197,3 +198,78 @@ TEST_F(BufferManagerTest, TrimPoolOnDestruction)
     EXPECT_LE(memoryPoolReserved(), reserved);
     EXPECT_LE(memoryPoolFree(), free);
 }
+
+TEST_F(BufferManagerTest, ArenaRoundTrip)
+{
+    BufferManager manager(mStream);
+    std::vector<std::int32_t> const inputIds{1, 2, 3, 4, 5, 6};
+    std::vector<std::int32_t> const inputLengths{6};
+    auto arena = manager.createArena(MemoryType::kGPU, BufferArena::kAlignment * 4);
+    auto ids = manager.copyFrom(inputIds, ITensor::makeShape({1, 6}), arena);
+    auto lengths = manager.copyFrom(inputLengths, ITensor::makeShape({1}), arena);
+    auto output = BufferManager::emptyTensor(arena, nvinfer1::DataType::kINT32);
+    EXPECT_EQ(ids->getMemoryType(), MemoryType::kGPU);
+    EXPECT_EQ(arena->getNumBlocks(), 1u);
+
+    // Outgrowing the block adds one
+    output->reshape(ITensor::makeShape({1, 1, 1024}));
+    EXPECT_EQ(arena->getNumBlocks(), 2u);
+
+    auto idsHost = manager.copyFrom(*ids, MemoryType::kCPU);
+    auto lengthsHost = manager.copyFrom(*lengths, MemoryType::kCPU);
+    manager.getStream().synchronize();
+    auto const* idsData = bufferCast<std::int32_t>(*idsHost);
+    EXPECT_EQ(std::vector<std::int32_t>(idsData, idsData + idsHost->getSize()), inputIds);
+    EXPECT_EQ(*bufferCast<std::int32_t>(*lengthsHost), inputLengths.front());
+
+    // The blocks go back when the last tensor is gone
+    std::weak_ptr<BufferArena> weakArena = arena;
+    arena.reset();
+    ids.reset();
+    lengths.reset();
+    EXPECT_FALSE(weakArena.expired());
+    output.reset();
+    EXPECT_TRUE(weakArena.expired());
+}
+
+TEST_F(BufferManagerTest, CopyBatch)
+{
+    BufferManager manager(mStream);
+    auto constexpr size = 1000;
+    IBuffer::SharedPtr device{manager.gpu(size, nvinfer1::DataType::kINT32)};
+    manager.setZero(*device);
+    auto batch = manager.createCopyBatch();
+
+    // Slices of one buffer, out of order and with a gap, plus a standalone buffer
+    std::vector<std::int32_t> head(100);
+    std::iota(head.begin(), head.end(), 0);
+    std::vector<std::int32_t> tail(size - 301);
+    std::iota(tail.begin(), tail.end(), 301);
+    std::vector<std::int32_t> middle(200);
+    std::iota(middle.begin(), middle.end(), 100);
+    auto headSlice = IBuffer::slice(device, 0, head.size());
+    auto middleSlice = IBuffer::slice(device, 100, middle.size());
+    auto tailSlice = IBuffer::slice(device, 301, tail.size());
+    batch->add(std::move(tail), *tailSlice);
+    batch->add(head.data(), *headSlice);
+    batch->add(std::move(middle), *middleSlice);
+    std::vector<std::int32_t> const single{42};
+    auto other = manager.gpu(1, nvinfer1::DataType::kINT32);
+    batch->add(single.data(), *other);
+    EXPECT_EQ(batch->getNumPending(), 4u);
+
+    batch->execute();
+    EXPECT_EQ(batch->getNumPending(), 0u);
+    // Head and middle are adjacent
+    EXPECT_EQ(batch->getNumTransfers(), 3u);
+
+    auto deviceHost = manager.copyFrom(*device, MemoryType::kCPU);
+    auto otherHost = manager.copyFrom(*other, MemoryType::kCPU);
+    manager.getStream().synchronize();
+    auto const* data = bufferCast<std::int32_t>(*deviceHost);
+    for (std::int32_t i = 0; i < size; ++i)
+    {
+        EXPECT_EQ(data[i], i == 300 ? 0 : i) << "at " << i;
+    }
+    EXPECT_EQ(*bufferCast<std::int32_t>(*otherHost), 42);
+}
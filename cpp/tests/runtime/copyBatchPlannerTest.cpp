@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/copyBatchPlanner.h"
+
+#include <array>
+#include <cstdint>
+
+using namespace tensorrt_llm::runtime;
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+using Region = CopyBatchPlanner::Region;
+
+// Stands in for device memory, only addresses are used
+alignas(256) std::array<std::uint8_t, 4096> gDevice;
+alignas(256) std::array<std::uint8_t, 4096> gHost;
+
+void* dst(std::size_t offset)
+{
+    return gDevice.data() + offset;
+}
+
+void const* src(std::size_t offset)
+{
+    return gHost.data() + offset;
+}
+} // namespace
+
+TEST(CopyBatchPlannerTest, Empty)
+{
+    auto const plan = CopyBatchPlanner::plan({{src(0), dst(0), 0}});
+    EXPECT_TRUE(plan.transfers.empty());
+    EXPECT_TRUE(plan.gathers.empty());
+    EXPECT_EQ(plan.stagingSize, 0u);
+}
+
+TEST(CopyBatchPlannerTest, MergeAdjacentDestinations)
+{
+    // Given out of order, with an empty region in between
+    auto const plan = CopyBatchPlanner::plan(
+        {{src(512), dst(64), 32}, {src(0), dst(0), 64}, {src(900), dst(64), 0}, {src(1024), dst(256), 8}});
+    ASSERT_EQ(plan.transfers.size(), 2u);
+    EXPECT_EQ(plan.transfers[0].dst, dst(0));
+    EXPECT_EQ(plan.transfers[0].offset, 0u);
+    EXPECT_EQ(plan.transfers[0].size, 96u);
+    EXPECT_EQ(plan.transfers[1].dst, dst(256));
+    EXPECT_EQ(plan.transfers[1].offset, 96u);
+    EXPECT_EQ(plan.transfers[1].size, 8u);
+    EXPECT_EQ(plan.stagingSize, 104u);
+    EXPECT_EQ(plan.maxTransferSize, 96u);
+
+    // The sources are not adjacent, so each has its own gather
+    ASSERT_EQ(plan.gathers.size(), 3u);
+    EXPECT_EQ(plan.gathers[0].src, src(0));
+    EXPECT_EQ(plan.gathers[0].offset, 0u);
+    EXPECT_EQ(plan.gathers[1].src, src(512));
+    EXPECT_EQ(plan.gathers[1].offset, 64u);
+    EXPECT_EQ(plan.gathers[2].src, src(1024));
+    EXPECT_EQ(plan.gathers[2].offset, 96u);
+}
+
+TEST(CopyBatchPlannerTest, MergeAdjacentSources)
+{
+    auto const plan = CopyBatchPlanner::plan({{src(0), dst(0), 16}, {src(16), dst(16), 48}, {src(64), dst(128), 4},
+        {src(68), dst(261), 4}});
+    ASSERT_EQ(plan.transfers.size(), 3u);
+    // The third region lands right after the first two in staging, so its gather joins theirs
+    EXPECT_EQ(plan.transfers[1].offset, 64u);
+    // The last destination is misaligned and needs padding, so its gather is separate
+    EXPECT_EQ(plan.transfers[2].offset, 69u);
+    ASSERT_EQ(plan.gathers.size(), 2u);
+    EXPECT_EQ(plan.gathers[0].size, 68u);
+    EXPECT_EQ(plan.gathers[1].src, src(68));
+    EXPECT_EQ(plan.gathers[1].offset, 69u);
+}
+
+TEST(CopyBatchPlannerTest, CongruentOffsets)
+{
+    auto const plan = CopyBatchPlanner::plan({{src(0), dst(3), 5}, {src(100), dst(37), 20}, {src(200), dst(1000), 1}});
+    ASSERT_EQ(plan.transfers.size(), 3u);
+    std::size_t end = 0;
+    for (auto const& transfer : plan.transfers)
+    {
+        auto const address = reinterpret_cast<std::uintptr_t>(transfer.dst);
+        EXPECT_EQ(transfer.offset % CopyBatchPlanner::kAlignment, address % CopyBatchPlanner::kAlignment);
+        // No more padding than needed
+        EXPECT_GE(transfer.offset, end);
+        EXPECT_LT(transfer.offset, end + CopyBatchPlanner::kAlignment);
+        end = transfer.offset + transfer.size;
+    }
+    EXPECT_EQ(plan.stagingSize, end);
+}
+
+TEST(CopyBatchPlannerTest, OverlapThrows)
+{
+    EXPECT_THROW(static_cast<void>(CopyBatchPlanner::plan({{src(0), dst(0), 64}, {src(64), dst(32), 64}})),
+        tc::TllmException);
+    EXPECT_THROW(
+        static_cast<void>(CopyBatchPlanner::plan({{src(0), dst(0), 8}, {src(64), dst(0), 8}})), tc::TllmException);
+}
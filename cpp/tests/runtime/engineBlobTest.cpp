@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/common/tllmException.h"
+#include "tensorrt_llm/runtime/engineBlob.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+namespace fs = std::filesystem;
+namespace tc = tensorrt_llm::common;
+
+namespace
+{
+using LoadMode = EngineBlob::LoadMode;
+
+// Not a multiple of the O_DIRECT alignment, to read a partial last block
+std::vector<std::uint8_t> makeContents(std::size_t size)
+{
+    std::vector<std::uint8_t> contents(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        contents[i] = static_cast<std::uint8_t>(i * 31 + 7);
+    }
+    return contents;
+}
+
+std::string writeEngineFile(std::string const& name, std::vector<std::uint8_t> const& contents)
+{
+    auto const path = fs::temp_directory_path() / name;
+    std::ofstream(path, std::ios::binary)
+        .write(reinterpret_cast<char const*>(contents.data()), static_cast<std::streamsize>(contents.size()));
+    return path.string();
+}
+
+} // namespace
+
+class EngineBlobTest : public ::testing::TestWithParam<LoadMode> // NOLINT(cppcoreguidelines-pro-type-member-init)
+{
+};
+
+TEST_P(EngineBlobTest, Load)
+{
+    auto const contents = makeContents(3 * 4096 + 123);
+    auto const path = writeEngineFile("engineBlobTest.engine", contents);
+
+    auto const blob = EngineBlob::load(path, GetParam());
+    ASSERT_EQ(blob->size(), contents.size());
+    EXPECT_EQ(std::memcmp(blob->data(), contents.data(), contents.size()), 0);
+    EXPECT_EQ(blob->getFileId(), EngineBlob::getFileId(path));
+#if defined(_WIN32)
+    EXPECT_EQ(blob->getLoadMode(), LoadMode::kREAD);
+#else
+    // O_DIRECT falls back to reading on file systems that do not support it, such as tmpfs
+    if (GetParam() != LoadMode::kDIRECT)
+    {
+        EXPECT_EQ(blob->getLoadMode(), GetParam());
+    }
+#endif
+    fs::remove(path);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    LoadModes, EngineBlobTest, ::testing::Values(LoadMode::kREAD, LoadMode::kMMAP, LoadMode::kDIRECT));
+
+TEST(EngineBlobRegistryTest, Share)
+{
+    auto const path = writeEngineFile("engineBlobRegistryTest.engine", makeContents(1000));
+    auto& registry = EngineBlobRegistry::getInstance();
+    auto const nbBlobs = registry.getNbBlobs();
+
+    auto first = registry.acquire(path, LoadMode::kMMAP);
+    auto second = registry.acquire(path, LoadMode::kREAD);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(second->getLoadMode(), LoadMode::kMMAP);
+    EXPECT_EQ(registry.getNbBlobs(), nbBlobs + 1);
+
+    // The blob is released with its last user
+    first.reset();
+    EXPECT_EQ(registry.getNbBlobs(), nbBlobs + 1);
+    second.reset();
+    EXPECT_EQ(registry.getNbBlobs(), nbBlobs);
+
+    // A file rebuilt by renaming a new one over it gets a new blob, and the mapped one keeps the old contents
+    auto const blob = registry.acquire(path, LoadMode::kMMAP);
+    auto const rebuilt = makeContents(2000);
+    fs::rename(writeEngineFile("engineBlobRegistryTest.engine.tmp", rebuilt), path);
+    auto const next = registry.acquire(path, LoadMode::kMMAP);
+    EXPECT_NE(next, blob);
+    ASSERT_EQ(next->size(), rebuilt.size());
+    EXPECT_EQ(std::memcmp(next->data(), rebuilt.data(), rebuilt.size()), 0);
+    auto const contents = makeContents(1000);
+    ASSERT_EQ(blob->size(), contents.size());
+    EXPECT_EQ(std::memcmp(blob->data(), contents.data(), contents.size()), 0);
+    fs::remove(path);
+}
+
+TEST(EngineBlobLoadModeTest, Parse)
+{
+    EXPECT_EQ(EngineBlob::parseLoadMode("read"), LoadMode::kREAD);
+    EXPECT_EQ(EngineBlob::parseLoadMode("mmap"), LoadMode::kMMAP);
+    EXPECT_EQ(EngineBlob::parseLoadMode("direct"), LoadMode::kDIRECT);
+    EXPECT_FALSE(EngineBlob::parseLoadMode("").has_value());
+    EXPECT_FALSE(EngineBlob::parseLoadMode("MMAP").has_value());
+}
+
+#if !defined(_WIN32)
+TEST(EngineBlobLoadModeTest, Default)
+{
+    // Mapping is opt-in
+    ::unsetenv("TLLM_ENGINE_LOAD_MODE");
+    EXPECT_EQ(EngineBlob::getDefaultLoadMode(), LoadMode::kREAD);
+    ::setenv("TLLM_ENGINE_LOAD_MODE", "mmap", 1);
+    EXPECT_EQ(EngineBlob::getDefaultLoadMode(), LoadMode::kMMAP);
+    ::setenv("TLLM_ENGINE_LOAD_MODE", "direct", 1);
+    EXPECT_EQ(EngineBlob::getDefaultLoadMode(), LoadMode::kDIRECT);
+    ::setenv("TLLM_ENGINE_LOAD_MODE", "unknown", 1);
+    EXPECT_EQ(EngineBlob::getDefaultLoadMode(), LoadMode::kREAD);
+    ::unsetenv("TLLM_ENGINE_LOAD_MODE");
+}
+#endif
+
+TEST(EngineBlobRegistryTest, MissingFile)
+{
+    auto const path = (fs::temp_directory_path() / "engineBlobRegistryTest.missing").string();
+    EXPECT_THROW(static_cast<void>(EngineBlobRegistry::getInstance().acquire(path)), tc::TllmException);
+    auto const empty = writeEngineFile("engineBlobRegistryTest.empty", {});
+    EXPECT_THROW(static_cast<void>(EngineBlob::load(empty, LoadMode::kMMAP)), tc::TllmException);
+    fs::remove(empty);
+}
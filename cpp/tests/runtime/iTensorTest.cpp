@@ -19,6 +19,9 @@
 
 #include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/iTensor.h"
+#include "tensorrt_llm/runtime/tensorSpan.h"
+
+#include <numeric>
 
 using namespace tensorrt_llm::runtime;
 
@@ -217,3 +220,58 @@ TEST(ITensorTest, TensorSlice)
     auto uniqueSlice = ITensor::slice(std::move(constSlice), 1);
     EXPECT_EQ(uniqueSlice->getShape().d[0], dims.d[0] - offset - 1);
 }
+
+TEST(ITensorTest, TensorSpan)
+{
+    auto dims = ITensor::makeShape({16, 2, 4});
+    auto constexpr dataType = nvinfer1::DataType::kINT32;
+    ITensor::SharedPtr tensor{BufferManager::cpu(dims, dataType)};
+    auto* data = bufferCast<std::int32_t>(*tensor);
+    std::iota(data, data + tensor->getSize(), 0);
+
+    TensorSpan const span{*tensor};
+    EXPECT_EQ(span.data(), tensor->data());
+    EXPECT_EQ(span.getSize(), tensor->getSize());
+    EXPECT_EQ(span.getMemoryType(), MemoryType::kCPU);
+
+    // Same layout as ITensor::slice
+    auto const slice = span.slice(3, 5);
+    auto tensorSlice = ITensor::slice(tensor, 3, 5);
+    EXPECT_EQ(slice.data(), tensorSlice->data());
+    EXPECT_EQ(slice.getShape().d[0], 5);
+    EXPECT_EQ(slice.getSizeInBytes(), tensorSlice->getSizeInBytes());
+    EXPECT_EQ(span.slice(10).getShape().d[0], 6);
+    EXPECT_EQ(span.slice(16).getSize(), 0u);
+    EXPECT_THROW(static_cast<void>(span.slice(17)), std::runtime_error);
+    EXPECT_THROW(static_cast<void>(span.slice(10, 7)), std::runtime_error);
+
+    auto const row = span.at(2);
+    EXPECT_EQ(row.getShape().nbDims, 2);
+    EXPECT_EQ(*bufferCast<std::int32_t>(row), 16);
+    EXPECT_EQ(bufferCast<std::int32_t>(row.at(1).at(3)) - data, 2 * 8 + 4 + 3);
+    EXPECT_THROW(static_cast<void>(bufferCast<float>(row)), std::bad_cast);
+    EXPECT_EQ(span.view(ITensor::makeShape({128})).getShape().nbDims, 1);
+    EXPECT_THROW(static_cast<void>(span.view(ITensor::makeShape({129}))), std::runtime_error);
+
+    // Passed to functions taking an ITensor, and reshaped within the span only
+    SpanTensor spanTensor{slice};
+    ITensor& asTensor = spanTensor;
+    EXPECT_EQ(asTensor.data(), slice.data());
+    EXPECT_EQ(asTensor.getSize(), 40u);
+    EXPECT_NO_THROW(asTensor.reshape(ITensor::makeShape({5, 8})));
+    EXPECT_THROW(asTensor.reshape(ITensor::makeShape({6, 8})), std::runtime_error);
+    EXPECT_NO_THROW(asTensor.release());
+    EXPECT_EQ(asTensor.data(), nullptr);
+
+    // A tensor that keeps its owner alive
+    auto owning = slice.toTensor(tensor);
+    EXPECT_EQ(owning->data(), slice.data());
+    EXPECT_EQ(owning->getShape().d[0], 5);
+    std::weak_ptr<ITensor> weakTensor = tensor;
+    tensor.reset();
+    tensorSlice.reset();
+    EXPECT_FALSE(weakTensor.expired());
+    owning.reset();
+    EXPECT_TRUE(weakTensor.expired());
+    EXPECT_THROW(static_cast<void>(span.toTensor(BufferManager::cpu(dims, dataType))), std::runtime_error);
+}
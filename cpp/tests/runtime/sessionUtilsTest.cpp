@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2022-2024, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tensorrt_llm/runtime/bufferManager.h"
+#include "tensorrt_llm/runtime/utils/sessionUtils.h"
+
+#include <string>
+#include <vector>
+
+using namespace tensorrt_llm::runtime;
+
+namespace
+{
+using TensorMap = StringPtrMap<ITensor>;
+using nvinfer1::DataType;
+} // namespace
+
+TEST(SessionUtilsTest, MakeTensorNames)
+{
+    EXPECT_EQ(utils::makeTensorNames("past_key_value_", 3, 4),
+        (std::vector<std::string>{"past_key_value_4", "past_key_value_5", "past_key_value_6"}));
+    EXPECT_TRUE(utils::makeTensorNames("past_key_value_", 0, 0).empty());
+}
+
+TEST(SessionUtilsTest, UpdateTensor)
+{
+    TensorMap map;
+    ITensor::SharedPtr const first{BufferManager::cpu(ITensor::makeShape({2}), DataType::kINT32)};
+    ITensor::SharedPtr const second{BufferManager::cpu(ITensor::makeShape({2}), DataType::kINT32)};
+
+    utils::updateTensor(map, "input_ids", first);
+    EXPECT_EQ(map.at("input_ids"), first);
+    utils::updateTensor(map, "input_ids", second);
+    EXPECT_EQ(map.at("input_ids"), second);
+
+    auto const names = utils::makeTensorNames("present_key_value_", 2, 0);
+    utils::updateTensorVector(map, names, {first, second});
+    EXPECT_EQ(map.at("present_key_value_0"), first);
+    EXPECT_EQ(map.at("present_key_value_1"), second);
+    utils::updateTensorVector(map, names, {second, first});
+    EXPECT_EQ(map.at("present_key_value_0"), second);
+    EXPECT_EQ(map.at("present_key_value_1"), first);
+    EXPECT_EQ(map.size(), 3u);
+}
+
+TEST(SessionUtilsTest, UpdateTensorView)
+{
+    TensorMap map;
+    ITensor::SharedPtr const kvCache{BufferManager::cpu(ITensor::makeShape({2, 2, 4, 8, 16}), DataType::kHALF)};
+    auto const kvCacheShape = kvCache->getShape();
+    auto emptyShape = kvCacheShape;
+    emptyShape.d[3] = 0;
+
+    utils::updateTensorView(map, "past_key_value_0", kvCache, emptyShape);
+    // Not a shared pointer, which would keep the view from being reused
+    ITensor const* const view = map.at("past_key_value_0").get();
+    EXPECT_NE(view, kvCache.get());
+    EXPECT_EQ(view->getSize(), 0u);
+    EXPECT_TRUE(ITensor::shapeEquals(view->getShape(), emptyShape));
+
+    // The view is reused and reshaped, the tensor it views is not
+    utils::updateTensorView(map, "past_key_value_0", kvCache, kvCacheShape);
+    EXPECT_EQ(map.at("past_key_value_0").get(), view);
+    EXPECT_TRUE(ITensor::shapeEquals(view->getShape(), kvCacheShape));
+    EXPECT_EQ(view->data(), kvCache->data());
+    utils::updateTensorView(map, "past_key_value_0", kvCache, emptyShape);
+    EXPECT_EQ(map.at("past_key_value_0").get(), view);
+    EXPECT_TRUE(ITensor::shapeEquals(view->getShape(), emptyShape));
+    EXPECT_TRUE(ITensor::shapeEquals(kvCache->getShape(), kvCacheShape));
+
+    // A view of another tensor is replaced
+    ITensor::SharedPtr const other{BufferManager::cpu(kvCacheShape, DataType::kHALF)};
+    utils::updateTensorView(map, "past_key_value_0", other, kvCacheShape);
+    EXPECT_EQ(map.at("past_key_value_0")->data(), other->data());
+
+    // A tensor held elsewhere is never reshaped
+    utils::updateTensor(map, "logits", kvCache);
+    utils::updateTensorView(map, "logits", kvCache, emptyShape);
+    EXPECT_NE(map.at("logits"), kvCache);
+    EXPECT_TRUE(ITensor::shapeEquals(map.at("logits")->getShape(), emptyShape));
+    EXPECT_TRUE(ITensor::shapeEquals(kvCache->getShape(), kvCacheShape));
+}
+
+TEST(SessionUtilsTest, DiffTensorMap)
+{
+    TensorMap map;
+    ITensor::SharedPtr const inputIds{BufferManager::cpu(ITensor::makeShape({4}), DataType::kINT32)};
+    ITensor::SharedPtr const positionIds{BufferManager::cpu(ITensor::makeShape({4}), DataType::kINT32)};
+    ITensor::SharedPtr const mask{BufferManager::cpu(ITensor::makeShape({4}), DataType::kINT32)};
+    map.emplace("input_ids", inputIds);
+    map.emplace("position_ids", positionIds);
+    map.emplace("attention_mask", mask);
+
+    auto const snapshot = utils::snapshotTensorMap(map);
+    EXPECT_EQ(snapshot.size(), 3u);
+    EXPECT_TRUE(utils::diffTensorMap(snapshot, map).empty());
+
+    ITensor::SharedPtr const nextInputIds{BufferManager::cpu(ITensor::makeShape({4}), DataType::kINT32)};
+    utils::updateTensor(map, "input_ids", nextInputIds);
+    positionIds->reshape(ITensor::makeShape({2}));
+    map.erase("attention_mask");
+    utils::updateTensor(map, "last_token_ids", mask);
+
+    auto const diff = utils::diffTensorMap(snapshot, map);
+    auto const lines = [&diff]()
+    {
+        std::vector<std::string> result;
+        std::size_t begin = 0;
+        for (auto end = diff.find('\n'); end != std::string::npos; begin = end + 1, end = diff.find('\n', begin))
+        {
+            result.push_back(diff.substr(begin, end - begin));
+        }
+        result.push_back(diff.substr(begin));
+        return result;
+    }();
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[0], "attention_mask: removed");
+    EXPECT_EQ(lines[1].rfind("input_ids: replaced moved ", 0), 0u);
+    EXPECT_EQ(lines[2].rfind("last_token_ids: added", 0), 0u);
+    EXPECT_EQ(lines[3].rfind("position_ids: reshaped", 0), 0u);
+}
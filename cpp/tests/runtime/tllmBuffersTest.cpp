@@ -20,12 +20,19 @@
 #include "tensorrt_llm/batch_manager/namedTensor.h"
 #include "tensorrt_llm/common/cudaUtils.h"
 #include "tensorrt_llm/common/stringUtils.h"
+#include "tensorrt_llm/runtime/allocationAudit.h"
+#include "tensorrt_llm/runtime/bufferManager.h"
 #include "tensorrt_llm/runtime/memoryCounters.h"
 #include "tensorrt_llm/runtime/tllmBuffers.h"
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
 #include <random>
 #include <sstream>
 #include <thread>
@@ -117,6 +124,48 @@ TEST_F(TllmBuffersTest, HostAllocator)
     EXPECT_EQ(allocator.getMemoryType(), MemoryType::kCPU);
 }
 
+TEST_F(TllmBuffersTest, PlacedHostAllocator)
+{
+    auto constexpr hugePageSize = HostMemoryPolicy::kHugePageSize;
+    HostMemoryPolicy policy;
+    EXPECT_TRUE(policy.isDefault());
+    policy.hugePages = true;
+    EXPECT_FALSE(policy.isDefault());
+    EXPECT_FALSE(policy.isMapped(0));
+    EXPECT_FALSE(policy.isMapped(hugePageSize - 1));
+    EXPECT_TRUE(policy.isMapped(hugePageSize));
+
+    // Not a multiple of the page size, and falls back to transparent huge pages if none are reserved
+    auto const size = hugePageSize + 4096 + 3;
+    PlacedCpuAllocator allocator{policy};
+    auto& counters = MemoryCounters::getInstance();
+    auto const initCpu = counters.getCpu();
+    auto* ptr = static_cast<std::uint8_t*>(allocator.allocate(size));
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % hugePageSize, 0u);
+    EXPECT_EQ(counters.getCpu(), initCpu + size);
+    std::fill(ptr, ptr + size, std::uint8_t{0xAB});
+    EXPECT_EQ(ptr[size - 1], 0xAB);
+    allocator.deallocate(ptr, size);
+    EXPECT_EQ(counters.getCpu(), initCpu);
+
+    // Buffers below the huge page size are mapped when they are large enough to bind. Binding may fail, which leaves
+    // the memory unbound.
+    auto constexpr numaMinSize = HostMemoryPolicy::kNumaMinSize;
+    policy.numaNode = 0;
+    EXPECT_FALSE(policy.isMapped(1));
+    EXPECT_FALSE(policy.isMapped(numaMinSize - 1));
+    EXPECT_TRUE(policy.isMapped(numaMinSize));
+    PlacedHostBuffer buffer{100, nvinfer1::DataType::kINT32, PlacedCpuAllocator{policy}};
+    auto* data = bufferCast<std::int32_t>(buffer);
+    std::fill(data, data + buffer.getSize(), 7);
+    buffer.resize(hugePageSize);
+    EXPECT_EQ(buffer.getSizeInBytes(), hugePageSize * sizeof(std::int32_t));
+    EXPECT_EQ(counters.getCpu(), initCpu + buffer.getSizeInBytes());
+    buffer.release();
+    EXPECT_EQ(counters.getCpu(), initCpu);
+}
+
 TEST_F(TllmBuffersTest, UVMAllocator)
 {
     auto constexpr size = 1024;
@@ -411,6 +460,161 @@ TEST_F(TllmBuffersTest, BytesToString)
     EXPECT_EQ(MemoryCounters::bytesToString(diff, precision), "-1.50 TB");
 }
 
+TEST_F(TllmBuffersTest, MemoryCountersTags)
+{
+    auto constexpr size = 1024;
+    auto& counters = MemoryCounters::getInstance();
+    auto const initCpu = counters.getCpu();
+    auto const initKvCache = counters.getTagged(MemoryTag::kKV_CACHE, MemoryType::kCPU);
+    counters.resetPeaks();
+    counters.enableTimeline(2);
+
+    HostAllocator untagged{};
+    std::optional<HostBuffer> kvCacheBuffer;
+    {
+        MemoryTagScope const kvCacheTag{MemoryTag::kKV_CACHE};
+        {
+            MemoryTagScope const loraTag{MemoryTag::kLORA};
+            EXPECT_EQ(MemoryCounters::getCurrentTag(), MemoryTag::kLORA);
+        }
+        EXPECT_EQ(MemoryCounters::getCurrentTag(), MemoryTag::kKV_CACHE);
+        kvCacheBuffer.emplace(size, nvinfer1::DataType::kUINT8);
+    }
+    EXPECT_EQ(MemoryCounters::getCurrentTag(), MemoryTag::kUNTAGGED);
+    EXPECT_EQ(untagged.getMemoryTag(), MemoryTag::kUNTAGGED);
+    EXPECT_EQ(counters.getTagged(MemoryTag::kKV_CACHE, MemoryType::kCPU), initKvCache + size);
+    counters.sample();
+
+    // Growing outside the scope stays with the tag the buffer was created with
+    kvCacheBuffer->resize(4 * size);
+    EXPECT_EQ(counters.getTagged(MemoryTag::kKV_CACHE, MemoryType::kCPU), initKvCache + 4 * size);
+    EXPECT_EQ(counters.getTaggedPeak(MemoryTag::kKV_CACHE, MemoryType::kCPU), initKvCache + 4 * size);
+    counters.sample();
+    kvCacheBuffer.reset();
+    EXPECT_EQ(counters.getTagged(MemoryTag::kKV_CACHE, MemoryType::kCPU), initKvCache);
+    EXPECT_EQ(counters.getTaggedPeak(MemoryTag::kKV_CACHE, MemoryType::kCPU), initKvCache + 4 * size);
+    EXPECT_EQ(counters.getCpu(), initCpu);
+    EXPECT_GE(counters.getCpuPeak(), initCpu + 4 * size);
+    counters.resetPeaks();
+    EXPECT_EQ(counters.getTaggedPeak(MemoryTag::kKV_CACHE, MemoryType::kCPU), initKvCache);
+
+    // The ring buffer keeps the latest samples
+    counters.sample();
+    auto const timeline = counters.getTimeline();
+    ASSERT_EQ(timeline.size(), 2);
+    auto const kvCacheIdx = static_cast<std::size_t>(MemoryTag::kKV_CACHE);
+    auto const cpuIdx = static_cast<std::size_t>(MemoryType::kCPU);
+    EXPECT_EQ(timeline[0].tagged[kvCacheIdx][cpuIdx], initKvCache + 4 * size);
+    EXPECT_EQ(timeline[1].tagged[kvCacheIdx][cpuIdx], initKvCache);
+    EXPECT_LE(timeline[0].timeUs, timeline[1].timeUs);
+
+    auto const csv = counters.timelineToCsv();
+    EXPECT_EQ(csv.rfind("time_us,tag,gpu,cpu,pinned,uvm\n", 0), 0);
+    EXPECT_NE(csv.find(",kv_cache,0," + std::to_string(initKvCache + 4 * size) + ","), std::string::npos);
+    auto const json = counters.timelineToJson();
+    EXPECT_EQ(json.front(), '[');
+    EXPECT_EQ(json.back(), ']');
+    EXPECT_NE(json.find("\"kv_cache\": {\"gpu\": 0, \"cpu\": " + std::to_string(initKvCache + 4 * size)),
+        std::string::npos);
+
+    counters.enableTimeline(0);
+    counters.sample();
+    EXPECT_TRUE(counters.getTimeline().empty());
+    EXPECT_EQ(counters.timelineToJson(), "[]");
+}
+
+TEST_F(TllmBuffersTest, AllocationAudit)
+{
+    auto constexpr size = 1024;
+    auto& audit = AllocationAudit::getInstance();
+    audit.enable();
+    ASSERT_TRUE(AllocationAudit::isEnabled());
+
+    auto const findLora = [](AllocationAudit::Snapshot const& snapshot)
+    {
+        std::size_t count{0};
+        std::size_t bytes{0};
+        for (auto const& usage : snapshot.sites)
+        {
+            if (usage.site.tag == MemoryTag::kLORA && usage.site.memoryType == MemoryType::kCPU)
+            {
+                count += usage.count;
+                bytes += usage.bytes;
+            }
+        }
+        return std::make_pair(count, bytes);
+    };
+
+    auto const before = audit.snapshot();
+    std::vector<HostBuffer> buffers;
+    {
+        MemoryTagScope const loraTag{MemoryTag::kLORA};
+        for (int i = 0; i < 3; ++i)
+        {
+            buffers.emplace_back(size, nvinfer1::DataType::kUINT8);
+        }
+    }
+    auto const held = audit.snapshot();
+    EXPECT_EQ(findLora(held), std::make_pair(std::size_t{3}, std::size_t{3 * size}));
+    EXPECT_GE(held.getBytes(), std::size_t{3 * size});
+    EXPECT_TRUE(std::is_sorted(held.sites.begin(), held.sites.end(),
+        [](auto const& lhs, auto const& rhs) { return lhs.bytes > rhs.bytes; }));
+    EXPECT_NE(held.toString().find("CPU, lora"), std::string::npos);
+
+    // Growing a buffer replaces its record
+    buffers.front().resize(4 * size);
+    EXPECT_EQ(findLora(audit.snapshot()), std::make_pair(std::size_t{3}, std::size_t{6 * size}));
+
+    auto const grown = AllocationAudit::diff(before, audit.snapshot());
+    EXPECT_EQ(grown.getBytes(), std::ptrdiff_t{6 * size});
+    ASSERT_FALSE(grown.sites.empty());
+    EXPECT_EQ(grown.sites.front().site.tag, MemoryTag::kLORA);
+    EXPECT_NE(grown.toString().find("+"), std::string::npos);
+
+    buffers.clear();
+    EXPECT_EQ(findLora(audit.snapshot()), std::make_pair(std::size_t{0}, std::size_t{0}));
+    EXPECT_TRUE(AllocationAudit::diff(before, audit.snapshot()).sites.empty());
+
+    // Pools record their blocks but not their chunks
+    {
+        using Allocator = PoolAllocator<HostAllocator>;
+        MemoryTagScope const loraTag{MemoryTag::kLORA};
+        Allocator allocator{};
+        auto* const ptr = allocator.allocate(size);
+        EXPECT_EQ(findLora(audit.snapshot()), std::make_pair(std::size_t{1}, std::size_t{size}));
+        allocator.deallocate(ptr, size);
+        EXPECT_EQ(findLora(audit.snapshot()), std::make_pair(std::size_t{0}, std::size_t{0}));
+        {
+            MemoryPool<HostAllocator> pool{size};
+            auto* const block = pool.allocate(size);
+            EXPECT_EQ(findLora(audit.snapshot()), std::make_pair(std::size_t{0}, std::size_t{0}));
+            pool.deallocate(block, size);
+        }
+    }
+
+    // Sites differ by stack, not only by tag
+    {
+        MemoryTagScope const loraTag{MemoryTag::kLORA};
+        auto const allocateHere = [] { return HostBuffer{size, nvinfer1::DataType::kUINT8}; };
+        HostBuffer first{size, nvinfer1::DataType::kUINT8};
+        auto second = allocateHere();
+        std::size_t numLoraSites{0};
+        for (auto const& usage : audit.snapshot().sites)
+        {
+            numLoraSites += usage.site.tag == MemoryTag::kLORA ? 1 : 0;
+        }
+#if !defined(_MSC_VER)
+        EXPECT_EQ(numLoraSites, 2u);
+#else
+        EXPECT_EQ(numLoraSites, 1u);
+#endif
+    }
+
+    audit.disable();
+    EXPECT_FALSE(AllocationAudit::isEnabled());
+    EXPECT_TRUE(audit.snapshot().sites.empty());
+}
+
 TEST_F(TllmBuffersTest, PinnedPoolAllocator)
 {
     if (mDeviceCount == 0)
@@ -445,6 +649,8 @@ TEST_F(TllmBuffersTest, PinnedPoolAllocator)
         it = std::next(it);
         EXPECT_EQ(it, std::end(segments));
     }
+    // Freed blocks stay in this thread's cache until flushed
+    PinnedPoolAllocator::flushThreadCache();
 
     auto const chunkSize = pool.getChunkSize();
     auto constexpr initChunkSize = kPinnedPoolChunkSize;
@@ -520,6 +726,434 @@ TEST_F(TllmBuffersTest, MemoryPool)
     EXPECT_EQ(memCounters.getCpu(), initMemory);
 }
 
+TEST_F(TllmBuffersTest, MemoryPoolBestFit)
+{
+    using MemPool = MemoryPool<HostAllocator>;
+    auto constexpr alignment = MemPool::kAlignment;
+    MemPool pool{alignment * 64};
+    auto* const base = static_cast<std::uint8_t*>(pool.allocate(alignment));
+
+    // Holes of 4, 1 and 2 blocks, each followed by a used block
+    std::vector<void*> blocks;
+    for (auto const size : {4, 1, 1, 1, 2, 1})
+    {
+        blocks.push_back(pool.allocate(size * alignment));
+    }
+    pool.deallocate(blocks[0], 4 * alignment);
+    pool.deallocate(blocks[2], alignment);
+    pool.deallocate(blocks[4], 2 * alignment);
+
+    // The smallest hole that fits is used, not the first one
+    EXPECT_EQ(pool.allocate(2 * alignment), blocks[4]);
+    EXPECT_EQ(pool.allocate(alignment), blocks[2]);
+    EXPECT_EQ(pool.allocate(3 * alignment), blocks[0]);
+    EXPECT_EQ(pool.allocate(alignment), base + 4 * alignment);
+    EXPECT_EQ(pool.getUsedSize(), 11 * alignment);
+    EXPECT_EQ(pool.getReservedSize(), 64 * alignment);
+
+    // Freeing everything coalesces the chunk back into one free segment
+    pool.deallocate(base, alignment);
+    for (auto* ptr : blocks)
+    {
+        pool.deallocate(ptr, 0);
+    }
+    pool.deallocate(base + 4 * alignment, alignment);
+    auto const& segments = pool.getMemorySegments();
+    ASSERT_EQ(segments.size(), 1u);
+    EXPECT_EQ(segments.front().tag, nullptr);
+    EXPECT_EQ(segments.front().size, 64 * alignment);
+    EXPECT_EQ(pool.getUsedSize(), 0u);
+}
+
+TEST_F(TllmBuffersTest, MemoryPoolRandomized)
+{
+    using MemPool = MemoryPool<HostAllocator>;
+    auto constexpr alignment = MemPool::kAlignment;
+    MemPool pool{alignment * 1024};
+    std::mt19937 rnd{7}; // NOLINT(*-msc51-cpp)
+    std::vector<std::tuple<std::uint8_t*, std::size_t>> live;
+    std::size_t liveSize{0};
+    for (int i = 0; i < 20000; ++i)
+    {
+        if (!live.empty() && rnd() % 2 == 0)
+        {
+            auto const index = rnd() % live.size();
+            auto const [ptr, size] = live[index];
+            pool.deallocate(ptr, size);
+            liveSize -= tc::ceilDiv(size, alignment) * alignment;
+            live[index] = live.back();
+            live.pop_back();
+        }
+        else
+        {
+            auto const size = std::size_t{1} << (rnd() % 15);
+            auto* ptr = static_cast<std::uint8_t*>(pool.allocate(size));
+            live.emplace_back(ptr, size);
+            liveSize += tc::ceilDiv(size, alignment) * alignment;
+        }
+        ASSERT_EQ(pool.getUsedSize(), liveSize);
+    }
+
+    // Segments tile every chunk, adjacent free segments are always merged
+    auto const& segments = pool.getMemorySegments();
+    std::size_t used{0};
+    for (auto it = segments.begin(); it != segments.end(); ++it)
+    {
+        auto const next = std::next(it);
+        if (next != segments.end() && next->basePointer == it->basePointer)
+        {
+            EXPECT_EQ(next->offset, it->offset + it->size);
+            EXPECT_FALSE(it->tag == nullptr && next->tag == nullptr);
+        }
+        used += it->tag ? it->size : 0;
+    }
+    EXPECT_EQ(used, liveSize);
+    EXPECT_EQ(used + std::accumulate(segments.begin(), segments.end(), std::size_t{0},
+                  [](std::size_t sum, auto const& segment) { return segment.tag ? sum : sum + segment.size; }),
+        pool.getReservedSize());
+
+    for (auto const& [ptr, size] : live)
+    {
+        pool.deallocate(ptr, size);
+    }
+    EXPECT_EQ(pool.getUsedSize(), 0u);
+}
+
+TEST_F(TllmBuffersTest, MemoryPoolTrim)
+{
+    using MemPool = MemoryPool<HostAllocator>;
+    auto constexpr alignment = MemPool::kAlignment;
+    auto constexpr chunkSize = alignment * 4;
+    auto& memCounters = MemoryCounters::getInstance();
+    auto const initMemory = memCounters.getCpu();
+    MemPool pool{chunkSize};
+
+    // Fill the first chunk and leave a hole, then grow a second chunk of twice the request
+    std::vector<void*> small(4);
+    for (auto& ptr : small)
+    {
+        ptr = pool.allocate(alignment);
+    }
+    pool.deallocate(small[1], alignment);
+    auto* large = pool.allocate(3 * alignment);
+    EXPECT_EQ(pool.getReservedSize(), 10 * alignment);
+
+    auto report = pool.getReport();
+    EXPECT_EQ(report.reservedSize, 10 * alignment);
+    EXPECT_EQ(report.usedSize, 6 * alignment);
+    EXPECT_EQ(report.freeSize, 4 * alignment);
+    EXPECT_EQ(report.largestFreeSegment, 3 * alignment);
+    EXPECT_EQ(report.numChunks, 2);
+    EXPECT_EQ(report.numFreeChunks, 0);
+    EXPECT_EQ(report.numFreeSegments, 2);
+    EXPECT_DOUBLE_EQ(report.getFragmentation(), 0.25);
+    // 256 B and 768 B fall into the classes of 2^8 and 2^9
+    ASSERT_EQ(report.freeBytesHistogram.size(), 10);
+    EXPECT_EQ(report.freeBytesHistogram[8], alignment);
+    EXPECT_EQ(report.freeBytesHistogram[9], 3 * alignment);
+    EXPECT_NE(report.toString().find("2 chunks (0 free)"), std::string::npos);
+
+    // Only chunks without used segments are released
+    EXPECT_EQ(pool.trimTo(0), 0);
+    pool.deallocate(large, 3 * alignment);
+    EXPECT_EQ(pool.getReport().numFreeChunks, 1);
+    EXPECT_EQ(pool.trimTo(0), 6 * alignment);
+    EXPECT_EQ(pool.getReservedSize(), chunkSize);
+    EXPECT_EQ(memCounters.getCpu(), initMemory + chunkSize);
+
+    // A trimmed pool grows again on demand
+    large = pool.allocate(3 * alignment);
+    EXPECT_EQ(pool.getReport().numChunks, 2);
+    pool.deallocate(large, 3 * alignment);
+
+    // trimTo keeps what fits into the limit
+    for (auto* ptr : {small[0], small[2], small[3]})
+    {
+        pool.deallocate(ptr, alignment);
+    }
+    EXPECT_EQ(pool.getReport().numFreeChunks, 2);
+    EXPECT_EQ(pool.trimTo(chunkSize), 6 * alignment);
+    EXPECT_EQ(pool.getReservedSize(), chunkSize);
+
+    // Idle chunks are released on the first pool operation after the timeout
+    pool.setIdleTimeout(std::chrono::milliseconds{1});
+    auto* ptr = pool.allocate(alignment);
+    EXPECT_EQ(pool.trimIdle(), 0);
+    pool.deallocate(ptr, alignment);
+    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    EXPECT_EQ(pool.trimIdle(), chunkSize);
+    EXPECT_EQ(pool.getReservedSize(), 0);
+
+    large = pool.allocate(4 * alignment);
+    pool.deallocate(large, 4 * alignment);
+    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    ptr = pool.allocate(alignment);
+    EXPECT_EQ(pool.getReport().numChunks, 1);
+    pool.deallocate(ptr, alignment);
+
+    pool.setIdleTimeout(std::chrono::milliseconds{0});
+    std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    EXPECT_EQ(pool.trimIdle(), 0);
+    EXPECT_EQ(pool.getReport().numFreeChunks, 1);
+}
+
+TEST_F(TllmBuffersTest, PoolAllocatorThreadCache)
+{
+    using Allocator = PoolAllocator<HostAllocator>;
+    auto constexpr alignment = Allocator::PoolType::kAlignment;
+    Allocator allocator{};
+    auto& pool = Allocator::getPool();
+    Allocator::flushThreadCache();
+    auto const poolUsedSize = pool.getUsedSize();
+    auto const initStats = Allocator::getThreadCacheStats();
+
+    // A freed block is reused by the next request of its size class without going to the pool
+    auto* const a = allocator.allocate(10 * alignment);
+    allocator.deallocate(a, 10 * alignment);
+    EXPECT_EQ(allocator.allocate(9 * alignment + 1), a);
+    auto stats = Allocator::getThreadCacheStats();
+    EXPECT_EQ(stats.hits - initStats.hits, 1u);
+    EXPECT_EQ(stats.misses - initStats.misses, 1u);
+    allocator.deallocate(a, 9 * alignment + 1);
+    EXPECT_EQ(pool.getUsedSize(), poolUsedSize + 10 * alignment);
+    EXPECT_EQ(Allocator::getThreadCacheStats().cachedBytes, initStats.cachedBytes + 10 * alignment);
+
+    // Repeated misses refill in growing batches, and a full magazine goes back to the pool in halves
+    std::vector<void*> blocks;
+    for (std::size_t i = 0; i < 4 * Allocator::kMagazineCapacity; ++i)
+    {
+        blocks.push_back(allocator.allocate(3 * alignment));
+    }
+    stats = Allocator::getThreadCacheStats();
+    EXPECT_LT(stats.refills - initStats.refills, blocks.size() / 2);
+    for (auto* ptr : blocks)
+    {
+        allocator.deallocate(ptr, 3 * alignment);
+    }
+    stats = Allocator::getThreadCacheStats();
+    EXPECT_GT(stats.flushes, initStats.flushes);
+    EXPECT_LE(stats.cachedBytes - initStats.cachedBytes, (3 * Allocator::kMagazineCapacity + 10) * alignment);
+
+    // Large requests bypass the cache
+    auto* const large = allocator.allocate(Allocator::kMaxCachedSize + 1);
+    allocator.deallocate(large, Allocator::kMaxCachedSize + 1);
+
+    Allocator::flushThreadCache();
+    EXPECT_EQ(pool.getUsedSize(), poolUsedSize);
+    EXPECT_EQ(Allocator::getThreadCacheStats().cachedBytes, initStats.cachedBytes);
+}
+
+TEST_F(TllmBuffersTest, PoolAllocatorThreadCacheConcurrent)
+{
+    using Allocator = PoolAllocator<HostAllocator>;
+    auto& pool = Allocator::getPool();
+    Allocator::flushThreadCache();
+    auto const poolUsedSize = pool.getUsedSize();
+
+    // Threads free each other's blocks through a shared queue, so blocks move between caches
+    auto constexpr numThreads = 4;
+    auto constexpr numIterations = 5000;
+    std::mutex lock;
+    std::vector<std::tuple<std::uint8_t*, std::size_t>> shared;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t)
+    {
+        threads.emplace_back(
+            [&, t]()
+            {
+                Allocator allocator{};
+                std::mt19937 rnd(t); // NOLINT(*-msc51-cpp)
+                std::vector<std::tuple<std::uint8_t*, std::size_t>> live;
+                for (int i = 0; i < numIterations; ++i)
+                {
+                    auto const size = std::size_t{1} << (rnd() % 18);
+                    auto* const ptr = static_cast<std::uint8_t*>(allocator.allocate(size));
+                    // Catch blocks handed out twice
+                    std::fill(ptr, ptr + size, static_cast<std::uint8_t>(t));
+                    live.emplace_back(ptr, size);
+                    if (rnd() % 4 == 0)
+                    {
+                        std::lock_guard<std::mutex> guard(lock);
+                        shared.push_back(live.back());
+                        live.pop_back();
+                    }
+                    if (live.size() > 32 || (!live.empty() && rnd() % 2 == 0))
+                    {
+                        auto const [p, s] = live.front();
+                        EXPECT_TRUE(std::all_of(p, p + s, [t](auto v) { return v == t; }));
+                        allocator.deallocate(p, s);
+                        live.erase(live.begin());
+                    }
+                    std::unique_lock<std::mutex> guard(lock);
+                    if (!shared.empty())
+                    {
+                        auto const [p, s] = shared.back();
+                        shared.pop_back();
+                        guard.unlock();
+                        allocator.deallocate(p, s);
+                    }
+                }
+                for (auto const& [p, s] : live)
+                {
+                    allocator.deallocate(p, s);
+                }
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    Allocator allocator{};
+    for (auto const& [p, s] : shared)
+    {
+        allocator.deallocate(p, s);
+    }
+
+    // Exiting threads flushed their caches
+    Allocator::flushThreadCache();
+    EXPECT_EQ(pool.getUsedSize(), poolUsedSize);
+}
+
+TEST_F(TllmBuffersTest, PoolAllocatorThreadCacheAtExit)
+{
+    using Allocator = PoolAllocator<HostAllocator>;
+    auto constexpr alignment = Allocator::PoolType::kAlignment;
+    auto& pool = Allocator::getPool();
+    Allocator::flushThreadCache();
+    auto const poolUsedSize = pool.getUsedSize();
+
+    // Allocates 9 units, of the 10-unit size class, when its thread exits
+    struct ExitAllocation
+    {
+        std::uint8_t** block;
+
+        ~ExitAllocation()
+        {
+            *block = static_cast<std::uint8_t*>(Allocator{}.allocate(9 * alignment));
+        }
+    };
+
+    std::uint8_t* block{nullptr};
+    std::thread(
+        [&block]()
+        {
+            // Constructed before the thread's cache, so destroyed after it
+            thread_local ExitAllocation exitAllocation{&block};
+            Allocator allocator{};
+            allocator.deallocate(allocator.allocate(alignment), alignment);
+        })
+        .join();
+    ASSERT_NE(block, nullptr);
+    // Allocated from the pool with the size of its class
+    EXPECT_EQ(pool.getUsedSize(), poolUsedSize + 10 * alignment);
+
+    // Freed into this thread's cache, where it serves any request of its class
+    Allocator allocator{};
+    allocator.deallocate(block, 9 * alignment);
+    auto* const reused = static_cast<std::uint8_t*>(allocator.allocate(10 * alignment));
+    EXPECT_EQ(reused, block);
+    std::fill(reused, reused + 10 * alignment, std::uint8_t{0xab});
+    allocator.deallocate(reused, 10 * alignment);
+
+    Allocator::flushThreadCache();
+    EXPECT_EQ(pool.getUsedSize(), poolUsedSize);
+}
+
+TEST_F(TllmBuffersTest, PoolAllocatorThreadCacheFlushRequest)
+{
+    using Allocator = PoolAllocator<HostAllocator>;
+    auto constexpr alignment = Allocator::PoolType::kAlignment;
+    auto& pool = Allocator::getPool();
+    Allocator::requestFlushAll();
+    pool.trimTo(0);
+    auto const poolUsedSize = pool.getUsedSize();
+    auto const poolReservedSize = pool.getReservedSize();
+
+    // Steps of a thread that caches a block and stays alive
+    std::mutex lock;
+    std::condition_variable cv;
+    int step{0};
+    auto const waitFor = [&](int expected)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        cv.wait(guard, [&]() { return step == expected; });
+    };
+    auto const advance = [&]()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            ++step;
+        }
+        cv.notify_all();
+    };
+
+    std::thread thread(
+        [&]()
+        {
+            Allocator allocator{};
+            auto* const held = allocator.allocate(alignment);
+            allocator.deallocate(allocator.allocate(alignment), alignment);
+            advance();
+            waitFor(2);
+            allocator.deallocate(held, alignment);
+            advance();
+            waitFor(4);
+        });
+
+    // The cached block keeps its chunk
+    waitFor(1);
+    EXPECT_GT(pool.getUsedSize(), poolUsedSize + alignment);
+    Allocator::requestFlushAll();
+    pool.trimTo(0);
+    EXPECT_GT(pool.getReservedSize(), poolReservedSize);
+
+    // The thread flushes on its next free, including the block it frees
+    advance();
+    waitFor(3);
+    EXPECT_EQ(pool.getUsedSize(), poolUsedSize);
+    pool.trimTo(0);
+    EXPECT_EQ(pool.getReservedSize(), poolReservedSize);
+
+    advance();
+    thread.join();
+}
+
+TEST_F(TllmBuffersTest, BufferArena)
+{
+    auto constexpr alignment = BufferArena::kAlignment;
+    auto& memCounters = MemoryCounters::getInstance();
+    auto const initMemory = memCounters.getCpu();
+    auto arena = std::make_shared<BufferArena>(MemoryType::kCPU, 8 * alignment);
+    EXPECT_EQ(arena->getNumBlocks(), 0u);
+
+    // Consecutive allocations are carved from one block
+    auto a = BufferManager::allocate(arena, ITensor::makeShape({4, 8}), nvinfer1::DataType::kINT32);
+    auto b = BufferManager::allocate(arena, alignment + 1);
+    auto c = BufferManager::emptyTensor(arena, nvinfer1::DataType::kFLOAT);
+    EXPECT_EQ(a->getMemoryType(), MemoryType::kCPU);
+    EXPECT_EQ(static_cast<std::uint8_t*>(b->data()), static_cast<std::uint8_t*>(a->data()) + alignment);
+    EXPECT_EQ(c->data(), nullptr);
+    EXPECT_EQ(arena->getNumBlocks(), 1u);
+    EXPECT_EQ(arena->getUsedSize(), 3 * alignment);
+    EXPECT_EQ(memCounters.getCpu(), initMemory + 8 * alignment);
+
+    // Freeing does not give memory back, growing past the block adds one of the request's size
+    b.reset();
+    c->reshape(ITensor::makeShape({4 * alignment}));
+    EXPECT_EQ(arena->getNumBlocks(), 2u);
+    EXPECT_EQ(arena->getReservedSize(), 8 * alignment + 16 * alignment);
+    EXPECT_EQ(arena->getUsedSize(), 19 * alignment);
+    c->reshape(ITensor::makeShape({alignment / 4}));
+    EXPECT_EQ(arena->getNumBlocks(), 2u);
+
+    // Buffers keep the arena alive
+    arena.reset();
+    a.reset();
+    EXPECT_EQ(memCounters.getCpu(), initMemory + 24 * alignment);
+    c.reset();
+    EXPECT_EQ(memCounters.getCpu(), initMemory);
+}
+
 TEST_F(TllmBuffersTest, PinnedPoolStressTest)
 {
     if (mDeviceCount == 0)
@@ -564,6 +1198,7 @@ TEST_F(TllmBuffersTest, PinnedPoolStressTest)
     }
     allocations.resize(deallocIdx);
     EXPECT_GE(pool.getUsedSize(), poolUsedSize + totalUsedSize);
+    Allocator::flushThreadCache();
     EXPECT_EQ(memCounters.getPinned() - initMemory, pool.getReservedSize() - poolReservedSize);
 
     std::thread thread(
@@ -585,6 +1220,7 @@ TEST_F(TllmBuffersTest, PinnedPoolStressTest)
                 totalUsedSize -= size;
             }
             EXPECT_EQ(totalUsedSize, 0u);
+            Allocator::flushThreadCache();
             EXPECT_EQ(pool.getUsedSize(), poolUsedSize);
         });
     thread.join();
@@ -23,6 +23,7 @@
 #include <gtest/gtest.h>
 
 #include "tensorrt_llm/common/cudaUtils.h"
+#include "tensorrt_llm/common/tllmException.h"
 #include "tensorrt_llm/runtime/tllmLogger.h"
 #include "tensorrt_llm/runtime/tllmRuntime.h"
 
@@ -144,3 +145,56 @@ TEST_F(TllmRuntimeTest, SinglePass)
     auto max = std::max_element(output.begin(), output.end());
     EXPECT_NEAR(*max, 0.140218f, 1e-5f);
 }
+
+TEST_F(TllmRuntimeTest, BindBySlot)
+{
+    TllmRuntime rt{*mSerializedEngine, mLogger};
+    auto& engine = rt.getEngine();
+    auto const& plan = rt.getBindingPlan();
+    ASSERT_EQ(plan.getNbSlots(), engine.getNbIOTensors());
+    for (SizeType slot = 0; slot < plan.getNbSlots(); ++slot)
+    {
+        auto const& desc = plan.getTensorDesc(slot);
+        EXPECT_EQ(desc.name, engine.getIOTensorName(slot));
+        EXPECT_EQ(desc.ioMode, engine.getTensorIOMode(desc.name.c_str()));
+        EXPECT_EQ(desc.dataType, engine.getTensorDataType(desc.name.c_str()));
+    }
+    ASSERT_EQ(plan.getInputSlots().size(), 1u);
+    ASSERT_EQ(plan.getOutputSlots().size(), 1u);
+    auto const inputSlot = plan.getInputSlots().front();
+    auto const outputSlot = plan.getOutputSlots().front();
+    rt.addContext(0);
+
+    auto& allocator = rt.getBufferManager();
+    TllmRuntime::TensorSlots tensorSlots(plan.getNbSlots());
+    auto const& inputDesc = plan.getTensorDesc(inputSlot);
+    tensorSlots[inputSlot] = allocator.gpu(inputDesc.shape, inputDesc.dataType);
+    allocator.setZero(*tensorSlots[inputSlot]);
+    rt.setInputTensors(0, tensorSlots);
+    rt.setOutputTensors(0, tensorSlots);
+    ASSERT_NE(tensorSlots[outputSlot], nullptr);
+    auto const outputBuffer = tensorSlots[outputSlot];
+
+    // Binding the same tensors again is a no-op, binding a new input takes effect
+    for (int i = 0; i < 2; ++i)
+    {
+        rt.setInputTensors(0, tensorSlots);
+        rt.setOutputTensors(0, tensorSlots);
+        EXPECT_EQ(tensorSlots[outputSlot], outputBuffer);
+        allocator.setZero(*outputBuffer);
+        EXPECT_TRUE(rt.executeContext(0));
+
+        std::vector<float> output(outputBuffer->getSize());
+        allocator.copy(*outputBuffer, output.data());
+        rt.getStream().synchronize();
+        auto const min = std::min_element(output.begin(), output.end());
+        EXPECT_NEAR(*min, -0.126409f, 1e-5f);
+
+        tensorSlots[inputSlot] = allocator.gpu(inputDesc.shape, inputDesc.dataType);
+        allocator.setZero(*tensorSlots[inputSlot]);
+    }
+
+    // Missing inputs are reported by name
+    tensorSlots[inputSlot].reset();
+    EXPECT_THROW(rt.setInputTensors(0, tensorSlots), tc::TllmException);
+}